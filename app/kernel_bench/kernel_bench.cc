@@ -0,0 +1,684 @@
+/*
+This file is part of the Ristra portage project.
+Please see the license file at the root of this repository, or at:
+    https://github.com/laristra/portage/blob/master/LICENSE
+*/
+
+#include <vector>
+#include <string>
+#include <array>
+#include <memory>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <map>
+#include <random>
+
+#ifdef PORTAGE_ENABLE_MPI
+#include <mpi.h>
+#endif
+
+// portage includes
+#include "portage/support/portage.h"
+#include "portage/support/timer.h"
+#include "portage/support/weights_csr.h"
+#include "portage/support/gid_map.h"
+#include "portage/search/search_kdtree.h"
+#include "portage/search/search_bvh.h"
+#include "portage/search/search_simple.h"
+#include "portage/search/search_direct_product.h"
+#include "portage/search/search_swept_face.h"
+#include "portage/intersect/intersect_r2d.h"
+#include "portage/intersect/intersect_r3d.h"
+#include "portage/intersect/intersect_swept_face.h"
+#include "portage/interpolate/gradient.h"
+#include "portage/interpolate/interpolate_1st_order.h"
+#include "portage/interpolate/interpolate_2nd_order.h"
+
+// wonton includes
+#include "wonton/mesh/simple/simple_mesh.h"
+#include "wonton/mesh/simple/simple_mesh_wrapper.h"
+#include "wonton/mesh/direct_product/direct_product_mesh.h"
+#include "wonton/mesh/direct_product/direct_product_mesh_wrapper.h"
+#include "wonton/state/state_vector_uni.h"
+#include "wonton/state/simple/simple_state_mm_wrapper.h"
+#include "wonton/support/Point.h"
+#include "wonton/support/Vector.h"
+
+/*!
+  @file kernel_bench.cc
+  @brief Microbenchmarks of the search, intersect, gradient and
+  interpolate kernels on Wonton::Simple_Mesh (Direct_Product_Mesh for
+  SearchDirectProduct), without the remap drivers, MPI or Jali.
+
+  Each kernel is run on the owned entities of unit square/cube meshes of
+  several resolutions, repeatedly until a minimal time has elapsed. The
+  source mesh is 'ratio' times finer than the target mesh along each
+  axis, which sets the number of candidates per target cell. The mean
+  time of a run and the throughput in entities per second are reported,
+  where entities are source cells for the set-up phases (".build") and
+  target cells otherwise. The global id maps of the redistribution are
+  benchmarked separately on 'gids' entities.
+*/
+
+using Wonton::Simple_Mesh;
+using Wonton::Simple_Mesh_Wrapper;
+using Wonton::Entity_kind;
+using Wonton::Entity_type;
+
+using State = Wonton::Simple_State_Wrapper<Simple_Mesh_Wrapper>;
+
+//////////////////////////////////////////////////////////////////////
+// Options and reporting
+
+struct Options {
+  std::vector<std::string> kernels;        // empty means all
+  std::vector<int> sizes2d = {32, 64, 128, 256};
+  std::vector<int> sizes3d = {8, 16, 32};
+  std::vector<double> ratios = {1.25, 2.5};
+  std::vector<int> gids = {1000000, 10000000};  // global ids mapped
+  double min_time = 0.2;                   // seconds per measurement
+  std::string csv;                         // optional output file
+};
+
+struct Record {
+  std::string kernel;
+  int dim;
+  int nsource;
+  int ntarget;
+  double candidates;   // mean candidates per target cell
+  int nentities;       // entities processed in one run
+  double seconds;      // mean time of one run
+};
+
+std::vector<Record> records;
+
+bool selected(Options const& options, std::string const& kernel) {
+  return options.kernels.empty() or
+         std::find(options.kernels.begin(), options.kernels.end(), kernel)
+         != options.kernels.end();
+}
+
+void report(Record const& record) {
+  std::printf("%-24s %3d %10d %10d %8.2f %12.3e %12.3e\n",
+              record.kernel.data(), record.dim, record.nsource,
+              record.ntarget, record.candidates, record.seconds,
+              record.nentities / std::max(record.seconds, 1.E-9));
+  std::fflush(stdout);
+  records.push_back(record);
+}
+
+/*!
+  @brief Run a kernel repeatedly for at least 'min_time' seconds
+  @param[in] kernel: the kernel to run.
+  @param[in] min_time: minimal time to run it for.
+  @return the mean time of one run in seconds.
+*/
+template<class Kernel>
+double measure(Kernel&& kernel, double min_time) {
+  kernel();  // warm up caches and allocations
+  int runs = 0;
+  double elapsed = 0.;
+  auto tic = timer::now();
+  do {
+    kernel();
+    runs++;
+    elapsed = timer::elapsed(tic);
+  } while (elapsed < min_time);
+  return elapsed / runs;
+}
+
+double mean_size(Portage::vector<std::vector<int>> const& candidates) {
+  int const n = candidates.size();
+  double total = 0.;
+  for (int i = 0; i < n; i++) {
+    std::vector<int> const& list = candidates[i];
+    total += list.size();
+  }
+  return n > 0 ? total / n : 0.;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Meshes and fields
+
+/*!
+  @class Problem
+  @brief Source and target Simple_Mesh of the unit square (D = 2) or
+  cube (D = 3) with a smooth field on the source cells.
+*/
+template<int D>
+class Problem {
+ public:
+  Problem(int nsource, int ntarget, double shift = 0.)
+    : source_mesh(make_mesh(nsource, 0.)),
+      target_mesh(make_mesh(ntarget, shift)),
+      source_mesh_wrapper(*source_mesh),
+      target_mesh_wrapper(*target_mesh),
+      source_state(source_mesh_wrapper),
+      target_state(target_mesh_wrapper) {
+
+    int const ncells = source_mesh_wrapper.num_owned_cells();
+    std::vector<double> values(ncells);
+    for (int c = 0; c < ncells; c++) {
+      Wonton::Point<D> centroid;
+      source_mesh_wrapper.cell_centroid(c, &centroid);
+      values[c] = 1. + centroid[0];
+      for (int d = 0; d < D; d++)
+        values[c] += centroid[d] * centroid[d];
+    }
+    source_state.add(std::make_shared<Wonton::StateVectorUni<>>(
+        "density", Entity_kind::CELL, values));
+  }
+
+  Problem(Problem const&) = delete;
+  Problem& operator=(Problem const&) = delete;
+
+  int num_source() const { return source_mesh_wrapper.num_owned_cells(); }
+  int num_target() const { return target_mesh_wrapper.num_owned_cells(); }
+
+  std::shared_ptr<Simple_Mesh> source_mesh;
+  std::shared_ptr<Simple_Mesh> target_mesh;
+  Simple_Mesh_Wrapper source_mesh_wrapper;
+  Simple_Mesh_Wrapper target_mesh_wrapper;
+  State source_state;
+  State target_state;
+
+ private:
+  static std::shared_ptr<Simple_Mesh> make_mesh(int n, double shift) {
+    double const x0 = shift, x1 = 1. + shift;
+    if (D == 2)
+      return std::make_shared<Simple_Mesh>(x0, x0, x1, x1, n, n);
+    else
+      return std::make_shared<Simple_Mesh>(x0, x0, x0, x1, x1, x1, n, n, n);
+  }
+};
+
+/// Polytope intersector of each dimension
+template<int D> struct Intersector;
+
+template<> struct Intersector<2> {
+  using type = Portage::IntersectR2D<Entity_kind::CELL, Simple_Mesh_Wrapper,
+                                     State, Simple_Mesh_Wrapper>;
+  static char const* name() { return "IntersectR2D"; }
+};
+
+template<> struct Intersector<3> {
+  using type = Portage::IntersectR3D<Entity_kind::CELL, Simple_Mesh_Wrapper,
+                                     State, Simple_Mesh_Wrapper>;
+  static char const* name() { return "IntersectR3D"; }
+};
+
+/*!
+  @brief Candidates of each target cell found with a k-d tree
+*/
+template<int D>
+Portage::vector<std::vector<int>> find_candidates(Problem<D> const& problem) {
+  Portage::SearchKDTree<D, Entity_kind::CELL,
+                        Simple_Mesh_Wrapper, Simple_Mesh_Wrapper>
+      search(problem.source_mesh_wrapper, problem.target_mesh_wrapper);
+
+  Portage::vector<std::vector<int>> candidates(problem.num_target());
+  auto const& target_mesh = problem.target_mesh_wrapper;
+  Portage::transform(target_mesh.begin(Entity_kind::CELL, Entity_type::PARALLEL_OWNED),
+                     target_mesh.end(Entity_kind::CELL, Entity_type::PARALLEL_OWNED),
+                     candidates.begin(),
+                     [&search](int t) { return search(t); });
+  return candidates;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Search kernels
+
+// Searches with the interface of the drivers' search slot
+template<int D, template<int, Entity_kind, class, class> class SearchType>
+void bench_search(Options const& options, Problem<D> const& problem,
+                  std::string const& name) {
+  using Search = SearchType<D, Entity_kind::CELL,
+                            Simple_Mesh_Wrapper, Simple_Mesh_Wrapper>;
+  auto const& source_mesh = problem.source_mesh_wrapper;
+  auto const& target_mesh = problem.target_mesh_wrapper;
+  int const nsource = problem.num_source();
+  int const ntarget = problem.num_target();
+
+  double const build = measure([&]() {
+    Search search(source_mesh, target_mesh);
+  }, options.min_time);
+
+  Search search(source_mesh, target_mesh);
+  Portage::vector<std::vector<int>> candidates(ntarget);
+  double const query = measure([&]() {
+    Portage::transform(target_mesh.begin(Entity_kind::CELL, Entity_type::PARALLEL_OWNED),
+                       target_mesh.end(Entity_kind::CELL, Entity_type::PARALLEL_OWNED),
+                       candidates.begin(),
+                       [&search](int t) { return search(t); });
+  }, options.min_time);
+
+  double const ncandidates = mean_size(candidates);
+  report({name + ".build", D, nsource, ntarget, ncandidates, nsource, build});
+  report({name, D, nsource, ntarget, ncandidates, ntarget, query});
+}
+
+// SearchSimple only handles 2D meshes
+void bench_search_simple(Options const& options, Problem<2> const& problem) {
+  using Search = Portage::SearchSimple<Simple_Mesh_Wrapper, Simple_Mesh_Wrapper>;
+  auto const& source_mesh = problem.source_mesh_wrapper;
+  auto const& target_mesh = problem.target_mesh_wrapper;
+  int const nsource = problem.num_source();
+  int const ntarget = problem.num_target();
+
+  double const build = measure([&]() {
+    Search search(source_mesh, target_mesh);
+  }, options.min_time);
+
+  Search search(source_mesh, target_mesh);
+  Portage::vector<std::vector<int>> candidates(ntarget);
+  double const query = measure([&]() {
+    Portage::transform(target_mesh.begin(Entity_kind::CELL, Entity_type::PARALLEL_OWNED),
+                       target_mesh.end(Entity_kind::CELL, Entity_type::PARALLEL_OWNED),
+                       candidates.begin(),
+                       [&search](int t) {
+                         std::vector<int> list;
+                         search(t, &list);
+                         return list;
+                       });
+  }, options.min_time);
+
+  double const ncandidates = mean_size(candidates);
+  report({"SearchSimple.build", 2, nsource, ntarget, ncandidates, nsource, build});
+  report({"SearchSimple", 2, nsource, ntarget, ncandidates, ntarget, query});
+}
+
+// SearchDirectProduct works on Direct_Product_Mesh of the same extents
+template<int D>
+void bench_search_direct_product(Options const& options,
+                                 int nsource_axis, int ntarget_axis) {
+  using Mesh = Wonton::Direct_Product_Mesh<D>;
+  using Wrapper = Wonton::Direct_Product_Mesh_Wrapper<D>;
+  using Search = Portage::SearchDirectProduct<D, Wrapper, Wrapper>;
+
+  auto axis_edges = [](int n) {
+    std::array<std::vector<double>, D> edges;
+    for (int d = 0; d < D; d++) {
+      edges[d].resize(n + 1);
+      for (int i = 0; i <= n; i++)
+        edges[d][i] = static_cast<double>(i) / n;
+    }
+    return edges;
+  };
+
+  Mesh source(axis_edges(nsource_axis));
+  Mesh target(axis_edges(ntarget_axis));
+  Wrapper const source_wrapper(source);
+  Wrapper const target_wrapper(target);
+  int const nsource = source_wrapper.num_owned_cells();
+  int const ntarget = target_wrapper.num_owned_cells();
+
+  Search search(source_wrapper, target_wrapper);
+  Portage::vector<std::vector<int>> candidates(ntarget);
+  double const query = measure([&]() {
+    Portage::transform(Portage::make_counting_iterator(0),
+                       Portage::make_counting_iterator(ntarget),
+                       candidates.begin(),
+                       [&search](int t) { return search(t); });
+  }, options.min_time);
+
+  report({"SearchDirectProduct", D, nsource, ntarget,
+          mean_size(candidates), ntarget, query});
+}
+
+//////////////////////////////////////////////////////////////////////
+// Intersect kernels
+
+template<int D>
+void bench_intersect(Options const& options, Problem<D> const& problem) {
+  auto const& target_mesh = problem.target_mesh_wrapper;
+  int const ntarget = problem.num_target();
+
+  auto const candidates = find_candidates(problem);
+
+  typename Intersector<D>::type intersect(problem.source_mesh_wrapper,
+                                          problem.source_state, target_mesh,
+                                          Portage::DEFAULT_NUMERIC_TOLERANCES<D>);
+
+  Portage::vector<std::vector<Wonton::Weights_t>> weights(ntarget);
+  double const seconds = measure([&]() {
+    Portage::transform(target_mesh.begin(Entity_kind::CELL, Entity_type::PARALLEL_OWNED),
+                       target_mesh.end(Entity_kind::CELL, Entity_type::PARALLEL_OWNED),
+                       candidates.begin(), weights.begin(),
+                       [&intersect](int t, std::vector<int> const& list) {
+                         return intersect(t, list);
+                       });
+  }, options.min_time);
+
+  report({Intersector<D>::name(), D, problem.num_source(), ntarget,
+          mean_size(candidates), ntarget, seconds});
+}
+
+// Swept-face intersection of a mesh with a copy of itself shifted by a
+// fraction of a cell (same topology, as required by the swept-face remap)
+template<int D>
+void bench_intersect_swept_face(Options const& options, int n) {
+  Problem<D> const problem(n, n, 0.25 / n);
+  auto const& source_mesh = problem.source_mesh_wrapper;
+  auto const& target_mesh = problem.target_mesh_wrapper;
+  int const ntarget = problem.num_target();
+
+  Portage::SearchSweptFace<D, Entity_kind::CELL,
+                           Simple_Mesh_Wrapper, Simple_Mesh_Wrapper>
+      search(source_mesh, target_mesh);
+
+  Portage::vector<std::vector<int>> candidates(ntarget);
+  Portage::transform(target_mesh.begin(Entity_kind::CELL, Entity_type::PARALLEL_OWNED),
+                     target_mesh.end(Entity_kind::CELL, Entity_type::PARALLEL_OWNED),
+                     candidates.begin(),
+                     [&search](int t) { return search(t); });
+
+  Portage::IntersectSweptFace<D, Entity_kind::CELL,
+                              Simple_Mesh_Wrapper, State, Simple_Mesh_Wrapper>
+      intersect(source_mesh, problem.source_state, target_mesh,
+                Portage::DEFAULT_NUMERIC_TOLERANCES<D>);
+
+  Portage::vector<std::vector<Wonton::Weights_t>> weights(ntarget);
+  double const seconds = measure([&]() {
+    Portage::transform(target_mesh.begin(Entity_kind::CELL, Entity_type::PARALLEL_OWNED),
+                       target_mesh.end(Entity_kind::CELL, Entity_type::PARALLEL_OWNED),
+                       candidates.begin(), weights.begin(),
+                       [&intersect](int t, std::vector<int> const& list) {
+                         return intersect(t, list);
+                       });
+  }, options.min_time);
+
+  report({"IntersectSweptFace", D, problem.num_source(), ntarget,
+          mean_size(candidates), ntarget, seconds});
+}
+
+//////////////////////////////////////////////////////////////////////
+// Gradient and interpolate kernels
+
+template<int D>
+using Gradient = Portage::Limited_Gradient<D, Entity_kind::CELL,
+                                           Simple_Mesh_Wrapper, State>;
+
+template<int D>
+Portage::vector<Wonton::Vector<D>> compute_gradient(Problem<D> const& problem) {
+  auto const& source_mesh = problem.source_mesh_wrapper;
+  Gradient<D> gradient(source_mesh, problem.source_state, "density",
+                       Portage::DEFAULT_LIMITER, Portage::DEFAULT_BND_LIMITER);
+
+  Portage::vector<Wonton::Vector<D>> field(problem.num_source());
+  Portage::transform(source_mesh.begin(Entity_kind::CELL, Entity_type::PARALLEL_OWNED),
+                     source_mesh.end(Entity_kind::CELL, Entity_type::PARALLEL_OWNED),
+                     field.begin(), [&gradient](int c) { return gradient(c); });
+  return field;
+}
+
+template<int D>
+void bench_gradient(Options const& options, Problem<D> const& problem) {
+  auto const& source_mesh = problem.source_mesh_wrapper;
+  int const nsource = problem.num_source();
+
+  // neighbor lists are collected when the kernel is built
+  double const build = measure([&]() {
+    Gradient<D> gradient(source_mesh, problem.source_state, "density",
+                         Portage::DEFAULT_LIMITER, Portage::DEFAULT_BND_LIMITER);
+  }, options.min_time);
+
+  Gradient<D> gradient(source_mesh, problem.source_state, "density",
+                       Portage::DEFAULT_LIMITER, Portage::DEFAULT_BND_LIMITER);
+
+  Portage::vector<Wonton::Vector<D>> field(nsource);
+  double const apply = measure([&]() {
+    Portage::transform(source_mesh.begin(Entity_kind::CELL, Entity_type::PARALLEL_OWNED),
+                       source_mesh.end(Entity_kind::CELL, Entity_type::PARALLEL_OWNED),
+                       field.begin(), [&gradient](int c) { return gradient(c); });
+  }, options.min_time);
+
+  report({"Limited_Gradient.build", D, nsource, problem.num_target(), 0., nsource, build});
+  report({"Limited_Gradient", D, nsource, problem.num_target(), 0., nsource, apply});
+}
+
+template<int D,
+         template<int, Entity_kind, class, class, class, class, class,
+                  template<class, int, class, class> class,
+                  class, class, class> class Interpolate>
+void bench_interpolate(Options const& options, Problem<D> const& problem,
+                       std::string const& name) {
+  auto const& target_mesh = problem.target_mesh_wrapper;
+  int const ntarget = problem.num_target();
+
+  // moments of intersection in the layout used by the drivers
+  auto const candidates = find_candidates(problem);
+  typename Intersector<D>::type intersect(problem.source_mesh_wrapper,
+                                          problem.source_state, target_mesh,
+                                          Portage::DEFAULT_NUMERIC_TOLERANCES<D>);
+
+  Portage::WeightsCSR weights;
+  for (int t = 0; t < ntarget; t++) {
+    std::vector<int> const& list = candidates[t];
+    weights.append(intersect(t, list));
+  }
+
+  auto gradient = compute_gradient(problem);
+
+  Interpolate<D, Entity_kind::CELL,
+              Simple_Mesh_Wrapper, Simple_Mesh_Wrapper, State, State, double,
+              Portage::DummyInterfaceReconstructor, void, void,
+              Wonton::DefaultCoordSys>
+      interpolate(problem.source_mesh_wrapper, target_mesh,
+                  problem.source_state, Portage::DEFAULT_NUMERIC_TOLERANCES<D>);
+  interpolate.set_interpolation_variable("density", &gradient);
+
+  std::vector<double> values(ntarget);
+  double const seconds = measure([&]() {
+    Portage::transform(target_mesh.begin(Entity_kind::CELL, Entity_type::PARALLEL_OWNED),
+                       target_mesh.end(Entity_kind::CELL, Entity_type::PARALLEL_OWNED),
+                       values.begin(),
+                       [&](int t) { return interpolate(t, weights[t]); });
+  }, options.min_time);
+
+  report({name, D, problem.num_source(), ntarget,
+          mean_size(candidates), ntarget, seconds});
+}
+
+//////////////////////////////////////////////////////////////////////
+// Global id maps
+
+/*!
+  @brief Construction and lookup of the maps from global id to flat index
+  built by MPI_Bounding_Boxes, with Portage::GidMap and with std::map.
+  @param[in] options: benchmark options.
+  @param[in] n: number of global ids.
+
+  The global ids are sorted but not contiguous, as the owned entities of
+  a flat mesh, and are looked up in random order, as when translating
+  connectivity lists.
+*/
+void bench_gid_map(Options const& options, int n) {
+  std::mt19937_64 random(n);
+  std::vector<Wonton::GID_t> gids(n);
+  Wonton::GID_t gid = 0;
+  for (int i = 0; i < n; i++) {
+    gid += 1 + random() % 3;
+    gids[i] = gid;
+  }
+  std::vector<Wonton::GID_t> queries(gids);
+  std::shuffle(queries.begin(), queries.end(), random);
+
+  long sum = 0;  // keeps the lookups from being optimized away
+
+  Portage::GidMap gid_map;
+  double const gid_map_build = measure([&] { gid_map.build(gids); },
+                                       options.min_time);
+  report({"GidMap.build", 0, n, n, 0., n, gid_map_build});
+
+  double const gid_map_find = measure([&] {
+    for (auto const& query : queries)
+      sum += gid_map.at(query);
+  }, options.min_time);
+  report({"GidMap.find", 0, n, n, 0., n, gid_map_find});
+
+  std::map<Wonton::GID_t, int> std_map;
+  double const std_map_build = measure([&] {
+    std_map.clear();
+    for (int i = 0; i < n; i++)
+      std_map[gids[i]] = i;
+  }, options.min_time);
+  report({"std::map.build", 0, n, n, 0., n, std_map_build});
+
+  double const std_map_find = measure([&] {
+    for (auto const& query : queries)
+      sum += std_map.at(query);
+  }, options.min_time);
+  report({"std::map.find", 0, n, n, 0., n, std_map_find});
+
+  if (sum < 0)
+    std::printf("%ld\n", sum);
+}
+
+//////////////////////////////////////////////////////////////////////
+// Driver
+
+template<int D>
+void run_all(Options const& options, std::vector<int> const& sizes) {
+  for (int n : sizes) {
+    for (double ratio : options.ratios) {
+      int const nsource = std::max(1, static_cast<int>(std::lround(n * ratio)));
+      Problem<D> const problem(nsource, n);
+
+      if (selected(options, "SearchKDTree"))
+        bench_search<D, Portage::SearchKDTree>(options, problem, "SearchKDTree");
+      if (selected(options, "SearchBVH"))
+        bench_search<D, Portage::SearchBVH>(options, problem, "SearchBVH");
+      if (selected(options, "SearchDirectProduct"))
+        bench_search_direct_product<D>(options, nsource, n);
+      if (selected(options, "Intersect"))
+        bench_intersect(options, problem);
+      if (selected(options, "Limited_Gradient"))
+        bench_gradient(options, problem);
+      if (selected(options, "Interpolate_1stOrder"))
+        bench_interpolate<D, Portage::Interpolate_1stOrder>
+            (options, problem, "Interpolate_1stOrder");
+      if (selected(options, "Interpolate_2ndOrder"))
+        bench_interpolate<D, Portage::Interpolate_2ndOrder>
+            (options, problem, "Interpolate_2ndOrder");
+    }
+
+    // same topology for source and target meshes: no ratio
+    if (selected(options, "IntersectSweptFace"))
+      bench_intersect_swept_face<D>(options, n);
+  }
+}
+
+void run_search_simple(Options const& options) {
+  if (not selected(options, "SearchSimple"))
+    return;
+  for (int n : options.sizes2d)
+    for (double ratio : options.ratios) {
+      int const nsource = std::max(1, static_cast<int>(std::lround(n * ratio)));
+      Problem<2> const problem(nsource, n);
+      bench_search_simple(options, problem);
+    }
+}
+
+template<typename T>
+std::vector<T> split(std::string const& list) {
+  std::vector<T> values;
+  std::stringstream stream(list);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    std::stringstream value(item);
+    T converted;
+    value >> converted;
+    values.push_back(converted);
+  }
+  return values;
+}
+
+void usage() {
+  std::printf("Usage: kernel_bench [options]\n"
+              "  --kernels=k1,k2,...  kernels to run among SearchKDTree, SearchBVH,\n"
+              "                       SearchSimple, SearchDirectProduct,\n"
+              "                       Intersect (R2D/R3D), IntersectSweptFace,\n"
+              "                       Limited_Gradient, Interpolate_1stOrder,\n"
+              "                       Interpolate_2ndOrder, GidMap (default: all)\n"
+              "  --sizes2d=n1,n2,...  target cells per axis in 2D\n"
+              "  --sizes3d=n1,n2,...  target cells per axis in 3D\n"
+              "  --ratios=r1,r2,...   source to target resolution ratios\n"
+              "  --gids=n1,n2,...     global ids in the GidMap benchmark\n"
+              "  --min-time=t         minimal time of a measurement (s)\n"
+              "  --csv=file           also write the results to a CSV file\n");
+}
+
+int main(int argc, char** argv) {
+
+#ifdef PORTAGE_ENABLE_MPI
+  int mpi_init_flag;
+  MPI_Initialized(&mpi_init_flag);
+  if (!mpi_init_flag)
+    MPI_Init(&argc, &argv);
+#endif
+
+  Options options;
+  for (int i = 1; i < argc; i++) {
+    std::string const arg = argv[i];
+    auto const pos = arg.find('=');
+    std::string const key = arg.substr(0, pos);
+    std::string const value = pos == std::string::npos ? "" : arg.substr(pos + 1);
+
+    if (key == "--kernels")
+      options.kernels = split<std::string>(value);
+    else if (key == "--sizes2d")
+      options.sizes2d = split<int>(value);
+    else if (key == "--sizes3d")
+      options.sizes3d = split<int>(value);
+    else if (key == "--ratios")
+      options.ratios = split<double>(value);
+    else if (key == "--gids")
+      options.gids = split<int>(value);
+    else if (key == "--min-time")
+      options.min_time = std::atof(value.data());
+    else if (key == "--csv")
+      options.csv = value;
+    else {
+      usage();
+      return key == "--help" ? 0 : 1;
+    }
+  }
+
+  std::printf("# threads: %d\n", Portage::num_threads());
+  std::printf("%-24s %3s %10s %10s %8s %12s %12s\n",
+              "kernel", "dim", "nsource", "ntarget", "cand/tgt",
+              "time (s)", "entities/s");
+
+  run_all<2>(options, options.sizes2d);
+  run_search_simple(options);
+  run_all<3>(options, options.sizes3d);
+
+  if (selected(options, "GidMap"))
+    for (int n : options.gids)
+      bench_gid_map(options, n);
+
+  if (not options.csv.empty()) {
+    std::ofstream file(options.csv);
+    if (not file.good()) {
+      std::fprintf(stderr, "Could not open file :%s\n", options.csv.data());
+      return 1;
+    }
+    file << "kernel,dim,nsource,ntarget,candidates,threads,seconds,entities_per_second\n";
+    for (auto const& record : records)
+      file << record.kernel << "," << record.dim << ","
+           << record.nsource << "," << record.ntarget << ","
+           << record.candidates << "," << Portage::num_threads() << ","
+           << record.seconds << ","
+           << record.nentities / std::max(record.seconds, 1.E-9) << "\n";
+  }
+
+#ifdef PORTAGE_ENABLE_MPI
+  MPI_Finalize();
+#endif
+  return 0;
+}
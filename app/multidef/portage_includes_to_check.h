@@ -63,6 +63,7 @@ Please see the license file at the root of this repository, or at:
 #include "portage/support/mpi_collate.h"
 #include "portage/support/operator.h"
 #include "portage/support/portage.h"
+#include "portage/support/smoothing_lengths.h"
 #include "portage/support/timer.h"
 #include "portage/support/weight.h"
 
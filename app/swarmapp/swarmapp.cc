@@ -212,7 +212,7 @@ void run<2>(int example_num, int n_source, int n_target,
   }
 
   std::vector<std::vector<double>> const default_lengths(1, std::vector<double>(2, h));
-  Portage::vector<std::vector<std::vector<double>>> smoothing_lengths(nsmooth, default_lengths);
+  SmoothingLengths smoothing_lengths(nsmooth, default_lengths);
 
 #ifdef HAVE_NANOFLANN  // Search by kdtree
   using Remapper = SwarmDriver<Portage::Search_KDTree_Nanoflann,
@@ -369,7 +369,7 @@ void run<3>(int example_num, int n_source, int n_target,
   }
 
   std::vector<std::vector<double>> const default_lengths(1, std::vector<double>(3, h));
-  Portage::vector<std::vector<std::vector<double>>> smoothing_lengths(nsmooth, default_lengths);
+  SmoothingLengths smoothing_lengths(nsmooth, default_lengths);
 
 #ifdef HAVE_NANOFLANN  // Search by kdtree
   using Remapper = SwarmDriver<Portage::Search_KDTree_Nanoflann,
@@ -385,6 +385,25 @@ else(ENABLE_THRUST)
   endif(Boost_FOUND)
 endif(ENABLE_THRUST)
 
+#-----------------------------------------------------------------------------
+# OpenMP threads for the host (non-Thrust) backend
+#-----------------------------------------------------------------------------
+set(ENABLE_OpenMP FALSE CACHE BOOL "Use OpenMP threads in the host backend")
+if (ENABLE_OpenMP)
+  if (ENABLE_THRUST)
+    message(FATAL_ERROR "ENABLE_OpenMP cannot be combined with ENABLE_THRUST; use THRUST_BACKEND=THRUST_DEVICE_SYSTEM_OMP instead")
+  endif (ENABLE_THRUST)
+
+  message(STATUS "Enabling OpenMP threads in the host backend")
+  FIND_PACKAGE(OpenMP REQUIRED)
+  if (OPENMP_FOUND)
+    set(PORTAGE_ENABLE_OPENMP True CACHE BOOL "Is Portage compiled with OpenMP?")
+    set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} ${OpenMP_C_FLAGS}")
+    set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} ${OpenMP_CXX_FLAGS}")
+    set(CMAKE_EXE_LINKER_FLAGS "${CMAKE_EXE_LINKER_FLAGS} ${OpenMP_EXE_LINKER_FLAGS}")
+  endif (OPENMP_FOUND)
+endif (ENABLE_OpenMP)
+
 
 
 
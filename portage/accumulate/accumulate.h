@@ -6,6 +6,9 @@ Please see the license file at the root of this repository, or at:
 #ifndef ACCUMULATE_H_INC_
 #define ACCUMULATE_H_INC_
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <vector>
 #include <memory>
 #include <cassert>
@@ -13,13 +16,11 @@ Please see the license file at the root of this repository, or at:
 // portage includes
 #include "portage/support/portage.h"
 #include "portage/support/weight.h"
+#include "portage/support/smoothing_lengths.h"
 #include "portage/support/basis.h"
 #include "portage/support/operator.h"
 #include "portage/swarm/swarm.h"
 
-// wonton includes
-#include "wonton/support/Matrix.h"
-
 namespace Portage { namespace Meshfree {
 
 /**
@@ -72,7 +73,7 @@ class Accumulate {
              EstimateType estimate, WeightCenter center,
              Portage::vector<Weight::Kernel> const& kernels,
              Portage::vector<Weight::Geometry> const& geometries,
-             Portage::vector<std::vector<std::vector<double>>> const& smoothing,
+             SmoothingLengths const& smoothing,
              basis::Type basis, oper::Type operator_spec = oper::LastOperator,
              Portage::vector<oper::Domain> const& operator_domain = {},
              Portage::vector<std::vector<Wonton::Point<dim>>> const& operator_data = {})
@@ -95,7 +96,7 @@ class Accumulate {
 
     assert(n_particles == kernels_.size());
     assert(n_particles == geometries_.size());
-    assert(n_particles == smoothing_.size());
+    assert(n_particles == static_cast<size_t>(smoothing_.size()));
     if (operator_spec_ != oper::LastOperator) {
       unsigned const num_target_particles = target_.num_owned_particles();
       assert(operator_data_.size()   == num_target_particles);
@@ -104,6 +105,24 @@ class Accumulate {
 #endif
   }
 
+  /**
+   * @brief Constructor from nested smoothing lengths
+   *
+   * The lengths are flattened once into a SmoothingLengths owned by the
+   * accumulator. The other parameters are the ones of the main constructor.
+   */
+  Accumulate(SourceSwarm const& source, TargetSwarm const& target,
+             EstimateType estimate, WeightCenter center,
+             Portage::vector<Weight::Kernel> const& kernels,
+             Portage::vector<Weight::Geometry> const& geometries,
+             Portage::vector<std::vector<std::vector<double>>> const& smoothing,
+             basis::Type basis, oper::Type operator_spec = oper::LastOperator,
+             Portage::vector<oper::Domain> const& operator_domain = {},
+             Portage::vector<std::vector<Wonton::Point<dim>>> const& operator_data = {})
+    : Accumulate(source, target, estimate, center, kernels, geometries,
+                 std::make_shared<SmoothingLengths const>(smoothing),
+                 basis, operator_spec, operator_domain, operator_data) {}
+
   /** 
    * @brief Evaluate meshfree weight function
    * @param particleA target index
@@ -146,118 +165,286 @@ class Accumulate {
 
     switch (estimate_) {
       case KernelDensity:  {
-        for (auto const& particleB : source_particles) {
-          double weight_val = weight(particleA, particleB);
-          std::vector<double> pair_result(1, weight_val);
-          result.emplace_back(particleB, pair_result);
+        std::vector<Wonton::Point<dim>> points;
+        std::vector<double> weight_val;
+        weights(particleA, source_particles, points, weight_val);
+        int const nsrc = source_particles.size();
+        for (int iB = 0; iB < nsrc; iB++) {
+          std::vector<double> pair_result(1, weight_val[iB]);
+          result.emplace_back(source_particles[iB], pair_result);
         }
         break;
       }
       case OperatorRegression:
       case LocalRegression: {
-        size_t nbasis = basis::function_size<dim>(basis_);
-        Wonton::Point<dim> x = target_.get_particle_coordinates(particleA);
-
-	      // If too few particles, set estimate to zero for this target
-	      bool zilchit = false;
-        if (source_particles.size() < nbasis) {
-          zilchit = true;
+        // dispatch to the regression with a basis size known at compile time
+        switch (basis_) {
+          case basis::Unitary:
+            regression<basis::Unitary>(particleA, source_particles, result);
+            break;
+          case basis::Linear:
+            regression<basis::Linear>(particleA, source_particles, result);
+            break;
+          case basis::Quadratic:
+            regression<basis::Quadratic>(particleA, source_particles, result);
+            break;
+          default:  // invalid basis
+            assert(false);
         }
+	      break;
+      }
+      default:  // invalid estimate
+	      assert(false);
+    }
+    return result;
+  }
 
-        // Calculate weights and moment matrix (P*W*transpose(P))
-	      std::vector<double> weight_val(source_particles.size());
-        Wonton::Matrix moment(nbasis,nbasis,0.);
-        size_t iB = 0;
-        if (not zilchit) {
-          for (auto const& particleB : source_particles) {
-            weight_val[iB] = weight(particleA, particleB); // save weights for later
-            Wonton::Point<dim> y = source_.get_particle_coordinates(particleB);
-            auto basis = basis::shift<dim>(basis_, x, y);
-            for (size_t i=0; i<nbasis; i++) {
-              for (size_t j=0; j<nbasis; j++) {
-                moment[i][j] += basis[i]*basis[j]*weight_val[iB];
-              }
-            }
-            iB++;
-          }
+  /**
+   * @brief Number of targets whose local regression weights were set to
+   * zero so far, because they had fewer neighbors than basis functions or
+   * an ill-conditioned moment matrix. It is shared by the copies of this
+   * accumulator.
+   */
+  int num_ill_conditioned() const { return *num_ill_conditioned_; }
+
+ private:
+
+  /**
+   * @brief Evaluate meshfree weight function for a target and all its
+   * source neighbors
+   * @param particleA target index
+   * @param source_particles source indices
+   * @param points coordinates of the source particles
+   * @param weight_val value of weight function for each source particle
+   *
+   * When the weights are centered on the target, they all share its
+   * geometry, kernel and smoothing lengths and are evaluated in a single
+   * batch. Otherwise each source particle has its own.
+   */
+  void weights(size_t const particleA, std::vector<int> const& source_particles,
+               std::vector<Wonton::Point<dim>>& points,
+               std::vector<double>& weight_val) {
+    int const nsrc = source_particles.size();
+    points.resize(nsrc);
+    weight_val.resize(nsrc);
+    for (int iB = 0; iB < nsrc; iB++)
+      points[iB] = source_.get_particle_coordinates(source_particles[iB]);
+
+    Wonton::Point<dim> x = target_.get_particle_coordinates(particleA);
+    if (center_ == Gather) {
+      Weight::eval<dim>(geometries_[particleA],
+                        kernels_[particleA],
+                        x, points.data(), nsrc,
+                        smoothing_[particleA],
+                        weight_val.data());
+    } else if (center_ == Scatter) {
+      for (int iB = 0; iB < nsrc; iB++) {
+        int const particleB = source_particles[iB];
+        weight_val[iB] = Weight::eval<dim>(geometries_[particleB],
+                                           kernels_[particleB],
+                                           points[iB], x, // faceted weights are asymmetric
+                                           smoothing_[particleB]);
+      }
+    }
+  }
+
+  /**
+   * @brief Compute the local regression corrected weights of a target
+   * @tparam type basis type, so that the size of the basis is known at
+   *         compile time and the moment matrix lives on the stack
+   * @param particleA target particle index in target swarm
+   * @param source_particles list of source particle neighbors of target particle
+   * @param result corrected weights of each source particle
+   */
+  template<basis::Type type>
+  void regression(size_t const particleA,
+                  std::vector<int> const& source_particles,
+                  std::vector<Weights_t>& result) {
+
+    constexpr int nbasis = basis::Traits<type, dim>::function_size;
+    int const nsrc = source_particles.size();
+    Wonton::Point<dim> x = target_.get_particle_coordinates(particleA);
+
+    // Calculate weights and basis functions of the neighbors, the
+    // latter stored as the columns of a nbasis x nsrc block P
+    std::vector<Wonton::Point<dim>> points;
+    std::vector<double> weight_val;
+    weights(particleA, source_particles, points, weight_val);
+
+    std::vector<double> block(nbasis * nsrc);
+    for (int iB = 0; iB < nsrc; iB++) {
+      auto const basis = basis::shift<type, dim>(x, points[iB]);
+      for (int i = 0; i < nbasis; i++)
+        block[i * nsrc + iB] = basis[i];
+    }
+
+    // Calculate the moment matrix (P*W*transpose(P)), factor it once
+    // and overwrite P with inverse(P*W*transpose(P))*P for all the
+    // neighbors at once. If there are too few particles or the moment
+    // matrix is ill-conditioned, set estimate to zero for this target.
+    bool solved = false;
+    if (nsrc >= nbasis) {
+      std::array<double, nbasis * nbasis> moment {};
+      for (int i = 0; i < nbasis; i++) {
+        double const* basis_i = block.data() + i * nsrc;
+        for (int j = 0; j <= i; j++) {
+          double const* basis_j = block.data() + j * nsrc;
+          double sum = 0.;
+          for (int iB = 0; iB < nsrc; iB++)
+            sum += basis_i[iB] * basis_j[iB] * weight_val[iB];
+          moment[i * nbasis + j] = sum;
         }
+      }
 
-        // Calculate inverse(P*W*transpose(P))*P*W
-        iB = 0;
-
-        for (auto const& particleB : source_particles) {
-	        std::vector<double> pair_result(nbasis);
-          Wonton::Point<dim> y = source_.get_particle_coordinates(particleB);
-	        std::vector<double> basis = basis::shift<dim>(basis_, x, y);
-
-          // recast as a Portage::Matrix
-          Wonton::Matrix basis_matrix(nbasis,1);
-          for (size_t i=0; i<nbasis; i++) basis_matrix[i][0] = basis[i];
-
-          // solve the linear system
-          if (not zilchit) {
-            std::string error="check";
-#ifdef HAVE_LAPACKE
-            Wonton::Matrix pair_result_matrix = moment.solve(basis_matrix, "lapack-sytr", error);
-#else
-            Wonton::Matrix pair_result_matrix = moment.solve(basis_matrix, "inverse", error);
-#endif
-            for (size_t i=0; i<nbasis; i++)
-              pair_result[i] = pair_result_matrix[i][0]*weight_val[iB];
-              // NOTE: THIS CODE HAS TO WAIT FOR AN UPDATED WONTON
-              //if (basis_matrix.is_singular() == 2 or error != "none") {
-              //  bad_count++;
-              //}
-          } else {
-            for (size_t i=0; i<nbasis; i++)
-              pair_result[i] = 0.;
-          }
+      if (factorize<nbasis>(moment)) {
+        solve<nbasis>(moment, block, nsrc);
+        solved = true;
+      }
+    }
+
+    if (not solved) {
+      (*num_ill_conditioned_)++;
+      std::fill(block.begin(), block.end(), 0.);
+    }
 
-          // If an operator is being applied, adjust final weights.
-          if (estimate_ == OperatorRegression) {
-            auto ijet = basis::inverse_jet<dim>(basis_, x);
-            std::vector<std::vector<double>> basisop;
-            oper::apply<dim>(operator_spec_, basis_,
-                             operator_domain_[particleA],
-                             operator_data_[particleA], basisop);
-            int const num_basis = nbasis;
-            int const opsize = oper::size_info(operator_spec_, basis_,
-                                            operator_domain_[particleA])[0];
-            std::vector<double> operator_result(opsize, 0.);
-
-            for (int j = 0; j < opsize; j++) {
-              for (int k = 0; k < num_basis; k++) {
-                for (int m = 0; m < num_basis; m++) {
-                  operator_result[j] += pair_result[k]*ijet[k][m]*basisop[m][j];
-                }
-              }
+    // If an operator is being applied, get it once for this target
+    typename basis::Traits<type, dim>::matrix_t ijet {};
+    std::vector<std::vector<double>> basisop;
+    int opsize = 0;
+    if (estimate_ == OperatorRegression) {
+      ijet = basis::inverse_jet<type, dim>(x);
+      oper::apply<dim>(operator_spec_, basis_,
+                       operator_domain_[particleA],
+                       operator_data_[particleA], basisop);
+      opsize = oper::size_info(operator_spec_, basis_,
+                               operator_domain_[particleA])[0];
+    }
+
+    for (int iB = 0; iB < nsrc; iB++) {
+      std::array<double, nbasis> pair_result;
+      for (int i = 0; i < nbasis; i++)
+        pair_result[i] = block[i * nsrc + iB] * weight_val[iB];
+
+      // If an operator is being applied, adjust final weights.
+      if (estimate_ == OperatorRegression) {
+        std::array<double, nbasis> operator_result {};
+
+        for (int j = 0; j < std::min(opsize, nbasis); j++) {
+          for (int k = 0; k < nbasis; k++) {
+            for (int m = 0; m < nbasis; m++) {
+              operator_result[j] += pair_result[k]*ijet[k][m]*basisop[m][j];
             }
-            for (int j = 0; j < num_basis; j++)
-              pair_result[j] = operator_result[j];
           }
-          result.emplace_back(particleB, pair_result);
-          iB++;
         }
-	      break;
+        pair_result = operator_result;
       }
-      default:  // invalid estimate
-	      assert(false);
+
+      // fill the weights in place: a single allocation per pair
+      result.emplace_back();
+      result.back().entityID = source_particles[iB];
+      result.back().weights.assign(pair_result.begin(), pair_result.end());
     }
-    return result;
   }
 
- private:
+  /**
+   * @brief Factor a symmetric positive definite matrix as L*D*transpose(L)
+   * @tparam n size of the matrix
+   * @param a row-major n x n matrix whose lower triangle is read and
+   *          overwritten by L (below the diagonal) and D (on the diagonal)
+   * @return false if a pivot is not positive or lost all but 12 digits of
+   *         its diagonal entry, i.e. the matrix is ill-conditioned
+   *
+   * Comparing each pivot to its own diagonal entry keeps the check
+   * independent of the very different scales of the basis functions.
+   */
+  template<int n>
+  static bool factorize(std::array<double, n * n>& a) {
+    double const tolerance = 1.e-12;
+    for (int j = 0; j < n; j++) {
+      double* row_j = a.data() + j * n;
+      for (int k = 0; k < j; k++) {
+        double const* row_k = a.data() + k * n;
+        double sum = row_j[k];
+        for (int m = 0; m < k; m++)
+          sum -= row_j[m] * row_k[m] * a[m * n + m];
+        row_j[k] = sum / row_k[k];
+      }
+      double const diagonal = row_j[j];
+      double pivot = diagonal;
+      for (int k = 0; k < j; k++)
+        pivot -= row_j[k] * row_j[k] * a[k * n + k];
+      if (not (diagonal > 0. and pivot > tolerance * diagonal))
+        return false;
+      row_j[j] = pivot;
+    }
+    return true;
+  }
+
+  /**
+   * @brief Solve L*D*transpose(L)*X = B for a block of right-hand sides
+   * @tparam n size of the matrix
+   * @param ldl factored n x n matrix (see factorize)
+   * @param b row-major n x nrhs block of right-hand sides, overwritten by X
+   * @param nrhs number of right-hand sides
+   */
+  template<int n>
+  static void solve(std::array<double, n * n> const& ldl,
+                    std::vector<double>& b, int nrhs) {
+    for (int i = 0; i < n; i++) {
+      double* b_i = b.data() + i * nrhs;
+      for (int k = 0; k < i; k++) {
+        double const l_ik = ldl[i * n + k];
+        double const* b_k = b.data() + k * nrhs;
+        for (int r = 0; r < nrhs; r++)
+          b_i[r] -= l_ik * b_k[r];
+      }
+    }
+    for (int i = 0; i < n; i++) {
+      double const d_inv = 1. / ldl[i * n + i];
+      double* b_i = b.data() + i * nrhs;
+      for (int r = 0; r < nrhs; r++)
+        b_i[r] *= d_inv;
+    }
+    for (int i = n - 1; i >= 0; i--) {
+      double* b_i = b.data() + i * nrhs;
+      for (int k = i + 1; k < n; k++) {
+        double const l_ki = ldl[k * n + i];
+        double const* b_k = b.data() + k * nrhs;
+        for (int r = 0; r < nrhs; r++)
+          b_i[r] -= l_ki * b_k[r];
+      }
+    }
+  }
+
+  // keeps the flattened lengths alive when built from nested ones
+  Accumulate(SourceSwarm const& source, TargetSwarm const& target,
+             EstimateType estimate, WeightCenter center,
+             Portage::vector<Weight::Kernel> const& kernels,
+             Portage::vector<Weight::Geometry> const& geometries,
+             std::shared_ptr<SmoothingLengths const> smoothing,
+             basis::Type basis, oper::Type operator_spec,
+             Portage::vector<oper::Domain> const& operator_domain,
+             Portage::vector<std::vector<Wonton::Point<dim>>> const& operator_data)
+    : Accumulate(source, target, estimate, center, kernels, geometries,
+                 *smoothing, basis, operator_spec, operator_domain, operator_data)
+  {
+    flat_smoothing_ = smoothing;
+  }
+
   SourceSwarm const& source_;
   TargetSwarm const& target_;
   EstimateType estimate_;
   WeightCenter center_;
   Portage::vector<Weight::Kernel> const& kernels_;
   Portage::vector<Weight::Geometry> const& geometries_;
-  Portage::vector<std::vector<std::vector<double>>> const& smoothing_;
+  SmoothingLengths const& smoothing_;
+  std::shared_ptr<SmoothingLengths const> flat_smoothing_;
   basis::Type basis_;
   oper::Type operator_spec_;
   Portage::vector<oper::Domain> operator_domain_;
   Portage::vector<std::vector<Wonton::Point<dim>>> operator_data_;
+  std::shared_ptr<std::atomic<int>> num_ill_conditioned_ =
+    std::make_shared<std::atomic<int>>(0);
 };
 
 }}
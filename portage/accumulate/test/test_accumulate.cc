@@ -116,6 +116,7 @@ void test_accumulate(EstimateType etype, basis::Type btype, WeightCenter center)
     }
   }
 
+  ASSERT_EQ(0, accumulator.num_ill_conditioned());
 }
 
 
@@ -516,3 +517,41 @@ TEST(operator, QuadraticTetrahedron) {
 
 
 
+
+// Targets whose moment matrix cannot be factored get zero weights and
+// are counted
+TEST(accumulate, ill_conditioned) {
+  using Accumulator = Accumulate<2, Swarm<2>, Swarm<2>>;
+
+  // the source particles are aligned: a linear fit is not defined
+  int const npoints = 10;
+  Portage::vector<Point<2>> source_points(npoints);
+  for (int i = 0; i < npoints; i++)
+    source_points[i] = Point<2>(0.1 * i, 0.);
+  Portage::vector<Point<2>> target_points(1, Point<2>(0.45, 0.));
+
+  Swarm<2> src_swarm(source_points);
+  Swarm<2> tgt_swarm(target_points);
+  Portage::vector<Weight::Kernel> kernels(1, Weight::B4);
+  Portage::vector<Weight::Geometry> geometries(1, Weight::TENSOR);
+  SmoothingLengths smoothing_h(1, std::vector<std::vector<double>>(1, {2., 2.}));
+
+  Accumulator accumulator(src_swarm, tgt_swarm, LocalRegression, Gather,
+                          kernels, geometries, smoothing_h, basis::Linear);
+  ASSERT_EQ(0, accumulator.num_ill_conditioned());
+
+  std::vector<int> src_particles(npoints);
+  std::iota(src_particles.begin(), src_particles.end(), 0);
+
+  auto shape_vecs = accumulator(0, src_particles);
+  ASSERT_EQ(unsigned(npoints), shape_vecs.size());
+  for (auto const& shape_vec : shape_vecs)
+    for (double w : shape_vec.weights)
+      ASSERT_EQ(0., w);
+  ASSERT_EQ(1, accumulator.num_ill_conditioned());
+
+  // fewer neighbors than basis functions
+  shape_vecs = accumulator(0, {0, 1});
+  ASSERT_EQ(unsigned(2), shape_vecs.size());
+  ASSERT_EQ(2, accumulator.num_ill_conditioned());
+}
@@ -11,6 +11,11 @@ Please see the license file at the root of this repository, or at:
 #ifdef PORTAGE_ENABLE_MPI
 
 #include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <functional>
+#include <type_traits>
 #include <algorithm>
 #include <numeric>
 #include <memory>
@@ -20,6 +25,8 @@ Please see the license file at the root of this repository, or at:
 #include <set>
 
 #include "portage/support/portage.h"
+#include "portage/support/gid_map.h"
+#include "portage/search/bvh.h"
 #include "wonton/support/Point.h"
 #include "wonton/state/state_vector_uni.h"
 #include "mpi.h"
@@ -40,6 +47,15 @@ using Wonton::to_MPI_Datatype;
   @brief Distributes source data using MPI based on bounding boxes
 
          Currently assumes coordinates and all fields are doubles.
+
+         With PARTITION_BOUNDING_BOX redistribution (the default), a rank
+         sends all its source cells to every rank whose target bounding box
+         overlaps the bounding box of its source partition. With
+         CELL_BOUNDING_BOX redistribution, each rank publishes a few boxes
+         covering its target cells and only the source cells overlapping
+         them are sent, along with the layer of node-adjacent cells needed
+         to compute gradients, so that the volume of data sent follows the
+         actual overlap of the partitions rather than their extents.
 */
 class MPI_Bounding_Boxes {
  public:
@@ -47,7 +63,10 @@ class MPI_Bounding_Boxes {
   /*!
     @brief Constructor of MPI_Bounding_Boxes
    */
-  MPI_Bounding_Boxes(Wonton::MPIExecutor_type const *mpiexecutor) {
+  MPI_Bounding_Boxes(Wonton::MPIExecutor_type const *mpiexecutor,
+                     Redistribution_type redistribution_type =
+                         DEFAULT_REDISTRIBUTION_TYPE)
+    : redistribution_type_(redistribution_type) {
     assert(mpiexecutor);
     comm_ = mpiexecutor->mpicomm;
   }
@@ -71,6 +90,9 @@ class MPI_Bounding_Boxes {
     std::vector<int> sendCounts {}, sendOwnedCounts {};
     //! Array of total/owned recv sizes to me from all PEs
     std::vector<int> recvCounts {}, recvOwnedCounts {};
+    //! Indices of the owned/ghost entities sent to each PE, empty when
+    //! whole ranges of entities are sent
+    std::vector<std::vector<int>> sendOwnedIds {}, sendGhostIds {};
   };
 
 
@@ -152,6 +174,10 @@ class MPI_Bounding_Boxes {
     @param[in] target_mesh       Target mesh
     @param[in] target_state      Target state (not actually used for now)
 
+    All the data sent to a rank (global ids, coordinates, topology, material
+    data and fields) is packed in a single buffer and the buffers of all
+    ranks are exchanged with one MPI_Alltoallv, preceded by a single
+    MPI_Alltoall of the counts of every piece of data.
    */
   template <class Source_Mesh, class Source_State, class Target_Mesh, class Target_State>
   void distribute(Source_Mesh &source_mesh_flat, Source_State &source_state_flat,
@@ -165,80 +191,100 @@ class MPI_Bounding_Boxes {
     int dim = dim_ = source_mesh_flat.space_dimension();
     assert(dim == target_mesh.space_dimension());
 
+    int sourceNumOwnedCells = source_mesh_flat.num_owned_cells();
+    int sourceNumCells = sourceNumOwnedCells + source_mesh_flat.num_ghost_cells();
+    int sourceNumOwnedNodes = source_mesh_flat.num_owned_nodes();
+    int sourceNumNodes = sourceNumOwnedNodes + source_mesh_flat.num_ghost_nodes();
+
     // sendFlags, which partitions to send data
-    // this is computed via intersection of whole partition bounding boxes
+    // this is computed via intersection of whole partition bounding boxes,
+    // or from the cells sent to each partition in cell granular mode
     std::vector<bool> sendFlags(commSize);
-    compute_sendflags(source_mesh_flat, target_mesh, sendFlags);
+    bool const cellGranular =
+        (redistribution_type_ == Redistribution_type::CELL_BOUNDING_BOX);
+
+    // cells and nodes sent to each partition in cell granular mode
+    std::vector<std::vector<int>> sendOwnedCells, sendGhostCells;
+    std::vector<std::vector<int>> sendOwnedNodes, sendGhostNodes;
+
+    // The data is sent in three steps. First, the counts of the data sent
+    // to each partition are set for each kind of data. Then all these
+    // counts are exchanged at once, and the data itself is packed and
+    // exchanged at once. Finally the received data is merged into the flat
+    // mesh and state. The mesh topology (global ids, connectivity and
+    // materials) is kept apart from the data that changes every cycle (node
+    // coordinates and fields), so that it is not sent again when it did not
+    // change in incremental mode.
+    std::vector<comm_info_t*> infos;
+    std::vector<transfer_t> transfers, dataTransfers;
 
-    // set counts for cells
     comm_info_t cellInfo;
-    int sourceNumOwnedCells = source_mesh_flat.num_owned_cells();
-    int sourceNumCells = sourceNumOwnedCells + source_mesh_flat.num_ghost_cells();
-    setSendRecvCounts(&cellInfo, commSize, sendFlags,sourceNumCells, sourceNumOwnedCells);
-
-    // set counts for nodes
     comm_info_t nodeInfo;
-    int sourceNumOwnedNodes = source_mesh_flat.num_owned_nodes();
-    int sourceNumNodes = sourceNumOwnedNodes + source_mesh_flat.num_ghost_nodes();
-    setSendRecvCounts(&nodeInfo, commSize, sendFlags,sourceNumNodes, sourceNumOwnedNodes);
+    infos.push_back(&cellInfo);
+    infos.push_back(&nodeInfo);
+
+    if (cellGranular) {
+      compute_send_cells(source_mesh_flat, target_mesh,
+                         sendOwnedCells, sendGhostCells);
+      for (int i=0; i<commSize; ++i)
+        sendFlags[i] = !sendOwnedCells[i].empty() || !sendGhostCells[i].empty();
+
+      // send the nodes of all the cells sent
+      adjacent_send_lists(sendOwnedCells, sendGhostCells,
+                          sourceNumNodes, sourceNumOwnedNodes,
+                          [&source_mesh_flat](int c, std::vector<int>* nodes) {
+                            source_mesh_flat.cell_get_nodes(c, nodes);
+                          },
+                          sendOwnedNodes, sendGhostNodes);
+
+      // set counts for cells and nodes
+      setSendCounts(&cellInfo, commSize, sendOwnedCells, sendGhostCells,
+                    sourceNumCells, sourceNumOwnedCells);
+      setSendCounts(&nodeInfo, commSize, sendOwnedNodes, sendGhostNodes,
+                    sourceNumNodes, sourceNumOwnedNodes);
+    } else {
+      compute_sendflags(source_mesh_flat, target_mesh, sendFlags);
+
+      // set counts for cells
+      setSendCounts(&cellInfo, commSize, sendFlags,sourceNumCells, sourceNumOwnedCells);
+
+      // set counts for nodes
+      setSendCounts(&nodeInfo, commSize, sendFlags,sourceNumNodes, sourceNumOwnedNodes);
+    }
 
     ///////////////////////////////////////////////////////
     // always distributed
     ///////////////////////////////////////////////////////
 
     // SEND GLOBAL CELL IDS
-
     std::vector<GID_t>& sourceCellGlobalIds = source_mesh_flat.get_global_cell_ids();
-    std::vector<GID_t> distributedCellGlobalIds(cellInfo.newNum);
-    sendField(cellInfo, commRank, commSize, to_MPI_Datatype<GID_t>(), 1,
-              sourceCellGlobalIds, &distributedCellGlobalIds);
+    std::vector<GID_t> distributedCellGlobalIds;
+    add_transfer(transfers, cellInfo, 1, sourceCellGlobalIds, &distributedCellGlobalIds);
 
     // SEND GLOBAL NODE IDS
     std::vector<GID_t>& sourceNodeGlobalIds = source_mesh_flat.get_global_node_ids();
-    std::vector<GID_t> distributedNodeGlobalIds(nodeInfo.newNum);
-    sendField(nodeInfo, commRank, commSize, to_MPI_Datatype<GID_t>(), 1,
-              sourceNodeGlobalIds, &distributedNodeGlobalIds);
-
-    // Using the post distribution global id's, compress the data so that each
-    // global id appears only once. The trick here is to get the ghosts correct.
-    // In the flat mesh, after distribution, an entity that was owned by any
-    // partition is considered owned in the flat mesh. Likewise, any entity that
-    // appears only as a ghost will be a ghost in the flat mesh
-    compress_with_ghosts(distributedCellGlobalIds, cellInfo.newNumOwned,
-      distributedCellIds_, flatCellGlobalIds_, flatCellNumOwned_);
-    compress_with_ghosts(distributedNodeGlobalIds, nodeInfo.newNumOwned,
-      distributedNodeIds_, flatNodeGlobalIds_, flatNodeNumOwned_);
-
-    // create the map from cell global id to flat cell index
-    create_gid_to_flat_map(flatCellGlobalIds_, gidToFlatCellId_);
-    create_gid_to_flat_map(flatNodeGlobalIds_, gidToFlatNodeId_);
+    std::vector<GID_t> distributedNodeGlobalIds;
+    add_transfer(transfers, nodeInfo, 1, sourceNodeGlobalIds, &distributedNodeGlobalIds);
 
     // SEND NODE COORDINATES
     std::vector<double>& sourceCoords = source_mesh_flat.get_coords();
-    std::vector<double> distributedCoords(dim*nodeInfo.newNum);
-    sendField(nodeInfo, commRank, commSize, MPI_DOUBLE, dim,
-              sourceCoords, &distributedCoords);
-
-    // merge and set coordinates in the flat mesh
-    merge_duplicate_data(distributedCoords, distributedNodeIds_, sourceCoords, dim_);
-
-
+    std::vector<double> distributedCoords;
+    add_transfer(dataTransfers, nodeInfo, dim, sourceCoords, &distributedCoords);
 
     ///////////////////////////////////////////////////////
     // 2D distributed
     ///////////////////////////////////////////////////////
 
+    comm_info_t cellToNodeInfo;
+    std::vector<int> distributedCellNodeCounts;
+    std::vector<GID_t> sourceCellToNodeGids, distributedCellToNodeList;
+
     if (dim == 2)
     {
 
       // send cell node counts
       std::vector<int>& sourceCellNodeCounts = source_mesh_flat.get_cell_node_counts();
-      std::vector<int> distributedCellNodeCounts(cellInfo.newNum);
-      sendField(cellInfo, commRank, commSize, MPI_INT, 1,
-                sourceCellNodeCounts, &distributedCellNodeCounts);
-
-      // merge and set cell node counts
-      merge_duplicate_data(distributedCellNodeCounts, distributedCellIds_, sourceCellNodeCounts);
+      add_transfer(transfers, cellInfo, 1, sourceCellNodeCounts, &distributedCellNodeCounts);
 
       // mesh data references
       std::vector<int>& sourceCellNodeOffsets = source_mesh_flat.get_cell_node_offsets();
@@ -249,20 +295,20 @@ class MPI_Bounding_Boxes {
           sourceNumCells == sourceNumOwnedCells ? sizeCellToNodeList :
           sourceCellNodeOffsets[sourceNumOwnedCells]);
 
-      comm_info_t cellToNodeInfo;
-      setSendRecvCounts(&cellToNodeInfo, commSize, sendFlags,
-              sizeCellToNodeList, sizeOwnedCellToNodeList);
+      if (cellGranular)
+        setSendCounts(&cellToNodeInfo, commSize,
+                expand_send_lists(sendOwnedCells, sourceCellNodeOffsets, sizeCellToNodeList),
+                expand_send_lists(sendGhostCells, sourceCellNodeOffsets, sizeCellToNodeList),
+                sizeCellToNodeList, sizeOwnedCellToNodeList);
+      else
+        setSendCounts(&cellToNodeInfo, commSize, sendFlags,
+                sizeCellToNodeList, sizeOwnedCellToNodeList);
+      infos.push_back(&cellToNodeInfo);
 
       // send cell to node lists
-      std::vector<GID_t> distributedCellToNodeList(cellToNodeInfo.newNum);
-      sendField(cellToNodeInfo, commRank, commSize, to_MPI_Datatype<GID_t>(), 1,
-                to_gid(sourceCellToNodeList, sourceNodeGlobalIds), &distributedCellToNodeList);
-
-
-      // merge and map cell node lists
-      merge_duplicate_lists(distributedCellToNodeList, distributedCellNodeCounts,
-        distributedCellIds_, gidToFlatNodeId_, sourceCellToNodeList);
-
+      sourceCellToNodeGids = to_gid(sourceCellToNodeList, sourceNodeGlobalIds);
+      add_transfer(transfers, cellToNodeInfo, 1, sourceCellToNodeGids,
+                   &distributedCellToNodeList);
     }
 
 
@@ -270,27 +316,41 @@ class MPI_Bounding_Boxes {
     // 3D distributed
     ///////////////////////////////////////////////////////
 
+    comm_info_t faceInfo;
+    comm_info_t cellToFaceInfo;
+    comm_info_t faceToNodeInfo;
+    std::vector<GID_t> distributedFaceGlobalIds;
+    std::vector<int> distributedCellFaceCounts;
+    std::vector<GID_t> sourceCellToFaceGids, distributedCellToFaceList;
+    std::vector<int> distributedFaceNodeCounts;
+    std::vector<GID_t> sourceFaceToNodeGids, distributedFaceToNodeList;
+
     if (dim == 3)
     {
 
       int sourceNumOwnedFaces = source_mesh_flat.num_owned_faces();
       int sourceNumFaces = sourceNumOwnedFaces + source_mesh_flat.num_ghost_faces();
 
-      comm_info_t faceInfo;
-      setSendRecvCounts(&faceInfo, commSize, sendFlags,sourceNumFaces, sourceNumOwnedFaces);
+      // faces sent to each partition in cell granular mode
+      std::vector<std::vector<int>> sendOwnedFaces, sendGhostFaces;
+
+      if (cellGranular) {
+        adjacent_send_lists(sendOwnedCells, sendGhostCells,
+                            sourceNumFaces, sourceNumOwnedFaces,
+                            [&source_mesh_flat](int c, std::vector<int>* faces) {
+                              std::vector<int> dirs;
+                              source_mesh_flat.cell_get_faces_and_dirs(c, faces, &dirs);
+                            },
+                            sendOwnedFaces, sendGhostFaces);
+        setSendCounts(&faceInfo, commSize, sendOwnedFaces, sendGhostFaces,
+                      sourceNumFaces, sourceNumOwnedFaces);
+      } else
+        setSendCounts(&faceInfo, commSize, sendFlags,sourceNumFaces, sourceNumOwnedFaces);
+      infos.push_back(&faceInfo);
 
       // SEND GLOBAL FACE IDS
       std::vector<GID_t>& sourceFaceGlobalIds = source_mesh_flat.get_global_face_ids();
-      std::vector<GID_t> distributedFaceGlobalIds(faceInfo.newNum);
-      sendField(faceInfo, commRank, commSize, MPI_LONG_LONG, 1,
-                sourceFaceGlobalIds, &distributedFaceGlobalIds);
-
-      // Create map from distributed gid's to distributed index and flat indices
-      compress_with_ghosts(distributedFaceGlobalIds, faceInfo.newNumOwned,
-        distributedFaceIds_, flatFaceGlobalIds_, flatFaceNumOwned_);
-
-      // create the map from face global id to flat cell index
-      create_gid_to_flat_map(flatFaceGlobalIds_, gidToFlatFaceId_);
+      add_transfer(transfers, faceInfo, 1, sourceFaceGlobalIds, &distributedFaceGlobalIds);
 
       // mesh data references
       std::vector<int>& sourceCellFaceOffsets = source_mesh_flat.get_cell_face_offsets();
@@ -301,55 +361,36 @@ class MPI_Bounding_Boxes {
           sourceNumCells == sourceNumOwnedCells ? sizeCellToFaceList :
           sourceCellFaceOffsets[sourceNumOwnedCells]);
 
-      comm_info_t cellToFaceInfo;
-      setSendRecvCounts(&cellToFaceInfo, commSize, sendFlags,
-              sizeCellToFaceList, sizeOwnedCellToFaceList);
+      if (cellGranular)
+        setSendCounts(&cellToFaceInfo, commSize,
+                expand_send_lists(sendOwnedCells, sourceCellFaceOffsets, sizeCellToFaceList),
+                expand_send_lists(sendGhostCells, sourceCellFaceOffsets, sizeCellToFaceList),
+                sizeCellToFaceList, sizeOwnedCellToFaceList);
+      else
+        setSendCounts(&cellToFaceInfo, commSize, sendFlags,
+                sizeCellToFaceList, sizeOwnedCellToFaceList);
+      infos.push_back(&cellToFaceInfo);
 
       // SEND NUMBER OF FACES FOR EACH CELL
       std::vector<int>& sourceCellFaceCounts = source_mesh_flat.get_cell_face_counts();
-      std::vector<int> distributedCellFaceCounts(cellInfo.newNum);
-      sendField(cellInfo, commRank, commSize, MPI_INT, 1,
-                sourceCellFaceCounts, &distributedCellFaceCounts);
-
-      // merge and set cell face counts
-      merge_duplicate_data( distributedCellFaceCounts, distributedCellIds_, sourceCellFaceCounts);
+      add_transfer(transfers, cellInfo, 1, sourceCellFaceCounts, &distributedCellFaceCounts);
 
       // SEND CELL-TO-FACE MAP
       // map the cell face list vector to gid's
-      std::vector<GID_t> sourceCellToFaceList_ = to_gid(sourceCellToFaceList, sourceFaceGlobalIds);
+      sourceCellToFaceGids = to_gid(sourceCellToFaceList, sourceFaceGlobalIds);
 
       // For this array only, pack up face IDs + dirs and send together
       std::vector<bool>& sourceCellToFaceDirs = source_mesh_flat.get_cell_to_face_dirs();
       int const sourceCellToFaceListSize = sourceCellToFaceList.size();
 
       for (int j = 0; j < sourceCellToFaceListSize; ++j) {
-        int f = sourceCellToFaceList_[j];
+        int f = sourceCellToFaceGids[j];
         int dir = static_cast<int>(sourceCellToFaceDirs[j]);
-        sourceCellToFaceList_[j] = (f << 1) | dir;
+        sourceCellToFaceGids[j] = (f << 1) | dir;
       }
 
-      std::vector<GID_t> distributedCellToFaceList(cellToFaceInfo.newNum);
-      sendField(cellToFaceInfo, commRank, commSize, MPI_LONG_LONG, 1,
-                sourceCellToFaceList_, &distributedCellToFaceList);
-
-      // Unpack face IDs and dirs
-      std::vector<bool> distributedCellToFaceDirs(cellToFaceInfo.newNum);
-      int const distributedCellToFaceListSize = distributedCellToFaceList.size();
-
-      for (int j = 0; j < distributedCellToFaceListSize; ++j) {
-        int fd = distributedCellToFaceList[j];
-        distributedCellToFaceList[j] = fd >> 1;
-        distributedCellToFaceDirs[j] = fd & 1;
-      }
-
-
-      // merge and map cell face lists
-      merge_duplicate_lists(distributedCellToFaceList, distributedCellFaceCounts,
-        distributedCellIds_, gidToFlatFaceId_, sourceCellToFaceList);
-
-      // merge cell face directions
-      merge_duplicate_lists(distributedCellToFaceDirs, distributedCellFaceCounts,
-        distributedCellIds_, sourceCellToFaceDirs);
+      add_transfer(transfers, cellToFaceInfo, 1, sourceCellToFaceGids,
+                   &distributedCellToFaceList);
 
       // mesh data references
       std::vector<int>& sourceFaceNodeOffsets = source_mesh_flat.get_face_node_offsets();
@@ -360,41 +401,35 @@ class MPI_Bounding_Boxes {
           sourceNumFaces == sourceNumOwnedFaces ? sizeFaceToNodeList :
           sourceFaceNodeOffsets[sourceNumOwnedFaces]);
 
-      comm_info_t faceToNodeInfo;
-      setSendRecvCounts(&faceToNodeInfo, commSize, sendFlags,
-              sizeFaceToNodeList, sizeOwnedFaceToNodeList);
+      if (cellGranular)
+        setSendCounts(&faceToNodeInfo, commSize,
+                expand_send_lists(sendOwnedFaces, sourceFaceNodeOffsets, sizeFaceToNodeList),
+                expand_send_lists(sendGhostFaces, sourceFaceNodeOffsets, sizeFaceToNodeList),
+                sizeFaceToNodeList, sizeOwnedFaceToNodeList);
+      else
+        setSendCounts(&faceToNodeInfo, commSize, sendFlags,
+                sizeFaceToNodeList, sizeOwnedFaceToNodeList);
+      infos.push_back(&faceToNodeInfo);
 
       // SEND NUMBER OF NODES FOR EACH FACE
       std::vector<int>& sourceFaceNodeCounts = source_mesh_flat.get_face_node_counts();
-      std::vector<int> distributedFaceNodeCounts(faceInfo.newNum);
-      sendField(faceInfo, commRank, commSize, MPI_INT, 1,
-                sourceFaceNodeCounts, &distributedFaceNodeCounts);
+      add_transfer(transfers, faceInfo, 1, sourceFaceNodeCounts, &distributedFaceNodeCounts);
 
       // SEND FACE-TO-NODE MAP
-      std::vector<GID_t> distributedFaceToNodeList(faceToNodeInfo.newNum);
-      sendField(faceToNodeInfo, commRank, commSize, MPI_LONG_LONG, 1,
-                to_gid(sourceFaceToNodeList, sourceNodeGlobalIds), &distributedFaceToNodeList);
-
-      // merge and set face node counts
-      merge_duplicate_data( distributedFaceNodeCounts, distributedFaceIds_, sourceFaceNodeCounts);
-
-      // merge and map face node lists
-      merge_duplicate_lists(distributedFaceToNodeList, distributedFaceNodeCounts,
-        distributedFaceIds_, gidToFlatNodeId_, sourceFaceToNodeList);
-
-      // merge face global ids
-      merge_duplicate_data(distributedFaceGlobalIds, distributedFaceIds_,sourceFaceGlobalIds);
-
-      // set counts for faces in the flat mesh
-      source_mesh_flat.set_num_owned_faces(flatFaceNumOwned_);
-
+      sourceFaceToNodeGids = to_gid(sourceFaceToNodeList, sourceNodeGlobalIds);
+      add_transfer(transfers, faceToNodeInfo, 1, sourceFaceToNodeGids,
+                   &distributedFaceToNodeList);
     }
 
     // SEND FIELD VALUES
 
     // multimaterial state info
     int nmats = source_state_flat.num_materials();
+    comm_info_t num_mats_info {};
+    comm_info_t shapes_info {};
     comm_info_t num_mat_cells_info {};
+    std::vector<int> material_ids, material_shapes, shapesByRank;
+    std::vector<GID_t> material_cell_gids;
 
     // Is the a multimaterial problem? If so we need to pass the cell indices
     // in addition to the field values
@@ -407,59 +442,244 @@ class MPI_Bounding_Boxes {
       /////////////////////////////////////////////////////////
 
       // set the info for the number of materials on each node
-      comm_info_t num_mats_info;
-      setSendRecvCounts(&num_mats_info, commSize, sendFlags, nmats, nmats);
+      setSendCounts(&num_mats_info, commSize, sendFlags, nmats, nmats);
+      infos.push_back(&num_mats_info);
 
       // get the sorted material ids on this node
-      std::vector<int> material_ids=source_state_flat.get_material_ids();
-
-      // get all material ids across
-      distributedMaterialIds_.resize(num_mats_info.newNum);
+      material_ids=source_state_flat.get_material_ids();
 
       // send all materials to all nodes, num_mats_info.recvCounts is the shape
-      sendData(commRank, commSize, MPI_INT, 1, 0, num_mats_info.sourceNum, 0,
-        num_mats_info.sendCounts, num_mats_info.recvCounts,
-        material_ids, &distributedMaterialIds_
-      );
+      add_transfer(transfers, num_mats_info, 1, material_ids, &distributedMaterialIds_);
 
       /////////////////////////////////////////////////////////
       // get the material cell shapes across all nodes
       /////////////////////////////////////////////////////////
 
       // get the sorted material shapes on this node
-      std::vector<int> material_shapes=source_state_flat.get_material_shapes();
+      material_shapes=source_state_flat.get_material_shapes();
+
+      // get the total number of material cell id's on this node
+      int nmatcells = source_state_flat.num_material_cells();
+
+      // get the sorted material ids on this node
+      std::vector<int> material_cells=source_state_flat.get_material_cells();
 
-      // resize the post distribute material id vector
-      distributedMaterialShapes_.resize(num_mats_info.newNum);
+      if (cellGranular) {
+
+        // only the material cells of the cells sent to a node are sent, so
+        // each node gets its own material shapes, stored one block of
+        // nmats values per node
+        std::vector<std::vector<int>> sendMaterialCells(commSize);
+        std::vector<std::vector<int>> sendShapes(commSize), noGhosts(commSize);
+        std::vector<int> sent(sourceNumCells, -1);
+        shapesByRank.assign(nmats*commSize, 0);
+
+        for (int i=0; i<commSize; ++i) {
+          if (!sendFlags[i]) continue;
+
+          for (int c : sendOwnedCells[i]) sent[c] = i;
+          for (int c : sendGhostCells[i]) sent[c] = i;
+
+          int offset = 0;
+          for (int m=0; m<nmats; ++m) {
+            for (int j=offset; j<offset+material_shapes[m]; ++j)
+              if (sent[material_cells[j]] == i) {
+                sendMaterialCells[i].push_back(j);
+                shapesByRank[nmats*i+m]++;
+              }
+            offset += material_shapes[m];
+            sendShapes[i].push_back(nmats*i+m);
+          }
+        }
+
+        // send the material shapes of each node
+        setSendCounts(&shapes_info, commSize, sendShapes, noGhosts,
+          nmats*commSize, nmats*commSize);
+        infos.push_back(&shapes_info);
+        add_transfer(transfers, shapes_info, 1, shapesByRank, &distributedMaterialShapes_);
+
+        // set the info for the material cells sent to each node
+        setSendCounts(&num_mat_cells_info, commSize, sendMaterialCells,
+          noGhosts, nmatcells, nmatcells);
+
+      } else {
 
-      // send all material shapes to all nodes
-      sendData(commRank, commSize, MPI_INT, 1, 0, num_mats_info.sourceNum, 0,
-        num_mats_info.sendCounts, num_mats_info.recvCounts,
-        material_shapes, &distributedMaterialShapes_
-      );
+        // send all material shapes to all nodes
+        add_transfer(transfers, num_mats_info, 1, material_shapes, &distributedMaterialShapes_);
+
+        // set the info for the number of materials on each node
+        setSendCounts(&num_mat_cells_info, commSize, sendFlags, nmatcells, nmatcells);
+      }
+      infos.push_back(&num_mat_cells_info);
 
       /////////////////////////////////////////////////////////
       // get the lists of material cell ids across all nodes
       /////////////////////////////////////////////////////////
 
-      // get the total number of material cell id's on this node
-      int nmatcells = source_state_flat.num_material_cells();
+      // send material cells to all nodes, but first translate to gid
+      material_cell_gids = to_gid(material_cells, sourceCellGlobalIds);
+      add_transfer(transfers, num_mat_cells_info, 1, material_cell_gids,
+                   &distributedMaterialCells_);
+    }
 
-      // set the info for the number of materials on each node
-      setSendRecvCounts(&num_mat_cells_info, commSize, sendFlags, nmatcells, nmatcells);
+    // Send each field to be remapped
+    std::vector<std::string> field_names = source_state_flat.names();
+    int const num_fields = field_names.size();
 
-      // get the sorted material ids on this node
-      std::vector<int> material_cells=source_state_flat.get_material_cells();
+    // these are packed versions of the fields with copied field values and
+    // not pointers to the original fields, they must outlive the exchange
+    std::vector<std::vector<double>> sourceFields(num_fields);
+    std::vector<std::vector<double>> distributedFields(num_fields);
+    std::vector<int> fieldStrides(num_fields);
 
-      // resize the post distribute material id vector
-      distributedMaterialCells_.resize(num_mat_cells_info.newNum);
+    for (int k = 0; k < num_fields; ++k)
+    {
+      std::string const& field_name = field_names[k];
 
-      // send material cells to all nodes, but first translate to gid
-      sendData(commRank, commSize, to_MPI_Datatype<GID_t>(), 1, 0,
-        num_mat_cells_info.sourceNum, 0, num_mat_cells_info.sendCounts,
-        num_mat_cells_info.recvCounts, to_gid(material_cells, sourceCellGlobalIds),
-        &distributedMaterialCells_
-      );
+      sourceFields[k] = source_state_flat.pack(field_name);
+
+      // get the field stride
+      fieldStrides[k] = source_state_flat.get_field_stride(field_name);
+
+      comm_info_t const* info;
+      if (source_state_flat.get_entity(field_name) == Entity_kind::NODE){
+          // node mesh field
+          info = &nodeInfo;
+      } else if (source_state_flat.field_type(Entity_kind::CELL, field_name) == Wonton::Field_type::MESH_FIELD){
+          // mesh cell field
+          info = &cellInfo;
+      } else {
+         // multi material field
+         info = &num_mat_cells_info;
+      }
+
+      // the new distributed data has raw doubles and will need to be merged
+      // and type converted
+      add_transfer(dataTransfers, *info, fieldStrides[k], sourceFields[k],
+                   &distributedFields[k]);
+    }
+
+    ///////////////////////////////////////////////////////
+    // only exchange coordinates and fields if the topology did not change
+    ///////////////////////////////////////////////////////
+
+    topology_key_t topologyKey;
+    if (incremental_)
+    {
+      // the data received by each rank is unchanged only if the data sent
+      // by all ranks is unchanged
+      topologyKey = topology_key(infos, transfers);
+      int unchanged = (topologyKey == topologyKey_) ? 1 : 0;
+      int allUnchanged;
+      MPI_Allreduce(&unchanged, &allUnchanged, 1, MPI_INT, MPI_LAND, comm_);
+
+      if (allUnchanged)
+      {
+        // the receive counts are the ones of the previous distribution
+        for (unsigned k=0; k<infos.size(); k++)
+          *infos[k] = topologyInfos_[k];
+        exchange(dataTransfers, commRank, commSize);
+
+        // merge and set coordinates in the flat mesh, and restore the rest
+        // of the flat mesh and the material cells
+        merge_duplicate_data(distributedCoords, distributedNodeIds_, sourceCoords, dim_);
+        restore_topology(source_mesh_flat, source_state_flat);
+
+        merge_fields(source_state_flat, field_names, distributedFields, fieldStrides);
+
+        source_mesh_flat.finish_init();
+        return;
+      }
+    }
+
+    ///////////////////////////////////////////////////////
+    // exchange everything
+    ///////////////////////////////////////////////////////
+
+    setRecvCounts(infos, commSize);
+    transfers.insert(transfers.end(), dataTransfers.begin(), dataTransfers.end());
+    exchange(transfers, commRank, commSize);
+
+    ///////////////////////////////////////////////////////
+    // merge the received data
+    ///////////////////////////////////////////////////////
+
+    // Using the post distribution global id's, compress the data so that each
+    // global id appears only once. The trick here is to get the ghosts correct.
+    // In the flat mesh, after distribution, an entity that was owned by any
+    // partition is considered owned in the flat mesh. Likewise, any entity that
+    // appears only as a ghost will be a ghost in the flat mesh
+    compress_with_ghosts(distributedCellGlobalIds, cellInfo.newNumOwned,
+      distributedCellIds_, flatCellGlobalIds_, flatCellNumOwned_);
+    compress_with_ghosts(distributedNodeGlobalIds, nodeInfo.newNumOwned,
+      distributedNodeIds_, flatNodeGlobalIds_, flatNodeNumOwned_);
+
+    // create the map from cell global id to flat cell index
+    gidToFlatCellId_.build(flatCellGlobalIds_);
+    gidToFlatNodeId_.build(flatNodeGlobalIds_);
+
+    // merge and set coordinates in the flat mesh
+    merge_duplicate_data(distributedCoords, distributedNodeIds_, sourceCoords, dim_);
+
+    if (dim == 2)
+    {
+      // merge and set cell node counts
+      merge_duplicate_data(distributedCellNodeCounts, distributedCellIds_,
+        source_mesh_flat.get_cell_node_counts());
+
+      // merge and map cell node lists
+      merge_duplicate_lists(distributedCellToNodeList, distributedCellNodeCounts,
+        distributedCellIds_, gidToFlatNodeId_, source_mesh_flat.get_cell_to_node_list());
+    }
+
+    if (dim == 3)
+    {
+      // Create map from distributed gid's to distributed index and flat indices
+      compress_with_ghosts(distributedFaceGlobalIds, faceInfo.newNumOwned,
+        distributedFaceIds_, flatFaceGlobalIds_, flatFaceNumOwned_);
+
+      // create the map from face global id to flat cell index
+      gidToFlatFaceId_.build(flatFaceGlobalIds_);
+
+      // merge and set cell face counts
+      merge_duplicate_data( distributedCellFaceCounts, distributedCellIds_,
+        source_mesh_flat.get_cell_face_counts());
+
+      // Unpack face IDs and dirs
+      std::vector<bool> distributedCellToFaceDirs(cellToFaceInfo.newNum);
+      int const distributedCellToFaceListSize = distributedCellToFaceList.size();
+
+      for (int j = 0; j < distributedCellToFaceListSize; ++j) {
+        int fd = distributedCellToFaceList[j];
+        distributedCellToFaceList[j] = fd >> 1;
+        distributedCellToFaceDirs[j] = fd & 1;
+      }
+
+      // merge and map cell face lists
+      merge_duplicate_lists(distributedCellToFaceList, distributedCellFaceCounts,
+        distributedCellIds_, gidToFlatFaceId_, source_mesh_flat.get_cell_to_face_list());
+
+      // merge cell face directions
+      merge_duplicate_lists(distributedCellToFaceDirs, distributedCellFaceCounts,
+        distributedCellIds_, source_mesh_flat.get_cell_to_face_dirs());
+
+      // merge and set face node counts
+      merge_duplicate_data( distributedFaceNodeCounts, distributedFaceIds_,
+        source_mesh_flat.get_face_node_counts());
+
+      // merge and map face node lists
+      merge_duplicate_lists(distributedFaceToNodeList, distributedFaceNodeCounts,
+        distributedFaceIds_, gidToFlatNodeId_, source_mesh_flat.get_face_to_node_list());
+
+      // merge face global ids
+      merge_duplicate_data(distributedFaceGlobalIds, distributedFaceIds_,
+        source_mesh_flat.get_global_face_ids());
+
+      // set counts for faces in the flat mesh
+      source_mesh_flat.set_num_owned_faces(flatFaceNumOwned_);
+    }
+
+    if (nmats>0){
 
       /////////////////////////////////////////////////////////
       // We need to turn the flattened material cells into a correctly shaped
@@ -507,6 +727,7 @@ class MPI_Bounding_Boxes {
       // cell material indices are added not replaced by vector so we need to
       // start clean
       source_state_flat.clear_material_cells();
+      flatMaterialCells_.clear();
 
       // merge the material cells and convert to local id (gid sort order)
       for (auto &kv: material_indices){
@@ -517,59 +738,536 @@ class MPI_Bounding_Boxes {
         // compress the material ids so each gid appears only once per material
         compress(kv.second, distributedMaterialCellIds_[m]);
 
-        // allocate the flat material cell ids for this material
-        std::vector<int> flatMaterialCellIds;
-        flatMaterialCellIds.reserve(distributedMaterialCellIds_[m].size());
+        // allocate the flat material cell ids for this material
+        std::vector<int> flatMaterialCellIds;
+        flatMaterialCellIds.reserve(distributedMaterialCellIds_[m].size());
+
+        // loop of material cell indices, converting to gid, then flat cell
+        for (auto id: distributedMaterialCellIds_[m])
+          flatMaterialCellIds.push_back(gidToFlatCellId_.at(kv.second[id]));
+
+        // add the material cells to the state manager
+        source_state_flat.mat_add_cells(kv.first, flatMaterialCellIds);
+
+        // keep them for the next distributions in incremental mode
+        if (incremental_)
+          flatMaterialCells_.emplace_back(kv.first, std::move(flatMaterialCellIds));
+
+      }
+    }
+
+    // Merge and unpack each field to be remapped
+    merge_fields(source_state_flat, field_names, distributedFields, fieldStrides);
+
+    // need to do this at the end of the mesh stuff, because converting to
+    // gid uses the global id's and we don't want to modify them before we are
+    // done converting the old relationships
+    // merge global ids and set in the flat mesh
+    merge_duplicate_data(distributedCellGlobalIds, distributedCellIds_, sourceCellGlobalIds);
+    merge_duplicate_data(distributedNodeGlobalIds, distributedNodeIds_, sourceNodeGlobalIds);
+
+    // set counts for cells and nodes in the flat mesh
+    source_mesh_flat.set_num_owned_cells(flatCellNumOwned_);
+    source_mesh_flat.set_num_owned_nodes(flatNodeNumOwned_);
+
+    // keep the topology for the next distributions in incremental mode
+    if (incremental_)
+      save_topology(source_mesh_flat, infos, topologyKey);
+
+    // Finish initialization using redistributed data
+    source_mesh_flat.finish_init();
+
+
+  } // distribute
+
+
+  /*!
+    @brief Number of bytes of mesh and field data sent to other ranks
+    so far by this distributor
+   */
+  long bytes_sent() const { return bytes_sent_; }
+
+
+  /*!
+    @brief Keep the topology of the flat mesh between distributions, for
+    meshes that move without changing their connectivity or partitioning
+    @param[in] incremental  whether to distribute incrementally
+
+    When the source entities sent to each rank, their global ids,
+    connectivity and materials are the same on all ranks as in the previous
+    distribution, only the node coordinates and the fields are exchanged and
+    merged with the maps of that distribution. Otherwise everything is
+    distributed again. This costs a copy of the flat mesh topology, and
+    must be set on all ranks since deciding costs an MPI_Allreduce.
+   */
+  void set_incremental(bool incremental) { incremental_ = incremental; }
+
+
+  /*!
+    @brief Largest MPI message sent by the exchange of mesh and field data,
+    at most and by default the largest int. Larger buffers are split into
+    several point-to-point messages.
+    @param[in] bytes  maximum number of bytes of a message
+   */
+  void set_max_message_size(int bytes) {
+    assert(bytes > 0);
+    max_message_bytes_ = bytes;
+  }
+
+  private:
+
+  /*!
+    @brief Key of the topology data sent by a rank, see topology_key
+   */
+  struct topology_key_t {
+    //! 64-bit FNV-1a hash of the data
+    uint64_t hash = 0;
+    //! Number of bytes hashed
+    size_t bytes = 0;
+
+    bool operator==(topology_key_t const& other) const {
+      return hash == other.hash && bytes == other.bytes;
+    }
+  };
+
+
+  // The communicator we are using
+  MPI_Comm comm_ = MPI_COMM_NULL;
+
+  // how source entities are selected for each rank
+  Redistribution_type redistribution_type_ = DEFAULT_REDISTRIBUTION_TYPE;
+
+  // whether the topology of the flat mesh is reused when it did not change
+  bool incremental_ = false;
+
+  // number of bins per axis of the grid used to group the target cells of
+  // a rank into the boxes sent to other ranks in cell granular mode
+  static constexpr int target_bins_per_axis_ = 4;
+
+  // bytes sent to other ranks
+  long bytes_sent_ = 0;
+
+  // largest number of bytes sent in one message, MPI counts being ints
+  int max_message_bytes_ = std::numeric_limits<int>::max();
+
+  int dim_ = 1;
+
+  // the number of nodes "owned" by the flat mesh. "Owned" is in quotes because
+  // a node may be "owned" by multiple partitions in the flat mesh. A node is
+  // owned by the flat mesh if it was owned by any partition.
+  int flatNodeNumOwned_ = 0;
+
+  // the global id's of the kept nodes in the flat mesh and their indices in the
+  // distributed node global id's
+  std::vector<GID_t> flatNodeGlobalIds_ {};
+  std::vector<int> distributedNodeIds_ {};
+
+  // maps from gid to distributed node index and flat node index
+  GidMap gidToFlatNodeId_ {};
+
+  // the number of faces "owned" by the flat mesh. "Owned" is in quotes because
+  // a face may be "owned" by multiple partitions in the flat mesh. A face is
+  // owned by the flat mesh if it was owned by any partition.
+  int flatFaceNumOwned_ = 0;
+
+  // the global id's of the kept faces in the flat mesh and their indices in the
+  // distributed face global id's
+  std::vector<GID_t> flatFaceGlobalIds_ {};
+  std::vector<int> distributedFaceIds_ {};
+
+  // maps from gid to distributed face index and flat face index
+  GidMap gidToFlatFaceId_ {};
+
+  // the number of cells "owned" by the flat mesh. "Owned" is in quotes because
+  // a cell may be "owned" by multiple partitions in the flat mesh. A cell is
+  // owned by the flat mesh if it was owned by any partition.
+  int flatCellNumOwned_ = 0;
+
+  // the global id's of the kept cells in the flat mesh and their indices in the
+  // distributed cell global id's
+  std::vector<GID_t> flatCellGlobalIds_ {};
+  std::vector<int> distributedCellIds_ {};
+
+  // maps from gid to distributed cell index and flat cell index
+  GidMap gidToFlatCellId_ {};
+
+  // vectors for distributed multimaterial data
+  std::vector<int> distributedMaterialIds_ {};
+  std::vector<int> distributedMaterialShapes_ {};
+  std::vector<GID_t> distributedMaterialCells_ {};
+
+  // map for the distributed material cell indices
+  // for each material there is a vector of unique distributed indices
+  std::map<int, std::vector<int>> distributedMaterialCellIds_ {};
+
+  // topology of the last distribution kept in incremental mode: the key
+  // of the topology data and send lists, the comms info of each entity
+  // type, the flat mesh connectivity and the flat material cells
+  topology_key_t topologyKey_ {};
+  std::vector<comm_info_t> topologyInfos_ {};
+  std::vector<int> flatCellNodeCounts_ {}, flatCellToNodeList_ {};
+  std::vector<int> flatCellFaceCounts_ {}, flatCellToFaceList_ {};
+  std::vector<bool> flatCellToFaceDirs_ {};
+  std::vector<int> flatFaceNodeCounts_ {}, flatFaceToNodeList_ {};
+  std::vector<std::pair<int, std::vector<int>>> flatMaterialCells_ {};
+
+  /*!
+    @brief Set the send counts needed to do comms for a given entity type
+    @param[in] info              Info data structure to be filled
+    @param[in] commSize          Total number of MPI ranks
+    @param[in] sendFlags         Array of flags:  do I send to PE n?
+    @param[in] sourceNum         Number of entities (total) on this rank
+    @param[in] sourceNumOwned    Number of owned entities on this rank
+
+    The receive counts are set for all entity types at once by setRecvCounts.
+   */
+  void setSendCounts(comm_info_t* info,
+               const int commSize,
+               const std::vector<bool>& sendFlags,
+               const int sourceNum,
+               const int sourceNumOwned)
+  {
+    // Set my counts of all entities and owned entities
+    info->sourceNum = sourceNum;
+    info->sourceNumOwned = sourceNumOwned;
+
+    // How many indexes and owned indexes this rank is going to send each rank
+    info->sendCounts.resize(commSize);
+    info->sendOwnedCounts.resize(commSize);
+    for (int i=0; i<commSize; i++)
+    {
+      info->sendCounts[i] = sendFlags[i] ? info->sourceNum : 0;
+      info->sendOwnedCounts[i] = sendFlags[i] ? info->sourceNumOwned : 0;
+    }
+  } // setSendCounts
+
+
+  /*!
+    @brief Set the send counts needed to do comms for a given entity type
+           when only some of the entities are sent to each rank
+    @param[in] info              Info data structure to be filled
+    @param[in] commSize          Total number of MPI ranks
+    @param[in] sendOwnedIds      Owned entities sent to each PE
+    @param[in] sendGhostIds      Ghost entities sent to each PE
+    @param[in] sourceNum         Number of entities (total) on this rank
+    @param[in] sourceNumOwned    Number of owned entities on this rank
+   */
+  void setSendCounts(comm_info_t* info,
+               const int commSize,
+               const std::vector<std::vector<int>>& sendOwnedIds,
+               const std::vector<std::vector<int>>& sendGhostIds,
+               const int sourceNum,
+               const int sourceNumOwned)
+  {
+    info->sourceNum = sourceNum;
+    info->sourceNumOwned = sourceNumOwned;
+    info->sendOwnedIds = sendOwnedIds;
+    info->sendGhostIds = sendGhostIds;
+
+    info->sendCounts.resize(commSize);
+    info->sendOwnedCounts.resize(commSize);
+    for (int i=0; i<commSize; i++)
+    {
+      info->sendOwnedCounts[i] = sendOwnedIds[i].size();
+      info->sendCounts[i] = sendOwnedIds[i].size() + sendGhostIds[i].size();
+    }
+  } // setSendCounts
+
+
+  /*!
+    @brief Exchange the send counts of several entity types in a single
+           MPI_Alltoall and set their receive counts
+    @param[in] infos             Info data structures, send counts set
+    @param[in] commSize          Total number of MPI ranks
+   */
+  void setRecvCounts(std::vector<comm_info_t*> const& infos, const int commSize)
+  {
+    // Each rank will tell each other rank how many total and owned indexes
+    // of each type it is going to send it
+    int const numInfos = infos.size();
+    std::vector<int> sendCounts(2*numInfos*commSize);
+    std::vector<int> recvCounts(2*numInfos*commSize);
+    for (int i=0; i<commSize; i++)
+      for (int k=0; k<numInfos; k++)
+      {
+        sendCounts[2*(numInfos*i+k)] = infos[k]->sendCounts[i];
+        sendCounts[2*(numInfos*i+k)+1] = infos[k]->sendOwnedCounts[i];
+      }
+    MPI_Alltoall(&(sendCounts[0]), 2*numInfos, MPI_INT,
+                 &(recvCounts[0]), 2*numInfos, MPI_INT, comm_);
+
+    // Compute the total number of indexes this rank will receive from all ranks
+    for (int k=0; k<numInfos; k++)
+    {
+      comm_info_t* info = infos[k];
+      info->recvCounts.resize(commSize);
+      info->recvOwnedCounts.resize(commSize);
+      info->newNum = 0;
+      info->newNumOwned = 0;
+      for (int i=0; i<commSize; i++)
+      {
+        info->recvCounts[i] = recvCounts[2*(numInfos*i+k)];
+        info->recvOwnedCounts[i] = recvCounts[2*(numInfos*i+k)+1];
+        info->newNum += info->recvCounts[i];
+        info->newNumOwned += info->recvOwnedCounts[i];
+      }
+    }
+  } // setRecvCounts
+
+
+  /*!
+    @brief A piece of data exchanged by distribute, e.g. a field or a list
+           of global ids, with its entity type
+   */
+  struct transfer_t {
+    //! comms info of the entity type
+    comm_info_t const* info;
+    //! Number of bytes for each entity
+    int entitySize;
+    //! Source data, entitySize bytes per entity
+    char const* sourceData;
+    //! Resize the new data for a number of entities and return it
+    std::function<char*(int)> allocate;
+  };
+
+
+  /*!
+    @brief Add a data field to the data exchanged by distribute
+    @tparam[in] T                C++ type of data to be sent
+    @param[in] transfers         Data exchanged
+    @param[in] info              Info struct for entity type of field
+    @param[in] stride            Stride of data field
+    @param[in] sourceData        Array of (old) source data, must not change
+                                 before the exchange
+    @param[in] newData           Array of new source data, filled by the exchange
+   */
+  template<typename T>
+  void add_transfer(std::vector<transfer_t>& transfers,
+                    const comm_info_t& info, int stride,
+                    const std::vector<T>& sourceData,
+                    std::vector<T>* newData) const
+  {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "only trivially copyable data can be packed");
+    transfers.push_back({&info, static_cast<int>(sizeof(T))*stride,
+                         reinterpret_cast<char const*>(sourceData.data()),
+                         [newData, stride](int newNum) {
+                           newData->resize(static_cast<size_t>(stride)*newNum);
+                           return reinterpret_cast<char*>(newData->data());
+                         }});
+  }
+
+
+  /*!
+    @brief Exchange all the data at once
+    @param[in] transfers         Data exchanged, receive counts set
+    @param[in] commRank          MPI rank of this PE
+    @param[in] commSize          Total number of MPI ranks
+
+    The data sent to each rank is packed in one buffer, piece after piece,
+    with the owned entities of each piece followed by its ghost entities.
+    The new data of each piece is laid out as before: owned entities from
+    all ranks in rank order, then ghost entities from all ranks.
+
+    The buffers of all ranks are exchanged with a single MPI_Alltoallv.
+    Byte counts are computed in size_t. MPI counts are ints, so when the
+    buffers of any rank are larger than max_message_bytes_ the collective
+    is replaced by point-to-point messages and each buffer is split into
+    messages of at most max_message_bytes_.
+   */
+  void exchange(std::vector<transfer_t> const& transfers,
+                int commRank, int commSize)
+  {
+    int const numTransfers = transfers.size();
+
+    // Sizes in bytes of the buffers sent to and received from each rank
+    std::vector<size_t> sendBytes(commSize, 0), recvBytes(commSize, 0);
+    for (auto const& transfer : transfers)
+      for (int i=0; i<commSize; i++)
+      {
+        size_t const size = transfer.entitySize;
+        sendBytes[i] += size * transfer.info->sendCounts[i];
+        recvBytes[i] += size * transfer.info->recvCounts[i];
+      }
+
+    std::vector<size_t> sendOffsets(commSize, 0), recvOffsets(commSize, 0);
+    std::partial_sum(sendBytes.begin(), sendBytes.end()-1, sendOffsets.begin()+1);
+    std::partial_sum(recvBytes.begin(), recvBytes.end()-1, recvOffsets.begin()+1);
+
+    std::vector<char> sendBuffer(sendOffsets[commSize-1] + sendBytes[commSize-1]);
+    std::vector<char> recvBuffer(recvOffsets[commSize-1] + recvBytes[commSize-1]);
+
+    // Allocate the new data of each piece and find where the owned and
+    // ghost entities received from each rank go in it
+    std::vector<char*> newData(numTransfers);
+    std::vector<std::vector<size_t>> ownedStart(numTransfers), ghostStart(numTransfers);
+    for (int k=0; k<numTransfers; k++)
+    {
+      comm_info_t const& info = *transfers[k].info;
+      newData[k] = transfers[k].allocate(info.newNum);
+      ownedStart[k].resize(commSize);
+      ghostStart[k].resize(commSize);
+      size_t ownedOffset = 0;
+      size_t ghostOffset = info.newNumOwned;
+      for (int i=0; i<commSize; i++)
+      {
+        ownedStart[k][i] = ownedOffset;
+        ghostStart[k][i] = ghostOffset;
+        ownedOffset += info.recvOwnedCounts[i];
+        ghostOffset += info.recvCounts[i] - info.recvOwnedCounts[i];
+      }
+    }
+
+    // Pack the data for rank i
+    auto pack = [&](int i) {
+      char* out = sendBuffer.data() + sendOffsets[i];
+      for (auto const& transfer : transfers)
+      {
+        comm_info_t const& info = *transfer.info;
+        int const size = transfer.entitySize;
+        if (!info.sendOwnedIds.empty())
+        {
+          for (auto const* ids : {&info.sendOwnedIds[i], &info.sendGhostIds[i]})
+            for (int id : *ids)
+            {
+              std::memcpy(out, transfer.sourceData + size*static_cast<size_t>(id), size);
+              out += size;
+            }
+        }
+        else if (info.sendCounts[i] > 0)
+        {
+          // owned entities come first in the source data
+          std::memcpy(out, transfer.sourceData, size*static_cast<size_t>(info.sourceNum));
+          out += size*static_cast<size_t>(info.sourceNum);
+        }
+      }
+      if (i != commRank)
+        bytes_sent_ += sendBytes[i];
+    };
+
+    // Unpack the data received from rank i, owned then ghost entities
+    auto unpack = [&](int i, char const* in) {
+      for (int k=0; k<numTransfers; k++)
+      {
+        comm_info_t const& info = *transfers[k].info;
+        size_t const size = transfers[k].entitySize;
+        size_t const numOwned = info.recvOwnedCounts[i];
+        size_t const numGhost = info.recvCounts[i] - info.recvOwnedCounts[i];
+        std::memcpy(newData[k] + size*ownedStart[k][i], in, size*numOwned);
+        in += size*numOwned;
+        std::memcpy(newData[k] + size*ghostStart[k][i], in, size*numGhost);
+        in += size*numGhost;
+      }
+    };
 
-        // loop of material cell indices, converting to gid, then flat cell
-        for (auto id: distributedMaterialCellIds_[m])
-          flatMaterialCellIds.push_back(gidToFlatCellId_[kv.second[id]]);
+    size_t const maxBytes = max_message_bytes_;
 
-        // add the material cells to the state manager
-        source_state_flat.mat_add_cells(kv.first, flatMaterialCellIds);
+    // all ranks must agree on using the collective, whose counts and
+    // offsets are ints
+    int tooLarge = sendBuffer.size() > maxBytes || recvBuffer.size() > maxBytes;
+    MPI_Allreduce(MPI_IN_PLACE, &tooLarge, 1, MPI_INT, MPI_LOR, comm_);
 
-      }
+    if (!tooLarge)
+    {
+      for (int i=0; i<commSize; i++)
+        pack(i);
+
+      std::vector<int> sendCounts(sendBytes.begin(), sendBytes.end());
+      std::vector<int> recvCounts(recvBytes.begin(), recvBytes.end());
+      std::vector<int> sendDispls(sendOffsets.begin(), sendOffsets.end());
+      std::vector<int> recvDispls(recvOffsets.begin(), recvOffsets.end());
+      MPI_Alltoallv(sendBuffer.data(), &(sendCounts[0]), &(sendDispls[0]), MPI_BYTE,
+                    recvBuffer.data(), &(recvCounts[0]), &(recvDispls[0]), MPI_BYTE,
+                    comm_);
+
+      for (int i=0; i<commSize; i++)
+        unpack(i, recvBuffer.data() + recvOffsets[i]);
+      return;
     }
 
-    // Send and receive each field to be remapped
-    for (std::string field_name : source_state_flat.names())
-    {
+    // Each rank will do non-blocking receives from each rank from which
+    // it will receive data, one per message of at most maxBytes. Messages
+    // between two ranks arrive in the order they are sent.
+    std::vector<MPI_Request> recvRequests, sendRequests;
+    std::vector<int> senders, pendingMessages(commSize, 0);
+    for (int i=0; i<commSize; i++)
+      if (i != commRank)
+        for (size_t start=0; start<recvBytes[i]; start+=maxBytes)
+        {
+          MPI_Request request;
+          int const count = std::min(maxBytes, recvBytes[i]-start);
+          MPI_Irecv(recvBuffer.data() + recvOffsets[i] + start, count, MPI_BYTE,
+                    i, 0, comm_, &request);
+          recvRequests.push_back(request);
+          senders.push_back(i);
+          pendingMessages[i]++;
+        }
 
-      // this is a packed version of the field with copied field values and is
-      // not a pointer to the original field
-      std::vector<double> sourceField = source_state_flat.pack(field_name);
+    // Send the data for each rank as soon as it is packed, starting with
+    // the next rank so that all ranks do not send to the same one first
+    for (int j=1; j<=commSize; j++)
+    {
+      int const i = (commRank + j) % commSize;
+      if (sendBytes[i] == 0)
+        continue;
+      pack(i);
+      if (i != commRank)
+        for (size_t start=0; start<sendBytes[i]; start+=maxBytes)
+        {
+          MPI_Request request;
+          int const count = std::min(maxBytes, sendBytes[i]-start);
+          MPI_Isend(sendBuffer.data() + sendOffsets[i] + start, count, MPI_BYTE,
+                    i, 0, comm_, &request);
+          sendRequests.push_back(request);
+        }
+    }
 
-      // get the field stride
-      int sourceFieldStride = source_state_flat.get_field_stride(field_name);
+    // The data kept on this rank does not go through MPI
+    if (sendBytes[commRank] > 0)
+      unpack(commRank, sendBuffer.data() + sendOffsets[commRank]);
 
-      comm_info_t info;
-      if (source_state_flat.get_entity(field_name) == Entity_kind::NODE){
-          // node mesh field
-          info = nodeInfo;
-      } else if (source_state_flat.field_type(Entity_kind::CELL, field_name) == Wonton::Field_type::MESH_FIELD){
-          // mesh cell field
-          info = cellInfo;
-      } else {
-         // multi material field
-         info = num_mat_cells_info;
-      }
+    // Unpack the data of other ranks once all their messages arrived
+    for (unsigned n=0; n<recvRequests.size(); n++)
+    {
+      int index;
+      MPI_Waitany(recvRequests.size(), &(recvRequests[0]), &index,
+                  MPI_STATUS_IGNORE);
+      int const i = senders[index];
+      if (--pendingMessages[i] == 0)
+        unpack(i, recvBuffer.data() + recvOffsets[i]);
+    }
 
-      // allocate storage for the new distributed data, note that this data
-      // has raw doubles and will need to be merged and type converted
+    if (!sendRequests.empty())
+      MPI_Waitall(sendRequests.size(), &(sendRequests[0]), MPI_STATUSES_IGNORE);
+  } // exchange
 
-      std::vector<double> distributedField(sourceFieldStride*info.newNum);
 
-      // send the field
-      sendField(info, commRank, commSize, MPI_DOUBLE, sourceFieldStride,
-        sourceField, &distributedField);
+  /*!
+    @brief Merge the fields received and set them in the flat state
+    @param[in] source_state_flat  Flat state, material cells set
+    @param[in] field_names        Names of the fields distributed
+    @param[in] distributedFields  Field values received, as raw doubles
+    @param[in] fieldStrides       Strides of the fields
+   */
+  template <class Source_State>
+  void merge_fields(Source_State &source_state_flat,
+                    std::vector<std::string> const& field_names,
+                    std::vector<std::vector<double>>& distributedFields,
+                    std::vector<int> const& fieldStrides)
+  {
+    int const num_fields = field_names.size();
 
+    for (int k = 0; k < num_fields; ++k)
+    {
+      std::string const& field_name = field_names[k];
+      std::vector<double>& distributedField = distributedFields[k];
       std::vector<double> tempDistributedField;
 
       if (source_state_flat.get_entity(field_name) == Entity_kind::NODE){
 
         // node mesh field
         // merge duplicates, but data still is raw doubles
-        merge_duplicate_data(distributedField, distributedNodeIds_, tempDistributedField, sourceFieldStride);
+        merge_duplicate_data(distributedField, distributedNodeIds_, tempDistributedField, fieldStrides[k]);
 
         // unpack the field, has the correct data type
         source_state_flat.unpack(field_name, tempDistributedField);
@@ -578,7 +1276,7 @@ class MPI_Bounding_Boxes {
 
         // cell mesh field
         // merge duplicates, but data still is raw doubles
-        merge_duplicate_data(distributedField, distributedCellIds_, tempDistributedField, sourceFieldStride);
+        merge_duplicate_data(distributedField, distributedCellIds_, tempDistributedField, fieldStrides[k]);
 
         // unpack the field, has the correct data types
         source_state_flat.unpack(field_name, tempDistributedField);
@@ -594,240 +1292,476 @@ class MPI_Bounding_Boxes {
           distributedMaterialCellIds_);
       }
     }
+  } // merge_fields
 
-    // need to do this at the end of the mesh stuff, because converting to
-    // gid uses the global id's and we don't want to modify them before we are
-    // done converting the old relationships
-    // merge global ids and set in the flat mesh
-    merge_duplicate_data(distributedCellGlobalIds, distributedCellIds_, sourceCellGlobalIds);
-    merge_duplicate_data(distributedNodeGlobalIds, distributedNodeIds_, sourceNodeGlobalIds);
-
-    // set counts for cells and nodes in the flat mesh
-    source_mesh_flat.set_num_owned_cells(flatCellNumOwned_);
-    source_mesh_flat.set_num_owned_nodes(flatNodeNumOwned_);
 
-    // Finish initialization using redistributed data
-    source_mesh_flat.finish_init();
+  /*!
+    @brief Key of the topology data sent by this rank
+    @param[in] infos             Info data structures, send counts set
+    @param[in] transfers         Topology data exchanged
+
+    The key hashes the send counts and lists of each entity type and the
+    source data of each piece, each list preceded by its size, so that two
+    distributions with the same key send the same topology data (up to a
+    collision of the 64-bit hashes of streams of the same length). Only
+    the key is kept between distributions, not the data.
+   */
+  topology_key_t topology_key(std::vector<comm_info_t*> const& infos,
+                              std::vector<transfer_t> const& transfers) const
+  {
+    topology_key_t key;
+    key.hash = 14695981039346656037ull;  // FNV-1a offset basis
+    auto append = [&key](void const* data, size_t size) {
+      unsigned char const* bytes = static_cast<unsigned char const*>(data);
+      for (size_t i=0; i<size; i++)
+      {
+        key.hash ^= bytes[i];
+        key.hash *= 1099511628211ull;  // FNV-1a prime
+      }
+      key.bytes += size;
+    };
+    auto append_ints = [&append](std::vector<int> const& values) {
+      int const size = values.size();
+      append(&size, sizeof(int));
+      append(values.data(), sizeof(int)*size);
+    };
+
+    for (auto const* info : infos)
+    {
+      append(&info->sourceNum, sizeof(int));
+      append(&info->sourceNumOwned, sizeof(int));
+      append_ints(info->sendCounts);
+      append_ints(info->sendOwnedCounts);
+      for (auto const& ids : info->sendOwnedIds) append_ints(ids);
+      for (auto const& ids : info->sendGhostIds) append_ints(ids);
+    }
+    for (auto const& transfer : transfers)
+      append(transfer.sourceData,
+             transfer.entitySize*static_cast<size_t>(transfer.info->sourceNum));
+    return key;
+  } // topology_key
 
 
-  } // distribute
+  /*!
+    @brief Keep the topology of the flat mesh for the next distributions
+    @param[in] source_mesh_flat  Flat mesh, redistributed
+    @param[in] infos             Info data structures, receive counts set
+    @param[in] topologyKey       Key of the topology data sent
+   */
+  template <class Source_Mesh>
+  void save_topology(Source_Mesh &source_mesh_flat,
+                     std::vector<comm_info_t*> const& infos,
+                     topology_key_t const& topologyKey)
+  {
+    topologyKey_ = topologyKey;
+    topologyInfos_.clear();
+    for (auto const* info : infos)
+      topologyInfos_.push_back(*info);
 
-  private:
+    if (dim_ == 2)
+    {
+      flatCellNodeCounts_ = source_mesh_flat.get_cell_node_counts();
+      flatCellToNodeList_ = source_mesh_flat.get_cell_to_node_list();
+    }
 
-  // The communicator we are using
-  MPI_Comm comm_ = MPI_COMM_NULL;
+    if (dim_ == 3)
+    {
+      flatCellFaceCounts_ = source_mesh_flat.get_cell_face_counts();
+      flatCellToFaceList_ = source_mesh_flat.get_cell_to_face_list();
+      flatCellToFaceDirs_ = source_mesh_flat.get_cell_to_face_dirs();
+      flatFaceNodeCounts_ = source_mesh_flat.get_face_node_counts();
+      flatFaceToNodeList_ = source_mesh_flat.get_face_to_node_list();
+    }
+  } // save_topology
 
-  int dim_ = 1;
 
-  // the number of nodes "owned" by the flat mesh. "Owned" is in quotes because
-  // a node may be "owned" by multiple partitions in the flat mesh. A node is
-  // owned by the flat mesh if it was owned by any partition.
-  int flatNodeNumOwned_ = 0;
+  /*!
+    @brief Set the topology kept from the last distribution in the flat
+           mesh and state
+    @param[in] source_mesh_flat  Flat mesh, coordinates already merged
+    @param[in] source_state_flat Flat state
+   */
+  template <class Source_Mesh, class Source_State>
+  void restore_topology(Source_Mesh &source_mesh_flat,
+                        Source_State &source_state_flat) const
+  {
+    if (dim_ == 2)
+    {
+      source_mesh_flat.get_cell_node_counts() = flatCellNodeCounts_;
+      source_mesh_flat.get_cell_to_node_list() = flatCellToNodeList_;
+    }
 
-  // the global id's of the kept nodes in the flat mesh and their indices in the
-  // distributed node global id's
-  std::vector<GID_t> flatNodeGlobalIds_ {};
-  std::vector<int> distributedNodeIds_ {};
+    if (dim_ == 3)
+    {
+      source_mesh_flat.get_cell_face_counts() = flatCellFaceCounts_;
+      source_mesh_flat.get_cell_to_face_list() = flatCellToFaceList_;
+      source_mesh_flat.get_cell_to_face_dirs() = flatCellToFaceDirs_;
+      source_mesh_flat.get_face_node_counts() = flatFaceNodeCounts_;
+      source_mesh_flat.get_face_to_node_list() = flatFaceToNodeList_;
+      source_mesh_flat.get_global_face_ids() = flatFaceGlobalIds_;
+      source_mesh_flat.set_num_owned_faces(flatFaceNumOwned_);
+    }
 
-  // maps from gid to distributed node index and flat node index
-  std::map<GID_t,int> gidToFlatNodeId_ {};
+    if (source_state_flat.num_materials() > 0)
+    {
+      source_state_flat.clear_material_cells();
+      for (auto const& kv : flatMaterialCells_)
+        source_state_flat.mat_add_cells(kv.first, kv.second);
+    }
 
-  // the number of faces "owned" by the flat mesh. "Owned" is in quotes because
-  // a face may be "owned" by multiple partitions in the flat mesh. A face is
-  // owned by the flat mesh if it was owned by any partition.
-  int flatFaceNumOwned_ = 0;
+    source_mesh_flat.get_global_cell_ids() = flatCellGlobalIds_;
+    source_mesh_flat.get_global_node_ids() = flatNodeGlobalIds_;
+    source_mesh_flat.set_num_owned_cells(flatCellNumOwned_);
+    source_mesh_flat.set_num_owned_nodes(flatNodeNumOwned_);
+  } // restore_topology
 
-  // the global id's of the kept faces in the flat mesh and their indices in the
-  // distributed face global id's
-  std::vector<GID_t> flatFaceGlobalIds_ {};
-  std::vector<int> distributedFaceIds_ {};
 
-  // maps from gid to distributed face index and flat face index
-  std::map<GID_t,int> gidToFlatFaceId_ {};
+  /*!
+    @brief Compute the bounding boxes of the cells of a mesh
+    @param[in] mesh    Mesh whose cells are boxed
+    @param[in] ncells  Number of cells (owned first) to box
+    @param[in] dim     Spatial dimension of the mesh
+    @return The boxes, 2*dim values per cell: min and max along each axis
+   */
+  template <class Mesh>
+  std::vector<double> cell_bounding_boxes(Mesh const& mesh, int ncells,
+                                          int dim) const {
+    std::vector<double> boxes(2*dim*ncells);
+    std::vector<int> nodes;
+    for (int c=0; c<ncells; ++c)
+    {
+      double* box = &(boxes[2*dim*c]);
+      for (int k=0; k<dim; ++k)
+      {
+        box[2*k] = std::numeric_limits<double>::max();
+        box[2*k+1] = -std::numeric_limits<double>::max();
+      }
 
-  // the number of cells "owned" by the flat mesh. "Owned" is in quotes because
-  // a cell may be "owned" by multiple partitions in the flat mesh. A cell is
-  // owned by the flat mesh if it was owned by any partition.
-  int flatCellNumOwned_ = 0;
+      mesh.cell_get_nodes(c, &nodes);
+      for (int n : nodes)
+      {
+        // dim is not known at compile time
+        double coord[3];
+        if (dim == 3)
+        {
+          Point<3> nodeCoord;
+          mesh.node_get_coordinates(n, &nodeCoord);
+          for (int k=0; k<3; ++k) coord[k] = nodeCoord[k];
+        }
+        else
+        {
+          Point<2> nodeCoord;
+          mesh.node_get_coordinates(n, &nodeCoord);
+          for (int k=0; k<2; ++k) coord[k] = nodeCoord[k];
+        }
+        for (int k=0; k<dim; ++k)
+        {
+          box[2*k] = std::min(box[2*k], coord[k]);
+          box[2*k+1] = std::max(box[2*k+1], coord[k]);
+        }
+      }
+    }
+    return boxes;
+  }
 
-  // the global id's of the kept cells in the flat mesh and their indices in the
-  // distributed cell global id's
-  std::vector<GID_t> flatCellGlobalIds_ {};
-  std::vector<int> distributedCellIds_ {};
 
-  // maps from gid to distributed cell index and flat cell index
-  std::map<GID_t,int> gidToFlatCellId_ {};
+  /*!
+    @brief Whether two boxes overlap by more than a small tolerance
 
-  // vectors for distributed multimaterial data
-  std::vector<int> distributedMaterialIds_ {};
-  std::vector<int> distributedMaterialShapes_ {};
-  std::vector<GID_t> distributedMaterialCells_ {};
+    As in compute_sendflags, boxes that are only incident to each other are
+    not considered overlapping.
+   */
+  static bool boxes_overlap(double const* box1, double const* box2, int dim) {
+    const double boxOffset = 2.0*std::numeric_limits<double>::epsilon();
+    for (int k=0; k<dim; ++k)
+      if (box1[2*k+1]-boxOffset < box2[2*k]+boxOffset ||
+          box2[2*k+1]-boxOffset < box1[2*k]+boxOffset)
+        return false;
+    return true;
+  }
 
-  // map for the distributed material cell indices
-  // for each material there is a vector of unique distributed indices
-  std::map<int, std::vector<int>> distributedMaterialCellIds_ {};
 
   /*!
-    @brief Compute fields needed to do comms for a given entity type
-    @param[in] info              Info data structure to be filled
-    @param[in] commSize          Total number of MPI ranks
-    @param[in] sendFlags         Array of flags:  do I send to PE n?
-    @param[in] sourceNum         Number of entities (total) on this rank
-    @param[in] sourceNumOwned    Number of owned entities on this rank
+    @brief Find the source cells overlapping the target boxes of each rank
+    @tparam D  Spatial dimension
+    @param[in] sourceCellBoxes  Bounding boxes of the source cells
+    @param[in] sourceNumOwnedCells  Number of owned source cells
+    @param[in] targetBoxes  Gathered target boxes of all ranks
+    @param[in] boxRanks  Rank of each target box, in increasing order
+    @param[out] sendOwnedCells  Owned cells to send to each rank
+    @param[out] sendGhostCells  Ghost cells to send to each rank
+
+    The target boxes are put in a bounding volume hierarchy queried with
+    the box of each source cell, so that the search is not proportional to
+    the number of source cells times the number of target boxes. Cells are
+    listed in increasing order for each rank.
    */
-  void setSendRecvCounts(comm_info_t* info,
-               const int commSize,
-               const std::vector<bool>& sendFlags,
-               const int sourceNum,
-               const int sourceNumOwned)
-  {
-    // Set my counts of all entities and owned entities
-    info->sourceNum = sourceNum;
-    info->sourceNumOwned = sourceNumOwned;
-
-    // Each rank will tell each other rank how many indexes it is going to send it
-    info->sendCounts.resize(commSize);
-    info->recvCounts.resize(commSize);
-    for (int i=0; i<commSize; i++)
-      info->sendCounts[i] = sendFlags[i] ? info->sourceNum : 0;
-    MPI_Alltoall(&(info->sendCounts[0]), 1, MPI_INT,
-                 &(info->recvCounts[0]), 1, MPI_INT, comm_);
-
-    // Each rank will tell each other rank how many owned indexes it is going to send it
-    info->sendOwnedCounts.resize(commSize);
-    info->recvOwnedCounts.resize(commSize);
-    for (int i=0; i<commSize; i++)
-      info->sendOwnedCounts[i] = sendFlags[i] ? info->sourceNumOwned : 0;
-    MPI_Alltoall(&(info->sendOwnedCounts[0]), 1, MPI_INT,
-                 &(info->recvOwnedCounts[0]), 1, MPI_INT, comm_);
+  template <int D>
+  static void find_send_cells(std::vector<double> const& sourceCellBoxes,
+                              int sourceNumOwnedCells,
+                              std::vector<double> const& targetBoxes,
+                              std::vector<int> const& boxRanks,
+                              std::vector<std::vector<int>>& sendOwnedCells,
+                              std::vector<std::vector<int>>& sendGhostCells) {
+    int const nbox = 2*D;
+    int const numBoxes = boxRanks.size();
+    int const sourceNumCells = sourceCellBoxes.size()/nbox;
+
+    auto make_box = [](double const* values) {
+      Point<D> lo, hi;
+      for (int k=0; k<D; ++k)
+      {
+        lo[k] = values[2*k];
+        hi[k] = values[2*k+1];
+      }
+      IsotheticBBox<D> box;
+      box.add(lo);
+      box.add(hi);
+      return box;
+    };
+
+    std::vector<IsotheticBBox<D>> boxes(numBoxes);
+    for (int b=0; b<numBoxes; ++b)
+      boxes[b] = make_box(&(targetBoxes[nbox*b]));
+    BVH<D> const tree(boxes);
+
+    std::vector<int> found;
+    for (int c=0; c<sourceNumCells; ++c)
+    {
+      double const* box = &(sourceCellBoxes[nbox*c]);
+      tree.intersect(make_box(box), &found);
 
-    // Compute the total number of indexes this rank will receive from all ranks
-    for (int i=0; i<commSize; i++)
-      info->newNum += info->recvCounts[i];
-    for (int i=0; i<commSize; i++)
-      info->newNumOwned += info->recvOwnedCounts[i];
-  } // setSendRecvCounts
+      // the boxes found are sorted, so are their ranks
+      int lastRank = -1;
+      for (int b : found)
+      {
+        int const i = boxRanks[b];
+        if (i == lastRank || !boxes_overlap(box, &(targetBoxes[nbox*b]), D))
+          continue;
+        lastRank = i;
+        if (c < sourceNumOwnedCells)
+          sendOwnedCells[i].push_back(c);
+        else
+          sendGhostCells[i].push_back(c);
+      }
+    }
+  }
 
 
   /*!
-    @brief Send values for a single data field to all ranks as needed
-    @tparam[in] T                C++ type of data to be sent
-    @param[in] info              Info struct for entity type of field
-    @param[in] commRank          MPI rank of this PE
-    @param[in] commSize          Total number of MPI ranks
-    @param[in] mpiType           MPI type of data (MPI_???) to be sent
-    @param[in] stride            Stride of data field
-    @param[in] sourceData        Array of (old) source data
-    @param[in] newData           Array of new source data
+    @brief Compute the source cells to send to each rank in cell granular mode
+    @param[in] source_mesh  Source mesh (flat representation)
+    @param[in] target_mesh  Target mesh
+    @param[out] sendOwnedCells  Owned cells to send to each rank
+    @param[out] sendGhostCells  Ghost cells to send to each rank
+
+    The owned target cells of each rank are grouped by their centroid on a
+    coarse grid over the partition and the bounding boxes of the groups are
+    gathered on all ranks. A source cell, owned or ghost, is sent to every
+    rank with a box overlapping its bounding box, and keeps its ownership.
+    The node-adjacent cells of the owned cells sent are sent as ghosts so
+    that gradients can be computed on the receiving rank.
    */
-  template<typename T>
-  void sendField(const comm_info_t& info,
-                 int commRank, int commSize,
-                 MPI_Datatype mpiType, int stride,
-                 const std::vector<T>& sourceData,
-                 std::vector<T>* newData)
-  {
-    // Perform two rounds of sends: the first for owned cells, and the second for ghost cells
-    std::vector<int> recvGhostCounts(commSize);
-    std::vector<int> sendGhostCounts(commSize);
+  template <class Source_Mesh, class Target_Mesh>
+  void compute_send_cells(Source_Mesh & source_mesh, Target_Mesh &target_mesh,
+                          std::vector<std::vector<int>>& sendOwnedCells,
+                          std::vector<std::vector<int>>& sendGhostCells) {
 
-    for (int i=0; i<commSize; i++)
+    // Get the MPI communicator size and rank information
+    int commSize, commRank;
+    MPI_Comm_size(comm_, &commSize);
+    MPI_Comm_rank(comm_, &commRank);
+
+    int const dim = source_mesh.space_dimension();
+    int const nbox = 2*dim;
+
+    // Bounding boxes of the owned target cells and of the partition
+    int const targetNumOwnedCells = target_mesh.num_owned_cells();
+    std::vector<double> targetCellBoxes =
+        cell_bounding_boxes(target_mesh, targetNumOwnedCells, dim);
+
+    std::vector<double> partitionBox(nbox);
+    for (int k=0; k<dim; ++k)
     {
-      recvGhostCounts[i] = info.recvCounts[i] - info.recvOwnedCounts[i];
-      sendGhostCounts[i] = info.sendCounts[i] - info.sendOwnedCounts[i];
+      partitionBox[2*k] = std::numeric_limits<double>::max();
+      partitionBox[2*k+1] = -std::numeric_limits<double>::max();
     }
+    for (int c=0; c<targetNumOwnedCells; ++c)
+      for (int k=0; k<dim; ++k)
+      {
+        partitionBox[2*k] = std::min(partitionBox[2*k], targetCellBoxes[nbox*c+2*k]);
+        partitionBox[2*k+1] = std::max(partitionBox[2*k+1], targetCellBoxes[nbox*c+2*k+1]);
+      }
 
-    sendData(commRank, commSize, mpiType, stride,
-             0, info.sourceNumOwned,
-             0,
-             info.sendOwnedCounts, info.recvOwnedCounts,
-             sourceData, newData);
-    sendData(commRank, commSize, mpiType, stride,
-             info.sourceNumOwned, info.sourceNum,
-             info.newNumOwned,
-             sendGhostCounts, recvGhostCounts,
-             sourceData, newData);
-
-#ifdef DEBUG_MPI
-    std::cout << "Number of values on rank " << commRank << ": " << (*newData).size() << std::endl;
-    for (int f=0; f<(*newData).size(); f++)
-      std::cout << (*newData)[f] << " ";
-    std::cout << std::endl << std::endl;
-#endif
-  } // sendField
+    // Group the target cells by the bin of the grid holding their centroid
+    int numBins = 1;
+    for (int k=0; k<dim; ++k) numBins *= target_bins_per_axis_;
 
+    std::vector<double> binBoxes(nbox*numBins);
+    for (int b=0; b<numBins; ++b)
+      for (int k=0; k<dim; ++k)
+      {
+        binBoxes[nbox*b+2*k] = std::numeric_limits<double>::max();
+        binBoxes[nbox*b+2*k+1] = -std::numeric_limits<double>::max();
+      }
 
-  /*!
-    @brief Send values for a single range of data to all ranks as needed
-    @tparam[in] T                C++ type of data to be sent
-    @param[in] commRank          MPI rank of this PE
-    @param[in] commSize          Total number of MPI ranks
-    @param[in] mpiType           MPI type of data (MPI_???) to be sent
-    @param[in] stride            Stride of data field
-    @param[in] sourceStart       Start location in source (send) data
-    @param[in] sourceEnd         End location in source (send) data
-    @param[in] newStart          Start location in new (recv) data
-    @param[in] curSendCounts     Array of send sizes from me to all PEs
-    @param[in] curRecvCounts     Array of recv sizes to me from all PEs
-    @param[in] sourceData        Array of (old) source data
-    @param[in] newData           Array of new source data
-   */
-  template<typename T>
-  void sendData(int commRank, int commSize,
-                MPI_Datatype mpiType, int stride,
-                int sourceStart, int sourceEnd,
-                int newStart,
-                const std::vector<int>& curSendCounts,
-                const std::vector<int>& curRecvCounts,
-                const std::vector<T>& sourceData,
-                std::vector<T>* newData)
-  {
-    // Each rank will do a non-blocking receive from each rank from
-    // which it will receive data values
-    int writeOffset = newStart;
-    int myOffset = 0;
-    std::vector<MPI_Request> requests;
-    for (int i=0; i<commSize; i++)
+    std::vector<bool> binUsed(numBins, false);
+    for (int c=0; c<targetNumOwnedCells; ++c)
     {
-      if ((i != commRank) && (curRecvCounts[i] > 0))
+      double const* box = &(targetCellBoxes[nbox*c]);
+      int bin = 0;
+      for (int k=dim-1; k>=0; --k)
       {
-        MPI_Request request;
-        MPI_Irecv((void *)&((*newData)[stride*writeOffset]),
-                  stride*curRecvCounts[i], mpiType, i,
-                  MPI_ANY_TAG, comm_, &request);
-        requests.push_back(request);
+        double const extent = partitionBox[2*k+1] - partitionBox[2*k];
+        double const center = 0.5*(box[2*k] + box[2*k+1]);
+        int ib = extent > 0. ?
+            static_cast<int>((center - partitionBox[2*k])/extent*target_bins_per_axis_) : 0;
+        ib = std::max(0, std::min(ib, target_bins_per_axis_-1));
+        bin = bin*target_bins_per_axis_ + ib;
       }
-      else if (i == commRank)
+      binUsed[bin] = true;
+      for (int k=0; k<dim; ++k)
       {
-        myOffset = writeOffset;
+        binBoxes[nbox*bin+2*k] = std::min(binBoxes[nbox*bin+2*k], box[2*k]);
+        binBoxes[nbox*bin+2*k+1] = std::max(binBoxes[nbox*bin+2*k+1], box[2*k+1]);
       }
-      writeOffset += curRecvCounts[i];
     }
 
-    // Copy data values that will stay on this rank into the
-    // proper place in the new vector
-    if (curRecvCounts[commRank] > 0)
-      std::copy(sourceData.begin() + stride*sourceStart,
-                sourceData.begin() + stride*sourceEnd,
-                newData->begin() + stride*myOffset);
+    std::vector<double> myBoxes;
+    for (int b=0; b<numBins; ++b)
+      if (binUsed[b])
+        myBoxes.insert(myBoxes.end(), binBoxes.begin()+nbox*b,
+                       binBoxes.begin()+nbox*(b+1));
+
+    // Gather the boxes of all ranks
+    int myNumValues = myBoxes.size();
+    std::vector<int> numValues(commSize), valueOffsets(commSize+1, 0);
+    MPI_Allgather(&myNumValues, 1, MPI_INT, &(numValues[0]), 1, MPI_INT, comm_);
+    std::partial_sum(numValues.begin(), numValues.end(), valueOffsets.begin()+1);
+
+    std::vector<double> targetBoxes(valueOffsets[commSize]);
+    MPI_Allgatherv(myBoxes.data(), myNumValues, MPI_DOUBLE,
+                   targetBoxes.data(), &(numValues[0]), &(valueOffsets[0]),
+                   MPI_DOUBLE, comm_);
+
+    // Bounding boxes of the source cells
+    int const sourceNumOwnedCells = source_mesh.num_owned_cells();
+    int const sourceNumCells = sourceNumOwnedCells + source_mesh.num_ghost_cells();
+    std::vector<double> sourceCellBoxes =
+        cell_bounding_boxes(source_mesh, sourceNumCells, dim);
+
+    sendOwnedCells.assign(commSize, {});
+    sendGhostCells.assign(commSize, {});
+
+    // rank of each gathered box
+    std::vector<int> boxRanks(valueOffsets[commSize]/nbox);
+    for (int i=0; i<commSize; ++i)
+      std::fill(boxRanks.begin()+valueOffsets[i]/nbox,
+                boxRanks.begin()+valueOffsets[i+1]/nbox, i);
 
-    // Each rank will send its data values to appropriate ranks
-    for (int i=0; i<commSize; i++)
+    if (dim == 3)
+      find_send_cells<3>(sourceCellBoxes, sourceNumOwnedCells, targetBoxes,
+                         boxRanks, sendOwnedCells, sendGhostCells);
+    else
+      find_send_cells<2>(sourceCellBoxes, sourceNumOwnedCells, targetBoxes,
+                         boxRanks, sendOwnedCells, sendGhostCells);
+
+    std::vector<int> sent(sourceNumCells, -1);
+    std::vector<int> neighbors;
+
+    for (int i=0; i<commSize; ++i)
     {
-      if ((i != commRank) && (curSendCounts[i] > 0))
+      for (int c : sendOwnedCells[i]) sent[c] = i;
+      for (int c : sendGhostCells[i]) sent[c] = i;
+
+      // add the layer of cells around the owned cells sent as ghosts
+      for (int c : sendOwnedCells[i])
       {
-        MPI_Send((void *)&(sourceData[stride*sourceStart]),
-                 stride*curSendCounts[i], mpiType, i, 0, comm_);
+        source_mesh.cell_get_node_adj_cells(c, Entity_type::ALL, &neighbors);
+        for (int n : neighbors)
+          if (sent[n] != i)
+          {
+            sent[n] = i;
+            sendGhostCells[i].push_back(n);
+          }
       }
+      std::sort(sendGhostCells[i].begin(), sendGhostCells[i].end());
     }
+  } // compute_send_cells
+
 
-    // Wait for all receives to complete
-    if (!requests.empty())
+  /*!
+    @brief Compute the entities of a given kind to send to each rank from
+           the cells sent to it
+    @param[in] sendOwnedCells   Owned cells sent to each rank
+    @param[in] sendGhostCells   Ghost cells sent to each rank
+    @param[in] sourceNum        Number of entities (total) on this rank
+    @param[in] sourceNumOwned   Number of owned entities on this rank
+    @param[in] cell_get_entities  Function filling the entities of a cell
+    @param[out] sendOwnedIds    Owned entities to send to each rank
+    @param[out] sendGhostIds    Ghost entities to send to each rank
+
+    Entities keep their ownership on this rank, whatever the cell they
+    are sent with.
+   */
+  template <class Get_Entities>
+  void adjacent_send_lists(std::vector<std::vector<int>> const& sendOwnedCells,
+                           std::vector<std::vector<int>> const& sendGhostCells,
+                           int sourceNum, int sourceNumOwned,
+                           Get_Entities const& cell_get_entities,
+                           std::vector<std::vector<int>>& sendOwnedIds,
+                           std::vector<std::vector<int>>& sendGhostIds) const {
+    int const commSize = sendOwnedCells.size();
+    sendOwnedIds.assign(commSize, {});
+    sendGhostIds.assign(commSize, {});
+
+    std::vector<int> sent(sourceNum, -1);
+    std::vector<int> entities;
+
+    for (int i=0; i<commSize; ++i)
     {
-      std::vector<MPI_Status> statuses(requests.size());
-      MPI_Waitall(requests.size(), &(requests[0]), &(statuses[0]));
+      for (auto const* cells : {&sendOwnedCells[i], &sendGhostCells[i]})
+        for (int c : *cells)
+        {
+          cell_get_entities(c, &entities);
+          for (int e : entities)
+            if (sent[e] != i)
+            {
+              sent[e] = i;
+              if (e < sourceNumOwned)
+                sendOwnedIds[i].push_back(e);
+              else
+                sendGhostIds[i].push_back(e);
+            }
+        }
+      std::sort(sendOwnedIds[i].begin(), sendOwnedIds[i].end());
+      std::sort(sendGhostIds[i].begin(), sendGhostIds[i].end());
     }
-  } // sendData
+  } // adjacent_send_lists
+
+
+  /*!
+    @brief Expand the entities sent to each rank into the positions of
+           their references in a ragged list, e.g. the cell to node list
+    @param[in] sendIds   Entities sent to each rank
+    @param[in] offsets   Offset of the references of each entity in the list
+    @param[in] listSize  Size of the list
+    @return The positions in the list sent to each rank
+   */
+  std::vector<std::vector<int>>
+  expand_send_lists(std::vector<std::vector<int>> const& sendIds,
+                    std::vector<int> const& offsets, int listSize) const {
+    int const numEntities = offsets.size();
+    std::vector<std::vector<int>> result(sendIds.size());
+    for (unsigned i=0; i<sendIds.size(); ++i)
+      for (int e : sendIds[i])
+      {
+        int const end = e+1 < numEntities ? offsets[e+1] : listSize;
+        for (int j=offsets[e]; j<end; ++j)
+          result[i].push_back(j);
+      }
+    return result;
+  } // expand_send_lists
 
 
   template <class Source_Mesh, class Target_Mesh>
@@ -1017,26 +1951,9 @@ class MPI_Bounding_Boxes {
   void compress(std::vector<GID_t> const& distributedGlobalIds,
                 std::vector<int>& distributedIds) const {
 
-    // a map for keeping track of what we have already seen
-    std::map<GID_t,int> uniqueGid;
-
-    int const num_distributed_global_ids = distributedGlobalIds.size();
-
-    // loop over owned cells in the distributed global id's
-    for (int i = 0 ; i < num_distributed_global_ids; ++i){
-
-      // get the current gid
-      GID_t gid = distributedGlobalIds[i];
-
-      // is this gid new
-      if (uniqueGid.find(gid) == uniqueGid.end()){
-
-        // make the gid seen
-        uniqueGid[gid]=i;
-
-      }
-
-    }
+    // the first occurrence of each gid, in gid order
+    std::vector<std::pair<GID_t,int>> uniqueGid =
+      sorted_unique(distributedGlobalIds, 0, distributedGlobalIds.size());
 
     // clear and reserve the result
     distributedIds.clear();
@@ -1107,29 +2024,18 @@ class MPI_Bounding_Boxes {
     int const distributedNumOwned, std::vector<int>& distributedIds,
     std::vector<GID_t>& flatGlobalIds, int &flatNumOwned) const {
 
-    // a map for keeping track of what we have already seen
-    std::map<GID_t,int> uniqueGid, uniqueGhostGid;
-
-    // loop over owned entitites in the distributed global id's
-    for (int i=0 ; i<distributedNumOwned ; ++i){
-
-      // get the current gid
-      GID_t gid = distributedGlobalIds[i];
-
-      // is this gid new
-      if (uniqueGid.find(gid)==uniqueGid.end()){
-
-        // make the gid seen
-        uniqueGid[gid]=i;
-
-      }
-
-    }
+    // the first occurrence of each gid among the owned entitites in the
+    // distributed global id's, in gid order
+    std::vector<std::pair<GID_t,int>> uniqueGid =
+      sorted_unique(distributedGlobalIds, 0, distributedNumOwned);
 
     // We have processed owned entitites in the distributed mesh, so everything
     // we have collected to this point is considered owned
     flatNumOwned = uniqueGid.size();
 
+    flatGlobalIds.clear();
+    distributedIds.clear();
+
     // push the owned entitites first and in gid order
     for (auto const& kv : uniqueGid){
 
@@ -1141,28 +2047,20 @@ class MPI_Bounding_Boxes {
 
     }
 
-    int const num_distributed_global_ids = distributedGlobalIds.size();
-
-    // loop over ghost entitites in the distributed global id's
-    for (int i = distributedNumOwned ; i < num_distributed_global_ids; ++i){
-
-      // get the current gid
-      GID_t gid = distributedGlobalIds[i];
-
-      // is this gid new
-      if (uniqueGid.find(gid)==uniqueGid.end() &&
-        uniqueGhostGid.find(gid)==uniqueGhostGid.end()){
-
-        // make the gid seen
-        uniqueGhostGid[gid]=i;
+    // the first occurrence of each gid among the ghost entitites in the
+    // distributed global id's, in gid order
+    std::vector<std::pair<GID_t,int>> uniqueGhostGid =
+      sorted_unique(distributedGlobalIds, distributedNumOwned,
+                    distributedGlobalIds.size());
 
-      }
-
-    }
-
-    // push the ghost entities in gid order
+    // push the ghost entities that are not owned in gid order
     for (auto const& kv : uniqueGhostGid){
 
+      // skip the gid if it is owned, the owned gids are sorted
+      if (std::binary_search(flatGlobalIds.begin(),
+                             flatGlobalIds.begin() + flatNumOwned, kv.first))
+        continue;
+
       // push to the flat entities gid
       flatGlobalIds.push_back(kv.first);
 
@@ -1175,26 +2073,35 @@ class MPI_Bounding_Boxes {
 
 
   /*!
-    @brief Create a map from gid to flat mesh index
-
-    @param[in] flatGlobalIds  The vector of gid's in the flat mesh
-    @param[out] gidToFlat  The map from global id to flat cell index
+    @brief Find the first occurrence of each gid in a range of distributed
+    global id's
 
-    This function creates a trivial map from global id to flat cell index.
-    The index of the global id is the value of the map. We use this later when
-    converting global id's into the new flat mesh local index.
+    @param[in] distributedGlobalIds  The vector of gid's post distribution
+    @param[in] begin  The first index of the range
+    @param[in] end  The index past the end of the range
+    @return The (gid, index of first occurrence) pairs in ascending gid order
 
-    In the above example, create_gid_flat_map would take the vector
-    `flatGlobalIds=[2, 3, 7, 9, 10, 4, 5]` and return the map
-    `gidToFlat={(2:0),(3:1),(7:2),(9:3),(10:4),(4:5),(5:6)}`.
+    The (gid, index) pairs are sorted with all threads, so that the first
+    occurrence of each gid comes first among its duplicates, and only the
+    first pair of each gid is kept.
   */
-  void create_gid_to_flat_map(std::vector<GID_t> const& flatGlobalIds,
-                              std::map<GID_t,int>& gidToFlat) const {
-
-    int const num_flat_global_ids = flatGlobalIds.size();
-    for (int i = 0; i < num_flat_global_ids; ++i)
-      gidToFlat[flatGlobalIds[i]]=i;
-
+  std::vector<std::pair<GID_t,int>>
+  sorted_unique(std::vector<GID_t> const& distributedGlobalIds,
+                int begin, int end) const {
+
+    std::vector<std::pair<GID_t,int>> pairs(end - begin);
+    for (int i = begin; i < end; ++i)
+      pairs[i - begin] = {distributedGlobalIds[i], i};
+
+    parallel_sort(pairs);
+
+    pairs.erase(std::unique(pairs.begin(), pairs.end(),
+                            [](std::pair<GID_t,int> const& a,
+                               std::pair<GID_t,int> const& b) {
+                              return a.first == b.first;
+                            }),
+                pairs.end());
+    return pairs;
   }
 
 
@@ -1244,7 +2151,7 @@ class MPI_Bounding_Boxes {
     topological references need to get converted from gid to their new flat index id.
   */
   void merge_duplicate_lists(std::vector<GID_t>const& in, std::vector<int> const& counts,
-    std::vector<int>const& distributedIds, std::map<GID_t,int>const& gidToFlatId,
+    std::vector<int>const& distributedIds, GidMap const& gidToFlatId,
     std::vector<int>& result){
 
     // allocate offsets
@@ -18,6 +18,7 @@ Please see the license file at the root of this repository, or at:
 #include "portage/accumulate/accumulate.h"
 #include "portage/support/portage.h"
 #include "portage/support/weight.h"
+#include "portage/support/smoothing_lengths.h"
 #include "wonton/support/Point.h"
 
 #include "mpi.h"
@@ -87,7 +88,7 @@ public:
   template<class SourceSwarm, class SourceState, class TargetSwarm, class TargetState>
   void distribute(SourceSwarm& source_swarm, SourceState& source_state,
                   TargetSwarm& target_swarm, TargetState& target_state,
-                  Portage::vector<std::vector<std::vector<double>>>& smoothing_lengths,
+                  Meshfree::SmoothingLengths& smoothing_lengths,
                   Portage::vector<Point<dim>>& source_extents,
                   Portage::vector<Point<dim>>& target_extents,
                   Portage::vector<Meshfree::Weight::Kernel>& kernel_types,
@@ -259,18 +260,19 @@ public:
     *         the Scatter scheme                                              *
     ***************************************************************************/
     if (center == Meshfree::WeightCenter::Scatter) {
-      //collect smoothing length sizes and get max
-      std::vector<std::vector<double>> h0 = smoothing_lengths[0];
-      int smlen_dim = h0[0].size();
+      //collect smoothing length sizes and get max over all ranks, so
+      //that every rank packs and unpacks the same message layout even
+      //if it has no particle
+      int const local_dim = smoothing_lengths.facet_size();
       std::vector<int> smoothing_length_sizes(nb_source_points);
-      int max_slsize = 0;
+      int sizes[2] = {local_dim, 0};
       for (int i = 0; i < nb_source_points; i++) {
-        std::vector<std::vector<double>> h = smoothing_lengths[i];
-        smoothing_length_sizes[i] = h.size();
-        max_slsize = std::max<int>(smoothing_length_sizes[i], max_slsize);
-        for (int j = 0; j < smoothing_length_sizes[i]; j++)
-          assert(h[j].size() == unsigned(smlen_dim));
+        smoothing_length_sizes[i] = smoothing_lengths.num_facets(i);
+        sizes[1] = std::max<int>(smoothing_length_sizes[i], sizes[1]);
       }
+      MPI_Allreduce(MPI_IN_PLACE, sizes, 2, MPI_INT, MPI_MAX, comm_);
+      int const smlen_dim = sizes[0];
+      int const max_slsize = sizes[1];
 
       //-----------------------------------------------
       //communicate smoothing length sizes
@@ -296,10 +298,6 @@ public:
         smoothing_length_sizes.push_back(smlensize);
       }
 
-      // create cumulative received sizes
-      std::vector<int> recvSLSizeCum(src_info.new_num, 0);
-      for (int i = 1; i < src_info.new_num; ++i) recvSLSizeCum[i] += recvSLSizeCum[i - 1];
-
       //-----------------------------------------------
       //communicate smoothing_lengths
       //this is inefficient if doing facets and there is large variation in number of facets
@@ -308,13 +306,18 @@ public:
         if ((!sendFlags[i]) || (i == rank))
           continue;
         else {
+          auto& buffer = sourceSendSmoothLengths[i];
+          buffer.reserve(sourcePtsToSendSize[i] * max_slsize * smlen_dim);
           for (int j = 0; j < sourcePtsToSendSize[i]; ++j) {
-            std::vector<std::vector<double>> smlen(max_slsize, std::vector<double>(smlen_dim, 0.));
-            std::vector<std::vector<double>> h = smoothing_lengths[sourcePtsToSend[i][j]];
-            std::copy(h.begin(), h.end(), smlen.begin());
-            for (int k = 0; k < max_slsize; ++k)
-              for (int d = 0; d < smlen_dim; d++)
-                sourceSendSmoothLengths[i].push_back(smlen[k][d]);
+            // facets of the particle, padded with zeros to max_slsize
+            // facets of smlen_dim lengths
+            int const p = sourcePtsToSend[i][j];
+            double const* h = smoothing_lengths.data(p);
+            size_t const start = buffer.size();
+            buffer.resize(start + max_slsize * smlen_dim, 0.);
+            for (int k = 0; k < smoothing_length_sizes[p]; k++)
+              std::copy(h + k * local_dim, h + (k + 1) * local_dim,
+                        buffer.begin() + start + k * smlen_dim);
           }
         }
       }
@@ -325,13 +328,9 @@ public:
 
       // update local source particle list with received new particles
       for (int i = 0; i < src_info.new_num; ++i) {
-        std::vector<std::vector<double>> smlen
-          (smoothing_length_sizes[nb_source_points + i], std::vector<double>(smlen_dim));
-        for (int k = 0; k < smoothing_length_sizes[nb_source_points + i]; k++)
-          for (int d = 0; d < smlen_dim; ++d)
-            smlen[k][d] = sourceRecvSmoothLengths[recvSLSizeCum[i] + k * smlen_dim + d];
-
-        smoothing_lengths.push_back(smlen);
+        double const* h = sourceRecvSmoothLengths.data() + i * max_slsize * smlen_dim;
+        smoothing_lengths.push_back(h, smoothing_length_sizes[nb_source_points + i],
+                                    smlen_dim);
       }
 
       //-----------------------------------------------
@@ -479,6 +478,30 @@ public:
 
   } // distribute
 
+  /*!
+    @brief Same as above, for smoothing lengths given as nested vectors.
+    They are flattened for the communication and the lengths of the
+    received particles are appended to them.
+   */
+  template<class SourceSwarm, class SourceState, class TargetSwarm, class TargetState>
+  void distribute(SourceSwarm& source_swarm, SourceState& source_state,
+                  TargetSwarm& target_swarm, TargetState& target_state,
+                  Portage::vector<std::vector<std::vector<double>>>& smoothing_lengths,
+                  Portage::vector<Point<dim>>& source_extents,
+                  Portage::vector<Point<dim>>& target_extents,
+                  Portage::vector<Meshfree::Weight::Kernel>& kernel_types,
+                  Portage::vector<Meshfree::Weight::Geometry>& geom_types,
+                  Meshfree::WeightCenter center = Meshfree::WeightCenter::Gather) {
+    Meshfree::SmoothingLengths lengths(smoothing_lengths);
+    distribute(source_swarm, source_state, target_swarm, target_state,
+               lengths, source_extents, target_extents,
+               kernel_types, geom_types, center);
+
+    int const nb_lengths = lengths.size();
+    for (int i = smoothing_lengths.size(); i < nb_lengths; i++)
+      smoothing_lengths.push_back(lengths[i]);
+  }
+
 private:
 
   MPI_Comm comm_ = MPI_COMM_NULL;
@@ -7,7 +7,10 @@ Please see the license file at the root of this repository, or at:
 #include <iostream>
 #include <memory>
 #include <vector>
+#include <string>
+#include <array>
 #include <algorithm>
+#include <cmath>
 
 #include "gtest/gtest.h"
 
@@ -574,3 +577,521 @@ TEST(MPI_Bounding_Boxes, NeedsRedistribution3D_3) {
 }
 
 
+
+
+TEST(MPI_Bounding_Boxes, CellGranular2D) {
+
+  Jali::MeshFactory mf(MPI_COMM_WORLD);
+
+  // Source mesh
+  std::shared_ptr<Jali::Mesh> source_mesh = mf(0.0, 0.0, 1.0, 1.0, 8, 8);
+  Wonton::Jali_Mesh_Wrapper inputMeshWrapper(*source_mesh);
+
+  // Target mesh
+  std::shared_ptr<Jali::Mesh> target_mesh = mf(0.0, 0.0, 1.0, 1.0, 5, 5);
+  Wonton::Jali_Mesh_Wrapper target_mesh_(*target_mesh);
+  std::shared_ptr<Jali::State> target_state(Jali::State::create(target_mesh));
+  Wonton::Jali_State_Wrapper target_state_(*target_state);
+
+  Wonton::MPIExecutor_type executor(MPI_COMM_WORLD);
+
+  // distribute the same source mesh with whole partitions and cell by cell
+  int num_cells[2];
+  for (auto type : {Portage::PARTITION_BOUNDING_BOX, Portage::CELL_BOUNDING_BOX}) {
+
+    Wonton::Flat_Mesh_Wrapper<> source_mesh_flat;
+    source_mesh_flat.initialize(inputMeshWrapper);
+
+    std::vector<Wonton::GID_t>& gids = source_mesh_flat.get_global_cell_ids();
+    int const num_gids = gids.size();
+    std::vector<double> dtest(num_gids);
+    for (int i = 0; i < num_gids; ++i) dtest[i] = double(gids[i]) + 10.;
+
+    std::shared_ptr<Jali::State> state(Jali::State::create(source_mesh));
+    state->add("d1", source_mesh, Jali::Entity_kind::CELL,
+               Jali::Entity_type::ALL, dtest.data());
+
+    Wonton::Jali_State_Wrapper wrapper(*state);
+    Wonton::Flat_State_Wrapper<Wonton::Flat_Mesh_Wrapper<>> source_state_flat(source_mesh_flat);
+    source_state_flat.initialize(wrapper, {"d1"});
+
+    Portage::MPI_Bounding_Boxes distributor(&executor, type);
+    distributor.distribute(source_mesh_flat, source_state_flat, target_mesh_,
+                           target_state_);
+
+    int const num_owned_cells = source_mesh_flat.num_owned_cells();
+    num_cells[type] = num_owned_cells + source_mesh_flat.num_ghost_cells();
+
+    std::vector<Wonton::GID_t>& cell_gids = source_mesh_flat.get_global_cell_ids();
+    double* ddata = nullptr;
+    source_state_flat.mesh_get_data(Portage::Entity_kind::CELL, "d1", &ddata);
+
+    // bounding boxes of the owned source cells
+    std::vector<Wonton::Point<2>> lo(num_owned_cells), hi(num_owned_cells);
+    for (int c = 0; c < num_owned_cells; ++c) {
+      std::vector<Wonton::Point<2>> coords;
+      source_mesh_flat.cell_get_coordinates(c, &coords);
+      lo[c] = hi[c] = coords[0];
+      for (auto const& p : coords)
+        for (int k = 0; k < 2; ++k) {
+          lo[c][k] = std::min(lo[c][k], p[k]);
+          hi[c][k] = std::max(hi[c][k], p[k]);
+        }
+      ASSERT_EQ(double(cell_gids[c]) + 10., ddata[c]);
+    }
+
+    // the owned source cells overlapping each target cell cover it, and
+    // they have all their neighbors
+    for (int t = 0; t < target_mesh_.num_owned_cells(); ++t) {
+      std::vector<Wonton::Point<2>> coords;
+      target_mesh_.cell_get_coordinates(t, &coords);
+      Wonton::Point<2> tlo = coords[0], thi = coords[0];
+      for (auto const& p : coords)
+        for (int k = 0; k < 2; ++k) {
+          tlo[k] = std::min(tlo[k], p[k]);
+          thi[k] = std::max(thi[k], p[k]);
+        }
+
+      double area = 0.;
+      for (int c = 0; c < num_owned_cells; ++c) {
+        double dx = std::min(hi[c][0], thi[0]) - std::max(lo[c][0], tlo[0]);
+        double dy = std::min(hi[c][1], thi[1]) - std::max(lo[c][1], tlo[1]);
+        if (dx <= 1.e-12 || dy <= 1.e-12) continue;
+        area += dx * dy;
+
+        int ix = static_cast<int>(std::round(lo[c][0] * 8));
+        int iy = static_cast<int>(std::round(lo[c][1] * 8));
+        int expected = (std::min(ix + 1, 7) - std::max(ix - 1, 0) + 1) *
+                       (std::min(iy + 1, 7) - std::max(iy - 1, 0) + 1) - 1;
+        std::vector<int> neighbors;
+        source_mesh_flat.cell_get_node_adj_cells(c, Portage::Entity_type::ALL,
+                                                 &neighbors);
+        ASSERT_EQ(unsigned(expected), neighbors.size());
+      }
+      ASSERT_NEAR(0.04, area, 1.e-12);
+    }
+  }
+
+  // no more cells than with whole partitions
+  ASSERT_LE(num_cells[Portage::CELL_BOUNDING_BOX],
+            num_cells[Portage::PARTITION_BOUNDING_BOX]);
+}
+
+
+// Average of the nodes of a 2D cell
+template <class Mesh>
+Wonton::Point<2> cell_centroid(Mesh const& mesh, int c) {
+  std::vector<Wonton::Point<2>> coords;
+  mesh.cell_get_coordinates(c, &coords);
+  Wonton::Point<2> p(0., 0.);
+  for (auto const& q : coords)
+    for (int k = 0; k < 2; ++k) p[k] += q[k] / coords.size();
+  return p;
+}
+
+
+TEST(MPI_Bounding_Boxes, CellGranularMultiMat2D) {
+
+  Jali::MeshFactory mf(MPI_COMM_WORLD);
+
+  // Source mesh
+  std::shared_ptr<Jali::Mesh> source_mesh = mf(0.0, 0.0, 1.0, 1.0, 8, 8);
+  Wonton::Jali_Mesh_Wrapper inputMeshWrapper(*source_mesh);
+
+  // Target mesh
+  std::shared_ptr<Jali::Mesh> target_mesh = mf(0.0, 0.0, 1.0, 1.0, 5, 5);
+  Wonton::Jali_Mesh_Wrapper target_mesh_(*target_mesh);
+  std::shared_ptr<Jali::State> target_state(Jali::State::create(target_mesh));
+  Wonton::Jali_State_Wrapper target_state_(*target_state);
+
+  // Three overlapping materials: a left band, a right band and a top band.
+  // Some cells have one material, others two or three, and some ranks do
+  // not have all of them.
+  int const nmats = 3;
+  auto in_material = [](int m, Wonton::Point<2> const& p) {
+    switch (m) {
+      case 0: return p[0] < 0.5;
+      case 1: return p[0] > 0.375;
+      default: return p[1] > 0.75;
+    }
+  };
+  int const nsrccells = inputMeshWrapper.num_entities(Wonton::Entity_kind::CELL,
+                                                      Wonton::Entity_type::ALL);
+  std::vector<std::vector<int>> matcells(nmats);
+  std::vector<std::vector<double>> matvf(nmats), matrho(nmats);
+  for (int c = 0; c < nsrccells; ++c) {
+    Wonton::Point<2> p = cell_centroid(inputMeshWrapper, c);
+    int num_cell_mats = 0;
+    for (int m = 0; m < nmats; ++m)
+      if (in_material(m, p)) num_cell_mats++;
+    double const gid = inputMeshWrapper.get_global_id(c, Wonton::Entity_kind::CELL);
+    for (int m = 0; m < nmats; ++m)
+      if (in_material(m, p)) {
+        matcells[m].push_back(c);
+        matvf[m].push_back(1. / num_cell_mats);
+        matrho[m].push_back(gid + 100. * m);
+      }
+  }
+
+  Wonton::MPIExecutor_type executor(MPI_COMM_WORLD);
+
+  // distribute the same material data with whole partitions and cell by cell
+  int num_mat_cells[2];
+  for (auto type : {Portage::PARTITION_BOUNDING_BOX, Portage::CELL_BOUNDING_BOX}) {
+
+    std::shared_ptr<Jali::State> state(Jali::State::create(source_mesh));
+    Wonton::Jali_State_Wrapper wrapper(*state);
+    std::vector<std::string> matnames = {"mat0", "mat1", "mat2"};
+    for (int m = 0; m < nmats; ++m)
+      wrapper.add_material(matnames[m], matcells[m]);
+    for (int m = 0; m < nmats; ++m) {
+      wrapper.mat_add_celldata("mat_volfracs", m, matvf[m].data());
+      wrapper.mat_add_celldata("density", m, matrho[m].data());
+    }
+
+    Wonton::Flat_Mesh_Wrapper<> source_mesh_flat;
+    source_mesh_flat.initialize(inputMeshWrapper);
+    Wonton::Flat_State_Wrapper<Wonton::Flat_Mesh_Wrapper<>> source_state_flat(source_mesh_flat);
+    source_state_flat.initialize(wrapper, {"density"});
+
+    Portage::MPI_Bounding_Boxes distributor(&executor, type);
+    distributor.distribute(source_mesh_flat, source_state_flat, target_mesh_,
+                           target_state_);
+
+    int const num_cells = source_mesh_flat.num_owned_cells() +
+                          source_mesh_flat.num_ghost_cells();
+    std::vector<Wonton::GID_t>& cell_gids = source_mesh_flat.get_global_cell_ids();
+    ASSERT_EQ(nmats, source_state_flat.num_materials());
+
+    // every cell received is in the materials of its centroid, with the
+    // densities it had on its source rank
+    std::vector<int> num_cell_mats(num_cells, 0);
+    num_mat_cells[type] = 0;
+    for (int m = 0; m < nmats; ++m) {
+      std::vector<int> cells;
+      source_state_flat.mat_get_cells(m, &cells);
+      double const* rho = nullptr;
+      source_state_flat.mat_get_celldata("density", m, &rho);
+
+      int const ncells = cells.size();
+      for (int i = 0; i < ncells; ++i) {
+        int const c = cells[i];
+        ASSERT_TRUE(in_material(m, cell_centroid(source_mesh_flat, c)));
+        ASSERT_DOUBLE_EQ(double(cell_gids[c]) + 100. * m, rho[i]);
+        num_cell_mats[c]++;
+      }
+      num_mat_cells[type] += ncells;
+    }
+
+    for (int c = 0; c < num_cells; ++c) {
+      Wonton::Point<2> p = cell_centroid(source_mesh_flat, c);
+      int expected = 0;
+      for (int m = 0; m < nmats; ++m)
+        if (in_material(m, p)) expected++;
+      ASSERT_EQ(expected, num_cell_mats[c]);
+    }
+
+    // and the volume fractions of its number of materials
+    for (int m = 0; m < nmats; ++m) {
+      std::vector<int> cells;
+      source_state_flat.mat_get_cells(m, &cells);
+      double const* vf = nullptr;
+      source_state_flat.mat_get_celldata("mat_volfracs", m, &vf);
+      for (unsigned i = 0; i < cells.size(); ++i)
+        ASSERT_DOUBLE_EQ(1. / num_cell_mats[cells[i]], vf[i]);
+    }
+  }
+
+  // no more material cells than with whole partitions
+  ASSERT_LE(num_mat_cells[Portage::CELL_BOUNDING_BOX],
+            num_mat_cells[Portage::PARTITION_BOUNDING_BOX]);
+}
+
+
+TEST(MPI_Bounding_Boxes, SplitMessages3D) {
+
+  Jali::MeshFactory mf(MPI_COMM_WORLD);
+
+  std::shared_ptr<Jali::Mesh> source_mesh = mf(0.0, 0.0, 0.0, 1.0, 1.0, 1.0,
+                                               4, 4, 4);
+  Wonton::Jali_Mesh_Wrapper inputMeshWrapper(*source_mesh);
+
+  std::shared_ptr<Jali::Mesh> target_mesh = mf(0.0, 0.0, 0.0, 1.0, 1.0, 1.0,
+                                               3, 3, 3);
+  Wonton::Jali_Mesh_Wrapper target_mesh_(*target_mesh);
+  std::shared_ptr<Jali::State> target_state(Jali::State::create(target_mesh));
+  Wonton::Jali_State_Wrapper target_state_(*target_state);
+
+  Wonton::MPIExecutor_type executor(MPI_COMM_WORLD);
+
+  // the exchange split into small messages gives the same flat mesh and
+  // state as the collective one, with both redistribution types
+  for (auto type : {Portage::PARTITION_BOUNDING_BOX, Portage::CELL_BOUNDING_BOX}) {
+
+    Wonton::Flat_Mesh_Wrapper<> mesh_flat[2];
+    std::unique_ptr<Wonton::Flat_State_Wrapper<Wonton::Flat_Mesh_Wrapper<>>> state_flat[2];
+    std::shared_ptr<Jali::State> state(Jali::State::create(source_mesh));
+
+    for (int mode = 0; mode < 2; ++mode) {
+      mesh_flat[mode].initialize(inputMeshWrapper);
+
+      std::vector<Wonton::GID_t>& gids = mesh_flat[mode].get_global_cell_ids();
+      std::vector<double> dtest(gids.size());
+      for (unsigned i = 0; i < gids.size(); ++i) dtest[i] = double(gids[i]) + 10.;
+      if (mode == 0)
+        state->add("d1", source_mesh, Jali::Entity_kind::CELL,
+                   Jali::Entity_type::ALL, dtest.data());
+
+      Wonton::Jali_State_Wrapper wrapper(*state);
+      state_flat[mode].reset(
+          new Wonton::Flat_State_Wrapper<Wonton::Flat_Mesh_Wrapper<>>(mesh_flat[mode]));
+      state_flat[mode]->initialize(wrapper, {"d1"});
+
+      Portage::MPI_Bounding_Boxes distributor(&executor, type);
+      if (mode == 1)
+        distributor.set_max_message_size(64);
+      distributor.distribute(mesh_flat[mode], *state_flat[mode], target_mesh_,
+                             target_state_);
+    }
+
+    ASSERT_EQ(mesh_flat[0].num_owned_cells(), mesh_flat[1].num_owned_cells());
+    ASSERT_EQ(mesh_flat[0].num_ghost_cells(), mesh_flat[1].num_ghost_cells());
+    ASSERT_EQ(mesh_flat[0].num_owned_faces(), mesh_flat[1].num_owned_faces());
+    ASSERT_EQ(mesh_flat[0].num_owned_nodes(), mesh_flat[1].num_owned_nodes());
+    ASSERT_EQ(mesh_flat[0].get_global_cell_ids(), mesh_flat[1].get_global_cell_ids());
+    ASSERT_EQ(mesh_flat[0].get_global_face_ids(), mesh_flat[1].get_global_face_ids());
+    ASSERT_EQ(mesh_flat[0].get_global_node_ids(), mesh_flat[1].get_global_node_ids());
+    ASSERT_EQ(mesh_flat[0].get_coords(), mesh_flat[1].get_coords());
+    ASSERT_EQ(mesh_flat[0].get_cell_to_face_list(), mesh_flat[1].get_cell_to_face_list());
+    ASSERT_EQ(mesh_flat[0].get_face_to_node_list(), mesh_flat[1].get_face_to_node_list());
+
+    double* d0 = nullptr;
+    double* d1 = nullptr;
+    state_flat[0]->mesh_get_data(Portage::Entity_kind::CELL, "d1", &d0);
+    state_flat[1]->mesh_get_data(Portage::Entity_kind::CELL, "d1", &d1);
+    int const num_cells = mesh_flat[0].num_owned_cells() + mesh_flat[0].num_ghost_cells();
+    for (int c = 0; c < num_cells; ++c)
+      ASSERT_EQ(d0[c], d1[c]);
+  }
+}
+
+
+// Distribute a source mesh with a cell field once with a new distributor
+// and once with the incremental one, check that both give the same flat
+// mesh and state, and return the bytes sent by the incremental one and
+// the coordinates it distributed
+
+void check_incremental(std::shared_ptr<Jali::Mesh> source_mesh,
+                       Wonton::Jali_Mesh_Wrapper& target_mesh,
+                       Wonton::Jali_State_Wrapper& target_state,
+                       Portage::MPI_Bounding_Boxes& incremental,
+                       double offset, long* bytes,
+                       std::vector<double>* coords) {
+
+  Wonton::MPIExecutor_type executor(MPI_COMM_WORLD);
+  Wonton::Jali_Mesh_Wrapper inputMeshWrapper(*source_mesh);
+
+  Wonton::Flat_Mesh_Wrapper<> mesh_flat[2];
+  std::unique_ptr<Wonton::Flat_State_Wrapper<Wonton::Flat_Mesh_Wrapper<>>> state_flat[2];
+  std::shared_ptr<Jali::State> state(Jali::State::create(source_mesh));
+  long const bytes_before = incremental.bytes_sent();
+
+  for (int k = 0; k < 2; ++k) {
+    mesh_flat[k].initialize(inputMeshWrapper);
+
+    std::vector<Wonton::GID_t>& gids = mesh_flat[k].get_global_cell_ids();
+    std::vector<double> dtest(gids.size());
+    for (unsigned i = 0; i < gids.size(); ++i)
+      dtest[i] = double(gids[i]) + offset;
+    if (k == 0)
+      state->add("d1", source_mesh, Jali::Entity_kind::CELL,
+                 Jali::Entity_type::ALL, dtest.data());
+
+    Wonton::Jali_State_Wrapper wrapper(*state);
+    state_flat[k].reset(
+        new Wonton::Flat_State_Wrapper<Wonton::Flat_Mesh_Wrapper<>>(mesh_flat[k]));
+    state_flat[k]->initialize(wrapper, {"d1"});
+
+    if (k == 0) {
+      Portage::MPI_Bounding_Boxes full(&executor);
+      full.distribute(mesh_flat[k], *state_flat[k], target_mesh, target_state);
+    } else {
+      incremental.distribute(mesh_flat[k], *state_flat[k], target_mesh,
+                             target_state);
+    }
+  }
+
+  ASSERT_EQ(mesh_flat[0].num_owned_cells(), mesh_flat[1].num_owned_cells());
+  ASSERT_EQ(mesh_flat[0].num_ghost_cells(), mesh_flat[1].num_ghost_cells());
+  ASSERT_EQ(mesh_flat[0].num_owned_faces(), mesh_flat[1].num_owned_faces());
+  ASSERT_EQ(mesh_flat[0].num_owned_nodes(), mesh_flat[1].num_owned_nodes());
+  ASSERT_EQ(mesh_flat[0].get_global_cell_ids(), mesh_flat[1].get_global_cell_ids());
+  ASSERT_EQ(mesh_flat[0].get_global_face_ids(), mesh_flat[1].get_global_face_ids());
+  ASSERT_EQ(mesh_flat[0].get_global_node_ids(), mesh_flat[1].get_global_node_ids());
+  ASSERT_EQ(mesh_flat[0].get_coords(), mesh_flat[1].get_coords());
+  ASSERT_EQ(mesh_flat[0].get_cell_to_face_list(), mesh_flat[1].get_cell_to_face_list());
+  ASSERT_EQ(mesh_flat[0].get_face_to_node_list(), mesh_flat[1].get_face_to_node_list());
+
+  double* d0 = nullptr;
+  double* d1 = nullptr;
+  state_flat[0]->mesh_get_data(Portage::Entity_kind::CELL, "d1", &d0);
+  state_flat[1]->mesh_get_data(Portage::Entity_kind::CELL, "d1", &d1);
+  int const num_cells = mesh_flat[0].num_owned_cells() + mesh_flat[0].num_ghost_cells();
+  for (int c = 0; c < num_cells; ++c)
+    ASSERT_EQ(d0[c], d1[c]);
+
+  // the volumes follow the distributed coordinates
+  for (int c = 0; c < num_cells; ++c)
+    ASSERT_DOUBLE_EQ(mesh_flat[0].cell_volume(c), mesh_flat[1].cell_volume(c));
+
+  *bytes = incremental.bytes_sent() - bytes_before;
+  *coords = mesh_flat[1].get_coords();
+}
+
+
+TEST(MPI_Bounding_Boxes, Incremental3D) {
+
+  Jali::MeshFactory mf(MPI_COMM_WORLD);
+
+  std::shared_ptr<Jali::Mesh> source_mesh = mf(0.0, 0.0, 0.0, 1.0, 1.0, 1.0,
+                                               4, 4, 4);
+
+  std::shared_ptr<Jali::Mesh> target_mesh = mf(0.0, 0.0, 0.0, 1.0, 1.0, 1.0,
+                                               3, 3, 3);
+  Wonton::Jali_Mesh_Wrapper target_mesh_(*target_mesh);
+  std::shared_ptr<Jali::State> target_state(Jali::State::create(target_mesh));
+  Wonton::Jali_State_Wrapper target_state_(*target_state);
+
+  Wonton::MPIExecutor_type executor(MPI_COMM_WORLD);
+
+  // the incremental distributor only exchanges coordinates and fields after
+  // the first cycle, and gives the same flat mesh and state as a full
+  // distribution every cycle
+  Portage::MPI_Bounding_Boxes incremental(&executor);
+  incremental.set_incremental(true);
+  long first_cycle_bytes = 0;
+
+  for (int cycle = 0; cycle < 3; ++cycle) {
+    long cycle_bytes = 0;
+    std::vector<double> coords;
+    check_incremental(source_mesh, target_mesh_, target_state_, incremental,
+                      10. + 100. * cycle, &cycle_bytes, &coords);
+    if (HasFatalFailure())
+      return;
+
+    // the topology is not sent again after the first cycle
+    if (cycle == 0)
+      first_cycle_bytes = cycle_bytes;
+    else if (first_cycle_bytes > 0)
+      ASSERT_LT(cycle_bytes, first_cycle_bytes);
+  }
+}
+
+
+// The source mesh moves between cycles without changing its connectivity
+// or partitioning: after the first cycle only the new coordinates and the
+// fields are exchanged, and they are the ones a full distribution gives
+
+TEST(MPI_Bounding_Boxes, IncrementalMovingNodes3D) {
+
+  Jali::MeshFactory mf(MPI_COMM_WORLD);
+
+  std::shared_ptr<Jali::Mesh> source_mesh = mf(0.0, 0.0, 0.0, 1.0, 1.0, 1.0,
+                                               4, 4, 4);
+  std::shared_ptr<Jali::Mesh> target_mesh = mf(0.0, 0.0, 0.0, 1.0, 1.0, 1.0,
+                                               3, 3, 3);
+  Wonton::Jali_Mesh_Wrapper target_mesh_(*target_mesh);
+  std::shared_ptr<Jali::State> target_state(Jali::State::create(target_mesh));
+  Wonton::Jali_State_Wrapper target_state_(*target_state);
+
+  // initial node coordinates
+  int const num_nodes = source_mesh->num_entities(Jali::Entity_kind::NODE,
+                                                  Jali::Entity_type::ALL);
+  std::vector<std::array<double, 3>> initial(num_nodes);
+  for (int n = 0; n < num_nodes; ++n)
+    source_mesh->node_get_coordinates(n, &initial[n]);
+
+  Wonton::MPIExecutor_type executor(MPI_COMM_WORLD);
+  Portage::MPI_Bounding_Boxes incremental(&executor);
+  incremental.set_incremental(true);
+
+  long first_cycle_bytes = 0;
+  std::vector<double> previous_coords;
+
+  for (int cycle = 0; cycle < 3; ++cycle) {
+
+    // move the interior nodes, by less than the distance between the
+    // source and target partition boundaries so that the same source
+    // cells are sent to each rank
+    for (int n = 0; n < num_nodes; ++n) {
+      std::array<double, 3> p = initial[n];
+      bool interior = true;
+      for (int d = 0; d < 3; ++d)
+        interior &= (p[d] > 1.e-12 && p[d] < 1. - 1.e-12);
+      if (!interior)
+        continue;
+      for (int d = 0; d < 3; ++d)
+        p[d] += 0.02 * cycle * std::sin(2 * M_PI * (initial[n][0] + initial[n][1]) + d);
+      source_mesh->node_set_coordinates(n, p.data());
+    }
+
+    long cycle_bytes = 0;
+    std::vector<double> coords;
+    check_incremental(source_mesh, target_mesh_, target_state_, incremental,
+                      10. + 100. * cycle, &cycle_bytes, &coords);
+    if (HasFatalFailure())
+      return;
+
+    if (cycle == 0)
+      first_cycle_bytes = cycle_bytes;
+    else {
+      // the coordinates received are the new ones
+      if (!coords.empty())
+        ASSERT_NE(previous_coords, coords);
+      // without the topology
+      if (first_cycle_bytes > 0)
+        ASSERT_LT(cycle_bytes, first_cycle_bytes);
+    }
+    previous_coords = coords;
+  }
+}
+
+
+// The source mesh changes between cycles: the incremental distributor
+// falls back to a full distribution, then exchanges coordinates and fields
+// only once the mesh stays the same
+
+TEST(MPI_Bounding_Boxes, IncrementalTopologyChange3D) {
+
+  Jali::MeshFactory mf(MPI_COMM_WORLD);
+
+  std::shared_ptr<Jali::Mesh> source_meshes[3] = {
+    mf(0.0, 0.0, 0.0, 1.0, 1.0, 1.0, 4, 4, 4),
+    mf(0.0, 0.0, 0.0, 1.0, 1.0, 1.0, 5, 4, 4),
+    nullptr
+  };
+  source_meshes[2] = source_meshes[1];
+
+  std::shared_ptr<Jali::Mesh> target_mesh = mf(0.0, 0.0, 0.0, 1.0, 1.0, 1.0,
+                                               3, 3, 3);
+  Wonton::Jali_Mesh_Wrapper target_mesh_(*target_mesh);
+  std::shared_ptr<Jali::State> target_state(Jali::State::create(target_mesh));
+  Wonton::Jali_State_Wrapper target_state_(*target_state);
+
+  Wonton::MPIExecutor_type executor(MPI_COMM_WORLD);
+  Portage::MPI_Bounding_Boxes incremental(&executor);
+  incremental.set_incremental(true);
+
+  long bytes[3] = {0, 0, 0};
+  for (int cycle = 0; cycle < 3; ++cycle) {
+    std::vector<double> coords;
+    check_incremental(source_meshes[cycle], target_mesh_, target_state_,
+                      incremental, 10. + 100. * cycle, &bytes[cycle], &coords);
+    if (HasFatalFailure())
+      return;
+  }
+
+  // the new mesh is sent with its topology, then without it
+  if (bytes[2] > 0)
+    ASSERT_GT(bytes[1], bytes[2]);
+}
@@ -17,6 +17,7 @@
 #include <type_traits>
 #include <memory>
 #include <limits>
+#include <atomic>
 
 
 #ifdef HAVE_TANGRAM
@@ -24,8 +25,12 @@
 #endif
 
 #include "portage/intersect/dummy_interface_reconstructor.h"
+#include "portage/intersect/material_moments.h"
+#include "portage/intersect/intersection_cache.h"
 #include "portage/interpolate/gradient.h"
 #include "portage/support/portage.h"
+#include "portage/support/weights_csr.h"
+#include "portage/support/timer.h"
 #include "wonton/support/Point.h"
 #include "wonton/support/CoordinateSystem.h"
 #include "portage/driver/parts.h"
@@ -161,6 +166,31 @@ class CoreDriverBase {
     auto derived_class_ptr = static_cast<CoreDriverType<ONWHAT> *>(this);
     return derived_class_ptr->template intersect_meshes<Intersect>(intersection_candidates);
   }
+
+  /*! @brief intersect target entities with candidate source entities
+    and store the moments in compressed form
+
+    @tparam Entity_kind  what kind of entity are we searching on/for
+
+    @tparam Intersect    intersect functor
+
+    @param[in] intersection_candidates  vector of intersection candidates for each target entity
+
+    @returns  intersection moments of all target entities
+  */
+
+  template<
+    Entity_kind ONWHAT,
+    template <Entity_kind, class, class, class,
+              template <class, int, class, class> class,
+              class, class> class Intersect
+    >
+  WeightsCSR
+  intersect_meshes_csr(Portage::vector<std::vector<int>> const& intersection_candidates) {
+    assert(ONWHAT == onwhat());
+    auto derived_class_ptr = static_cast<CoreDriverType<ONWHAT> *>(this);
+    return derived_class_ptr->template intersect_meshes_csr<Intersect>(intersection_candidates);
+  }
     
 
 
@@ -212,6 +242,28 @@ class CoreDriverBase {
                                                material_id, source_part);
   }
 
+  /**
+   * @brief Compute the gradient fields of several mesh variables on the
+   * source mesh, collecting the neighbors of each entity only once.
+   *
+   * @tparam ONWHAT: entity kind (cell or node).
+   * @param field_names: the variable names.
+   * @param limiter_types: gradient limiter of each variable on internal regions.
+   * @param boundary_limiter_types: gradient limiter of each variable on boundary.
+   */
+  template<Entity_kind ONWHAT>
+  std::vector<Portage::vector<Vector<D>>> compute_source_gradients(
+    std::vector<std::string> const& field_names,
+    std::vector<Limiter_type> const& limiter_types,
+    std::vector<Boundary_Limiter_type> const& boundary_limiter_types) {
+
+    assert(ONWHAT == onwhat());
+    auto derived_class_ptr = static_cast<CoreDriverType<ONWHAT> *>(this);
+    return derived_class_ptr->compute_source_gradients(field_names,
+                                                       limiter_types,
+                                                       boundary_limiter_types);
+  }
+
   /*!
 
     Interpolate a mesh variable of type T residing on entity kind
@@ -234,10 +286,11 @@ class CoreDriverBase {
            Entity_kind ONWHAT,
            template<int, Entity_kind, class, class, class, class, class,
                     template <class, int, class, class> class,
-                    class, class, class> class Interpolate
+                    class, class, class> class Interpolate,
+           class SourceWeights
            >
   void interpolate_mesh_var(std::string srcvarname, std::string trgvarname,
-                            Portage::vector<std::vector<Weights_t>> const& sources_and_weights,
+                            SourceWeights const& sources_and_weights,
                             Portage::vector<Vector<D>>* gradients = nullptr) {
     assert(ONWHAT == onwhat());
     auto derived_class_ptr = static_cast<CoreDriverType<ONWHAT> *>(this);
@@ -247,6 +300,85 @@ class CoreDriverBase {
                                                       gradients);
   }
 
+  /*!
+    Interpolate several mesh variables of type T residing on entity
+    kind ONWHAT in a single traversal of previously computed
+    intersection weights
+
+    @tparam T   type of variables
+
+    @tparam ONWHAT  Entity_kind that fields reside on
+
+    @tparam Interpolate  Functor for doing the interpolate from mesh to mesh
+
+    @param[in] srcvarnames   Variable names on source mesh
+
+    @param[in] trgvarnames   Variable names on target mesh
+
+    @param[in] gradients     Gradients of each variable on source mesh (can be nullptr for 1st order remap)
+  */
+
+  template<typename T = double,
+           Entity_kind ONWHAT,
+           template<int, Entity_kind, class, class, class, class, class,
+                    template <class, int, class, class> class,
+                    class, class, class> class Interpolate,
+           class SourceWeights
+           >
+  void interpolate_mesh_vars(std::vector<std::string> const& srcvarnames,
+                             std::vector<std::string> const& trgvarnames,
+                             SourceWeights const& sources_and_weights,
+                             std::vector<Portage::vector<Vector<D>>>* gradients = nullptr) {
+    assert(ONWHAT == onwhat());
+    auto derived_class_ptr = static_cast<CoreDriverType<ONWHAT> *>(this);
+    derived_class_ptr->
+        template interpolate_mesh_vars<T, Interpolate>(srcvarnames, trgvarnames,
+                                                       sources_and_weights,
+                                                       gradients);
+  }
+
+  /**
+   * @brief Search, intersect and interpolate several mesh variables
+   * tile by tile, keeping the memory of intermediate structures bounded
+   * by the tile size.
+   *
+   * @tparam ONWHAT: entity kind (cell or node).
+   * @tparam Search: search functor.
+   * @tparam Intersect: intersect functor.
+   * @tparam T: type of the variables.
+   * @tparam Interpolate: interpolate functor.
+   * @param srcvarnames: source mesh variables to remap.
+   * @param trgvarnames: target mesh variables to remap.
+   * @param gradients: gradients of each variable on source mesh (can be nullptr for 1st order remap).
+   * @param tile_size: number of target entities processed at a time (0 for the one set with set_tile_size).
+   * @param retain_weights: keep the moments of all tiles.
+   * @param xsect_volumes: if not null, filled with the intersection volume of each target entity.
+   * @return the moments of all target entities if retained, empty weights otherwise.
+   */
+  template<Entity_kind ONWHAT,
+           template<int, Entity_kind, class, class> class Search,
+           template <Entity_kind, class, class, class,
+                     template <class, int, class, class> class,
+                     class, class> class Intersect,
+           typename T,
+           template<int, Entity_kind, class, class, class, class, class,
+                    template <class, int, class, class> class,
+                    class, class, class> class Interpolate
+           >
+  WeightsCSR remap_mesh_vars_tiled(std::vector<std::string> const& srcvarnames,
+                                   std::vector<std::string> const& trgvarnames,
+                                   std::vector<Portage::vector<Vector<D>>>* gradients = nullptr,
+                                   int tile_size = 0,
+                                   bool retain_weights = false,
+                                   std::vector<double>* xsect_volumes = nullptr) {
+    assert(ONWHAT == onwhat());
+    auto derived_class_ptr = static_cast<CoreDriverType<ONWHAT> *>(this);
+    return derived_class_ptr->
+        template remap_mesh_vars_tiled<Search, Intersect, T, Interpolate>(
+            srcvarnames, trgvarnames, gradients, tile_size, retain_weights,
+            xsect_volumes);
+  }
+
   /*!
 
     (Part-by-part) Interpolate a cell variable of type T residing on
@@ -273,10 +405,11 @@ class CoreDriverBase {
            Entity_kind ONWHAT,
            template<int, Entity_kind, class, class, class, class, class,
                     template <class, int, class, class> class,
-                    class, class, class> class Interpolate>
+                    class, class, class> class Interpolate,
+           class SourceWeights>
   typename std::enable_if<ONWHAT == CELL, void>
   interpolate_mesh_var(std::string srcvarname, std::string trgvarname,
-                            Portage::vector<std::vector<Weights_t>> const& sources_and_weights,
+                            SourceWeights const& sources_and_weights,
                             const PartPair<D, SourceMesh, SourceState,
                             TargetMesh, TargetState>* parts_pair,
                             Portage::vector<Vector<D>>* gradients = nullptr) {
@@ -323,19 +456,39 @@ class CoreDriverBase {
 
     @tparam Entity_kind  What kind of entity are we performing intersection of
 
-    @param[in] sources_weights  Intersection sources and moments (vols, centroids) 
+    @param[in] sources_weights  Intersection sources and moments (vols, centroids)
+                                either one list per target entity or compressed
     @returns   Whether the meshes are mismatched
   */
 
-  template<Entity_kind ONWHAT>
+  template<Entity_kind ONWHAT, class SourceWeights>
   bool 
-  check_mismatch(Portage::vector<std::vector<Weights_t>> const& source_weights) {
+  check_mismatch(SourceWeights const& source_weights) {
     assert(ONWHAT == onwhat());
     auto derived_class_ptr = static_cast<CoreDriverType<ONWHAT> *>(this);
     return derived_class_ptr->check_mismatch(source_weights);
   }
 
 
+  /*!
+    @brief Check if meshes are mismatched given only the intersection
+    volume of each target entity (see remap_mesh_vars_tiled)
+
+    @tparam Entity_kind  What kind of entity are we performing intersection of
+
+    @param[in] xsect_volumes  Intersection volume of each owned target entity
+    @returns   Whether the meshes are mismatched
+  */
+
+  template<Entity_kind ONWHAT>
+  bool
+  check_mismatch_volumes(std::vector<double> const& xsect_volumes) {
+    assert(ONWHAT == onwhat());
+    auto derived_class_ptr = static_cast<CoreDriverType<ONWHAT> *>(this);
+    return derived_class_ptr->check_mismatch_volumes(xsect_volumes);
+  }
+
+
   /*!
     @brief Return if meshes are mismatched (check_mismatch must already have been
     called)
@@ -419,6 +572,38 @@ class CoreDriverBase {
     derived_class_ptr->set_num_tols(num_tols);
   }
 
+  /*!
+    @brief Accumulate phase timings and counts into a profiler
+
+    @tparam Entity_kind  what kind of entity are we setting for
+
+    @param profiler      profiler to fill in (nullptr to stop profiling)
+  */
+
+  template<Entity_kind ONWHAT>
+  void
+  set_profiler(Profiler* profiler) {
+    assert(ONWHAT == onwhat());
+    auto derived_class_ptr = static_cast<CoreDriverType<ONWHAT> *>(this);
+    derived_class_ptr->set_profiler(profiler);
+  }
+
+  /*!
+    @brief Share the per-cell data of the intersectors across intersections
+
+    @tparam Entity_kind  what kind of entity are we setting for
+
+    @param cache         cache for the meshes of this driver (nullptr for none)
+  */
+
+  template<Entity_kind ONWHAT>
+  void
+  set_intersection_cache(std::shared_ptr<IntersectionCache<D>> cache) {
+    assert(ONWHAT == onwhat());
+    auto derived_class_ptr = static_cast<CoreDriverType<ONWHAT> *>(this);
+    derived_class_ptr->set_intersection_cache(cache);
+  }
+
 
 #ifdef HAVE_TANGRAM
   /*!
@@ -565,6 +750,8 @@ class CoreDriver : public CoreDriverBase<D,
   template<template<int, Entity_kind, class, class> class Search>
   Portage::vector<std::vector<int>>
   search() {
+    auto tic = timer::now();
+
     // Get an instance of the desired search algorithm type
     const Search<D, ONWHAT, SourceMesh, TargetMesh>
         search_functor(source_mesh_, target_mesh_);
@@ -578,6 +765,15 @@ class CoreDriver : public CoreDriverBase<D,
                        target_mesh_.end(ONWHAT, PARALLEL_OWNED),
                        candidates.begin(), search_functor);
 
+    if (profiler_) {
+      profiler_->time.search += timer::elapsed(tic);
+      profiler_->count.targets += ntarget_ents;
+      for (int t = 0; t < ntarget_ents; t++) {
+        std::vector<int> const& entity_candidates = candidates[t];
+        profiler_->count.candidates += entity_candidates.size();
+      }
+    }
+
     return candidates;
   }
 
@@ -598,21 +794,9 @@ class CoreDriver : public CoreDriverBase<D,
   Portage::vector<std::vector<Portage::Weights_t>>
   intersect_meshes(Portage::vector<std::vector<int>> const& candidates) {
 
-#ifdef HAVE_TANGRAM
-    // If user did NOT set tolerances for Tangram, use Portage tolerances
-    if (reconstructor_tols_.empty()) {
-      reconstructor_tols_ = { {1000, num_tols_.min_absolute_distance,
-                                     num_tols_.min_absolute_volume},
-                              {100, num_tols_.min_absolute_distance,
-                                    num_tols_.min_absolute_distance} };
-    }
-    // If user set tolerances for Tangram, but not for Portage,
-    // use Tangram tolerances
-    else if (!num_tols_.user_tolerances) {
-      num_tols_.min_absolute_distance = reconstructor_tols_[0].arg_eps;
-      num_tols_.min_absolute_volume = reconstructor_tols_[0].fun_eps;
-    }
-#endif
+    auto tic = timer::now();
+
+    prepare_intersection();
 
     int nents = target_mesh_.num_entities(ONWHAT, PARALLEL_OWNED);
     Portage::vector<std::vector<Portage::Weights_t>> sources_and_weights(nents);
@@ -620,12 +804,87 @@ class CoreDriver : public CoreDriverBase<D,
     Intersect<ONWHAT, SourceMesh, SourceState, TargetMesh,
               InterfaceReconstructorType, Matpoly_Splitter, Matpoly_Clipper>
         intersector(source_mesh_, source_state_, target_mesh_, num_tols_);
+    use_intersection_cache(intersector, 0);
+    prepare_intersector(intersector, target_mesh_.begin(ONWHAT, PARALLEL_OWNED),
+                        nents, candidates.begin(), 0);
 
     Portage::transform(target_mesh_.begin(ONWHAT, PARALLEL_OWNED),
                        target_mesh_.end(ONWHAT, PARALLEL_OWNED),
                        candidates.begin(),
                        sources_and_weights.begin(),
-                       intersector);
+                       count_thread_load(intersector));
+
+    if (profiler_) {
+      profiler_->time.intersect += timer::elapsed(tic);
+      flush_thread_load();
+      for (int t = 0; t < nents; t++) {
+        std::vector<Portage::Weights_t> const& entity_weights = sources_and_weights[t];
+        profiler_->count.intersections += entity_weights.size();
+      }
+    }
+
+    return sources_and_weights;
+  }
+
+
+  /*! 
+    Intersect source and target mesh entities of kind 'ONWHAT' and
+    return the intersecting entities and moments of intersection in
+    compressed form. Target entities are intersected in blocks whose
+    moments are compressed right away, so that the one-list-per-entity
+    layout never exists for the whole mesh. Intersectors with an
+    'intersect' method writing to flat arrays (IntersectR2D,
+    IntersectR3D) fill the compressed form directly; the lists of
+    Weights_t of the other ones are compressed block by block.
+
+    @param candidates Vector of intersection candidates for each target entity
+
+    @param block_size Number of target entities intersected at a time
+
+    @return intersection moments of all target entities
+  */
+
+  template<template <Entity_kind, class, class, class,
+                     template <class, int, class, class> class,
+                     class, class> class Intersect>
+  WeightsCSR
+  intersect_meshes_csr(Portage::vector<std::vector<int>> const& candidates,
+                       int block_size = 4096) {
+
+    auto tic = timer::now();
+
+    prepare_intersection();
+
+    int const nents = target_mesh_.num_entities(ONWHAT, PARALLEL_OWNED);
+
+    Intersect<ONWHAT, SourceMesh, SourceState, TargetMesh,
+              InterfaceReconstructorType, Matpoly_Splitter, Matpoly_Clipper>
+        intersector(source_mesh_, source_state_, target_mesh_, num_tols_);
+    use_intersection_cache(intersector, 0);
+
+    WeightsCSR sources_and_weights;
+    sources_and_weights.reserve(nents, 0);
+
+    IntersectionBlock block;
+
+    auto const first_entity = target_mesh_.begin(ONWHAT, PARALLEL_OWNED);
+    for (int first = 0; first < nents; first += block_size) {
+      int const last = std::min(first + block_size, nents);
+
+      prepare_intersector(intersector, first_entity + first, last - first,
+                          candidates.begin() + first, 0);
+      intersect_block(intersector, first_entity + first, last - first,
+                      candidates.begin() + first, &block,
+                      &sources_and_weights, 0);
+    }
+
+    sources_and_weights.shrink_to_fit();
+
+    if (profiler_) {
+      profiler_->time.intersect += timer::elapsed(tic);
+      flush_thread_load();
+      profiler_->count.intersections += sources_and_weights.num_entries();
+    }
 
     return sources_and_weights;
   }
@@ -644,6 +903,42 @@ class CoreDriver : public CoreDriverBase<D,
     num_tols_ = num_tols;
   }
 
+  /*!
+    @brief Precompute the least-squares gradient stencils of the source
+    cells in compute_source_gradients (see
+    Limited_Gradient::precompute_stencils), so that the gradients of all
+    the cell fields are computed with the same weights. Ignored for nodes.
+
+    @param precompute  whether to precompute the stencils
+  */
+  void set_gradient_stencils(bool precompute) {
+    precompute_gradient_stencils_ = precompute;
+  }
+
+  /*!
+    @brief Share the per-cell data that the intersectors derive from the
+    meshes (see IntersectionCache) across intersections, e.g. between the
+    mesh and material intersections, the cell and node remaps or
+    successive remaps between unchanged meshes. Without a cache, each
+    intersection starts from an empty one.
+
+    @param cache  cache for the meshes of this driver (nullptr for none)
+  */
+  void set_intersection_cache(std::shared_ptr<IntersectionCache<D>> cache) {
+    intersection_cache_ = cache;
+  }
+
+  /*!
+    @brief Set the number of target entities processed at a time by
+    remap_mesh_vars_tiled when it is not given a tile size
+
+    @param tile_size  number of target entities per tile
+  */
+  void set_tile_size(int tile_size) {
+    assert(tile_size > 0);
+    tile_size_ = tile_size;
+  }
+
 #ifdef HAVE_TANGRAM
   /*!
     @brief set options for interface reconstructor driver
@@ -693,50 +988,13 @@ class CoreDriver : public CoreDriverBase<D,
 #ifdef HAVE_TANGRAM
 
     int nmats = source_state_.num_materials();
-    // Make sure we have a valid interface reconstruction method instantiated
 
-    assert(typeid(InterfaceReconstructorType<SourceMesh, D,
-                  Matpoly_Splitter, Matpoly_Clipper >) !=
-           typeid(DummyInterfaceReconstructor<SourceMesh, D,
-                  Matpoly_Splitter, Matpoly_Clipper>));
+    reconstruct_interfaces();
 
-    // Intel 18.0.1 does not recognize std::make_unique even with -std=c++14 flag *ugh*
-    // interface_reconstructor_ =
-    //     std::make_unique<Tangram::Driver<InterfaceReconstructorType, D,
-    //                                      SourceMesh,
-    //                                      Matpoly_Splitter,
-    //                                      Matpoly_Clipper>
-    //                      >(source_mesh_, tols, true);
-    interface_reconstructor_ =
-        std::unique_ptr<Tangram::Driver<InterfaceReconstructorType, D,
-                                        SourceMesh,
-                                        Matpoly_Splitter,
-                                        Matpoly_Clipper>
-                        >(new Tangram::Driver<InterfaceReconstructorType, D,
-                          SourceMesh,
-                          Matpoly_Splitter,
-                          Matpoly_Clipper>(source_mesh_, reconstructor_tols_,
-                                           reconstructor_all_convex_));
+    auto tic = timer::now();
 
     int ntargetcells = target_mesh_.num_entities(CELL, PARALLEL_OWNED);
 
-
-    std::vector<int> cell_num_mats, cell_mat_ids;
-    std::vector<double> cell_mat_volfracs;
-    std::vector<Wonton::Point<D>> cell_mat_centroids;
-
-    // Extract volume fraction and centroid data for cells in compact
-    // cell-centric form (ccc)
-
-    ccc_vfcen_data(cell_num_mats, cell_mat_ids, cell_mat_volfracs,
-                   cell_mat_centroids);
-
-    interface_reconstructor_->set_volume_fractions(cell_num_mats,
-                                                   cell_mat_ids,
-                                                   cell_mat_volfracs,
-                                                   cell_mat_centroids);
-    interface_reconstructor_->reconstruct(executor_);
-
     // Make an intersector which knows about the source state (to be
     // able to query the number of materials, etc) and also knows
     // about the interface reconstructor so that it can retrieve pure
@@ -746,6 +1004,9 @@ class CoreDriver : public CoreDriverBase<D,
               InterfaceReconstructorType, Matpoly_Splitter, Matpoly_Clipper>
         intersector(source_mesh_, source_state_, target_mesh_, num_tols_,
                     interface_reconstructor_);
+    use_intersection_cache(intersector, 0);
+    prepare_intersector(intersector, target_mesh_.begin(CELL, PARALLEL_OWNED),
+                        ntargetcells, candidates.begin(), 0);
 
     // Assume (with no harm for sizing purposes) that all materials
     // in source made it into target
@@ -890,6 +1151,13 @@ class CoreDriver : public CoreDriverBase<D,
 
     }  // for each material m
 
+    if (profiler_) {
+      profiler_->time.intersect += timer::elapsed(tic);
+      for (auto const& mat_weights : source_weights_by_mat)
+        for (std::vector<Weights_t> const& cell_weights : mat_weights)
+          profiler_->count.intersections += cell_weights.size();
+    }
+
     return source_weights_by_mat;
 #else
     return std::vector<Portage::vector<std::vector<Weights_t>>>();
@@ -898,6 +1166,70 @@ class CoreDriver : public CoreDriverBase<D,
   }
 
 
+#ifdef HAVE_TANGRAM
+  /*!
+    @brief Reconstruct material interfaces in the source mesh from the
+    volume fractions and centroids of the source state. This is done
+    by intersect_materials but has to be invoked explicitly when
+    material intersection moments are reused from a previous remap,
+    since material gradients and interpolation need the material
+    polytopes.
+  */
+  void reconstruct_interfaces() {
+
+    auto tic = timer::now();
+
+    // Make sure we have a valid interface reconstruction method instantiated
+
+    assert(typeid(InterfaceReconstructorType<SourceMesh, D,
+                  Matpoly_Splitter, Matpoly_Clipper >) !=
+           typeid(DummyInterfaceReconstructor<SourceMesh, D,
+                  Matpoly_Splitter, Matpoly_Clipper>));
+
+    // Intel 18.0.1 does not recognize std::make_unique even with -std=c++14 flag *ugh*
+    // interface_reconstructor_ =
+    //     std::make_unique<Tangram::Driver<InterfaceReconstructorType, D,
+    //                                      SourceMesh,
+    //                                      Matpoly_Splitter,
+    //                                      Matpoly_Clipper>
+    //                      >(source_mesh_, tols, true);
+    interface_reconstructor_ =
+        std::unique_ptr<Tangram::Driver<InterfaceReconstructorType, D,
+                                        SourceMesh,
+                                        Matpoly_Splitter,
+                                        Matpoly_Clipper>
+                        >(new Tangram::Driver<InterfaceReconstructorType, D,
+                          SourceMesh,
+                          Matpoly_Splitter,
+                          Matpoly_Clipper>(source_mesh_, reconstructor_tols_,
+                                           reconstructor_all_convex_));
+
+    std::vector<int> cell_num_mats, cell_mat_ids;
+    std::vector<double> cell_mat_volfracs;
+    std::vector<Wonton::Point<D>> cell_mat_centroids;
+
+    // Extract volume fraction and centroid data for cells in compact
+    // cell-centric form (ccc)
+
+    ccc_vfcen_data(cell_num_mats, cell_mat_ids, cell_mat_volfracs,
+                   cell_mat_centroids);
+
+    interface_reconstructor_->set_volume_fractions(cell_num_mats,
+                                                   cell_mat_ids,
+                                                   cell_mat_volfracs,
+                                                   cell_mat_centroids);
+    interface_reconstructor_->reconstruct(executor_);
+
+    // material volumes and centroids used by the gradient and
+    // interpolation kernels
+    material_moments_.compute(source_mesh_, source_state_,
+                              *interface_reconstructor_);
+
+    if (profiler_)
+      profiler_->time.interface += timer::elapsed(tic);
+  }
+#endif
+
   /**
    * @brief Compute the gradient field of the given variable on source mesh.
    *
@@ -913,6 +1245,8 @@ class CoreDriver : public CoreDriverBase<D,
     int material_id = 0,
     const Part<SourceMesh, SourceState>* source_part = nullptr) const {
 
+    auto tic = timer::now();
+
     int nallent = 0;
 #ifdef HAVE_TANGRAM
     // enable part-by-part only for cell-based remap
@@ -953,6 +1287,8 @@ class CoreDriver : public CoreDriverBase<D,
     Gradient kernel(source_mesh_, source_state_, field_name,
                     limiter_type, boundary_limiter_type,
                     interface_reconstructor_, source_part);
+    if (multimat)
+      kernel.set_material_moments(&material_moments_);
 #else
     Gradient kernel(source_mesh_, source_state_, field_name,
                     limiter_type, boundary_limiter_type, source_part);
@@ -988,24 +1324,93 @@ class CoreDriver : public CoreDriverBase<D,
 #ifdef HAVE_TANGRAM
     }
 #endif
+
+    if (profiler_)
+      profiler_->time.gradient += timer::elapsed(tic);
+
     return gradient_field;
   }
 
+
+  /**
+   * @brief Compute the gradient fields of several mesh variables on the
+   * source mesh. A single gradient kernel is used for all variables so
+   * that the neighbors of each entity are collected only once.
+   *
+   * @param field_names: the variable names (mesh fields only).
+   * @param limiter_types: gradient limiter of each variable on internal regions.
+   * @param boundary_limiter_types: gradient limiter of each variable on boundary.
+   * @return the gradient field of each variable.
+   */
+  std::vector<Portage::vector<Vector<D>>> compute_source_gradients(
+    std::vector<std::string> const& field_names,
+    std::vector<Limiter_type> const& limiter_types,
+    std::vector<Boundary_Limiter_type> const& boundary_limiter_types) const {
+
+    int const nvars = field_names.size();
+    assert(limiter_types.size() == field_names.size());
+    assert(boundary_limiter_types.size() == field_names.size());
+
+    std::vector<Portage::vector<Vector<D>>> gradient_fields(nvars);
+    if (nvars == 0)
+      return gradient_fields;
+
+    auto tic = timer::now();
+
+#ifdef HAVE_TANGRAM
+    Gradient kernel(source_mesh_, source_state_, field_names[0],
+                    limiter_types[0], boundary_limiter_types[0],
+                    interface_reconstructor_);
+#else
+    Gradient kernel(source_mesh_, source_state_, field_names[0],
+                    limiter_types[0], boundary_limiter_types[0]);
+#endif
+
+    if (precompute_gradient_stencils_)
+      precompute_stencils(kernel);
+
+    // the kernel holds the neighbor lists: use it by reference
+    auto gradient = [&kernel](int entity) { return kernel(entity); };
+
+    int const nallent = source_mesh_.num_entities(ONWHAT, ALL);
+    Vector<D> zerovec;
+
+    for (int i = 0; i < nvars; i++) {
+      assert(source_state_.field_type(ONWHAT, field_names[i]) ==
+             Field_type::MESH_FIELD);
+
+      kernel.set_interpolation_variable(field_names[i], limiter_types[i],
+                                        boundary_limiter_types[i]);
+
+      gradient_fields[i].resize(nallent, zerovec);
+      Portage::transform(source_mesh_.begin(ONWHAT, PARALLEL_OWNED),
+                         source_mesh_.end(ONWHAT, PARALLEL_OWNED),
+                         gradient_fields[i].begin(), gradient);
+    }
+
+    if (profiler_)
+      profiler_->time.gradient += timer::elapsed(tic);
+
+    return gradient_fields;
+  }
+
   /**
    * @brief Interpolate mesh variable.
    *
    * @param[in] srcvarname          source mesh variable to remap
    * @param[in] trgvarname          target mesh variable to remap
    * @param[in] sources_and_weights weights for mesh-mesh interpolation
+   *                                (one list per target entity or compressed)
    * @param[in] gradients           gradients of variable on source mesh (can be nullptr for 1st order remap)
    */
   template<typename T = double,
            template<int, Entity_kind, class, class, class, class, class,
     template<class, int, class, class> class,
-    class, class, class> class Interpolate
+    class, class, class> class Interpolate,
+    class SourceWeights
   >
   void interpolate_mesh_var(std::string srcvarname, std::string trgvarname,
-                            Portage::vector<std::vector<Weights_t>> const& sources_and_weights,
+                            SourceWeights const& sources_and_weights,
                             Portage::vector<Vector<D>>* gradients = nullptr) {
 
     if (source_state_.get_entity(srcvarname) != ONWHAT) {
@@ -1022,6 +1427,8 @@ class CoreDriver : public CoreDriverBase<D,
                                      InterfaceReconstructorType,
                                      Matpoly_Splitter, Matpoly_Clipper, CoordSys>;
 
+    auto tic = timer::now();
+
     Interpolator interpolator(source_mesh_, target_mesh_, source_state_,
                               num_tols_);
     interpolator.set_interpolation_variable(srcvarname, gradients);
@@ -1034,8 +1441,197 @@ class CoreDriver : public CoreDriverBase<D,
     Portage::pointer<T> target_field(target_mesh_field);
     Portage::transform(target_mesh_.begin(ONWHAT, PARALLEL_OWNED),
                        target_mesh_.end(ONWHAT, PARALLEL_OWNED),
-                       sources_and_weights.begin(),
-                       target_field, interpolator);
+                       target_field,
+                       [&](int entity) {
+                         return interpolator(entity,
+                                             weights_row(sources_and_weights, entity));
+                       });
+
+    if (profiler_)
+      profiler_->time.interpolate += timer::elapsed(tic);
+  }
+
+
+  /**
+   * @brief Interpolate several mesh variables in a single traversal of
+   * the intersection weights. The entries of each target entity are
+   * read once and used for all variables while they are in cache,
+   * instead of walking all the weights once per variable.
+   *
+   * @param[in] srcvarnames         source mesh variables to remap
+   * @param[in] trgvarnames         target mesh variables to remap
+   * @param[in] sources_and_weights weights for mesh-mesh interpolation
+   *                                (one list per target entity or compressed)
+   * @param[in] gradients           gradients of each variable on source mesh (can be nullptr for 1st order remap)
+   */
+  template<typename T = double,
+           template<int, Entity_kind, class, class, class, class, class,
+    template<class, int, class, class> class,
+    class, class, class> class Interpolate,
+    class SourceWeights
+  >
+  void interpolate_mesh_vars(std::vector<std::string> const& srcvarnames,
+                             std::vector<std::string> const& trgvarnames,
+                             SourceWeights const& sources_and_weights,
+                             std::vector<Portage::vector<Vector<D>>>* gradients = nullptr) {
+
+    auto tic = timer::now();
+
+    std::vector<MeshInterpolator<T, Interpolate>> interpolators;
+    std::vector<T*> target_fields;
+    bind_mesh_vars(srcvarnames, trgvarnames, gradients,
+                   &interpolators, &target_fields);
+
+    int const nfields = interpolators.size();
+    if (nfields == 0)
+      return;
+
+    Portage::for_each(target_mesh_.begin(ONWHAT, PARALLEL_OWNED),
+                      target_mesh_.end(ONWHAT, PARALLEL_OWNED),
+                      [&](int entity) {
+                        auto const& entity_weights =
+                            weights_row(sources_and_weights, entity);
+                        for (int i = 0; i < nfields; i++)
+                          target_fields[i][entity] =
+                              interpolators[i](entity, entity_weights);
+                      });
+
+    if (profiler_)
+      profiler_->time.interpolate += timer::elapsed(tic);
+  }
+
+
+  /**
+   * @brief Search, intersect and interpolate several mesh variables
+   * tile by tile. Target entities are processed in tiles of
+   * 'tile_size' entities: the candidates and moments of a tile are
+   * computed, used to interpolate all variables on the tile and then
+   * discarded, so that the memory needed for the intermediate
+   * structures is bounded by the tile size rather than by the total
+   * number of overlaps. The moments are only kept when asked for,
+   * e.g. to reuse them for more variables or to check for mismatch.
+   *
+   * @tparam Search      search functor
+   * @tparam Intersect   intersect functor
+   * @tparam Interpolate interpolate functor
+   *
+   * @param[in] srcvarnames    source mesh variables to remap
+   * @param[in] trgvarnames    target mesh variables to remap
+   * @param[in] gradients      gradients of each variable on source mesh (can be nullptr for 1st order remap)
+   * @param[in] tile_size      number of target entities processed at a time,
+   *                           0 for the one set with set_tile_size
+   * @param[in] retain_weights keep the moments of all tiles
+   * @param[out] xsect_volumes if not null, the intersection volume of
+   *                           each target entity, summed up tile by tile
+   *                           (enough for check_mismatch_volumes)
+   * @return the moments of all target entities if 'retain_weights' is
+   *         set, empty weights otherwise
+   */
+  template<template<int, Entity_kind, class, class> class Search,
+           template <Entity_kind, class, class, class,
+                     template <class, int, class, class> class,
+                     class, class> class Intersect,
+           typename T,
+           template<int, Entity_kind, class, class, class, class, class,
+                    template<class, int, class, class> class,
+                    class, class, class> class Interpolate
+  >
+  WeightsCSR remap_mesh_vars_tiled(std::vector<std::string> const& srcvarnames,
+                                   std::vector<std::string> const& trgvarnames,
+                                   std::vector<Portage::vector<Vector<D>>>* gradients = nullptr,
+                                   int tile_size = 0,
+                                   bool retain_weights = false,
+                                   std::vector<double>* xsect_volumes = nullptr) {
+
+    if (tile_size == 0)
+      tile_size = tile_size_;
+    assert(tile_size > 0);
+
+    const Search<D, ONWHAT, SourceMesh, TargetMesh>
+        search_functor(source_mesh_, target_mesh_);
+
+    prepare_intersection();
+
+    Intersect<ONWHAT, SourceMesh, SourceState, TargetMesh,
+              InterfaceReconstructorType, Matpoly_Splitter, Matpoly_Clipper>
+        intersector(source_mesh_, source_state_, target_mesh_, num_tols_);
+    use_intersection_cache(intersector, 0);
+
+    std::vector<MeshInterpolator<T, Interpolate>> interpolators;
+    std::vector<T*> target_fields;
+    bind_mesh_vars(srcvarnames, trgvarnames, gradients,
+                   &interpolators, &target_fields);
+    int const nfields = interpolators.size();
+
+    int const nents = target_mesh_.num_entities(ONWHAT, PARALLEL_OWNED);
+
+    WeightsCSR sources_and_weights;
+    if (retain_weights)
+      sources_and_weights.reserve(nents, 0);
+    if (xsect_volumes)
+      xsect_volumes->assign(nents, 0.);
+
+    int const ntile = std::min(nents, tile_size);
+    Portage::vector<std::vector<int>> candidates(ntile);
+    WeightsCSR weights;
+    IntersectionBlock block;
+
+    auto tic = timer::now();
+
+    auto const first_entity = target_mesh_.begin(ONWHAT, PARALLEL_OWNED);
+    for (int first = 0; first < nents; first += tile_size) {
+      int const last = std::min(first + tile_size, nents);
+
+      Portage::transform(first_entity + first, first_entity + last,
+                         candidates.begin(), search_functor);
+
+      if (profiler_) {
+        profiler_->time.search += timer::elapsed(tic);
+        profiler_->count.targets += last - first;
+        for (int t = first; t < last; t++) {
+          std::vector<int> const& entity_candidates = candidates[t - first];
+          profiler_->count.candidates += entity_candidates.size();
+        }
+        tic = timer::now();
+      }
+
+      weights.clear();
+      prepare_intersector(intersector, first_entity + first, last - first,
+                          candidates.begin(), 0);
+      intersect_block(intersector, first_entity + first, last - first,
+                      candidates.begin(), &block, &weights, 0);
+
+      if (profiler_) {
+        profiler_->time.intersect += timer::elapsed(tic);
+        flush_thread_load();
+        profiler_->count.intersections += weights.num_entries();
+        tic = timer::now();
+      }
+
+      if (nfields > 0)
+        Portage::for_each(first_entity + first, first_entity + last,
+                          [&](int entity) {
+                            auto const& entity_weights =
+                                weights_row(weights, entity - first);
+                            for (int i = 0; i < nfields; i++)
+                              target_fields[i][entity] =
+                                  interpolators[i](entity, entity_weights);
+                          });
+
+      if (profiler_)
+        profiler_->time.interpolate += timer::elapsed(tic, true);
+
+      if (retain_weights)
+        sources_and_weights.append(weights);
+
+      if (xsect_volumes)
+        for (int t = first; t < last; t++)
+          for (auto const& entry : weights[t - first])
+            (*xsect_volumes)[t] += entry.weights[0];
+    }
+
+    sources_and_weights.shrink_to_fit();
+    return sources_and_weights;
   }
 
 
@@ -1069,11 +1665,12 @@ class CoreDriver : public CoreDriverBase<D,
            template<int, Entity_kind, class, class, class, class, class,
                     template<class, int, class, class> class,
                     class, class, class> class Interpolate,
+           class SourceWeights,
            Entity_kind ONWHAT1 = ONWHAT,
            typename = typename std::enable_if<ONWHAT1 == CELL>::type>
   void
   interpolate_mesh_var(std::string srcvarname, std::string trgvarname,
-                       Portage::vector<std::vector<Weights_t>> const& sources_and_weights,
+                       SourceWeights const& sources_and_weights,
                        const PartPair<D, SourceMesh, SourceState,
                        TargetMesh, TargetState>* partition,
                        Portage::vector<Vector<D>>* gradients = nullptr) {
@@ -1139,7 +1736,7 @@ class CoreDriver : public CoreDriverBase<D,
       // For that, we just iterate on the related weight list, and add the
       // current couple of entity/weights if it belongs to the source part.
       // nb: 'auto' may imply unexpected behavior with thrust enabled.
-      entity_weights_t const& entity_weights = sources_and_weights[entity];
+      auto const& entity_weights = weights_row(sources_and_weights, entity);
       entity_weights_t heap;
       heap.reserve(10); // size of a local vicinity
       for (auto&& weight : entity_weights) {
@@ -1226,10 +1823,13 @@ class CoreDriver : public CoreDriverBase<D,
                                      InterfaceReconstructorType,
                                      Matpoly_Splitter, Matpoly_Clipper, CoordSys>;
 
+    auto tic = timer::now();
+
     Interpolator interpolator(source_mesh_, target_mesh_,
                               source_state_, num_tols_,
                               interface_reconstructor_);
-      
+    use_material_moments(interpolator, 0);
+
     int const nmats = source_state_.num_materials();
 
     for (int m = 0; m < nmats; m++) {
@@ -1273,6 +1873,8 @@ class CoreDriver : public CoreDriverBase<D,
       target_state_.mat_add_celldata(trgvarname, m, target_field_raw);
     }  // over all mats
 
+    if (profiler_)
+      profiler_->time.interpolate += timer::elapsed(tic);
   }  // CoreDriver::interpolate_mat_var
 
 #endif  // HAVE_TANGRAM
@@ -1282,34 +1884,44 @@ class CoreDriver : public CoreDriverBase<D,
     Check mismatch between meshes
 
     @param[in] sources_and_weights Intersection sources and moments
-    (vols, centroids)
+    (vols, centroids), one list per target entity or compressed
 
     @returns   Whether the meshes are mismatched
   */
+  template<class SourceWeights>
   bool
-  check_mismatch(Portage::vector<std::vector<Weights_t>> const& source_weights) {
+  check_mismatch(SourceWeights const& source_weights) {
 
-    // Instantiate mismatch fixer for later use
-    if (not mismatch_fixer_) {
-      // Intel 18.0.1 does not recognize std::make_unique even with -std=c++14 flag *ugh*
-      // mismatch_fixer_ = std::make_unique<MismatchFixer<D, ONWHAT,
-      //                                                  SourceMesh, SourceState,
-      //                                                  TargetMesh,  TargetState>
-      //                                    >
-      //     (source_mesh_, source_state_, target_mesh_, target_state_,
-      //      source_weights, executor_);
+    make_mismatch_fixer();
 
-      mismatch_fixer_ = std::unique_ptr<MismatchFixer<D, ONWHAT,
-                                                      SourceMesh, SourceState,
-                                                      TargetMesh,  TargetState>
-                                        >(new MismatchFixer<D, ONWHAT,
-                                          SourceMesh, SourceState,
-                                          TargetMesh,  TargetState>
-                                          (source_mesh_, source_state_, target_mesh_, target_state_,
-                                           executor_));
-    }
+    auto tic = timer::now();
+    bool const mismatch = mismatch_fixer_->check_mismatch(source_weights);
+    if (profiler_)
+      profiler_->time.mismatch += timer::elapsed(tic);
 
-    return mismatch_fixer_->check_mismatch(source_weights);
+    return mismatch;
+  }
+
+
+  /*!
+    Check mismatch between meshes given only the intersection volume of
+    each target entity, e.g. as summed up by remap_mesh_vars_tiled when
+    the weights are not kept
+
+    @param[in] xsect_volumes Intersection volume of each owned target entity
+
+    @returns   Whether the meshes are mismatched
+  */
+  bool
+  check_mismatch_volumes(std::vector<double> const& xsect_volumes) {
+    make_mismatch_fixer();
+
+    auto tic = timer::now();
+    bool const mismatch = mismatch_fixer_->check_mismatch_volumes(xsect_volumes);
+    if (profiler_)
+      profiler_->time.mismatch += timer::elapsed(tic);
+
+    return mismatch;
   }
 
   
@@ -1366,16 +1978,59 @@ class CoreDriver : public CoreDriverBase<D,
 
     assert(mismatch_fixer_ && "check_mismatch must be called first!");
 
-    if (source_state_.field_type(ONWHAT, src_var_name) ==
+    if (source_state_.field_type(ONWHAT, src_var_name) !=
         Field_type::MESH_FIELD)
-      return mismatch_fixer_->fix_mismatch(src_var_name, trg_var_name,
-                                  global_lower_bound, global_upper_bound,
-                                  conservation_tol, maxiter,
-                                  partial_fixup_type, empty_fixup_type);
-    return false;
+      return false;
+
+    auto tic = timer::now();
+    bool const fixed =
+        mismatch_fixer_->fix_mismatch(src_var_name, trg_var_name,
+                                      global_lower_bound, global_upper_bound,
+                                      conservation_tol, maxiter,
+                                      partial_fixup_type, empty_fixup_type);
+    if (profiler_) {
+      profiler_->time.mismatch += timer::elapsed(tic);
+      profiler_->count.partial_fixed += mismatch_fixer_->num_partial();
+      if (empty_fixup_type != Empty_fixup_type::LEAVE_EMPTY)
+        profiler_->count.empty_fixed += mismatch_fixer_->num_empty();
+    }
+    return fixed;
   }
+
+  /*!
+    @brief Accumulate the time spent in each phase and the related
+    counts (targets, candidates, intersections, fixed up entities,
+    candidates examined per thread) into a profiler.
+
+    @param[in] profiler profiler to fill in, or nullptr to stop profiling
+  */
+  void set_profiler(Profiler* profiler) { profiler_ = profiler; }
   
  private:
+  // Precompute the stencils of a cell gradient kernel
+  template<Entity_kind ONWHAT1 = ONWHAT>
+  static typename std::enable_if<ONWHAT1 == CELL>::type
+  precompute_stencils(Gradient& kernel) { kernel.precompute_stencils(); }
+
+  // Node gradient kernels have no precomputed stencils
+  template<Entity_kind ONWHAT1 = ONWHAT>
+  static typename std::enable_if<ONWHAT1 != CELL>::type
+  precompute_stencils(Gradient& /* kernel */) {}
+
+#ifdef HAVE_TANGRAM
+  // Hand the material moments to interpolators using them
+  template<class Interpolator>
+  auto use_material_moments(Interpolator& interpolator, int) const
+    -> decltype(interpolator.set_material_moments(nullptr), void()) {
+    interpolator.set_material_moments(&material_moments_);
+  }
+
+  // Other interpolators (e.g. first order) do not need them
+  template<class Interpolator>
+  void use_material_moments(Interpolator& /* interpolator */, long) const {}
+#endif
+
+
   SourceMesh const & source_mesh_;
   TargetMesh const & target_mesh_;
   SourceState const & source_state_;
@@ -1388,10 +2043,259 @@ class CoreDriver : public CoreDriverBase<D,
 
   Wonton::Executor_type const *executor_;
 
+  // where to record phase timings and counts (if anywhere)
+  Profiler* profiler_ = nullptr;
+
+  // candidates examined by each thread during the current intersection
+  std::shared_ptr<std::vector<std::atomic<long>>> thread_load_;
+
+  // whether to precompute the least-squares stencils of cell gradients
+  bool precompute_gradient_stencils_ = false;
+
+  // target entities per tile in remap_mesh_vars_tiled
+  int tile_size_ = 65536;
+
+  // per-cell data of the intersectors shared across intersections
+  std::shared_ptr<IntersectionCache<D>> intersection_cache_;
+
 #ifdef PORTAGE_ENABLE_MPI
   MPI_Comm mycomm_ = MPI_COMM_NULL;
 #endif
 
+  // Instantiate the mismatch fixer for later use
+  void make_mismatch_fixer() {
+    if (not mismatch_fixer_) {
+      // Intel 18.0.1 does not recognize std::make_unique even with -std=c++14 flag *ugh*
+      // mismatch_fixer_ = std::make_unique<MismatchFixer<D, ONWHAT,
+      //                                                  SourceMesh, SourceState,
+      //                                                  TargetMesh,  TargetState>
+      //                                    >
+      //     (source_mesh_, source_state_, target_mesh_, target_state_,
+      //      source_weights, executor_);
+
+      mismatch_fixer_ = std::unique_ptr<MismatchFixer<D, ONWHAT,
+                                                      SourceMesh, SourceState,
+                                                      TargetMesh,  TargetState>
+                                        >(new MismatchFixer<D, ONWHAT,
+                                          SourceMesh, SourceState,
+                                          TargetMesh,  TargetState>
+                                          (source_mesh_, source_state_, target_mesh_, target_state_,
+                                           executor_));
+    }
+  }
+
+  // Reconcile tolerances and discard stale state before intersecting meshes
+  void prepare_intersection() {
+#ifdef HAVE_TANGRAM
+    // If user did NOT set tolerances for Tangram, use Portage tolerances
+    if (reconstructor_tols_.empty()) {
+      reconstructor_tols_ = { {1000, num_tols_.min_absolute_distance,
+                                     num_tols_.min_absolute_volume},
+                              {100, num_tols_.min_absolute_distance,
+                                    num_tols_.min_absolute_distance} };
+    }
+    // If user set tolerances for Tangram, but not for Portage,
+    // use Tangram tolerances
+    else if (!num_tols_.user_tolerances) {
+      num_tols_.min_absolute_distance = reconstructor_tols_[0].arg_eps;
+      num_tols_.min_absolute_volume = reconstructor_tols_[0].fun_eps;
+    }
+#endif
+
+    // any mismatch state computed from previous weights is stale now
+    mismatch_fixer_.reset();
+
+    if (profiler_) {
+      if (static_cast<int>(profiler_->thread_load.size()) < num_threads())
+        profiler_->thread_load.resize(num_threads(), 0);
+      thread_load_ =
+        std::make_shared<std::vector<std::atomic<long>>>(num_threads());
+    } else
+      thread_load_.reset();
+  }
+
+  // Wrap an intersector to count the candidates examined by each
+  // thread when profiling. The counters are atomic since thread_id()
+  // does not tell the threads of every backend apart (it is always 0
+  // with TBB), then added to the profiler by flush_thread_load.
+  template<class Intersector>
+  auto count_thread_load(Intersector const& intersector) const {
+    auto counters = thread_load_;
+    return [counters, &intersector](int entity,
+                                    std::vector<int> const& candidates) {
+      if (counters)
+        (*counters)[thread_id()].fetch_add(candidates.size(),
+                                           std::memory_order_relaxed);
+      return intersector(entity, candidates);
+    };
+  }
+
+  // Hand the shared cache, or a fresh one for this intersection, to
+  // intersectors keeping per-cell data
+  template<class Intersector>
+  auto use_intersection_cache(Intersector& intersector, int) const
+    -> decltype(intersector.set_cache(std::shared_ptr<IntersectionCache<D>>()),
+                void()) {
+    intersector.set_cache(intersection_cache_ ? intersection_cache_ :
+                          std::make_shared<IntersectionCache<D>>());
+  }
+
+  // Other intersectors have no per-cell data
+  template<class Intersector>
+  void use_intersection_cache(Intersector& /* intersector */, long) const {}
+
+  // Let intersectors keeping per-cell data compute it for the n target
+  // entities about to be intersected and for their candidates only
+  template<class Intersector, class EntityIterator, class CandidateIterator>
+  auto prepare_intersector(Intersector& intersector,
+                           EntityIterator entities, int n,
+                           CandidateIterator candidates, int) const
+    -> decltype(intersector.prepare(std::vector<int>(), std::vector<int>()),
+                void()) {
+    std::vector<int> targets(entities, entities + n);
+    std::vector<int> sources;
+    for (int i = 0; i < n; i++) {
+      std::vector<int> const& entity_candidates = candidates[i];
+      sources.insert(sources.end(), entity_candidates.begin(),
+                     entity_candidates.end());
+    }
+    intersector.prepare(targets, sources);
+  }
+
+  // Other intersectors have nothing to prepare
+  template<class Intersector, class EntityIterator, class CandidateIterator>
+  void prepare_intersector(Intersector& /* intersector */,
+                           EntityIterator /* entities */, int /* n */,
+                           CandidateIterator /* candidates */, long) const {}
+
+  // Buffers of intersect_block, reused from one block to the next
+  struct IntersectionBlock {
+    std::vector<int> offsets;     // first slot of each target entity
+    std::vector<int> sizes;       // entries found for each target entity
+    std::vector<int> entities;
+    std::vector<double> moments;
+    Portage::vector<std::vector<Weights_t>> weights;  // other intersectors
+  };
+
+  // Intersect a block of n target entities with their candidates and
+  // append their moments to 'weights'. Intersectors writing to flat
+  // arrays fill a slot per candidate in parallel, the slots of each
+  // entity then being compressed without any Weights_t in between.
+  template<class Intersector, class EntityIterator, class CandidateIterator>
+  auto intersect_block(Intersector const& intersector,
+                       EntityIterator entities, int n,
+                       CandidateIterator candidates,
+                       IntersectionBlock* block, WeightsCSR* weights, int)
+    -> decltype(intersector.intersect(0, std::vector<int>(), nullptr, nullptr),
+                void()) {
+
+    int const nmoments = D + 1;
+
+    block->offsets.resize(n + 1);
+    block->offsets[0] = 0;
+    for (int i = 0; i < n; i++) {
+      std::vector<int> const& entity_candidates = candidates[i];
+      block->offsets[i+1] = block->offsets[i] + entity_candidates.size();
+    }
+    block->sizes.resize(n);
+    block->entities.resize(block->offsets[n]);
+    block->moments.resize(static_cast<size_t>(block->offsets[n]) * nmoments);
+
+    int const* offsets = block->offsets.data();
+    int* sizes = block->sizes.data();
+    int* slots = block->entities.data();
+    double* moments = block->moments.data();
+    auto counters = thread_load_;
+
+    Portage::for_each(make_counting_iterator(0),
+                      make_counting_iterator(n),
+                      [&](int i) {
+                        std::vector<int> const& entity_candidates = candidates[i];
+                        if (counters)
+                          (*counters)[thread_id()].fetch_add(
+                              entity_candidates.size(), std::memory_order_relaxed);
+                        sizes[i] = intersector.intersect(
+                            entities[i], entity_candidates, slots + offsets[i],
+                            moments + static_cast<size_t>(offsets[i]) * nmoments);
+                      });
+
+    for (int i = 0; i < n; i++)
+      weights->append(slots + offsets[i],
+                      moments + static_cast<size_t>(offsets[i]) * nmoments,
+                      sizes[i], nmoments);
+  }
+
+  // Other intersectors return a list of Weights_t per target entity
+  template<class Intersector, class EntityIterator, class CandidateIterator>
+  void intersect_block(Intersector const& intersector,
+                       EntityIterator entities, int n,
+                       CandidateIterator candidates,
+                       IntersectionBlock* block, WeightsCSR* weights, long) {
+    block->weights.resize(n);
+    Portage::transform(entities, entities + n, candidates,
+                       block->weights.begin(),
+                       count_thread_load(intersector));
+    for (int i = 0; i < n; i++)
+      weights->append(block->weights[i]);
+  }
+
+  // Add the candidates counted by count_thread_load to the profiler
+  void flush_thread_load() {
+    if (profiler_ and thread_load_) {
+      int const nthreads = thread_load_->size();
+      for (int t = 0; t < nthreads; t++)
+        profiler_->thread_load[t] += (*thread_load_)[t].exchange(0);
+    }
+  }
+
+  // Interpolator of mesh variables of type T
+  template<typename T,
+           template<int, Entity_kind, class, class, class, class, class,
+                    template<class, int, class, class> class,
+                    class, class, class> class Interpolate>
+  using MeshInterpolator = Interpolate<D, ONWHAT,
+                                       SourceMesh, TargetMesh,
+                                       SourceState, TargetState,
+                                       T,
+                                       InterfaceReconstructorType,
+                                       Matpoly_Splitter, Matpoly_Clipper, CoordSys>;
+
+  // Set up an interpolator and get the target field of each variable
+  // defined on ONWHAT, skipping the others
+  template<typename T, class Interpolator>
+  void bind_mesh_vars(std::vector<std::string> const& srcvarnames,
+                      std::vector<std::string> const& trgvarnames,
+                      std::vector<Portage::vector<Vector<D>>>* gradients,
+                      std::vector<Interpolator>* interpolators,
+                      std::vector<T*>* target_fields) const {
+
+    int const nvars = srcvarnames.size();
+    assert(trgvarnames.size() == srcvarnames.size());
+    assert(gradients == nullptr or static_cast<int>(gradients->size()) == nvars);
+
+    interpolators->reserve(nvars);
+    target_fields->reserve(nvars);
+
+    for (int i = 0; i < nvars; i++) {
+      if (source_state_.get_entity(srcvarnames[i]) != ONWHAT) {
+        std::cerr << "Variable " << srcvarnames[i] << " not defined on Entity_kind "
+                  << ONWHAT << ". Skipping!" << std::endl;
+        continue;
+      }
+
+      interpolators->emplace_back(source_mesh_, target_mesh_, source_state_,
+                                  num_tols_);
+      interpolators->back().set_interpolation_variable(
+          srcvarnames[i], gradients ? &((*gradients)[i]) : nullptr);
+
+      // get a handle to a memory location where the target state
+      // would like us to write this variable into.
+      T* target_mesh_field = nullptr;
+      target_state_.mesh_get_data(ONWHAT, trgvarnames[i], &target_mesh_field);
+      target_fields->push_back(target_mesh_field);
+    }
+  }
+
 #ifdef HAVE_TANGRAM
 
   // The following tolerances as well as the all-convex flag are
@@ -1418,6 +2322,10 @@ class CoreDriver : public CoreDriverBase<D,
                                   SourceMesh,
                                   Matpoly_Splitter, Matpoly_Clipper>
                   > interface_reconstructor_;
+
+  // Volume and centroid of each material in each of its cells, computed
+  // once after interface reconstruction
+  MaterialMoments<D> material_moments_;
   
 
   // Convert volume fraction and centroid data from compact
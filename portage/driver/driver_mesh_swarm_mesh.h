@@ -263,23 +263,24 @@ public:
       SwarmState<dim> target_swarm_state(target_state_, Wonton::CELL);
 
       // set up smoothing lengths and extents
-      Portage::vector<std::vector<std::vector<double>>> smoothing_lengths;
+      SmoothingLengths smoothing_lengths;
       std::vector<std::vector<double>> default_lengths(1, std::vector<double>(dim));
       Portage::vector<Wonton::Point<dim>> weight_extents, other_extents;
       Portage::vector<std::vector<std::vector<double>>> part_smoothing; // only for faceted,scatter,parts
 
       if (geometry_ == Weight::FACETED) {
         using Weight::faceted_setup_cell;
+        Portage::vector<std::vector<std::vector<double>>> faceted_lengths;
 
         if (part_field_ == "NONE") {
           switch (center_) {
             case Scatter: faceted_setup_cell<dim>(source_mesh_,
-                                                  smoothing_lengths,
+                                                  faceted_lengths,
                                                   weight_extents,
                                                   smoothing_factor_,
                                                   boundary_factor_); break;
             case Gather:  faceted_setup_cell<dim>(target_mesh_,
-                                                  smoothing_lengths,
+                                                  faceted_lengths,
                                                   weight_extents,
                                                   smoothing_factor_,
                                                   boundary_factor_); break;
@@ -295,22 +296,23 @@ public:
                                       dummy_extents, 0.25, 0.25);
               // Get usual smoothing lengths and extents
               faceted_setup_cell<dim>(source_mesh_,
-                                      smoothing_lengths, weight_extents,
+                                      faceted_lengths, weight_extents,
                                       smoothing_factor_, boundary_factor_);
               break;
             case Gather: faceted_setup_cell<dim>(target_mesh_, target_state_,
                                                  part_field_, part_tolerance_,
-                                                 smoothing_lengths, weight_extents,
+                                                 faceted_lengths, weight_extents,
                                                  smoothing_factor_, boundary_factor_);
             break;
             default: break;
           }
         }
+        smoothing_lengths = SmoothingLengths(faceted_lengths);
       } else /* part_field_ != NONE */ {
         int ncells = (center_ == Scatter ? source_mesh_.num_owned_cells()
                                          : target_mesh_.num_owned_cells());
 
-        smoothing_lengths.resize(ncells, default_lengths);
+        smoothing_lengths = SmoothingLengths(ncells, default_lengths);
 
         for (int i = 0; i < ncells; i++) {
           double radius = 0.0;
@@ -320,9 +322,7 @@ public:
             default: break;
           }
 
-          std::vector<std::vector<double>> h = smoothing_lengths[i];
-          h[0] = std::vector<double>(dim, 2. * radius * smoothing_factor_);
-          smoothing_lengths[i] = h;
+          std::fill_n(smoothing_lengths.data(i), dim, 2. * radius * smoothing_factor_);
         }
       }
 
@@ -355,7 +355,8 @@ public:
       swarm_remap.set_remap_var_names(source_cellvar_names, target_cellvar_names,
                                       estimate_, basis_, operator_spec_,
                                       operator_domains_, operator_data_,
-                                      part_field_, part_tolerance_, part_smoothing);
+                                      part_field_, part_tolerance_,
+                                      SmoothingLengths(part_smoothing));
       // do the remap
       swarm_remap.run(executor, true);
 
@@ -392,7 +393,7 @@ public:
       SwarmState<dim> target_swarm_state(target_state_, Wonton::NODE);
 
       // create smoothing lengths
-      Portage::vector<std::vector<std::vector<double>>> smoothing_lengths;
+      SmoothingLengths smoothing_lengths;
       std::vector<std::vector<double>> default_lengths(1, std::vector<double>(dim));
 
       if (geometry_ == Weight::FACETED) {
@@ -403,7 +404,7 @@ public:
       int nnodes = (center_ == Scatter ? source_mesh_.num_owned_nodes()
                                        : target_mesh_.num_owned_nodes());
 
-      smoothing_lengths.resize(nnodes, default_lengths);
+      smoothing_lengths = SmoothingLengths(nnodes, default_lengths);
 
       for (int i = 0; i < nnodes; i++) {
         double radius = 0.0;
@@ -413,9 +414,7 @@ public:
           default: break;
         }
 
-        std::vector<std::vector<double>> h = smoothing_lengths[i];
-        h[0] = std::vector<double>(dim, radius * smoothing_factor_);
-        smoothing_lengths[i] = h;
+        std::fill_n(smoothing_lengths.data(i), dim, radius * smoothing_factor_);
       }
 
       // create swarm remap driver
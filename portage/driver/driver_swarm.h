@@ -19,6 +19,7 @@
 #include "portage/support/timer.h"
 #include "portage/support/basis.h"
 #include "portage/support/weight.h"
+#include "portage/support/smoothing_lengths.h"
 #include "portage/support/operator.h"
 #include "portage/search/search_simple_points.h"
 #include "portage/accumulate/accumulate.h"
@@ -29,8 +30,6 @@
 #endif
 
 namespace Portage { namespace Meshfree {
-  // avoid very long type names.
-  using SmoothingLengths = Portage::vector<std::vector<std::vector<double>>>;
 
 /**
  * @brief Provides an interface to remap variables from one swarm to another.
@@ -203,6 +202,48 @@ public:
     target_extents_ = target_extents;
   }
 
+  /**
+   * @brief Constructors from nested smoothing lengths
+   *
+   * The lengths are flattened once into a SmoothingLengths owned by the
+   * driver. The other parameters are the ones of the constructors above.
+   */
+  SwarmDriver(SourceSwarm& source_swarm,
+              SourceState& source_state,
+              TargetSwarm const& target_swarm,
+              TargetState& target_state,
+              Portage::vector<std::vector<std::vector<double>>> const& smoothing_lengths,
+              Weight::Kernel const kernel_type = Weight::B4,
+              Weight::Geometry const support_geom_type = Weight::ELLIPTIC,
+              WeightCenter const center=Gather)
+      : SwarmDriver(source_swarm, source_state, target_swarm, target_state,
+                    SmoothingLengths(smoothing_lengths),
+                    kernel_type, support_geom_type, center) {}
+
+  SwarmDriver(SourceSwarm& source_swarm,
+              SourceState& source_state,
+              TargetSwarm const& target_swarm,
+              TargetState& target_state,
+              Portage::vector<std::vector<std::vector<double>>> const& smoothing_lengths,
+              Portage::vector<Weight::Kernel> const& kernel_types,
+              Portage::vector<Weight::Geometry> const& geom_types,
+              WeightCenter const center = Gather)
+      : SwarmDriver(source_swarm, source_state, target_swarm, target_state,
+                    SmoothingLengths(smoothing_lengths),
+                    kernel_types, geom_types, center) {}
+
+  SwarmDriver(SourceSwarm& source_swarm,
+              SourceState& source_state,
+              TargetSwarm const& target_swarm,
+              TargetState& target_state,
+              Portage::vector<std::vector<std::vector<double>>> const& smoothing_lengths,
+              Portage::vector<Point<dim>> const& source_extents,
+              Portage::vector<Point<dim>> const& target_extents,
+              WeightCenter const center = Gather)
+      : SwarmDriver(source_swarm, source_state, target_swarm, target_state,
+                    SmoothingLengths(smoothing_lengths),
+                    source_extents, target_extents, center) {}
+
   /**
    * @brief Disabled copy constructor
    */
@@ -278,6 +319,26 @@ public:
     part_smoothing_ = part_smoothing;
   }
 
+  /**
+   * @brief Same as above, with nested smoothing lengths for part-by-particle,
+   *        flattened once.
+   */
+  void set_remap_var_names(std::vector<std::string> const& source_vars,
+                           std::vector<std::string> const& target_vars,
+                           EstimateType const estimator_type,
+                           basis::Type const basis_type,
+                           oper::Type const operator_spec,
+                           Portage::vector<oper::Domain> const& operator_domains,
+                           Portage::vector<std::vector<Point<dim>>> const& operator_data,
+                           std::string part_field,
+                           double part_tolerance,
+                           Portage::vector<std::vector<std::vector<double>>> const& part_smoothing) {
+    set_remap_var_names(source_vars, target_vars, estimator_type, basis_type,
+                        operator_spec, operator_domains, operator_data,
+                        part_field, part_tolerance,
+                        SmoothingLengths(part_smoothing));
+  }
+
   /**
    * @brief Get all source swarm variables names.
    *
@@ -358,13 +419,12 @@ public:
     Portage::vector<std::vector<int>> candidates(nb_target);
 
     // Get an instance of the desired search algorithm type which is expected
-    // to be a functor with an operator() of the right form
+    // to be a functor with an operator() of the right form, or to provide
+    // the candidates of all the target particles at once (find_all)
     Searcher search(source_swarm_, target_swarm_,
                     source_extents_, target_extents_, weight_center_);
 
-    Portage::transform(target_swarm_.begin(Wonton::PARTICLE, Wonton::PARALLEL_OWNED),
-                       target_swarm_.end(Wonton::PARTICLE, Wonton::PARALLEL_OWNED),
-                       candidates.begin(), search);
+    find_candidates(search, candidates, 0);
 
     tot_seconds_srch = timer::elapsed(tic);
 
@@ -452,6 +512,9 @@ public:
 
     tot_seconds_xsect = timer::elapsed(tic, true);
 
+    // targets whose weights were zeroed for lack of a well-posed regression
+    int const nb_ill_conditioned = accumulate.num_ill_conditioned();
+
     // ESTIMATE (one variable at a time)
     nb_fields = source_vars_.size();
     if (rank == 0)
@@ -497,6 +560,7 @@ public:
         std::cout << "  Swarm Distribution Time Rank " << rank << " (s): " << tot_seconds_dist << std::endl;
         std::cout << "  Swarm Search Time Rank " << rank << " (s): " << tot_seconds_srch << std::endl;
         std::cout << "  Swarm Accumulate Time Rank " << rank << " (s): " << tot_seconds_xsect << std::endl;
+        std::cout << "  Swarm Ill-Conditioned Targets Rank " << rank << ": " << nb_ill_conditioned << std::endl;
         std::cout << "  Swarm Estimate Time Rank " << rank << " (s): " << tot_seconds_interp << std::endl;
 
         // put out neighbor statistics
@@ -559,7 +623,7 @@ protected:
   void check_sizes(WeightCenter const weight_center) {
 #ifdef DEBUG
     unsigned const swarm_size = get_swarm_size();
-    assert(smoothing_lengths_.size() == swarm_size);
+    assert(unsigned(smoothing_lengths_.size()) == swarm_size);
     assert(kernel_types_.size() == swarm_size);
     assert(geom_types_.size() == swarm_size);
 #endif
@@ -595,8 +659,11 @@ protected:
         if (geom_types_[i] == Weight::FACETED) {
           throw std::runtime_error("FACETED geometry is not available here");
         }
-        std::vector<std::vector<double>> temp = smoothing_lengths_[i];
-        target_extents_[i] = Point<dim>(temp[0]);
+        double const* h = smoothing_lengths_.data(i);
+        Point<dim> extent;
+        for (int d = 0; d < dim; d++)
+          extent[d] = h[d];
+        target_extents_[i] = extent;
       }
     } else if (weight_center_ == Scatter) {
       int const nb_source = source_swarm_.num_particles(Wonton::PARALLEL_OWNED);
@@ -607,12 +674,54 @@ protected:
         if (geom_types_[i] == Weight::FACETED) {
           throw std::runtime_error("FACETED geometry is not available here");
         }
-        std::vector<std::vector<double>> temp = smoothing_lengths_[i];
-        source_extents_[i] = Point<dim>(temp[0]);
+        double const* h = smoothing_lengths_.data(i);
+        Point<dim> extent;
+        for (int d = 0; d < dim; d++)
+          extent[d] = h[d];
+        source_extents_[i] = extent;
       }
     }
   }
 
+  /**
+   * @brief Find the candidates of all the owned target particles at once,
+   *        for searches providing them as a compressed table (find_all),
+   *        instead of building a list per query.
+   *
+   * @param search: the search instance.
+   * @param candidates: the candidates of each owned target particle.
+   */
+  template<class Searcher>
+  auto find_candidates(Searcher const& search,
+                       Portage::vector<std::vector<int>>& candidates, int) const
+    -> decltype(search.find_all(std::declval<std::vector<int>&>(),
+                                std::declval<std::vector<int>&>()), void()) {
+    std::vector<int> offsets, all_candidates;
+    search.find_all(offsets, all_candidates);
+
+    // owned target particles come first
+    int const nb_target = candidates.size();
+    assert(offsets.size() > unsigned(nb_target));
+    for (int i = 0; i < nb_target; i++)
+      candidates[i] = std::vector<int>(all_candidates.begin() + offsets[i],
+                                       all_candidates.begin() + offsets[i+1]);
+  }
+
+  /**
+   * @brief Find the candidates of the owned target particles one at a
+   *        time, for searches only providing an operator().
+   *
+   * @param search: the search instance.
+   * @param candidates: the candidates of each owned target particle.
+   */
+  template<class Searcher>
+  void find_candidates(Searcher const& search,
+                       Portage::vector<std::vector<int>>& candidates, long) const {
+    Portage::transform(target_swarm_.begin(Wonton::PARTICLE, Wonton::PARALLEL_OWNED),
+                       target_swarm_.end(Wonton::PARTICLE, Wonton::PARALLEL_OWNED),
+                       candidates.begin(), search);
+  }
+
 private:
   SourceSwarm& source_swarm_;
   TargetSwarm const& target_swarm_;
@@ -633,7 +742,7 @@ private:
   Portage::vector<std::vector<Point<dim>>> operator_data_ {};
   std::string part_field_ = "";
   double part_tolerance_ = 0.0;
-  Portage::vector<std::vector<std::vector<double>>> part_smoothing_ {};
+  SmoothingLengths part_smoothing_ {};
 };  // class SwarmDriver
 
 }}  // namespace Portage::Meshfree
@@ -22,6 +22,7 @@ Please see the license file at the root of this repository, or at:
 #include <stdexcept>
 
 #include "portage/support/portage.h"
+#include "portage/support/weights_csr.h"
 
 /*!
   @file detect_mismatch.h
@@ -43,6 +44,13 @@ using Wonton::Weights_t;
 // calculation, 0 means this entity has been encountered on a previous
 // processor. This is useful for meshes where the partitioning of cells
 // on ranks is not mutually exclusive.
+//
+// Ranks do not gather all the global ids, which would take memory
+// proportional to the global mesh size on every rank. Instead, each
+// global id has a home rank (a distributed directory) to which the
+// ranks having it send it. The home rank tells the lowest of these ranks
+// that its entity is the unique one, so that the memory and the data
+// exchanged are proportional to the number of entities on each rank.
 
 #ifdef PORTAGE_ENABLE_MPI
 
@@ -56,44 +64,78 @@ void get_unique_entity_masks(Mesh_Wrapper const &mesh,
   MPI_Comm_rank(mycomm, &rank);
   MPI_Comm_size(mycomm, &nprocs);
 
-
-  // collect source and target cell volumes because we will need it
-  // a few times for each variable we process
-
   int nents = (onwhat == Entity_kind::CELL) ?
       mesh.num_owned_cells() : mesh.num_owned_nodes();
 
   unique_mask->resize(nents, 1);
 
   if (nprocs > 1) {
-    std::vector<int> nents_all(nprocs, 0);
-    MPI_Allgather(&nents, 1, MPI_INT, &(nents_all[0]), 1, MPI_INT, mycomm);
-    int maxents = *std::max_element(nents_all.begin(), nents_all.end());
-
-    std::vector<int> gids(maxents, -1);
-    for (int e = 0; e < nents; e++)
+    using Wonton::GID_t;
+
+    // Mask the repeated instances of an entity on this rank, and find
+    // the home rank of the others. The home ranks follow from the global
+    // ids only, so that all the instances of an entity go to the same rank
+    std::vector<GID_t> gids(nents);
+    std::vector<int> home(nents, -1);
+    std::vector<int> send_counts(nprocs, 0);
+    std::unordered_set<GID_t> local_gids;
+    for (int e = 0; e < nents; e++) {
       gids[e] = mesh.get_global_id(e, onwhat);
+      if (!local_gids.insert(gids[e]).second) {
+        (*unique_mask)[e] = 0;  // ent already seen on this rank
+        continue;
+      }
+      home[e] = static_cast<int>(static_cast<unsigned long long>(gids[e]) % nprocs);
+      send_counts[home[e]]++;
+    }
+    local_gids.clear();
+
+    std::vector<int> recv_counts(nprocs, 0);
+    MPI_Alltoall(send_counts.data(), 1, MPI_INT,
+                 recv_counts.data(), 1, MPI_INT, mycomm);
+
+    std::vector<int> send_offsets(nprocs, 0), recv_offsets(nprocs, 0);
+    std::partial_sum(send_counts.begin(), send_counts.end() - 1,
+                     send_offsets.begin() + 1);
+    std::partial_sum(recv_counts.begin(), recv_counts.end() - 1,
+                     recv_offsets.begin() + 1);
+    int const nsend = send_offsets[nprocs-1] + send_counts[nprocs-1];
+    int const nrecv = recv_offsets[nprocs-1] + recv_counts[nprocs-1];
+
+    // Send each global id to its home rank
+    std::vector<GID_t> send_gids(nsend);
+    std::vector<int> position(nents, -1);
+    std::vector<int> fill(send_offsets);
+    for (int e = 0; e < nents; e++)
+      if (home[e] >= 0) {
+        position[e] = fill[home[e]]++;
+        send_gids[position[e]] = gids[e];
+      }
 
-    std::vector<int> gids_all(nprocs*maxents);
-    MPI_Allgather(&(gids[0]), maxents, MPI_INT, &(gids_all[0]), maxents,
+    std::vector<GID_t> recv_gids(nrecv);
+    MPI_Alltoallv(send_gids.data(), send_counts.data(), send_offsets.data(),
+                  Wonton::to_MPI_Datatype<GID_t>(),
+                  recv_gids.data(), recv_counts.data(), recv_offsets.data(),
+                  Wonton::to_MPI_Datatype<GID_t>(), mycomm);
+
+    // The global ids received are in rank order, so the first instance of
+    // each of them comes from the lowest rank having it
+    std::vector<int> send_unique(nrecv, 0);
+    std::unordered_set<GID_t> home_gids;
+    home_gids.reserve(nrecv);
+    for (int i = 0; i < nrecv; i++)
+      send_unique[i] = home_gids.insert(recv_gids[i]).second ? 1 : 0;
+
+    // Reply to each rank in the order of its requests
+    std::vector<int> recv_unique(nsend);
+    MPI_Alltoallv(send_unique.data(), recv_counts.data(), recv_offsets.data(),
+                  MPI_INT,
+                  recv_unique.data(), send_counts.data(), send_offsets.data(),
                   MPI_INT, mycomm);
 
-    // Add gids from all lower ranks into a set (no duplicates)
-
-    std::unordered_set<int> unique_gids;
-    for (int p = 0; p < rank; p++)
-      for (int e = 0; e < nents_all[p]; e++) {
-        int gid = gids_all[p*maxents+e];
-        unique_gids.insert(gid);
-      }
-
-    // Now go through gids of this rank and mask the ones that are already
-    // occurring in other ranks.
-    for (int e = 0; e < nents; e++) {
-      auto itpair = unique_gids.insert(gids[e]);
-      if (!itpair.second)
-        (*unique_mask)[e] = 0;  // ent already in set; mask this instance
-    }
+    for (int e = 0; e < nents; e++)
+      if (position[e] >= 0 && !recv_unique[position[e]])
+        (*unique_mask)[e] = 0;  // ent already on a lower rank; mask it
   }
 }  // get_unique_entity_masks
 
@@ -148,14 +190,76 @@ class MismatchFixer {
 
 
   /// @brief Compute (and cache) whether the mesh domains are mismatched
-  /// @param[in] sources_and_weights Intersection sources and moments (vols, centroids)
+  /// @param[in] sources_and_weights Intersection sources and moments (vols,
+  /// centroids), either one list per target entity or compressed
   /// @returns whether the mesh domains are mismatched
-  bool check_mismatch(
-    Portage::vector<std::vector<Weights_t>> const & source_ents_and_weights) {
+  template<class SourceWeights>
+  bool check_mismatch(SourceWeights const & source_ents_and_weights) {
     
     // If we have already computed the mismatch, just return the result
     if (computed_mismatch_) return mismatch_;
-    
+
+    int const ntargetents = (onwhat == Entity_kind::CELL) ?
+        target_mesh_.num_owned_cells() : target_mesh_.num_owned_nodes();
+
+    std::vector<double> xsect_volumes(ntargetents, 0.0);
+    for (int t = 0; t < ntargetents; t++) {
+      auto const& sw_vec = weights_row(source_ents_and_weights, t);
+      for (auto const& sw : sw_vec)
+        xsect_volumes[t] += sw.weights[0];
+    }
+
+    check_mismatch_volumes(xsect_volumes);
+
+#ifdef DEBUG
+    if (relvoldiff_source_ > voldifftol_) {
+      // Find one source cell (or dual cell) that is not fully covered
+      // by the target mesh and output its ID. Unfortunately, that means
+      // processing all source cells. We initialize each source cell to
+      // its volume and subtract any intersection volume we find between
+      // it and a target cell
+
+      // Also, it will likely give a false positive in distributed
+      // meshes because a source cell may be covered by target cells
+      // from multiple processors
+
+      std::vector<double> source_covered_vol(source_ent_volumes_);
+      for (auto it = target_mesh_.begin(onwhat, Entity_type::PARALLEL_OWNED);
+           it != target_mesh_.end(onwhat, Entity_type::PARALLEL_OWNED); it++) {
+        auto const& sw_vec = weights_row(source_ents_and_weights, *it);
+        for (auto const& sw : sw_vec)
+          source_covered_vol[sw.entityID] -= sw.weights[0];
+      }
+
+      for (auto it = source_mesh_.begin(onwhat, Entity_type::PARALLEL_OWNED);
+           it != source_mesh_.end(onwhat, Entity_type::PARALLEL_OWNED); it++)
+        if (source_covered_vol[*it] > voldifftol_) {
+          if (onwhat == Entity_kind::CELL)
+            std::cerr << "Source cell " << *it <<
+                " not fully covered by target cells \n";
+          else
+            std::cerr << "Source dual cell " << *it <<
+                " not fully covered by target dual cells \n";
+          break;
+        }
+    }
+#endif
+
+    return mismatch_;
+  }
+
+
+  /// @brief Same as above given only the intersection volume of each
+  /// owned target entity, e.g. summed up tile by tile when the weights
+  /// are not kept
+  /// @param[in] xsect_volumes Volume of the intersection of each owned
+  /// target entity with the source mesh
+  /// @returns whether the mesh domains are mismatched
+  bool check_mismatch_volumes(std::vector<double> const & xsect_volumes) {
+
+    // If we have already computed the mismatch, just return the result
+    if (computed_mismatch_) return mismatch_;
+
     nsourceents_ = (onwhat == Entity_kind::CELL) ?
         source_mesh_.num_owned_cells() : source_mesh_.num_owned_nodes();
 
@@ -220,11 +324,17 @@ class MismatchFixer {
     // CELLS EXIST GLOBALLY. So, at this stage, we can just check
     // on-rank intersections only
 
-    xsect_volumes_.resize(ntargetents_, 0.0);
+    assert(static_cast<int>(xsect_volumes.size()) == ntargetents_);
+    xsect_volumes_ = xsect_volumes;
+
+    // count the empty and partially covered target entities
+    nempty_ = npartial_ = 0;
     for (int t = 0; t < ntargetents_; t++) {
-      std::vector<Weights_t> const& sw_vec = source_ents_and_weights[t];
-      for (auto const& sw : sw_vec)
-        xsect_volumes_[t] += sw.weights[0];
+      if (fabs(xsect_volumes_[t]) < std::numeric_limits<double>::epsilon())
+        nempty_++;
+      else if (fabs(xsect_volumes_[t] - target_ent_volumes_[t]) >
+               voldifftol_*target_ent_volumes_[t])
+        npartial_++;
     }
 
     double xsect_volume = std::accumulate(xsect_volumes_.begin(),
@@ -251,37 +361,6 @@ class MismatchFixer {
         std::cerr << "\n** MESH MISMATCH -" <<
             " some source cells are not fully covered by the target mesh\n";
 
-#ifdef DEBUG
-      // Find one source cell (or dual cell) that is not fully covered
-      // by the target mesh and output its ID. Unfortunately, that means
-      // processing all source cells. We initialize each source cell to
-      // its volume and subtract any intersection volume we find between
-      // it and a target cell
-
-      // Also, it will likely give a false positive in distributed
-      // meshes because a source cell may be covered by target cells
-      // from multiple processors
-
-      std::vector<double> source_covered_vol(source_ent_volumes_);
-      for (auto it = target_mesh_.begin(onwhat, Entity_type::PARALLEL_OWNED);
-           it != target_mesh_.end(onwhat, Entity_type::PARALLEL_OWNED); it++) {
-        std::vector<Weights_t> const& sw_vec = source_ents_and_weights[*it];
-        for (auto const& sw : sw_vec)
-          source_covered_vol[sw.entityID] -= sw.weights[0];
-      }
-
-      for (auto it = source_mesh_.begin(onwhat, Entity_type::PARALLEL_OWNED);
-           it != source_mesh_.end(onwhat, Entity_type::PARALLEL_OWNED); it++)
-        if (source_covered_vol[*it] > voldifftol_) {
-          if (onwhat == Entity_kind::CELL)
-            std::cerr << "Source cell " << *it <<
-                " not fully covered by target cells \n";
-          else
-            std::cerr << "Source dual cell " << *it <<
-                " not fully covered by target dual cells \n";
-          break;
-        }
-#endif
     }
 
     // Are some target cells not fully covered by source cells?
@@ -302,10 +381,7 @@ class MismatchFixer {
       for (auto it = target_mesh_.begin(onwhat, Entity_type::PARALLEL_OWNED);
            it != target_mesh_.end(onwhat, Entity_type::PARALLEL_OWNED); it++) {
         int t = *it;
-        double covered_vol = 0.0;
-        std::vector<Weights_t> const& sw_vec = source_ents_and_weights[t];
-        for (auto const& sw : sw_vec)
-          covered_vol += sw.weights[0];
+        double covered_vol = xsect_volumes_[t];
         if (fabs(covered_vol-target_ent_volumes_[t])/target_ent_volumes_[t] > voldifftol_) {
           if (onwhat == Entity_kind::CELL)
             std::cerr << "Target cell " << *it << " on rank " << rank_ <<
@@ -342,6 +418,21 @@ class MismatchFixer {
   }
 
 
+  /// @brief Number of owned target entities not covered at all by the
+  ///    source mesh (must be called after check_mismatch)
+  int num_empty() const {
+    assert(computed_mismatch_ && "check_mismatch must be called first!");
+    return nempty_;
+  }
+
+  /// @brief Number of owned target entities partially covered by the
+  ///    source mesh (must be called after check_mismatch)
+  int num_partial() const {
+    assert(computed_mismatch_ && "check_mismatch must be called first!");
+    return npartial_;
+  }
+
+
 
 
   /// @brief Repair the remapped field to account for boundary mismatch
@@ -703,6 +794,7 @@ class MismatchFixer {
   TargetMesh_Wrapper const& target_mesh_;
   TargetState_Wrapper & target_state_;
   int nsourceents_, ntargetents_;
+  int nempty_ = 0, npartial_ = 0;
   std::vector<double> source_ent_volumes_, target_ent_volumes_, xsect_volumes_;
   double source_volume_, target_volume_;
   double global_source_volume_, global_target_volume_, global_xsect_volume_;
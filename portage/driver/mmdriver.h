@@ -36,6 +36,7 @@
 #include "wonton/state/state_vector_multi.h"
 #include "portage/driver/fix_mismatch.h"
 #include "portage/driver/coredriver.h"
+#include "portage/driver/remap_plan.h"
 
 #ifdef PORTAGE_ENABLE_MPI
   #include "portage/distributed/mpi_bounding_boxes.h"
@@ -357,6 +358,103 @@ class MMDriver {
 
 #endif
 
+  /*!
+    @brief Reuse search and intersection results across calls to run()
+    as long as the versions given here do not change. Bump the mesh
+    versions whenever a mesh moves or is modified, and the material
+    version whenever the source volume fractions or centroids change.
+    In distributed runs the source mesh is still redistributed at each
+    run, which is deterministic for unchanged meshes.
+
+    @param source_mesh_version  version of the source mesh
+    @param target_mesh_version  version of the target mesh
+    @param material_version     version of the source material data
+  */
+  void set_mesh_versions(int source_mesh_version, int target_mesh_version,
+                         int material_version = 0) {
+    plan_.set_versions(source_mesh_version, target_mesh_version,
+                       material_version);
+  }
+
+  /// Discard cached search and intersection results
+  void invalidate_plan() { plan_.invalidate(); }
+
+  /// Cached search and intersection results of previous runs
+  RemapPlan<D> const& plan() const { return plan_; }
+
+  /*!
+    @brief Record the time spent in each phase of subsequent runs
+    (redistribution, interface reconstruction, search, intersection,
+    gradient, interpolation, mismatch) along with the number of target
+    entities processed, candidates examined, intersections kept,
+    entities fixed up, bytes sent during redistribution and candidates
+    examined per thread. Counters are accumulated over runs; reset the
+    profiler between runs if needed and call Profiler::to_json to
+    reduce them over ranks.
+
+    @param profiler  profiler to fill in, or nullptr to stop profiling
+  */
+  void set_profiler(Profiler* profiler) { profiler_ = profiler; }
+
+  /*!
+    @brief Choose how the source mesh is redistributed in distributed runs:
+    PARTITION_BOUNDING_BOX (default) sends whole source partitions to the
+    ranks whose target bounding box overlaps them, CELL_BOUNDING_BOX sends
+    only the source cells overlapping the target cells of each rank along
+    with the layer of neighboring cells needed for gradients.
+
+    @param type  redistribution type
+  */
+  void set_redistribution_type(Redistribution_type type) {
+    redistribution_type_ = type;
+#ifdef PORTAGE_ENABLE_MPI
+    distributor_.reset();
+#endif
+  }
+
+  /*!
+    @brief Keep the redistribution of the source mesh from one run of this
+    driver to the next, and only exchange the node coordinates and the
+    fields when the source entities sent to each rank did not change (see
+    MPI_Bounding_Boxes::set_incremental). Meant for source meshes that move
+    without changing their connectivity or partitioning. Must be set on all
+    ranks, and the runs must use the same communicator.
+
+    @param incremental  whether to redistribute incrementally
+  */
+  void set_incremental_redistribution(bool incremental) {
+    incremental_redistribution_ = incremental;
+#ifdef PORTAGE_ENABLE_MPI
+    distributor_.reset();
+#endif
+  }
+
+  /*!
+    @brief Precompute the least-squares gradient stencils of the source
+    cells once and use them for the gradients of all the cell mesh fields
+    (see CoreDriver::set_gradient_stencils). Pays off when many fields
+    are remapped with second order accuracy.
+
+    @param precompute  whether to precompute the stencils
+  */
+  void set_gradient_stencils(bool precompute) {
+    precompute_gradient_stencils_ = precompute;
+  }
+
+  /*!
+    @brief Search, intersect and interpolate the cell mesh fields tile by
+    tile, 'tile_size' target cells at a time (see
+    CoreDriver::remap_mesh_vars_tiled), which bounds the memory of the
+    candidate and moment lists. The moments are only kept, in compressed
+    form, when they are reused by later runs (see set_mesh_versions).
+
+    @param tile_size  target cells per tile, 0 (default) for no tiling
+  */
+  void set_tile_size(int tile_size) {
+    assert(tile_size >= 0);
+    tile_size_ = tile_size;
+  }
+
   /*!
     @brief Get the names of the variables to be remapped from the
     source mesh.
@@ -530,7 +628,8 @@ class MMDriver {
           std::string *errmsg = nullptr) {
     std::string message;
 
-    auto tic = timer::now();
+    auto const remap_tic = timer::now();
+    auto tic = remap_tic;
 
     bool distributed = false;
     int comm_rank = 0;
@@ -560,6 +659,19 @@ class MMDriver {
     std::vector<std::string> src_meshvar_names, src_matvar_names;
     std::vector<std::string> trg_meshvar_names, trg_matvar_names;
 
+    // Without mesh versions, weights from a previous run cannot be trusted
+    if (not plan_.reusable())
+      plan_.invalidate();
+
+    if (profiler_) {
+      profiler_->params.ranks   = nprocs;
+      profiler_->params.threads = num_threads();
+      profiler_->params.dim     = D;
+      profiler_->params.nsource = source_mesh_.num_owned_cells();
+      profiler_->params.ntarget = target_mesh_.num_owned_cells();
+      profiler_->params.nmats   = source_state_.num_materials();
+    }
+
 
     // -------- CELL VARIABLE REMAP ---------
     // Collect all cell based variables and remap them
@@ -600,7 +712,11 @@ class MMDriver {
 
     bool redistributed_source = false;
     if (distributed) {
-      MPI_Bounding_Boxes distributor(mpiexecutor);
+      if (not distributor_ or not incremental_redistribution_) {
+        distributor_.reset(new MPI_Bounding_Boxes(mpiexecutor, redistribution_type_));
+        distributor_->set_incremental(incremental_redistribution_);
+      }
+      MPI_Bounding_Boxes& distributor = *distributor_;
       if (distributor.is_redistribution_needed(source_mesh_, target_mesh_)) {
         tic = timer::now();
         
@@ -613,10 +729,16 @@ class MMDriver {
           source_remap_var_names.push_back(stpair.first);
         source_state_flat.initialize(source_state_, source_remap_var_names);
         
+        long const bytes_before = distributor.bytes_sent();
         distributor.distribute(source_mesh_flat, source_state_flat,
                                target_mesh_, target_state_);
         
         redistributed_source = true;
+
+        if (profiler_) {
+          profiler_->time.redistrib += timer::elapsed(tic);
+          profiler_->count.bytes_sent += distributor.bytes_sent() - bytes_before;
+        }
         
 #ifdef ENABLE_DEBUG
         float tot_seconds_dist = timer::elapsed(tic);
@@ -690,6 +812,9 @@ class MMDriver {
              executor);
     }
 
+    if (profiler_)
+      profiler_->time.remap += timer::elapsed(remap_tic);
+
     return 1;
   }  // run
 
@@ -713,6 +838,26 @@ class MMDriver {
   int max_fixup_iter_ = 5;
   NumericTolerances_t num_tols_ = DEFAULT_NUMERIC_TOLERANCES<D>;
 
+  // Search and intersection results kept across runs
+  RemapPlan<D> plan_;
+
+  // where to record phase timings and counts (if anywhere)
+  Profiler* profiler_ = nullptr;
+
+  // how the source mesh is redistributed in distributed runs
+  Redistribution_type redistribution_type_ = DEFAULT_REDISTRIBUTION_TYPE;
+  bool incremental_redistribution_ = false;
+#ifdef PORTAGE_ENABLE_MPI
+  // kept between runs in incremental mode
+  std::unique_ptr<MPI_Bounding_Boxes> distributor_;
+#endif
+
+  // whether to precompute the least-squares stencils of cell gradients
+  bool precompute_gradient_stencils_ = false;
+
+  // target cells per tile of the mesh field remap (0 for no tiling)
+  int tile_size_ = 0;
+
 
 #ifdef HAVE_TANGRAM
   // The following tolerances as well as the all-convex flag are
@@ -819,37 +964,52 @@ int MMDriver<Search, Intersect, Interpolate, D,
       coredriver_cell(source_mesh2, source_state2, target_mesh_, target_state_, executor);
 
   coredriver_cell.set_num_tols(num_tols_);
+  coredriver_cell.set_profiler(profiler_);
+  coredriver_cell.set_gradient_stencils(precompute_gradient_stencils_);
+  if (tile_size_ > 0)
+    coredriver_cell.set_tile_size(tile_size_);
+  // share the per-cell data of the intersectors between the mesh and
+  // material intersections, and across runs if the plan is reusable
+  coredriver_cell.set_intersection_cache(
+      plan_.reusable() ? plan_.intersection_cache() :
+                         std::make_shared<IntersectionCache<D>>());
 #ifdef HAVE_TANGRAM
   coredriver_cell.set_interface_reconstructor_options(reconstructor_all_convex_,
                                                       reconstructor_tols_);
 #endif  
   
-  // SEARCH
-  auto candidates = coredriver_cell.template search<Portage::SearchKDTree>();
+  int nmats = source_state2.num_materials();
+
+  // SEARCH AND INTERSECT MESHES (unless cached by a previous run)
+  Portage::vector<std::vector<int>> candidates;
+  WeightsCSR weights;
+
+  // tiles are searched, intersected and interpolated in one pass below
+  bool const tiled = tile_size_ > 0 and not plan_.has_weights(CELL);
+
+  if (not plan_.has_weights(CELL) and not tiled) {
+    candidates = coredriver_cell.template search<Portage::SearchKDTree>();
 #ifdef ENABLE_DEBUG
-  tot_seconds_srch = timer::elapsed(tic, true);
+    tot_seconds_srch = timer::elapsed(tic, true);
 #endif
-  int nmats = source_state2.num_materials();
 
-  //--------------------------------------------------------------------
-  // REMAP MESH FIELDS FIRST (this requires just mesh-mesh intersection)
-  //--------------------------------------------------------------------
+    //--------------------------------------------------------------------
+    // REMAP MESH FIELDS FIRST (this requires just mesh-mesh intersection)
+    //--------------------------------------------------------------------
 
-  // INTERSECT MESHES
-  auto source_ents_and_weights =
-      coredriver_cell.template intersect_meshes<Intersect>(candidates);
+    weights = coredriver_cell.template intersect_meshes_csr<Intersect>(candidates);
 #ifdef ENABLE_DEBUG
-  tot_seconds_xsect += timer::elapsed(tic);
+    tot_seconds_xsect += timer::elapsed(tic);
 #endif
-  // check for mesh mismatch
-  coredriver_cell.check_mismatch(source_ents_and_weights);
 
-  // compute bounds (for all variables) if required for mismatch
-  if (coredriver_cell.has_mismatch())
-    compute_bounds<SourceState_Wrapper2, CELL>
-        (source_state2, src_meshvar_names, trg_meshvar_names, executor);
-  
-  // INTERPOLATE (one variable at a time)
+    if (plan_.reusable()) {
+      plan_.store_weights(CELL, std::move(weights));
+      if (nmats > 1)
+        plan_.store_candidates(CELL, std::move(candidates));
+    }
+  }
+
+  // INTERPOLATE (all variables at once)
   int nvars = src_meshvar_names.size();
 #ifdef ENABLE_DEBUG
   tic = timer::now();
@@ -860,7 +1020,6 @@ int MMDriver<Search, Intersect, Interpolate, D,
   }
 #endif
 
-  Portage::vector<Vector<D>> gradients;
   // to check interpolation order
   using Interpolator = Interpolate<D, CELL,
                                    SourceMesh_Wrapper2, TargetMesh_Wrapper,
@@ -868,28 +1027,72 @@ int MMDriver<Search, Intersect, Interpolate, D,
                                    double, InterfaceReconstructorType,
                                    Matpoly_Splitter, Matpoly_Clipper>;
 
+  if (profiler_)
+    profiler_->params.order = Interpolator::order;
 
-  for (int i = 0; i < nvars; ++i) {
-    std::string const& srcvar = src_meshvar_names[i];
-    std::string const& trgvar = trg_meshvar_names[i];
-
-    if (Interpolator::order == 2) {
-      // set slope limiters
-      auto limiter = (limiters_.count(srcvar) ? limiters_[srcvar] : DEFAULT_LIMITER);
-      auto bndlimit = (bnd_limiters_.count(srcvar) ? bnd_limiters_[srcvar] : DEFAULT_BND_LIMITER);
-      // compute gradient field
-      gradients = coredriver_cell.compute_source_gradient(srcvar, limiter, bndlimit);
-      // interpolate
-      coredriver_cell.template interpolate_mesh_var<double, Interpolate>
-        (srcvar, trgvar, source_ents_and_weights, &gradients);
-    } else /* order 1 */ {
-      // just interpolate
-      coredriver_cell.template interpolate_mesh_var<double, Interpolate>
-        (srcvar, trgvar, source_ents_and_weights);
+  std::vector<Portage::vector<Vector<D>>> gradients;
+  if (Interpolator::order == 2) {
+    // set slope limiters
+    std::vector<Limiter_type> limiters(nvars);
+    std::vector<Boundary_Limiter_type> bndlimiters(nvars);
+    for (int i = 0; i < nvars; ++i) {
+      std::string const& srcvar = src_meshvar_names[i];
+      limiters[i] = (limiters_.count(srcvar) ? limiters_[srcvar] : DEFAULT_LIMITER);
+      bndlimiters[i] = (bnd_limiters_.count(srcvar) ? bnd_limiters_[srcvar] : DEFAULT_BND_LIMITER);
     }
+    // compute gradient fields
+    gradients = coredriver_cell.compute_source_gradients(src_meshvar_names,
+                                                         limiters, bndlimiters);
+  }
+  auto* source_gradients = (Interpolator::order == 2 ? &gradients : nullptr);
+
+  if (tiled) {
+    // search, intersect and interpolate all variables tile by tile (with
+    // the tile size set above). The weights are only kept if the plan
+    // reuses them: the mismatch check just needs the intersection volume
+    // of each target cell, summed up tile by tile.
+    std::vector<double> xsect_volumes;
+    weights = coredriver_cell.template remap_mesh_vars_tiled<Portage::SearchKDTree,
+                                                             Intersect,
+                                                             double,
+                                                             Interpolate>
+      (src_meshvar_names, trg_meshvar_names, source_gradients, 0,
+       plan_.reusable(), &xsect_volumes);
+#ifdef ENABLE_DEBUG
+    tot_seconds_xsect += timer::elapsed(tic);
+#endif
+
+    if (plan_.reusable())
+      plan_.store_weights(CELL, std::move(weights));
+
+    // check for mesh mismatch
+    coredriver_cell.check_mismatch_volumes(xsect_volumes);
+  }
+
+  auto const& source_ents_and_weights =
+      plan_.has_weights(CELL) ? plan_.weights(CELL) : weights;
+
+  // check for mesh mismatch
+  if (not tiled)
+    coredriver_cell.check_mismatch(source_ents_and_weights);
+
+  // compute bounds (for all variables) if required for mismatch
+  if (coredriver_cell.has_mismatch())
+    compute_bounds<SourceState_Wrapper2, CELL>
+        (source_state2, src_meshvar_names, trg_meshvar_names, executor);
+
+  // interpolate all variables in one pass over the weights
+  if (not tiled)
+    coredriver_cell.template interpolate_mesh_vars<double, Interpolate>
+      (src_meshvar_names, trg_meshvar_names, source_ents_and_weights,
+       source_gradients);
+
+  // fix mismatch if necessary
+  if (coredriver_cell.has_mismatch()) {
+    for (int i = 0; i < nvars; ++i) {
+      std::string const& srcvar = src_meshvar_names[i];
+      std::string const& trgvar = trg_meshvar_names[i];
 
-    // fix mismatch if necessary
-    if (coredriver_cell.has_mismatch()) {
       coredriver_cell.fix_mismatch(srcvar, trgvar,
                                    double_lower_bounds_[trgvar],
                                    double_upper_bounds_[trgvar],
@@ -910,8 +1113,38 @@ int MMDriver<Search, Intersect, Interpolate, D,
     // REMAP MULTIMATERIAL FIELDS NEXT, ONE MATERIAL AT A TIME
     //--------------------------------------------------------------------
     
-    auto source_ents_and_weights_mat =
+    std::vector<Portage::vector<std::vector<Weights_t>>> weights_by_mat;
+
+#ifdef HAVE_TANGRAM
+    if (plan_.has_material_weights()) {
+      // material polytopes are still needed for gradients and interpolation
+      coredriver_cell.reconstruct_interfaces();
+      plan_.restore_target_materials(target_state_);
+    } else {
+      if (plan_.has_candidates(CELL))
+        weights_by_mat =
+            coredriver_cell.template intersect_materials<Intersect>(plan_.candidates(CELL));
+      else {
+        if (candidates.empty())
+          candidates = coredriver_cell.template search<Portage::SearchKDTree>();
+        weights_by_mat =
+            coredriver_cell.template intersect_materials<Intersect>(candidates);
+      }
+
+      if (plan_.reusable()) {
+        plan_.store_material_weights(std::move(weights_by_mat));
+        plan_.record_target_materials(target_state_);
+      }
+    }
+#else
+    if (candidates.empty())
+      candidates = coredriver_cell.template search<Portage::SearchKDTree>();
+    weights_by_mat =
         coredriver_cell.template intersect_materials<Intersect>(candidates);
+#endif
+
+    auto const& source_ents_and_weights_mat =
+        plan_.has_material_weights() ? plan_.material_weights() : weights_by_mat;
     
     int nmatvars = src_matvar_names.size();
     std::vector<Portage::vector<Vector<D>>> matgradients(nmats);
@@ -1040,27 +1273,39 @@ int MMDriver<Search, Intersect, Interpolate, D,
       coredriver_node(source_mesh2, source_state2, target_mesh_, target_state_, executor);
 
   coredriver_node.set_num_tols(num_tols_);
+  coredriver_node.set_profiler(profiler_);
+  if (plan_.reusable())
+    coredriver_node.set_intersection_cache(plan_.intersection_cache());
 #ifdef HAVE_TANGRAM
   coredriver_node.set_interface_reconstructor_options(reconstructor_all_convex_,
                                                       reconstructor_tols_);
 #endif  
   
-  // SEARCH
+  // SEARCH AND INTERSECT MESHES (unless cached by a previous run)
+  WeightsCSR weights;
 
-  auto candidates = coredriver_node.template search<Portage::SearchKDTree>();
+  if (not plan_.has_weights(NODE)) {
+    auto candidates = coredriver_node.template search<Portage::SearchKDTree>();
 #ifdef ENABLE_DEBUG
-  tot_seconds_srch = timer::elapsed(tic, true);
+    tot_seconds_srch = timer::elapsed(tic, true);
 #endif
-  //--------------------------------------------------------------------
-  // REMAP MESH FIELDS FIRST (this requires just mesh-mesh intersection)
-  //--------------------------------------------------------------------
 
-  // INTERSECT MESHES
-  auto source_ents_and_weights =
-      coredriver_node.template intersect_meshes<Intersect>(candidates);
+    //--------------------------------------------------------------------
+    // REMAP MESH FIELDS FIRST (this requires just mesh-mesh intersection)
+    //--------------------------------------------------------------------
+
+    weights = coredriver_node.template intersect_meshes_csr<Intersect>(candidates);
 #ifdef ENABLE_DEBUG
-  tot_seconds_xsect += timer::elapsed(tic);
+    tot_seconds_xsect += timer::elapsed(tic);
 #endif
+
+    if (plan_.reusable())
+      plan_.store_weights(NODE, std::move(weights));
+  }
+
+  auto const& source_ents_and_weights =
+      plan_.has_weights(NODE) ? plan_.weights(NODE) : weights;
+
   // check for mesh mismatch
   coredriver_node.check_mismatch(source_ents_and_weights);
 
@@ -1069,7 +1314,7 @@ int MMDriver<Search, Intersect, Interpolate, D,
     compute_bounds<SourceState_Wrapper2, NODE>
         (source_state2, src_meshvar_names, trg_meshvar_names, executor);
 
-  // INTERPOLATE (one variable at a time)
+  // INTERPOLATE (all variables at once)
   int nvars = src_meshvar_names.size();
 #ifdef ENABLE_DEBUG
   tic = timer::now();
@@ -1080,7 +1325,6 @@ int MMDriver<Search, Intersect, Interpolate, D,
   }
 #endif
 
-  Portage::vector<Vector<D>> gradients;
   // to check interpolation order
   using Interpolator = Interpolate<D, NODE,
                                    SourceMesh_Wrapper2, TargetMesh_Wrapper,
@@ -1088,27 +1332,33 @@ int MMDriver<Search, Intersect, Interpolate, D,
                                    double, InterfaceReconstructorType,
                                    Matpoly_Splitter, Matpoly_Clipper>;
 
-  for (int i = 0; i < nvars; ++i) {
-    std::string const& srcvar = src_meshvar_names[i];
-    std::string const& trgvar = trg_meshvar_names[i];
-
-    if (Interpolator::order == 2) {
-      // set slope limiters
-      auto limiter = (limiters_.count(srcvar) ? limiters_[srcvar] : DEFAULT_LIMITER);
-      auto bndlimit = (bnd_limiters_.count(srcvar) ? bnd_limiters_[srcvar] : DEFAULT_BND_LIMITER);
-      // compute gradient field
-      gradients = coredriver_node.compute_source_gradient(srcvar, limiter, bndlimit);
-      // interpolate
-      coredriver_node.template interpolate_mesh_var<double, Interpolate>
-        (srcvar, trgvar, source_ents_and_weights, &gradients);
-    } else /* order 1 */ {
-      // just interpolate
-      coredriver_node.template interpolate_mesh_var<double, Interpolate>
-        (srcvar, trgvar, source_ents_and_weights);
+  if (Interpolator::order == 2) {
+    // set slope limiters
+    std::vector<Limiter_type> limiters(nvars);
+    std::vector<Boundary_Limiter_type> bndlimiters(nvars);
+    for (int i = 0; i < nvars; ++i) {
+      std::string const& srcvar = src_meshvar_names[i];
+      limiters[i] = (limiters_.count(srcvar) ? limiters_[srcvar] : DEFAULT_LIMITER);
+      bndlimiters[i] = (bnd_limiters_.count(srcvar) ? bnd_limiters_[srcvar] : DEFAULT_BND_LIMITER);
     }
+    // compute gradient fields
+    auto gradients = coredriver_node.compute_source_gradients(src_meshvar_names,
+                                                              limiters, bndlimiters);
+    // interpolate all variables in one pass over the weights
+    coredriver_node.template interpolate_mesh_vars<double, Interpolate>
+      (src_meshvar_names, trg_meshvar_names, source_ents_and_weights, &gradients);
+  } else /* order 1 */ {
+    // just interpolate
+    coredriver_node.template interpolate_mesh_vars<double, Interpolate>
+      (src_meshvar_names, trg_meshvar_names, source_ents_and_weights);
+  }
+
+  // fix mismatch if necessary
+  if (coredriver_node.has_mismatch()) {
+    for (int i = 0; i < nvars; ++i) {
+      std::string const& srcvar = src_meshvar_names[i];
+      std::string const& trgvar = trg_meshvar_names[i];
 
-    // fix mismatch if necessary
-    if (coredriver_node.has_mismatch()) {
       coredriver_node.fix_mismatch(srcvar, trgvar,
                                    double_lower_bounds_[trgvar],
                                    double_upper_bounds_[trgvar],
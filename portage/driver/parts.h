@@ -20,6 +20,7 @@
 #include <limits>
 
 #include "portage/support/portage.h"
+#include "portage/support/weights_csr.h"
 #include "portage/driver/fix_mismatch.h"
 
 #define DEBUG_PART_BY_PART 0
@@ -328,11 +329,12 @@ public:
   /**
    * @brief Compute source and target parts intersection volume.
    *
-   * @param source_weights: candidate source cells and their intersection moments.
+   * @param source_weights: candidate source cells and their intersection moments,
+   *                        either one list per target cell or compressed.
    * @return the total intersection volume.
    */
-  double compute_intersect_volumes
-    (Portage::vector<entity_weights_t> const& source_weights) {
+  template<class SourceWeights>
+  double compute_intersect_volumes(SourceWeights const& source_weights) {
     // retrieve target entities list
     auto const& target_entities = target_.cells();
 
@@ -340,7 +342,7 @@ public:
     Portage::for_each(target_entities.begin(), target_entities.end(), [&](int t) {
       auto const& i = target_.index(t);
       // accumulate moments
-      entity_weights_t const moments = source_weights[t];
+      auto const& moments = weights_row(source_weights, t);
       intersection_volumes_[i] = 0.;
       for (auto const& current : moments) {
         // matched source cell should be in the source part
@@ -377,10 +379,12 @@ public:
    *
    * WARNING: 'source_ents_and_weights' is a GLOBAL list defined on the entire
    *          target mesh.
-   * @param source... source entities ID and weights for each target entity.
+   * @param source... source entities ID and weights for each target entity,
+   *                  either one list per target entity or compressed.
    * @return true if a mismatch has been identified, false otherwise.
    */
-  bool check_mismatch(Portage::vector<entity_weights_t> const& source_weights) {
+  template<class SourceWeights>
+  bool check_mismatch(SourceWeights const& source_weights) {
 
     // ------------------------------------------
     // COMPUTE VOLUMES ON SOURCE AND TARGET PARTS
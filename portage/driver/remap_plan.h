@@ -0,0 +1,272 @@
+/*
+  This file is part of the Ristra portage project.
+  Please see the license file at the root of this repository, or at:
+  https://github.com/laristra/portage/blob/master/LICENSE
+*/
+
+#ifndef PORTAGE_DRIVER_REMAP_PLAN_H_
+#define PORTAGE_DRIVER_REMAP_PLAN_H_
+
+#include <map>
+#include <string>
+#include <vector>
+#include <utility>
+#include <cassert>
+#include <memory>
+
+#include "portage/support/portage.h"
+#include "portage/support/weights_csr.h"
+#include "portage/intersect/intersection_cache.h"
+#include "wonton/support/Point.h"
+
+/*!
+  @file remap_plan.h
+  @brief Cache of the search and intersection results of a remap so
+  that they can be reused to remap new field values between the same
+  meshes.
+*/
+
+namespace Portage {
+
+using Wonton::Entity_kind;
+using Wonton::Weights_t;
+using Wonton::Point;
+
+/*!
+  @class RemapPlan "remap_plan.h"
+
+  @brief Search candidates, intersection moments and target material
+  layout computed for a pair of meshes.
+
+  Codes that remap many times between the same meshes (or meshes that
+  only change every few cycles) can keep a plan across remaps and
+  redo only the interpolation phase. The plan has no way to detect
+  that a mesh has moved: the caller tells it through set_versions()
+  and every cached result computed for other versions is discarded.
+
+  Mesh intersection moments only depend on the meshes. Material
+  intersection moments also depend on the source material
+  distribution (volume fractions and centroids), so they carry their
+  own version number. Without any call to set_versions, the plan is
+  not reusable and the drivers recompute everything at each remap.
+
+  The plan also keeps the per-cell data that the intersectors derive
+  from the meshes (see IntersectionCache), so that intersecting again
+  for the same mesh versions, e.g. the materials after their
+  distribution changed, does not recompute it.
+
+  @tparam D  dimension of the meshes
+*/
+template<int D>
+class RemapPlan {
+ public:
+
+  /// Default constructor: an empty and non-reusable plan
+  RemapPlan() = default;
+
+  /// Copy constructor (disabled)
+  RemapPlan(const RemapPlan &) = delete;
+
+  /// Assignment operator (disabled)
+  RemapPlan & operator = (const RemapPlan &) = delete;
+
+  /// Enable move semantics
+  RemapPlan(RemapPlan &&) noexcept = default;
+
+  /// Destructor
+  ~RemapPlan() = default;
+
+  /*!
+    @brief Set the versions of the meshes and of the source material
+    distribution being remapped. Cached results are kept only if the
+    versions did not change since the last call.
+
+    @param[in] source_mesh_version  version of the source mesh
+    @param[in] target_mesh_version  version of the target mesh
+    @param[in] material_version     version of the source material data
+  */
+  void set_versions(int source_mesh_version, int target_mesh_version,
+                    int material_version = 0) {
+    if (not reusable_ or
+        source_mesh_version != source_mesh_version_ or
+        target_mesh_version != target_mesh_version_)
+      invalidate();
+    else if (material_version != material_version_)
+      invalidate_materials();
+
+    source_mesh_version_ = source_mesh_version;
+    target_mesh_version_ = target_mesh_version;
+    material_version_ = material_version;
+    reusable_ = true;
+  }
+
+  /// Can cached results be reused across remaps?
+  bool reusable() const { return reusable_; }
+
+  /// Discard all cached results
+  void invalidate() {
+    candidates_.clear();
+    weights_.clear();
+    intersection_cache_.reset();
+    invalidate_materials();
+  }
+
+  /// Discard cached material results only
+  void invalidate_materials() {
+    weights_by_mat_.clear();
+    target_materials_.clear();
+    have_material_weights_ = false;
+  }
+
+  /// Are mesh-mesh intersection moments available for this entity kind?
+  bool has_weights(Entity_kind onwhat) const {
+    return weights_.count(onwhat) > 0;
+  }
+
+  /// Are search candidates available for this entity kind?
+  bool has_candidates(Entity_kind onwhat) const {
+    return candidates_.count(onwhat) > 0;
+  }
+
+  /// Are material intersection moments available?
+  bool has_material_weights() const { return have_material_weights_; }
+
+  /*!
+    @brief Store the search candidates of an entity kind. They are
+    only needed to intersect materials again when the material
+    distribution changes but the meshes do not.
+  */
+  void store_candidates(Entity_kind onwhat,
+                        Portage::vector<std::vector<int>>&& candidates) {
+    candidates_[onwhat] = std::move(candidates);
+  }
+
+  /// Store the mesh-mesh intersection moments of an entity kind
+  void store_weights(Entity_kind onwhat, WeightsCSR&& weights) {
+    weights_[onwhat] = std::move(weights);
+  }
+
+  /// Store the material intersection moments (indexed by source material)
+  void store_material_weights(
+      std::vector<Portage::vector<std::vector<Weights_t>>>&& weights_by_mat) {
+    weights_by_mat_ = std::move(weights_by_mat);
+    have_material_weights_ = true;
+  }
+
+  /// Per-cell data of the intersectors for the current mesh versions
+  std::shared_ptr<IntersectionCache<D>> intersection_cache() {
+    if (not intersection_cache_)
+      intersection_cache_ = std::make_shared<IntersectionCache<D>>();
+    return intersection_cache_;
+  }
+
+  /// Cached search candidates of an entity kind
+  Portage::vector<std::vector<int>> const& candidates(Entity_kind onwhat) const {
+    assert(has_candidates(onwhat));
+    return candidates_.at(onwhat);
+  }
+
+  /// Cached mesh-mesh intersection moments of an entity kind
+  WeightsCSR const& weights(Entity_kind onwhat) const {
+    assert(has_weights(onwhat));
+    return weights_.at(onwhat);
+  }
+
+  /// Cached material intersection moments
+  std::vector<Portage::vector<std::vector<Weights_t>>> const&
+  material_weights() const {
+    assert(have_material_weights_);
+    return weights_by_mat_;
+  }
+
+  /*!
+    @brief Record the materials, material cells, volume fractions and
+    centroids that the material intersection added to the target state,
+    so that a fresh target state can be set up without intersecting
+    again.
+
+    @param[in] target_state  target state after the material intersection
+  */
+  template<class TargetState>
+  void record_target_materials(TargetState const& target_state) {
+    target_materials_.clear();
+    int const nmats = target_state.num_materials();
+    for (int m = 0; m < nmats; m++) {
+      TargetMaterial material;
+      material.name = target_state.material_name(m);
+      target_state.mat_get_cells(m, &material.cells);
+
+      int const nmatcells = material.cells.size();
+      if (nmatcells > 0) {
+        double const* volfracs = nullptr;
+        Point<D> const* centroids = nullptr;
+        target_state.mat_get_celldata("mat_volfracs", m, &volfracs);
+        target_state.mat_get_celldata("mat_centroids", m, &centroids);
+        if (volfracs)
+          material.volfracs.assign(volfracs, volfracs + nmatcells);
+        if (centroids)
+          material.centroids.assign(centroids, centroids + nmatcells);
+      }
+      target_materials_.emplace_back(std::move(material));
+    }
+  }
+
+  /*!
+    @brief Add the recorded materials, material cells, volume fractions
+    and centroids to a target state.
+
+    @param[in,out] target_state  target state to set up
+  */
+  template<class TargetState>
+  void restore_target_materials(TargetState& target_state) const {
+    for (auto const& material : target_materials_) {
+      int const nmatstrg = target_state.num_materials();
+      int m = -1;
+      for (int i = 0; i < nmatstrg; i++)
+        if (target_state.material_name(i) == material.name) {
+          m = i;
+          break;
+        }
+
+      if (m < 0) {
+        target_state.add_material(material.name, material.cells);
+        m = nmatstrg;
+      } else
+        target_state.mat_add_cells(m, material.cells);
+
+      if (not material.volfracs.empty())
+        target_state.mat_add_celldata("mat_volfracs", m,
+                                      material.volfracs.data());
+      if (not material.centroids.empty())
+        target_state.mat_add_celldata("mat_centroids", m,
+                                      material.centroids.data());
+    }
+  }
+
+ private:
+
+  // Material data added to the target state by the material intersection
+  struct TargetMaterial {
+    std::string name;
+    std::vector<int> cells;
+    std::vector<double> volfracs;
+    std::vector<Point<D>> centroids;
+  };
+
+  bool reusable_ = false;
+  int source_mesh_version_ = 0;
+  int target_mesh_version_ = 0;
+  int material_version_ = 0;
+
+  std::map<Entity_kind, Portage::vector<std::vector<int>>> candidates_ {};
+  std::map<Entity_kind, WeightsCSR> weights_ {};
+  std::shared_ptr<IntersectionCache<D>> intersection_cache_ {};
+
+  bool have_material_weights_ = false;
+  std::vector<Portage::vector<std::vector<Weights_t>>> weights_by_mat_ {};
+  std::vector<TargetMaterial> target_materials_ {};
+};
+
+}  // namespace Portage
+
+#endif  // PORTAGE_DRIVER_REMAP_PLAN_H_
@@ -205,4 +205,179 @@ TEST(CellDriver, 3D_2ndOrder) {
 }  // CellDriver_3D_2ndOrder
 
 
+// Remap several linear fields at once with compressed weights and
+// check that the result is the same as remapping them one at a time
+
+TEST(CellDriver, 2D_2ndOrder_MultiVar) {
+  std::shared_ptr<Jali::Mesh> sourceMesh =
+      Jali::MeshFactory(MPI_COMM_WORLD)(0.0, 0.0, 1.0, 1.0, 5, 5);
+  std::shared_ptr<Jali::Mesh> targetMesh =
+      Jali::MeshFactory(MPI_COMM_WORLD)(0.0, 0.0, 1.0, 1.0, 7, 6);
+
+  std::shared_ptr<Jali::State> sourceState = Jali::State::create(sourceMesh);
+  std::shared_ptr<Jali::State> targetState = Jali::State::create(targetMesh);
+
+  Wonton::Jali_Mesh_Wrapper sourceMeshWrapper(*sourceMesh);
+  Wonton::Jali_Mesh_Wrapper targetMeshWrapper(*targetMesh);
+  Wonton::Jali_State_Wrapper sourceStateWrapper(*sourceState);
+  Wonton::Jali_State_Wrapper targetStateWrapper(*targetState);
+
+  int nsrccells = sourceMeshWrapper.num_entities(Wonton::Entity_kind::CELL,
+                                                 Wonton::Entity_type::ALL);
+
+  std::vector<std::string> const srcvars = {"temperature", "density", "energy"};
+  std::vector<std::string> const trgvars = {"temperature", "density", "energy"};
+  std::vector<std::string> const refvars = {"temperature_ref", "density_ref",
+                                            "energy_ref"};
+  int const nvars = srcvars.size();
+
+  for (int i = 0; i < nvars; i++) {
+    std::vector<double> srcfield(nsrccells);
+    for (int c = 0; c < nsrccells; c++) {
+      Wonton::Point<2> cen;
+      sourceMeshWrapper.cell_centroid(c, &cen);
+      srcfield[c] = (i+1)*cen[0] + 2*cen[1] + i;
+    }
+    sourceStateWrapper.mesh_add_data(Wonton::Entity_kind::CELL,
+                                     srcvars[i], srcfield.data());
+    targetStateWrapper.mesh_add_data<double>(Wonton::Entity_kind::CELL,
+                                             trgvars[i], 0.0);
+    targetStateWrapper.mesh_add_data<double>(Wonton::Entity_kind::CELL,
+                                             refvars[i], 0.0);
+  }
+
+  Portage::CoreDriver<2, Wonton::Entity_kind::CELL,
+                      Wonton::Jali_Mesh_Wrapper, Wonton::Jali_State_Wrapper>
+      d(sourceMeshWrapper, sourceStateWrapper,
+        targetMeshWrapper, targetStateWrapper);
+
+  auto candidates = d.search<Portage::SearchKDTree>();
+  auto srcwts = d.intersect_meshes_csr<Portage::IntersectR2D>(candidates);
+
+  std::vector<Portage::Limiter_type> limiters(nvars, Portage::NOLIMITER);
+  std::vector<Portage::Boundary_Limiter_type> bndlimiters(nvars,
+                                                          Portage::BND_NOLIMITER);
+  auto gradients = d.compute_source_gradients(srcvars, limiters, bndlimiters);
+  d.interpolate_mesh_vars<double, Portage::Interpolate_2ndOrder>(
+    srcvars, trgvars, srcwts, &gradients
+  );
+
+  // reference: one variable at a time
+  for (int i = 0; i < nvars; i++) {
+    auto gradient = d.compute_source_gradient(srcvars[i]);
+    d.interpolate_mesh_var<double, Portage::Interpolate_2ndOrder>(
+      srcvars[i], refvars[i], srcwts, &gradient
+    );
+  }
+
+  int ntrgcells = targetMeshWrapper.num_entities(Wonton::Entity_kind::CELL,
+                                                 Wonton::Entity_type::ALL);
+  for (int i = 0; i < nvars; i++) {
+    double *targetfield, *referencefield;
+    targetStateWrapper.mesh_get_data(Wonton::Entity_kind::CELL, trgvars[i],
+                                     &targetfield);
+    targetStateWrapper.mesh_get_data(Wonton::Entity_kind::CELL, refvars[i],
+                                     &referencefield);
+    for (int c = 0; c < ntrgcells; c++) {
+      Wonton::Point<2> cen;
+      targetMeshWrapper.cell_centroid(c, &cen);
+      double expected = (i+1)*cen[0] + 2*cen[1] + i;
+      ASSERT_NEAR(targetfield[c], expected, 1.0e-10);
+      ASSERT_DOUBLE_EQ(targetfield[c], referencefield[c]);
+    }
+  }
+}  // CellDriver_2D_2ndOrder_MultiVar
+
+
+// Remap tile by tile with tiles that do not divide the number of
+// target cells and check that the result and the retained weights are
+// the same as with the whole-mesh search, intersection and interpolation
+
+TEST(CellDriver, 2D_2ndOrder_Tiled) {
+  std::shared_ptr<Jali::Mesh> sourceMesh =
+      Jali::MeshFactory(MPI_COMM_WORLD)(0.0, 0.0, 1.0, 1.0, 5, 5);
+  std::shared_ptr<Jali::Mesh> targetMesh =
+      Jali::MeshFactory(MPI_COMM_WORLD)(0.0, 0.0, 1.0, 1.0, 7, 6);
+
+  std::shared_ptr<Jali::State> sourceState = Jali::State::create(sourceMesh);
+  std::shared_ptr<Jali::State> targetState = Jali::State::create(targetMesh);
+
+  Wonton::Jali_Mesh_Wrapper sourceMeshWrapper(*sourceMesh);
+  Wonton::Jali_Mesh_Wrapper targetMeshWrapper(*targetMesh);
+  Wonton::Jali_State_Wrapper sourceStateWrapper(*sourceState);
+  Wonton::Jali_State_Wrapper targetStateWrapper(*targetState);
+
+  int nsrccells = sourceMeshWrapper.num_entities(Wonton::Entity_kind::CELL,
+                                                 Wonton::Entity_type::ALL);
+  std::vector<double> srcfield(nsrccells);
+  for (int c = 0; c < nsrccells; c++) {
+    Wonton::Point<2> cen;
+    sourceMeshWrapper.cell_centroid(c, &cen);
+    srcfield[c] = cen[0] + 2*cen[1];
+  }
+  sourceStateWrapper.mesh_add_data(Wonton::Entity_kind::CELL,
+                                   "temperature", srcfield.data());
+  targetStateWrapper.mesh_add_data<double>(Wonton::Entity_kind::CELL,
+                                           "temperature", 0.0);
+  targetStateWrapper.mesh_add_data<double>(Wonton::Entity_kind::CELL,
+                                           "temperature_ref", 0.0);
+
+  Portage::CoreDriver<2, Wonton::Entity_kind::CELL,
+                      Wonton::Jali_Mesh_Wrapper, Wonton::Jali_State_Wrapper>
+      d(sourceMeshWrapper, sourceStateWrapper,
+        targetMeshWrapper, targetStateWrapper);
+
+  std::vector<Portage::vector<Wonton::Vector<2>>> gradients =
+      {d.compute_source_gradient("temperature")};
+
+  auto srcwts = d.remap_mesh_vars_tiled<Portage::SearchKDTree,
+                                        Portage::IntersectR2D,
+                                        double,
+                                        Portage::Interpolate_2ndOrder>(
+    {"temperature"}, {"temperature"}, &gradients, 5, true
+  );
+
+  // reference: whole mesh at once
+  auto candidates = d.search<Portage::SearchKDTree>();
+  auto refwts = d.intersect_meshes_csr<Portage::IntersectR2D>(candidates);
+  d.interpolate_mesh_var<double, Portage::Interpolate_2ndOrder>(
+    "temperature", "temperature_ref", refwts, &gradients[0]
+  );
+
+  ASSERT_EQ(srcwts.offsets(), refwts.offsets());
+  ASSERT_EQ(srcwts.entities(), refwts.entities());
+
+  double *targetfield, *referencefield;
+  targetStateWrapper.mesh_get_data(Wonton::Entity_kind::CELL, "temperature",
+                                   &targetfield);
+  targetStateWrapper.mesh_get_data(Wonton::Entity_kind::CELL, "temperature_ref",
+                                   &referencefield);
+
+  int ntrgcells = targetMeshWrapper.num_entities(Wonton::Entity_kind::CELL,
+                                                 Wonton::Entity_type::ALL);
+  for (int c = 0; c < ntrgcells; c++)
+    ASSERT_DOUBLE_EQ(targetfield[c], referencefield[c]);
+
+  // without keeping the weights, the intersection volumes are enough
+  // to check for mismatch
+  std::vector<double> xsect_volumes;
+  auto nowts = d.remap_mesh_vars_tiled<Portage::SearchKDTree,
+                                       Portage::IntersectR2D,
+                                       double,
+                                       Portage::Interpolate_2ndOrder>(
+    {"temperature"}, {"temperature"}, &gradients, 5, false, &xsect_volumes
+  );
+
+  ASSERT_TRUE(nowts.empty());
+  ASSERT_EQ(static_cast<int>(xsect_volumes.size()), refwts.size());
+  for (int c = 0; c < refwts.size(); c++) {
+    double volume = 0.;
+    for (auto const& entry : refwts[c])
+      volume += entry.weights[0];
+    ASSERT_NEAR(xsect_volumes[c], volume, 1.e-15);
+  }
+  ASSERT_FALSE(d.check_mismatch_volumes(xsect_volumes));
+}  // CellDriver_2D_2ndOrder_Tiled
+
+
 #endif  // ifdef HAVE_TANGRAM
@@ -317,3 +317,105 @@ TEST(Test_MultiVar_Remap, Nested_Meshes) {
 
 
 }
+
+
+// Remap the cell fields tile by tile, with tiles that do not divide the
+// number of target cells, and compare with the untiled remap
+
+TEST(Test_MultiVar_Remap, Tiled) {
+  Jali::MeshFactory mf(MPI_COMM_WORLD);
+  if (Jali::framework_available(Jali::MSTK))
+    mf.framework(Jali::MSTK);
+  std::shared_ptr<Jali::Mesh> source_mesh = mf(0.0, 0.0, 1.0, 1.0, 5, 5);
+  std::shared_ptr<Jali::Mesh> target_mesh = mf(0.0, 0.0, 1.0, 1.0, 7, 6);
+
+  const int ncells_source =
+      source_mesh->num_entities(Jali::Entity_kind::CELL,
+                                Jali::Entity_type::PARALLEL_OWNED);
+  const int ncells_target =
+      target_mesh->num_entities(Jali::Entity_kind::CELL,
+                                Jali::Entity_type::PARALLEL_OWNED);
+
+  std::shared_ptr<Jali::State> source_state(Jali::State::create(source_mesh));
+  std::shared_ptr<Jali::State> target_state(Jali::State::create(target_mesh));
+
+  // Two linear fields on source cells
+
+  Jali::UniStateVector<double> sourcevec1("cellvars1", source_mesh, nullptr,
+                                          Jali::Entity_kind::CELL,
+                                          Jali::Entity_type::PARALLEL_OWNED);
+  Jali::UniStateVector<double> sourcevec2("cellvars2", source_mesh, nullptr,
+                                          Jali::Entity_kind::CELL,
+                                          Jali::Entity_type::PARALLEL_OWNED);
+  for (int c = 0; c < ncells_source; ++c) {
+    JaliGeometry::Point ccen = source_mesh->cell_centroid(c);
+    sourcevec1[c] = ccen[0] + 2*ccen[1];
+    sourcevec2[c] = 3 - ccen[0];
+  }
+  source_state->add(sourcevec1);
+  source_state->add(sourcevec2);
+
+  std::vector<std::string> target_var_names =
+      {"cellvars1", "cellvars2", "cellvars1_ref", "cellvars2_ref"};
+  for (auto const& name : target_var_names)
+    target_state->add<double, Jali::Mesh, Jali::UniStateVector>(name,
+                                  target_mesh,
+                                  Jali::Entity_kind::CELL,
+                                  Jali::Entity_type::PARALLEL_OWNED);
+
+  Wonton::Jali_Mesh_Wrapper sourceMeshWrapper(*source_mesh);
+  Wonton::Jali_Mesh_Wrapper targetMeshWrapper(*target_mesh);
+  Wonton::Jali_State_Wrapper sourceStateWrapper(*source_state);
+  Wonton::Jali_State_Wrapper targetStateWrapper(*target_state);
+
+  std::vector<std::string> source_var_names = {"cellvars1", "cellvars2"};
+
+  // Reference: whole mesh at once
+
+  Portage::MMDriver<Portage::SearchKDTree,
+                  Portage::IntersectR2D,
+                  Portage::Interpolate_2ndOrder,
+                  2,
+                  Wonton::Jali_Mesh_Wrapper,
+                  Wonton::Jali_State_Wrapper> remapper1(sourceMeshWrapper,
+                                                         sourceStateWrapper,
+                                                         targetMeshWrapper,
+                                                         targetStateWrapper);
+  remapper1.set_remap_var_names(source_var_names,
+                                {"cellvars1_ref", "cellvars2_ref"});
+  remapper1.set_limiter(Portage::NOLIMITER);
+  remapper1.set_bnd_limiter(Portage::BND_NOLIMITER);
+  remapper1.run();
+
+  // Tiles of 4 target cells
+
+  Portage::MMDriver<Portage::SearchKDTree,
+                  Portage::IntersectR2D,
+                  Portage::Interpolate_2ndOrder,
+                  2,
+                  Wonton::Jali_Mesh_Wrapper,
+                  Wonton::Jali_State_Wrapper> remapper2(sourceMeshWrapper,
+                                                         sourceStateWrapper,
+                                                         targetMeshWrapper,
+                                                         targetStateWrapper);
+  remapper2.set_remap_var_names(source_var_names,
+                                {"cellvars1", "cellvars2"});
+  remapper2.set_limiter(Portage::NOLIMITER);
+  remapper2.set_bnd_limiter(Portage::BND_NOLIMITER);
+  remapper2.set_tile_size(4);
+  remapper2.run();
+
+  double *tiled1, *tiled2, *ref1, *ref2;
+  targetStateWrapper.mesh_get_data(Portage::Entity_kind::CELL, "cellvars1", &tiled1);
+  targetStateWrapper.mesh_get_data(Portage::Entity_kind::CELL, "cellvars2", &tiled2);
+  targetStateWrapper.mesh_get_data(Portage::Entity_kind::CELL, "cellvars1_ref", &ref1);
+  targetStateWrapper.mesh_get_data(Portage::Entity_kind::CELL, "cellvars2_ref", &ref2);
+
+  for (int c = 0; c < ncells_target; c++) {
+    JaliGeometry::Point ccen = target_mesh->cell_centroid(c);
+    ASSERT_NEAR(ccen[0] + 2*ccen[1], tiled1[c], TOL);
+    ASSERT_NEAR(3 - ccen[0], tiled2[c], TOL);
+    ASSERT_DOUBLE_EQ(ref1[c], tiled1[c]);
+    ASSERT_DOUBLE_EQ(ref2[c], tiled2[c]);
+  }
+}
@@ -74,7 +74,7 @@ public:
   void set_smoothing_lengths(const int* n, double h, WeightCenter center = Gather) {
     assert(n != nullptr);
     std::vector<std::vector<double>> const default_lengths(n[1], std::vector<double>(n[2], h));
-    smoothing_lengths_.resize(n[0], default_lengths);
+    smoothing_lengths_ = SmoothingLengths(n[0], default_lengths);
     center_ = center;
   }
 
@@ -154,7 +154,7 @@ protected:
   SwarmState<dim> target_state;
 
   // smoothing lengths matrix and weight center type
-  Portage::vector<std::vector<std::vector<double>>> smoothing_lengths_ {};
+  SmoothingLengths smoothing_lengths_ {};
   WeightCenter center_ = Gather;
 };
 
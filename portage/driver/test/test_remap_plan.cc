@@ -0,0 +1,73 @@
+/*
+This file is part of the Ristra portage project.
+Please see the license file at the root of this repository, or at:
+    https://github.com/laristra/portage/blob/master/LICENSE
+*/
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "portage/driver/remap_plan.h"
+
+namespace {
+
+// some mesh-mesh intersection moments for two target cells
+Portage::WeightsCSR dummy_weights() {
+  Portage::WeightsCSR weights;
+  weights.append({Wonton::Weights_t(0, {0.5})});
+  weights.append({Wonton::Weights_t(1, {0.25})});
+  return weights;
+}
+
+// same moments, one list per target cell
+Portage::vector<std::vector<Wonton::Weights_t>> dummy_mat_weights() {
+  return dummy_weights().to_vector();
+}
+
+}  // namespace
+
+TEST(RemapPlan, NotReusableByDefault) {
+  Portage::RemapPlan<2> plan;
+  ASSERT_FALSE(plan.reusable());
+  ASSERT_FALSE(plan.has_weights(Wonton::CELL));
+  ASSERT_FALSE(plan.has_material_weights());
+}
+
+TEST(RemapPlan, KeepWeightsForSameVersions) {
+  Portage::RemapPlan<2> plan;
+  plan.set_versions(1, 1);
+  plan.store_weights(Wonton::CELL, dummy_weights());
+  ASSERT_TRUE(plan.has_weights(Wonton::CELL));
+  ASSERT_FALSE(plan.has_weights(Wonton::NODE));
+
+  // same versions: the weights are kept
+  plan.set_versions(1, 1);
+  ASSERT_TRUE(plan.reusable());
+  ASSERT_TRUE(plan.has_weights(Wonton::CELL));
+  ASSERT_EQ(plan.weights(Wonton::CELL).size(), 2);
+  auto const& sw = plan.weights(Wonton::CELL)[1];
+  ASSERT_EQ(sw[0].entityID, 1);
+  ASSERT_DOUBLE_EQ(sw[0].weights[0], 0.25);
+
+  // target mesh moved: everything is discarded
+  plan.set_versions(1, 2);
+  ASSERT_FALSE(plan.has_weights(Wonton::CELL));
+}
+
+TEST(RemapPlan, MaterialVersion) {
+  Portage::RemapPlan<2> plan;
+  plan.set_versions(0, 0, 0);
+  plan.store_weights(Wonton::CELL, dummy_weights());
+  plan.store_material_weights({dummy_mat_weights(), dummy_mat_weights()});
+  ASSERT_TRUE(plan.has_material_weights());
+  ASSERT_EQ(plan.material_weights().size(), 2);
+
+  // materials changed but not the meshes
+  plan.set_versions(0, 0, 1);
+  ASSERT_TRUE(plan.has_weights(Wonton::CELL));
+  ASSERT_FALSE(plan.has_material_weights());
+
+  plan.invalidate();
+  ASSERT_FALSE(plan.has_weights(Wonton::CELL));
+}
@@ -0,0 +1,132 @@
+/*
+This file is part of the Ristra portage project.
+Please see the license file at the root of this repository, or at:
+    https://github.com/laristra/portage/blob/master/LICENSE
+*/
+
+#include <vector>
+#include <random>
+#include <unordered_set>
+#include <algorithm>
+
+#include "gtest/gtest.h"
+#include "mpi.h"
+
+#include "portage/support/portage.h"
+#include "portage/driver/fix_mismatch.h"
+
+// Only the global ids of the entities matter to get_unique_entity_masks
+
+struct GidMesh {
+  std::vector<Wonton::GID_t> gids;
+
+  int num_owned_cells() const { return gids.size(); }
+  int num_owned_nodes() const { return gids.size(); }
+  Wonton::GID_t get_global_id(int e, Wonton::Entity_kind) const {
+    return gids[e];
+  }
+};
+
+// Mask of the entities not seen on a lower rank or earlier on this rank,
+// found by gathering all the global ids on every rank. A single rank
+// keeps all its entities.
+
+std::vector<int> reference_masks(GidMesh const& mesh, MPI_Comm comm) {
+  int rank, nprocs;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &nprocs);
+
+  int const nents = mesh.gids.size();
+  if (nprocs == 1)
+    return std::vector<int>(nents, 1);
+
+  std::vector<int> counts(nprocs), offsets(nprocs, 0);
+  MPI_Allgather(&nents, 1, MPI_INT, counts.data(), 1, MPI_INT, comm);
+  for (int p = 1; p < nprocs; p++)
+    offsets[p] = offsets[p-1] + counts[p-1];
+
+  std::vector<Wonton::GID_t> all(offsets[nprocs-1] + counts[nprocs-1]);
+  MPI_Allgatherv(mesh.gids.data(), nents,
+                 Wonton::to_MPI_Datatype<Wonton::GID_t>(),
+                 all.data(), counts.data(), offsets.data(),
+                 Wonton::to_MPI_Datatype<Wonton::GID_t>(), comm);
+
+  std::unordered_set<Wonton::GID_t> seen(all.begin(), all.begin() + offsets[rank]);
+  std::vector<int> mask(nents);
+  for (int e = 0; e < nents; e++)
+    mask[e] = seen.insert(mesh.gids[e]).second ? 1 : 0;
+  return mask;
+}
+
+
+// Consecutive ranks share half of their cells, and each rank lists some
+// of its cells twice: every global id must be kept exactly once, by the
+// lowest rank having it
+TEST(UniqueEntityMasks, SharedGids) {
+  int rank, nprocs;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nprocs);
+
+  int const width = 20;
+  GidMesh mesh;
+  for (int i = 0; i < width; i++)
+    mesh.gids.push_back(rank * width/2 + i);
+  for (int i = 0; i < width; i += 7)
+    mesh.gids.push_back(rank * width/2 + i);   // repeated on this rank
+  std::reverse(mesh.gids.begin(), mesh.gids.end());
+
+  std::vector<int> mask;
+  Portage::get_unique_entity_masks<Wonton::Entity_kind::CELL>(mesh, &mask,
+                                                              MPI_COMM_WORLD);
+  ASSERT_EQ(mesh.gids.size(), mask.size());
+  ASSERT_EQ(reference_masks(mesh, MPI_COMM_WORLD), mask);
+  if (nprocs == 1)
+    return;
+
+  // count the instances kept for each global id over all ranks
+  int const ngids = (nprocs + 1) * width/2;
+  std::vector<int> kept(ngids, 0), lowest(ngids, nprocs);
+  for (unsigned e = 0; e < mask.size(); e++) {
+    kept[mesh.gids[e]] += mask[e];
+    lowest[mesh.gids[e]] = rank;
+  }
+  std::vector<int> owner(ngids, -1);
+  for (unsigned e = 0; e < mask.size(); e++)
+    if (mask[e])
+      owner[mesh.gids[e]] = rank;
+
+  MPI_Allreduce(MPI_IN_PLACE, kept.data(), ngids, MPI_INT, MPI_SUM,
+                MPI_COMM_WORLD);
+  MPI_Allreduce(MPI_IN_PLACE, lowest.data(), ngids, MPI_INT, MPI_MIN,
+                MPI_COMM_WORLD);
+  MPI_Allreduce(MPI_IN_PLACE, owner.data(), ngids, MPI_INT, MPI_MAX,
+                MPI_COMM_WORLD);
+
+  for (int g = 0; g < ngids; g++) {
+    ASSERT_EQ(1, kept[g]);
+    ASSERT_EQ(lowest[g], owner[g]);
+  }
+}
+
+
+// Random global ids, some of them negative and some ranks without any
+// entity: same masks as when all the global ids are gathered
+TEST(UniqueEntityMasks, RandomGids) {
+  int rank, nprocs;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nprocs);
+
+  for (int trial = 0; trial < 10; trial++) {
+    std::mt19937 random(100 * trial + rank);
+    GidMesh mesh;
+    int const nents = (rank + trial) % 3 == 0 ? 0 : random() % 200;
+    for (int e = 0; e < nents; e++)
+      mesh.gids.push_back(static_cast<Wonton::GID_t>(random() % 300) -
+                          (trial % 2 ? 50 : 0));
+
+    std::vector<int> mask;
+    Portage::get_unique_entity_masks<Wonton::Entity_kind::NODE>(mesh, &mask,
+                                                                MPI_COMM_WORLD);
+    ASSERT_EQ(reference_masks(mesh, MPI_COMM_WORLD), mask);
+  }
+}
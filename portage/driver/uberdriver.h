@@ -39,6 +39,7 @@
 #include "wonton/support/Point.h"
 #include "wonton/state/state_vector_multi.h"
 #include "portage/driver/coredriver.h"
+#include "portage/driver/remap_plan.h"
 
 
 #ifdef PORTAGE_ENABLE_MPI
@@ -272,8 +273,33 @@ class UberDriver {
   }
 
 
+  /*!
+    @brief Keep interpolation weights across calls to
+    compute_interpolation_weights as long as the versions given here do
+    not change. Bump the mesh versions whenever a mesh moves or is
+    modified, and the material version whenever the source volume
+    fractions or centroids change.
+
+    @param source_mesh_version  version of the source mesh
+    @param target_mesh_version  version of the target mesh
+    @param material_version     version of the source material data
+  */
+  void set_mesh_versions(int source_mesh_version, int target_mesh_version,
+                         int material_version = 0) {
+    plan_.set_versions(source_mesh_version, target_mesh_version,
+                       material_version);
+  }
+
+  /// Discard cached interpolation weights
+  void invalidate_plan() { plan_.invalidate(); }
+
+  /// Interpolation weights computed so far
+  RemapPlan<D> const& plan() const { return plan_; }
+
+
   /*! @brief Compute interpolation weights in advance of actual
-    interpolation of variables
+    interpolation of variables. If mesh versions were set, weights
+    computed by a previous call for the same versions are reused.
 
     @tparam Search A search method that takes the dimension, source
     mesh class and target mesh class as template parameters
@@ -290,34 +316,71 @@ class UberDriver {
     >
   void compute_interpolation_weights() {
 
+    // Without mesh versions, weights from a previous call cannot be trusted
+    if (not plan_.reusable())
+      plan_.invalidate();
+
+    // share the per-cell data of the intersectors between the mesh and
+    // material intersections, and across calls if the plan is reusable
+    auto intersection_cache = plan_.reusable() ? plan_.intersection_cache() :
+        std::make_shared<IntersectionCache<D>>();
+    for (Entity_kind onwhat : entity_kinds_) {
+      switch (onwhat) {
+        case CELL:
+          core_driver_serial_[CELL]->template set_intersection_cache<CELL>(
+              intersection_cache); break;
+        case NODE:
+          core_driver_serial_[NODE]->template set_intersection_cache<NODE>(
+              intersection_cache); break;
+        default:
+          std::cerr << "Cannot remap on " << to_string(onwhat) << "\n";
+      }
+    }
+
     Portage::vector<std::vector<int>> intersection_candidates;
     
     for (Entity_kind onwhat : entity_kinds_) {
       switch (onwhat) {
         case CELL: {
-          // find intersection candidates
-          intersection_candidates = search<CELL, Search>();
-
-          // Compute moments of intersection
-          source_weights_[onwhat] =
-              intersect_meshes<CELL, Intersect>(intersection_candidates);
+          if (not plan_.has_weights(CELL)) {
+            // find intersection candidates
+            intersection_candidates = search<CELL, Search>();
+
+            // Compute moments of intersection
+            plan_.store_weights(CELL,
+                                intersect_meshes<CELL, Intersect>(intersection_candidates));
+
+            // keep candidates to intersect materials again if only
+            // the material distribution changes
+            if (have_multi_material_fields_ and plan_.reusable())
+              plan_.store_candidates(CELL, std::move(intersection_candidates));
+          }
 
-          if (have_multi_material_fields_) {
+          if (have_multi_material_fields_ and
+              not plan_.has_material_weights()) {
             mat_intersection_completed_ = true;
-            
-            source_weights_by_mat_ =
-                intersect_materials<Intersect>(intersection_candidates);
+
+            if (plan_.has_candidates(CELL))
+              plan_.store_material_weights(
+                  intersect_materials<Intersect>(plan_.candidates(CELL)));
+            else {
+              if (intersection_candidates.empty())
+                intersection_candidates = search<CELL, Search>();
+              plan_.store_material_weights(
+                  intersect_materials<Intersect>(intersection_candidates));
+            }
           }
           break;
         }
         case NODE: {
-          // find intersection candidates
-          intersection_candidates = search<NODE, Search>();
-
-          // Compute moments of intersection
-          source_weights_[onwhat] =
-              intersect_meshes<NODE, Intersect>(intersection_candidates);
+          if (not plan_.has_weights(NODE)) {
+            // find intersection candidates
+            intersection_candidates = search<NODE, Search>();
 
+            // Compute moments of intersection
+            plan_.store_weights(NODE,
+                                intersect_meshes<NODE, Intersect>(intersection_candidates));
+          }
           break;
         }
         default:
@@ -377,6 +440,26 @@ class UberDriver {
     }
   }
 
+  /*!
+    @brief Accumulate the time spent in each phase and the related
+    counts into a profiler
+
+    @param profiler     profiler to fill in (nullptr to stop profiling)
+  */
+  void set_profiler(Profiler* profiler) {
+    for (Entity_kind onwhat : entity_kinds_) {
+      switch (onwhat) {
+        case CELL:
+          core_driver_serial_[CELL]->template set_profiler<CELL>(profiler); break;
+        case NODE:
+          core_driver_serial_[NODE]->template set_profiler<NODE>(profiler); break;
+        default:
+          std::cerr << "Cannot remap on " << to_string(onwhat) << "\n";
+
+      }
+    }
+  }
+
   /*!
     @brief search for candidate source entities whose control volumes
      (cells, dual cells) overlap the control volumes of target cells
@@ -411,7 +494,7 @@ class UberDriver {
 
      @param[in] candidates Intersection candidates for each target cell
 
-     @returns             vector of weights for each target cell
+     @returns             compressed weights of all target cells
   */
 
   template<
@@ -420,11 +503,11 @@ class UberDriver {
               template <class, int, class, class> class,
               class, class> class Intersect
     >
-  Portage::vector<std::vector<Portage::Weights_t>>         // return type
+  WeightsCSR         // return type
   intersect_meshes(Portage::vector<std::vector<int>> const& candidates) {
 
 
-    const auto& weights = core_driver_serial_[ONWHAT]->template intersect_meshes<ONWHAT, Intersect>(candidates);
+    auto weights = core_driver_serial_[ONWHAT]->template intersect_meshes_csr<ONWHAT, Intersect>(candidates);
     
     // Check the mesh mismatch once, to make sure the mismatch is cached
     // prior to interpolation with fixup. This is the correct place to automatically do the
@@ -608,7 +691,7 @@ class UberDriver {
       assert(ONWHAT == CELL);
       
       interpolate_mat_var<T, Interpolate>
-          (srcvarname, trgvarname, source_weights_by_mat_,
+          (srcvarname, trgvarname, plan_.material_weights(),
            lower_bound, upper_bound, limiter, bnd_limiter, partial_fixup_type,
            empty_fixup_type, conservation_tol, max_fixup_iter);
 #endif
@@ -618,7 +701,7 @@ class UberDriver {
       assert(mesh_intersection_completed_[ONWHAT]);
       
       interpolate_mesh_var<T, ONWHAT, Interpolate>
-          (srcvarname, trgvarname, source_weights_[ONWHAT],
+          (srcvarname, trgvarname, plan_.weights(ONWHAT),
            lower_bound, upper_bound, limiter, bnd_limiter, partial_fixup_type,
            empty_fixup_type, conservation_tol, max_fixup_iter);
     }
@@ -669,10 +752,11 @@ class UberDriver {
            Entity_kind ONWHAT,
            template<int, Entity_kind, class, class, class, class, class,
                     template <class, int, class, class> class,
-                    class, class, class> class Interpolate
+                    class, class, class> class Interpolate,
+           class SourceWeights
            >
   void interpolate_mesh_var(std::string srcvarname, std::string trgvarname,
-                            Portage::vector<std::vector<Weights_t>> const& sources_and_weights_in,
+                            SourceWeights const& sources_and_weights_in,
                             T lower_bound, T upper_bound,
                             Limiter_type limiter,
                             Boundary_Limiter_type bnd_limiter,
@@ -847,34 +931,11 @@ class UberDriver {
   std::map<Entity_kind, std::unique_ptr<SerialDriverType>> core_driver_serial_ {};
 
   // Weights of intersection b/w target entities and source entities
-  // Each intersection is between the control volume (cell, dual cell)
-  // of a target and source entity.
-
-  //  over all entity kinds (CELL, NODE, etc.)
-  //   ||
-  //   ||               for all target entities
-  //   ||                  of a particular kind
-  //   ||                        ||
-  //   ||                        ||     intersection moments list
-  //   ||                        ||     for each target entity
-  //   ||                        ||           ||
-  //   \/                        \/           \/
-  std::map<Entity_kind, Portage::vector<std::vector<Weights_t>>> source_weights_ {};
-
-  // Weights of intersection b/w target CELLS and source material polygons
-  // Each intersection is between a target cell and material polygon in
-  // a source cell for a particular material
-
-  //  for each material
-  //   ||
-  //   ||      for all target entities
-  //   ||         of a particular kind
-  //   ||               ||
-  //   ||               ||     intersection moments for
-  //   ||               ||     each target entity
-  //   ||               ||           ||
-  //   \/               \/           \/
-  std::vector<Portage::vector<std::vector<Weights_t>>> source_weights_by_mat_ {};
+  // for all entity kinds (CELL, NODE, etc.) and weights of
+  // intersection b/w target CELLS and source material polygons for
+  // each material. Each intersection is between the control volume
+  // (cell, dual cell) of a target and source entity.
+  RemapPlan<D> plan_;
 
   /*!
     @brief Instantiate core drivers that abstract away whether we
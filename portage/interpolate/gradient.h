@@ -8,6 +8,7 @@
 #define PORTAGE_INTERPOLATE_GRADIENT_H_
 
 #include <algorithm>
+#include <cmath>
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -15,6 +16,7 @@
 
 #include "portage/support/portage.h"
 #include "portage/intersect/dummy_interface_reconstructor.h"
+#include "portage/intersect/material_moments.h"
 #include "portage/driver/fix_mismatch.h"
 #include "portage/driver/parts.h"
 
@@ -264,6 +266,17 @@ namespace Portage {
     }
 #endif
 
+#ifdef HAVE_TANGRAM
+    /*!
+      @brief Use precomputed material volumes and centroids instead of
+      summing the moments of the material polytopes of the neighbors.
+      @param[in] moments material moments (not owned), nullptr to not use them
+    */
+    void set_material_moments(MaterialMoments<D> const* moments) {
+      material_moments_ = moments;
+    }
+#endif
+
     //This method should be called by the user if the field type is MULTIMATERIAL_FIELD.
     //As the constructor with interface reconstructor only sets the variable name
     //for such fields, this method is needed to properly set the multimaterial data local
@@ -291,6 +304,91 @@ namespace Portage {
       }
     }
 
+    /*!
+      @brief Precompute the least-squares gradient stencil of each owned cell.
+
+      The least-squares system of a cell only depends on the centroids of
+      the cell and its neighbors, so its pseudo-inverse (A^T A)^-1 A^T is
+      computed once here and stored in flat arrays along with the offsets
+      of the cell nodes to its centroid. The gradient of any mesh field is
+      then the sparse product of these weights with the field differences,
+      followed by the limiter. Material fields still use the per-field fit.
+      Worth it when the gradients of several fields are computed.
+    */
+    void precompute_stencils() {
+
+      int const nb_cells = cell_neighbors_.size();
+      int const nb_all_cells = mesh_.num_entities(Entity_kind::CELL,
+                                                  Entity_type::ALL);
+
+      std::vector<Point<D>> centroids(nb_all_cells);
+      Portage::for_each(make_counting_iterator(0),
+                        make_counting_iterator(nb_all_cells),
+                        [&](int c) { mesh_.cell_centroid(c, &centroids[c]); });
+
+      // count the neighbors and the nodes of each cell then scan
+      stencil_offsets_.assign(nb_cells + 1, 0);
+      stencil_node_offsets_.assign(nb_cells + 1, 0);
+      Portage::for_each(make_counting_iterator(0),
+                        make_counting_iterator(nb_cells),
+                        [&](int c) {
+                          std::vector<int> nodes;
+                          mesh_.cell_get_nodes(c, &nodes);
+                          stencil_offsets_[c + 1] = cell_neighbors_[c].size();
+                          stencil_node_offsets_[c + 1] = nodes.size();
+                        });
+
+      for (int c = 0; c < nb_cells; c++) {
+        stencil_offsets_[c + 1] += stencil_offsets_[c];
+        stencil_node_offsets_[c + 1] += stencil_node_offsets_[c];
+      }
+
+      stencil_cells_.resize(stencil_offsets_[nb_cells]);
+      stencil_weights_.resize(stencil_offsets_[nb_cells]);
+      stencil_node_vectors_.resize(stencil_node_offsets_[nb_cells]);
+
+      Portage::for_each(make_counting_iterator(0),
+                        make_counting_iterator(nb_cells),
+                        [&](int c) {
+        Point<D> const& center = centroids[c];
+        int const first = stencil_offsets_[c];
+        int const count = stencil_offsets_[c + 1] - first;
+
+        // normal matrix A^T A of the least-squares system
+        double normal[D][D] = {};
+        for (int i = 0; i < count; i++) {
+          int const neighbor = cell_neighbors_[c][i];
+          Vector<D> const row = centroids[neighbor] - center;
+          for (int j = 0; j < D; j++)
+            for (int k = 0; k < D; k++)
+              normal[j][k] += row[j] * row[k];
+          stencil_cells_[first + i] = neighbor;
+        }
+
+        // weights (A^T A)^-1 A^T, zero if the system is singular
+        double inverse[D][D];
+        bool const invertible = invert(normal, inverse);
+        for (int i = 0; i < count; i++) {
+          Vector<D> weight;
+          if (invertible) {
+            Vector<D> const row = centroids[cell_neighbors_[c][i]] - center;
+            for (int j = 0; j < D; j++)
+              for (int k = 0; k < D; k++)
+                weight[j] += inverse[j][k] * row[k];
+            CoordSys::modify_gradient(weight, center);
+          }
+          stencil_weights_[first + i] = weight;
+        }
+
+        // node offsets to the centroid for the limiter
+        std::vector<Point<D>> coords;
+        mesh_.cell_get_coordinates(c, &coords);
+        int const offset = stencil_node_offsets_[c];
+        for (int i = 0; i < static_cast<int>(coords.size()); i++)
+          stencil_node_vectors_[offset + i] = coords[i] - center;
+      });
+    }
+
     // @brief Implementation of Limited_Gradient functor for CELLs
     Vector<D> operator()(int cellid) {
 
@@ -317,6 +415,9 @@ namespace Portage {
         return grad;
       }
 
+      if (field_type_ == Field_type::MESH_FIELD && !stencil_offsets_.empty())
+        return stencil_gradient(cellid, apply_limiter);
+
       // Include cell where grad is needed as first element
       std::vector<int> neighbors{cellid};
 
@@ -344,7 +445,17 @@ namespace Portage {
         // in the case of mesh data, this is always true, since local cellid
         // (neigh_local) is equal to global cellid (neigh_global).
         // nota bene: cell_index_in_material can return -1.
-        if (neigh_local >= 0) {
+        if (neigh_local >= 0 && material_moments_ &&
+            field_type_ == Field_type::MULTIMATERIAL_FIELD) {
+          // Use the centroid of the material in the cell computed once
+          // after interface reconstruction, skipping zero volume polys
+          if (material_moments_->volume(material_id_, neigh_local) == 0.)
+            continue;
+
+          list_coords.push_back(material_moments_->centroid(material_id_,
+                                                            neigh_local));
+          list_values.push_back(values_[neigh_local]);
+        } else if (neigh_local >= 0) {
           std::vector<int> cell_mats;
           state_.cell_get_mats(neigh_global, &cell_mats);
           int const nb_mats = cell_mats.size();
@@ -462,6 +573,88 @@ namespace Portage {
     }
 
   private:
+
+    // Gradient of a mesh field from the precomputed stencil of a cell
+    Vector<D> stencil_gradient(int cellid, bool apply_limiter) const {
+
+      double const cellcenval = values_[cellid];
+      double minval = cellcenval;
+      double maxval = cellcenval;
+
+      Vector<D> grad;
+      int const first = stencil_offsets_[cellid];
+      int const last = stencil_offsets_[cellid + 1];
+      for (int i = first; i < last; i++) {
+        double const value = values_[stencil_cells_[i]];
+        grad += (value - cellcenval) * stencil_weights_[i];
+        minval = std::min(value, minval);
+        maxval = std::max(value, maxval);
+      }
+
+      // Barth-Jespersen limiter, see operator()
+      double phi = 1.0;
+      if (apply_limiter) {
+        int const last_node = stencil_node_offsets_[cellid + 1];
+        for (int i = stencil_node_offsets_[cellid]; i < last_node; i++) {
+          double diff = dot(grad, stencil_node_vectors_[i]);
+          double extremeval = (diff > 0.) ? maxval : minval;
+          double phi_new = (diff == 0. ? 1. : (extremeval - cellcenval) / diff);
+          phi = std::min(phi_new, phi);
+        }
+      }
+
+      return phi * grad;
+    }
+
+    // Invert a small symmetric positive semi-definite matrix by Gauss-Jordan
+    // elimination, return false if it is (numerically) singular
+    static bool invert(double const (&matrix)[D][D], double (&inverse)[D][D]) {
+      double a[D][D];
+      double scale = 0.;
+      for (int i = 0; i < D; i++) {
+        for (int j = 0; j < D; j++) {
+          a[i][j] = matrix[i][j];
+          inverse[i][j] = (i == j ? 1. : 0.);
+        }
+        scale = std::max(scale, std::abs(matrix[i][i]));
+      }
+
+      if (scale == 0.)
+        return false;
+
+      for (int k = 0; k < D; k++) {
+        int pivot = k;
+        for (int i = k + 1; i < D; i++)
+          if (std::abs(a[i][k]) > std::abs(a[pivot][k]))
+            pivot = i;
+
+        if (std::abs(a[pivot][k]) <= 1.e-12 * scale)
+          return false;
+
+        for (int j = 0; j < D; j++) {
+          std::swap(a[k][j], a[pivot][j]);
+          std::swap(inverse[k][j], inverse[pivot][j]);
+        }
+
+        double const diag = a[k][k];
+        for (int j = 0; j < D; j++) {
+          a[k][j] /= diag;
+          inverse[k][j] /= diag;
+        }
+
+        for (int i = 0; i < D; i++) {
+          if (i != k) {
+            double const factor = a[i][k];
+            for (int j = 0; j < D; j++) {
+              a[i][j] -= factor * a[k][j];
+              inverse[i][j] -= factor * inverse[k][j];
+            }
+          }
+        }
+      }
+      return true;
+    }
+
     Mesh const& mesh_;
     State const& state_;
     double const* values_;
@@ -473,8 +666,19 @@ namespace Portage {
     int material_id_ = 0;
     std::vector<int> cell_ids_;
     std::vector<std::vector<int>> cell_neighbors_;
+
+    // precomputed least-squares stencils of the owned cells (CSR layout):
+    // neighbors and weights of cell c are in [stencil_offsets_[c],
+    // stencil_offsets_[c+1]), node offsets to the centroid of cell c are
+    // in [stencil_node_offsets_[c], stencil_node_offsets_[c+1])
+    std::vector<int> stencil_offsets_;
+    std::vector<int> stencil_cells_;
+    std::vector<Vector<D>> stencil_weights_;
+    std::vector<int> stencil_node_offsets_;
+    std::vector<Vector<D>> stencil_node_vectors_;
 #ifdef HAVE_TANGRAM
     std::shared_ptr<InterfaceReconstructor> interface_reconstructor_;
+    MaterialMoments<D> const* material_moments_ = nullptr;
 #endif
     Part<Mesh, State> const* part_;
   };
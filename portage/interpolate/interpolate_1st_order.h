@@ -18,6 +18,7 @@ Please see the license file at the root of this repository, or at:
 // portage includes
 #include "portage/intersect/dummy_interface_reconstructor.h"
 #include "portage/support/portage.h"
+#include "portage/support/weights_csr.h"
 #include "portage/driver/parts.h"
 
 // wonton includes
@@ -352,7 +353,25 @@ class Interpolate_1stOrder<
   */
 
   T operator() (int const targetCellID,
-                     std::vector<Weights_t> const & sources_and_weights) const
+                     std::vector<Weights_t> const & sources_and_weights) const {
+    return interpolate(targetCellID, sources_and_weights);
+  }
+
+  /// Same as above with the entries of a row of compressed weights
+  T operator() (int const targetCellID,
+                WeightsCSR::Row const & sources_and_weights) const {
+    return interpolate(targetCellID, sources_and_weights);
+  }
+
+  constexpr static int order = 1;
+
+ private:
+
+  // Interpolate on a target cell given any list of entries with an
+  // 'entityID' and indexable 'weights'
+  template<class SourceWeights>
+  T interpolate(int const targetCellID,
+                SourceWeights const & sources_and_weights) const
   {
     int nsrccells = sources_and_weights.size();
     if (!nsrccells) return T(0.0);
@@ -367,7 +386,7 @@ class Interpolate_1stOrder<
     if (field_type_ == Field_type::MESH_FIELD) {
       for (auto const& wt : sources_and_weights) {
         int srccell = wt.entityID;
-        std::vector<double> pair_weights = wt.weights;
+        auto const& pair_weights = wt.weights;
         if (fabs(pair_weights[0]) < num_tols_.min_absolute_volume)
           continue;  // skip small intersections
         val += source_vals_[srccell] * pair_weights[0];
@@ -377,7 +396,7 @@ class Interpolate_1stOrder<
     } else if (field_type_ == Field_type::MULTIMATERIAL_FIELD) {
       for (auto const& wt : sources_and_weights) {
         int srccell = wt.entityID;
-        std::vector<double> pair_weights = wt.weights;
+        auto const& pair_weights = wt.weights;
         if (fabs(pair_weights[0]) < num_tols_.min_absolute_volume)
           continue;  // skip small intersections
         int matcell = source_state_.cell_index_in_material(srccell, matid_);
@@ -402,11 +421,8 @@ class Interpolate_1stOrder<
       val *= (1.0/wtsum0);
 
     return val;
-  }  // operator()
-  
-  constexpr static int order = 1;
+  }  // interpolate
 
- private:
   SourceMeshType const & source_mesh_;
   TargetMeshType const & target_mesh_;
   SourceStateType const & source_state_;
@@ -548,7 +564,25 @@ class Interpolate_1stOrder<
   */
 
   T operator() (int const targetNodeID,
-                std::vector<Weights_t> const & sources_and_weights) const
+                std::vector<Weights_t> const & sources_and_weights) const {
+    return interpolate(targetNodeID, sources_and_weights);
+  }
+
+  /// Same as above with the entries of a row of compressed weights
+  T operator() (int const targetNodeID,
+                WeightsCSR::Row const & sources_and_weights) const {
+    return interpolate(targetNodeID, sources_and_weights);
+  }
+
+  constexpr static int order = 1;
+
+ private:
+
+  // Interpolate on a target node given any list of entries with an
+  // 'entityID' and indexable 'weights'
+  template<class SourceWeights>
+  T interpolate(int const targetNodeID,
+                SourceWeights const & sources_and_weights) const
   {
     if (field_type_ != Field_type::MESH_FIELD) return T(0.0);
 
@@ -564,7 +598,7 @@ class Interpolate_1stOrder<
     int nsummed = 0;
     for (auto const& wt : sources_and_weights) {
       int srcnode = wt.entityID;
-      std::vector<double> pair_weights = wt.weights;
+      auto const& pair_weights = wt.weights;
       if (fabs(pair_weights[0]) < num_tols_.min_absolute_volume)
         continue;  // skip small intersections
       val += source_vals_[srcnode] * pair_weights[0];  // 1st order
@@ -587,11 +621,8 @@ class Interpolate_1stOrder<
       val *= (1.0/wtsum0);
 
     return val;
-  }  // operator()
+  }  // interpolate
 
-  constexpr static int order = 1;
-
- private:
   SourceMeshType const & source_mesh_;
   TargetMeshType const & target_mesh_;
   SourceStateType const & source_state_;
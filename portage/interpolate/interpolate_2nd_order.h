@@ -16,8 +16,10 @@ Please see the license file at the root of this repository, or at:
 #include <vector>
 
 #include "portage/support/portage.h"
+#include "portage/support/weights_csr.h"
 #include "portage/interpolate/gradient.h"
 #include "portage/intersect/dummy_interface_reconstructor.h"
+#include "portage/intersect/material_moments.h"
 #include "portage/driver/fix_mismatch.h"
 #include "portage/driver/parts.h"
 
@@ -319,6 +321,18 @@ namespace Portage {
      */
     void set_material(int m) { material_id_ = m; }
 
+#ifdef HAVE_TANGRAM
+    /**
+     * @brief Use precomputed material centroids instead of summing the
+     * moments of the material polytopes of each source cell.
+     *
+     * @param[in] moments: material moments (not owned), nullptr to not use them.
+     */
+    void set_material_moments(MaterialMoments<D> const* moments) {
+      material_moments_ = moments;
+    }
+#endif
+
 
     /**
      * @brief Set the name of the interpolation variable and the gradient field.
@@ -358,6 +372,28 @@ namespace Portage {
      */
     double operator()(int cell_id,
                       std::vector<Weights_t> const& sources_and_weights) const {
+      return interpolate(cell_id, sources_and_weights);
+    }
+
+    /**
+     * @brief Same as above with the entries of a row of compressed weights.
+     */
+    double operator()(int cell_id,
+                      WeightsCSR::Row const& sources_and_weights) const {
+      return interpolate(cell_id, sources_and_weights);
+    }
+
+    constexpr static int order = 2;
+
+  private:
+
+    /**
+     * @brief Interpolate on a target cell given any list of entries
+     * with an 'entityID' and indexable 'weights'.
+     */
+    template<class SourceWeights>
+    double interpolate(int cell_id,
+                       SourceWeights const& sources_and_weights) const {
 
       if (sources_and_weights.empty())
         return 0.;
@@ -376,7 +412,7 @@ namespace Portage {
       for (auto&& current : sources_and_weights) {
         // Get source cell and the intersection weights
         int src_cell = current.entityID;
-        auto intersect_weights = current.weights;
+        auto const& intersect_weights = current.weights;
         double intersect_volume = intersect_weights[0];
 
         if (fabs(intersect_volume) <= num_tols_.min_absolute_volume)
@@ -388,6 +424,17 @@ namespace Portage {
           source_mesh_.cell_centroid(src_cell, &source_centroid);
         }
 #ifdef HAVE_TANGRAM
+        else if (field_type_ == Field_type::MULTIMATERIAL_FIELD and
+                 material_moments_ != nullptr) {
+          // centroid of the material in the cell computed once after
+          // interface reconstruction (the cell centroid for pure cells)
+          int const index =
+            source_state_.cell_index_in_material(src_cell, material_id_);
+          if (index >= 0)
+            source_centroid = material_moments_->centroid(material_id_, index);
+          else
+            source_mesh_.cell_centroid(src_cell, &source_centroid);
+        }
         else if (field_type_ == Field_type::MULTIMATERIAL_FIELD) {
           int const nb_mats = source_state_.cell_get_num_mats(src_cell);
           std::vector<int> cellmats;
@@ -465,10 +512,7 @@ namespace Portage {
        */
       return nb_summed ? total_value / normalization : 0.;
     }
-    
-    constexpr static int order = 2;
 
-  private:
     SourceMeshType const& source_mesh_;
     TargetMeshType const& target_mesh_;
     SourceStateType const& source_state_;
@@ -480,6 +524,7 @@ namespace Portage {
     Field_type field_type_ = Field_type::UNKNOWN_TYPE_FIELD;
 #ifdef HAVE_TANGRAM
     std::shared_ptr<InterfaceReconstructor> interface_reconstructor_;
+    MaterialMoments<D> const* material_moments_ = nullptr;
 #endif
     Parts const* parts_;
   };
@@ -642,6 +687,28 @@ namespace Portage {
      */
     double operator()(int node_id,
                       std::vector<Weights_t> const& sources_and_weights) const {
+      return interpolate(node_id, sources_and_weights);
+    }
+
+    /**
+     * @brief Same as above with the entries of a row of compressed weights.
+     */
+    double operator()(int node_id,
+                      WeightsCSR::Row const& sources_and_weights) const {
+      return interpolate(node_id, sources_and_weights);
+    }
+
+    constexpr static int order = 2;
+
+  private:
+
+    /**
+     * @brief Interpolate on a target node given any list of entries
+     * with an 'entityID' and indexable 'weights'.
+     */
+    template<class SourceWeights>
+    double interpolate(int node_id,
+                       SourceWeights const& sources_and_weights) const {
 
       if (sources_and_weights.empty())
         return 0.;
@@ -656,7 +723,7 @@ namespace Portage {
 
       for (auto&& current : sources_and_weights) {
         int src_node = current.entityID;
-        auto intersect_weights = current.weights;
+        auto const& intersect_weights = current.weights;
         double intersect_volume = intersect_weights[0];
 
         if (fabs(intersect_volume) <= num_tols_.min_absolute_volume)
@@ -696,9 +763,6 @@ namespace Portage {
       return nb_summed ? total_value / normalization : 0.;
     }
 
-    constexpr static int order = 2;
-
-  private:
     SourceMeshType const& source_mesh_;
     TargetMeshType const& target_mesh_;
     SourceStateType const& source_state_;
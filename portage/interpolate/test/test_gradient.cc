@@ -139,6 +139,64 @@ TEST(Gradient, Fields_Cell_Ctr) {
   }
 }
 
+// Gradients computed with precomputed least-squares stencils must match
+// the ones fitted cell by cell, for several fields and limiters
+
+TEST(Gradient, Fields_Cell_Ctr_Stencils) {
+  std::shared_ptr<Wonton::Simple_Mesh> mesh1 =
+      std::make_shared<Wonton::Simple_Mesh>(0.0, 0.0, 1.0, 1.0, 5, 4);
+
+  Wonton::Simple_Mesh_Wrapper meshwrapper(*mesh1);
+  Wonton::Simple_State mystate(mesh1);
+  Wonton::Simple_State_Wrapper statewrapper(mystate);
+
+  const int nc1 = meshwrapper.num_owned_cells();
+
+  // a linear and a nonlinear field
+  std::vector<double> data1(nc1), data2(nc1);
+  for (int c = 0; c < nc1; c++) {
+    Wonton::Point<2> ccen;
+    meshwrapper.cell_centroid(c, &ccen);
+    data1[c] = ccen[0] + 2 * ccen[1];
+    data2[c] = ccen[0] * ccen[0] * ccen[1] + 3 * ccen[1] * ccen[1];
+  }
+  mystate.add("cellvars1", Portage::Entity_kind::CELL, &(data1[0]));
+  mystate.add("cellvars2", Portage::Entity_kind::CELL, &(data2[0]));
+
+  using Gradient = Portage::Limited_Gradient<2, Portage::Entity_kind::CELL,
+                                             Wonton::Simple_Mesh_Wrapper,
+                                             Wonton::Simple_State_Wrapper>;
+
+  Gradient reference(meshwrapper, statewrapper, "cellvars1",
+                     Portage::NOLIMITER, Portage::BND_NOLIMITER);
+  Gradient stencil(meshwrapper, statewrapper, "cellvars1",
+                   Portage::NOLIMITER, Portage::BND_NOLIMITER);
+  stencil.precompute_stencils();
+
+  std::vector<std::string> const fields = {"cellvars1", "cellvars2"};
+  std::vector<Portage::Limiter_type> const limiters = {Portage::NOLIMITER,
+                                                       Portage::BARTH_JESPERSEN};
+  std::vector<Portage::Boundary_Limiter_type> const bnd_limiters = {
+    Portage::BND_NOLIMITER, Portage::BND_ZERO_GRADIENT, Portage::BND_BARTH_JESPERSEN
+  };
+
+  for (auto&& field : fields) {
+    for (auto&& limiter : limiters) {
+      for (auto&& bnd_limiter : bnd_limiters) {
+        reference.set_interpolation_variable(field, limiter, bnd_limiter);
+        stencil.set_interpolation_variable(field, limiter, bnd_limiter);
+
+        for (int c = 0; c < nc1; ++c) {
+          Wonton::Vector<2> expected = reference(c);
+          Wonton::Vector<2> grad = stencil(c);
+          ASSERT_NEAR(expected[0], grad[0], 1.0e-10);
+          ASSERT_NEAR(expected[1], grad[1], 1.0e-10);
+        }
+      }
+    }
+  }
+}
+
 // Test gradient computation with node centered fields
 
 TEST(Gradient, Fields_Node_Ctr) {
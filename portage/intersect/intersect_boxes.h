@@ -3,7 +3,9 @@
 
 // ============================================================================
 
+#include <algorithm>
 #include <cmath>
+#include <numeric>
 #include <type_traits>
 #include <vector>
 
@@ -160,6 +162,207 @@ std::vector<Portage::Weights_t>
 }  // operator()
 
 
+// ============================================================================
+
+//! \class AxisAlignedCells  Axis-aligned box cells of a mesh
+//!
+//! Flags the cells of a mesh that are axis-aligned boxes, i.e. the
+//! quadrilaterals (2D) or hexahedra (3D) whose nodes are exactly the
+//! corners of their bounding box, and keeps their bounds. Generic
+//! intersectors use it to compute the moments of box-box pairs in closed
+//! form, which pays off on meshes that are mostly Cartesian but are
+//! presented through an unstructured mesh wrapper. Cells are only
+//! examined when they are added, so that intersectors can restrict the
+//! work to the cells they are about to intersect.
+
+template <int D>
+class AxisAlignedCells {
+
+ public:
+
+  //! Empty (no cells examined)
+  AxisAlignedCells() = default;
+
+  //! \brief Find the box cells of a mesh (owned and ghost cells)
+  //! \param[in] mesh  Mesh wrapper, queried with cell_get_coordinates
+  template <typename MeshType>
+  explicit AxisAlignedCells(MeshType const& mesh) {
+    int const ncells = mesh.num_owned_cells() + mesh.num_ghost_cells();
+    std::vector<int> cells(ncells);
+    std::iota(cells.begin(), cells.end(), 0);
+    add(mesh, cells);
+  }
+
+  //! \brief Examine the given cells of a mesh that were not examined
+  //!        yet, in parallel when the library is built with threads.
+  //!        Everything is forgotten if the number of cells changed.
+  //! \param[in] mesh   Mesh wrapper, queried with cell_get_coordinates
+  //! \param[in] cells  Owned or ghost cells of the mesh (repeats allowed)
+  template <typename MeshType>
+  void add(MeshType const& mesh, std::vector<int> const& cells) {
+    int const ncells = mesh.num_owned_cells() + mesh.num_ghost_cells();
+    if (ncells != static_cast<int>(flags_.size())) {
+      flags_.assign(ncells, UNKNOWN);
+      lower_.resize(ncells);
+      upper_.resize(ncells);
+    }
+
+    std::vector<int> missing;
+    for (int c : cells)
+      if (flags_[c] == UNKNOWN) {
+        flags_[c] = NOT_BOX;  // not a repeat
+        missing.push_back(c);
+      }
+
+    Portage::for_each(make_counting_iterator(0),
+                      make_counting_iterator(static_cast<int>(missing.size())),
+                      [&](int i) {
+                        int const c = missing[i];
+                        std::vector<Wonton::Point<D>> points;
+                        mesh.cell_get_coordinates(c, &points);
+                        if (box_bounds(points, &lower_[c], &upper_[c]))
+                          flags_[c] = BOX;
+                      });
+  }
+
+  //! Forget all cells
+  void clear() {
+    flags_.clear();
+    lower_.clear();
+    upper_.clear();
+  }
+
+  //! Whether cell c was examined
+  bool has(int c) const {
+    return c < static_cast<int>(flags_.size()) && flags_[c] != UNKNOWN;
+  }
+
+  //! Whether cell c was examined and is an axis-aligned box
+  bool is_box(int c) const {
+    return c < static_cast<int>(flags_.size()) && flags_[c] == BOX;
+  }
+
+  //! Lower corner of box cell c
+  Wonton::Point<D> const& lower(int c) const { return lower_[c]; }
+
+  //! Upper corner of box cell c
+  Wonton::Point<D> const& upper(int c) const { return upper_[c]; }
+
+  //! \brief Bounds of a cell if it is an axis-aligned box, examining it
+  //!        now if it was not added
+  //! \param[in] mesh    Mesh wrapper the cells were added from
+  //! \param[in] c       Cell
+  //! \param[out] lower  Lower corner of its bounding box
+  //! \param[out] upper  Upper corner of its bounding box
+  //! \return Whether the cell is an axis-aligned box
+  template <typename MeshType>
+  bool cell_box(MeshType const& mesh, int c,
+                Wonton::Point<D>* lower, Wonton::Point<D>* upper) const {
+    if (has(c)) {
+      if (flags_[c] != BOX)
+        return false;
+      *lower = lower_[c];
+      *upper = upper_[c];
+      return true;
+    }
+    std::vector<Wonton::Point<D>> points;
+    mesh.cell_get_coordinates(c, &points);
+    return box_bounds(points, lower, upper);
+  }
+
+  //! \brief Bounds of a cell if it is an axis-aligned box
+  //! \param[in] points     Coordinates of the nodes of the cell
+  //! \param[out] lower     Lower corner of its bounding box
+  //! \param[out] upper     Upper corner of its bounding box
+  //! \return Whether the 2^D nodes of the cell are the corners of its
+  //!         bounding box (up to a small fraction of its size)
+  static bool box_bounds(std::vector<Wonton::Point<D>> const& points,
+                         Wonton::Point<D>* lower, Wonton::Point<D>* upper) {
+    int const ncorners = 1 << D;
+    if (static_cast<int>(points.size()) != ncorners)
+      return false;
+
+    *lower = *upper = points[0];
+    for (auto const& p : points)
+      for (int d = 0; d < D; ++d) {
+        (*lower)[d] = std::min((*lower)[d], p[d]);
+        (*upper)[d] = std::max((*upper)[d], p[d]);
+      }
+
+    double size = 0.;
+    for (int d = 0; d < D; ++d)
+      size = std::max(size, (*upper)[d] - (*lower)[d]);
+    double const tolerance = 1.e-12 * size;
+    for (int d = 0; d < D; ++d)
+      if ((*upper)[d] - (*lower)[d] <= tolerance)
+        return false;  // degenerate
+
+    // every node must be a distinct corner of the bounding box
+    unsigned corners = 0;
+    for (auto const& p : points) {
+      int corner = 0;
+      for (int d = 0; d < D; ++d) {
+        if (std::abs(p[d] - (*upper)[d]) <= tolerance)
+          corner |= 1 << d;
+        else if (std::abs(p[d] - (*lower)[d]) > tolerance)
+          return false;
+      }
+      corners |= 1u << corner;
+    }
+    return corners == (1u << ncorners) - 1;
+  }
+
+ private:
+  enum : char {UNKNOWN, NOT_BOX, BOX};
+
+  std::vector<char> flags_;           // UNKNOWN until the cell is added
+  std::vector<Wonton::Point<D>> lower_;
+  std::vector<Wonton::Point<D>> upper_;
+};  // class AxisAlignedCells
+
+
+//! \brief Moments of the intersection of two axis-aligned boxes in
+//!        Cartesian coordinates
+//! \param[out] moments volume and first moments of the intersection (all
+//!                     zero if the boxes do not overlap), 1+D values
+
+template <int D>
+void intersect_box_moments(Wonton::Point<D> const& slo,
+                           Wonton::Point<D> const& shi,
+                           Wonton::Point<D> const& tlo,
+                           Wonton::Point<D> const& thi,
+                           double* moments) {
+  std::fill(moments, moments + 1 + D, 0.);
+
+  double volume = 1.;
+  Wonton::Point<D> ilo, ihi;
+  for (int d = 0; d < D; ++d) {
+    ilo[d] = std::max(slo[d], tlo[d]);
+    ihi[d] = std::min(shi[d], thi[d]);
+    volume *= std::max(ihi[d] - ilo[d], 0.);
+  }
+
+  if (volume <= 0.)
+    return;
+
+  moments[0] = volume;
+  for (int d = 0; d < D; ++d)
+    moments[1+d] = 0.5 * (ilo[d] + ihi[d]) * volume;
+}
+
+//! \brief Same as above, returning the moments
+
+template <int D>
+std::vector<double> intersect_box_moments(Wonton::Point<D> const& slo,
+                                          Wonton::Point<D> const& shi,
+                                          Wonton::Point<D> const& tlo,
+                                          Wonton::Point<D> const& thi) {
+  std::vector<double> moments(1+D);
+  intersect_box_moments<D>(slo, shi, tlo, thi, moments.data());
+  return moments;
+}
+
+
 } // namespace Portage
 
 #endif // INTERSECT_BOXES_H
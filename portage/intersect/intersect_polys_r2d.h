@@ -22,15 +22,17 @@ extern "C" {
 namespace Portage {
 
 // intersect one source polygon (possibly non-convex) with a
-// triangular decomposition of a target polygon
+// triangular decomposition of a target polygon, writing the 3 moments
+// of the intersection to 'moments'
 
 inline
-std::vector<double>
+void
 intersect_polys_r2d(std::vector<Wonton::Point<2>> const & source_poly,
                     std::vector<Wonton::Point<2>> const & target_poly,
-                    NumericTolerances_t num_tols) {
+                    NumericTolerances_t num_tols,
+                    double* moments) {
 
-  std::vector<double> moments(3, 0);
+  std::fill(moments, moments + 3, 0.);
   bool src_convex = true;
   bool trg_convex = true;
 
@@ -41,7 +43,7 @@ intersect_polys_r2d(std::vector<Wonton::Point<2>> const & source_poly,
   const int size1 = source_poly.size();
   const int size2 = target_poly.size();
   if (!size1 || !size2)
-    return moments;  // could allow top level code to avoid an 'if' statement
+    return;  // could allow top level code to avoid an 'if' statement
 
   std::vector<r2d_rvec2> verts1(size1);
   for (int i = 0; i < size1; ++i) {
@@ -134,7 +136,7 @@ intersect_polys_r2d(std::vector<Wonton::Point<2>> const & source_poly,
     // call the routine with the polygons reversed
 
     if (src_convex)
-      return intersect_polys_r2d(target_poly, source_poly, num_tols);
+      intersect_polys_r2d(target_poly, source_poly, num_tols, moments);
     else {
 
       // Must divide target_poly into triangles for clipping.  Choice
@@ -238,7 +240,17 @@ intersect_polys_r2d(std::vector<Wonton::Point<2>> const & source_poly,
       }  // for i
     }  // if (src_convex) ... else ...
   }  // if convex {} else {}
+}
+
+// Same as above, returning the moments
 
+inline
+std::vector<double>
+intersect_polys_r2d(std::vector<Wonton::Point<2>> const & source_poly,
+                    std::vector<Wonton::Point<2>> const & target_poly,
+                    NumericTolerances_t num_tols) {
+  std::vector<double> moments(3, 0);
+  intersect_polys_r2d(source_poly, target_poly, num_tols, moments.data());
   return moments;
 }
 
@@ -11,6 +11,7 @@ Please see the license file at the root of this repository, or at:
 #include <stdexcept>
 #include <vector>
 #include <algorithm>
+#include <cmath>
 
 extern "C" {
 #include "wonton/intersect/r3d/r3d.h"
@@ -33,11 +34,9 @@ using Wonton::Vector;
 
 typedef
 struct facetedpoly {
-  std::vector<std::vector<int>> facetpoints;  // we can flatten this to a
-  //                                          // 1D array if we assume only
-  //                                          // triangular facets or we
-  //                                          // include the number of points
-  //                                          // in each facet
+  std::vector<std::vector<int>> facetpoints;  // see FacetedPolyStore for a
+  //                                          // flattened layout of many
+  //                                          // polyhedra
   std::vector<Point<3>> points;
 } facetedpoly_t;
 
@@ -63,30 +62,217 @@ facetedpoly_t get_faceted_matpoly(const Tangram::MatPoly<3>& matpoly) {
 #endif
 
 
-// Intersect one source polyhedron (possibly non-convex but with
-// triangular facets only) with a bunch of tets forming a target
-// polyhedron
+/*!
+  @brief Read-only view of a faceted polyhedron in flattened form: the
+  points of facet f are points[facetpoints[facetoffsets[f]]] to
+  points[facetpoints[facetoffsets[f+1]-1]]
+*/
+struct FacetedPolyView {
+  Point<3> const* points;
+  int num_points;
+  int const* facetoffsets;   // num_facets+1 entries
+  int const* facetpoints;
+  int num_facets;
+};
+
+
+/*!
+  @class FacetedPolyStore intersect_polys_r3d.h
+  @brief Facetizations of many polyhedra (e.g. all source cells) stored
+  in a few flat arrays instead of one facetedpoly_t per polyhedron, so
+  that they can be computed once and reused for every intersection.
+*/
+class FacetedPolyStore {
+ public:
+
+  /// Empty store
+  FacetedPolyStore() = default;
+
+  /*!
+    @brief Facetize polyhedra 0 to n-1, in parallel when the library is
+    built with threads
+    @param[in] n          number of polyhedra
+    @param[in] facetize   function(i, facetpoints*, points*) facetizing
+                          polyhedron i like cell_get_facetization
+  */
+  template<class Facetize>
+  FacetedPolyStore(int n, Facetize&& facetize) {
+    int const block = 256;
+    int const nblocks = (n + block - 1) / block;
+    std::vector<FacetedPolyStore> blocks(nblocks);
+    auto* block_stores = blocks.data();
+    Portage::for_each(make_counting_iterator(0),
+                      make_counting_iterator(nblocks),
+                      [n, block_stores, &facetize](int b) {
+                        std::vector<std::vector<int>> facetpoints;
+                        std::vector<Point<3>> points;
+                        int const last = std::min(n, (b + 1) * block);
+                        for (int i = b * block; i < last; i++) {
+                          facetpoints.clear();
+                          points.clear();
+                          facetize(i, &facetpoints, &points);
+                          block_stores[b].append(facetpoints, points);
+                        }
+                      });
+    for (auto const& store : blocks)
+      append(store);
+  }
+
+  /// Number of polyhedra
+  int size() const { return point_offsets_.size() - 1; }
+
+  /// Add a polyhedron given in the facetedpoly_t layout
+  void append(std::vector<std::vector<int>> const& facetpoints,
+              std::vector<Point<3>> const& points) {
+    points_.insert(points_.end(), points.begin(), points.end());
+    point_offsets_.push_back(points_.size());
+    for (auto const& facet : facetpoints) {
+      facetpoints_.insert(facetpoints_.end(), facet.begin(), facet.end());
+      facetoffsets_.push_back(facetpoints_.size());
+    }
+    facet_offsets_.push_back(facetoffsets_.size() - 1);
+  }
+
+  /// Add all the polyhedra of another store
+  void append(FacetedPolyStore const& other) {
+    int const npoints = points_.size();
+    int const nfacets = facetoffsets_.size() - 1;
+    int const nfacetpoints = facetpoints_.size();
+    points_.insert(points_.end(), other.points_.begin(), other.points_.end());
+    facetpoints_.insert(facetpoints_.end(), other.facetpoints_.begin(),
+                        other.facetpoints_.end());
+    for (int i = 1; i < static_cast<int>(other.point_offsets_.size()); i++)
+      point_offsets_.push_back(npoints + other.point_offsets_[i]);
+    for (int i = 1; i < static_cast<int>(other.facetoffsets_.size()); i++)
+      facetoffsets_.push_back(nfacetpoints + other.facetoffsets_[i]);
+    for (int i = 1; i < static_cast<int>(other.facet_offsets_.size()); i++)
+      facet_offsets_.push_back(nfacets + other.facet_offsets_[i]);
+  }
+
+  /// Polyhedron i
+  FacetedPolyView operator[](int i) const {
+    int const first_point = point_offsets_[i];
+    int const first_facet = facet_offsets_[i];
+    return {points_.data() + first_point,
+            point_offsets_[i+1] - first_point,
+            facetoffsets_.data() + first_facet,
+            facetpoints_.data(),
+            facet_offsets_[i+1] - first_facet};
+  }
+
+ private:
+  std::vector<Point<3>> points_;          // points of all polyhedra
+  std::vector<int> point_offsets_ {0};    // first point of each polyhedron
+  std::vector<int> facetpoints_;          // local point ids of all facets
+  std::vector<int> facetoffsets_ {0};     // first point id of each facet
+  std::vector<int> facet_offsets_ {0};    // first facet of each polyhedron
+};
+
+
+/*!
+  @class FacetedCells intersect_polys_r3d.h
+  @brief Facetizations of the cells (or dual cells) of a mesh, kept in a
+  FacetedPolyStore. They are only computed for the cells asked for, the
+  first time they are.
+*/
+class FacetedCells {
+ public:
+
+  /// Number of cells of the mesh the facetizations are computed for
+  int num_cells() const { return slots_.size(); }
+
+  /// Was cell c facetized?
+  bool has(int c) const { return c < num_cells() && slots_[c] >= 0; }
+
+  /// Facetization of cell c, has(c) must hold
+  FacetedPolyView operator[](int c) const { return polys_[slots_[c]]; }
+
+  /*!
+    @brief Facetize the given cells that were not facetized yet, in
+    parallel when the library is built with threads. Everything is
+    recomputed if the number of cells of the mesh changed.
+    @param[in] ncells     number of cells of the mesh (owned and ghost)
+    @param[in] cells      cells to facetize (repeats allowed)
+    @param[in] facetize   function(c, facetpoints*, points*) facetizing
+                          cell c like cell_get_facetization
+  */
+  template<class Facetize>
+  void add(int ncells, std::vector<int> const& cells, Facetize&& facetize) {
+    if (ncells != num_cells()) {
+      clear();
+      slots_.assign(ncells, -1);
+    }
+
+    std::vector<int> missing;
+    for (int c : cells)
+      if (slots_[c] == -1) {
+        slots_[c] = polys_.size() + missing.size();
+        missing.push_back(c);
+      }
+
+    polys_.append(FacetedPolyStore(
+        static_cast<int>(missing.size()),
+        [&missing, &facetize](int i, std::vector<std::vector<int>>* facetpoints,
+                              std::vector<Point<3>>* points) {
+          facetize(missing[i], facetpoints, points);
+        }));
+  }
+
+  /// Forget all cells
+  void clear() {
+    slots_.clear();
+    polys_ = FacetedPolyStore();
+  }
+
+ private:
+  std::vector<int> slots_;      // index of each cell in polys_, -1 if none
+  FacetedPolyStore polys_;      // facetizations of the cells asked for
+};
+
+
+/*!
+  @brief Buffers in which the inputs of r3d are laid out. They are kept
+  from one intersection to the next, so that after the first few calls
+  no memory is allocated per intersection.
+*/
+struct R3DScratch {
+  std::vector<r3d_rvec3> verts;
+  std::vector<r3d_int> face_num_verts;
+  std::vector<r3d_int*> face_vert_ids;
+  std::vector<r3d_int> vert_ids;
+  std::vector<int> facetoffsets;    // to flatten facetedpoly_t inputs
+  std::vector<int> facetpoints;
+  std::vector<r3d_plane> planes;    // r3d_clip takes non-const planes
+};
+
+/// Scratch buffers of the calling thread
+inline R3DScratch& r3d_scratch() {
+  static thread_local R3DScratch scratch;
+  return scratch;
+}
+
+
+// Initialize the r3d description of a source polyhedron (possibly
+// non-convex but with triangular facets only) and compute its bounding
+// box (xmin, xmax, ymin, ymax, zmin, zmax). The vertex and face arrays
+// live in the scratch buffers of the calling thread.
 
-std::vector<double>
 inline
-intersect_polys_r3d(const facetedpoly_t &srcpoly,
-                    const std::vector<std::array<Point<3>, 4>> &target_tet_coords,
-                    NumericTolerances_t num_tols) {
+void init_r3d_source_poly(FacetedPolyView const& srcpoly, r3d_poly* poly,
+                          double source_cell_bounds[6]) {
 
-  // Bounding box of the target cell - will be used to compute
-  // epsilon for bounding box check. We could use the source cell
-  // coordinates to find the bounds as well but its probably an
-  // unnecessary computation (EVEN if the target cell is much
-  // smaller than the source cell)
+  R3DScratch& scratch = r3d_scratch();
 
-  std::vector<double> source_cell_bounds =  {1e99, -1e99, 1e99, -1e99,
-                                             1e99, -1e99};
+  for (int j = 0; j < 3; j++) {
+    source_cell_bounds[2*j] = 1e99;
+    source_cell_bounds[2*j+1] = -1e99;
+  }
 
   // Initialize the source polyhedron description in a form R3D wants
   // Simultaneously compute the bounding box
-  r3d_poly src_r3dpoly;
-  int num_verts = srcpoly.points.size();
-  r3d_rvec3 *verts = new r3d_rvec3[num_verts];
+  int num_verts = srcpoly.num_points;
+  scratch.verts.resize(num_verts);
+  r3d_rvec3 *verts = scratch.verts.data();
   for (int i = 0; i < num_verts; i++) {
     for (int j = 0; j < 3; j++) {
       verts[i].xyz[j] = srcpoly.points[i][j];
@@ -98,21 +284,19 @@ intersect_polys_r3d(const facetedpoly_t &srcpoly,
     }
   }
 
-  // used only for bounding box check not for intersections
-  double bbeps = num_tols.min_absolute_distance;
-
-  int num_faces = srcpoly.facetpoints.size();
-  r3d_int *face_num_verts = new r3d_int[num_faces];
-  for (int i = 0; i < num_faces; i++)
-    face_num_verts[i] = srcpoly.facetpoints[i].size();
-
-  r3d_int **face_vert_ids = new r3d_int *[num_faces];
-  for (int i = 0; i < num_faces; i++)
-    face_vert_ids[i] = new r3d_int[face_num_verts[i]];
-
-  for (int i = 0; i < num_faces; i++)
-    std::copy(srcpoly.facetpoints[i].begin(), srcpoly.facetpoints[i].end(),
-              face_vert_ids[i]);
+  int num_faces = srcpoly.num_facets;
+  int const first = srcpoly.facetoffsets[0];
+  int const num_face_verts = srcpoly.facetoffsets[num_faces] - first;
+  scratch.face_num_verts.resize(num_faces);
+  scratch.face_vert_ids.resize(num_faces);
+  scratch.vert_ids.assign(srcpoly.facetpoints + first,
+                          srcpoly.facetpoints + first + num_face_verts);
+  r3d_int *face_num_verts = scratch.face_num_verts.data();
+  r3d_int **face_vert_ids = scratch.face_vert_ids.data();
+  for (int i = 0; i < num_faces; i++) {
+    face_num_verts[i] = srcpoly.facetoffsets[i+1] - srcpoly.facetoffsets[i];
+    face_vert_ids[i] = scratch.vert_ids.data() + srcpoly.facetoffsets[i] - first;
+  }
 
 #ifdef DEBUG
   // Lets check the volume of the source polygon - If its convex or
@@ -129,9 +313,9 @@ intersect_polys_r3d(const facetedpoly_t &srcpoly,
   for (int i = 0; i < num_faces; i++) {
     // p0, p1, p2 traversed in order form a triangle whose normal
     // points out of the source polyhedron
-    const Point<3> &p0 = srcpoly.points[srcpoly.facetpoints[i][0]];
-    const Point<3> &p1 = srcpoly.points[srcpoly.facetpoints[i][1]];
-    const Point<3> &p2 = srcpoly.points[srcpoly.facetpoints[i][2]];
+    const Point<3> &p0 = srcpoly.points[face_vert_ids[i][0]];
+    const Point<3> &p1 = srcpoly.points[face_vert_ids[i][1]];
+    const Point<3> &p2 = srcpoly.points[face_vert_ids[i][2]];
 
     Vector<3> v0 = p1-p0;
     Vector<3> v1 = p2-p0;
@@ -147,17 +331,38 @@ intersect_polys_r3d(const facetedpoly_t &srcpoly,
     throw std::runtime_error("Source polyhedron has negative volume");
 #endif
 
-  r3d_init_poly(&src_r3dpoly, verts, num_verts, face_vert_ids, face_num_verts,
+  r3d_init_poly(poly, verts, num_verts, face_vert_ids, face_num_verts,
                 num_faces);
+}
+
+
+// Intersect one source polyhedron (possibly non-convex but with
+// triangular facets only) with a bunch of tets forming a target
+// polyhedron, writing the 4 moments of the intersection to 'moments'
+
+inline
+void
+intersect_polys_r3d(FacetedPolyView const& srcpoly,
+                    const std::vector<std::array<Point<3>, 4>> &target_tet_coords,
+                    NumericTolerances_t num_tols,
+                    double* moments) {
+
+  // Bounding box of the source cell - will be used for the bounding box
+  // check against each target tet
+  double source_cell_bounds[6];
+  r3d_poly src_r3dpoly;
+  init_r3d_source_poly(srcpoly, &src_r3dpoly, source_cell_bounds);
+
+  // used only for bounding box check not for intersections
+  double bbeps = num_tols.min_absolute_distance;
 
   // Finished building source poly; now intersect with tets of target cell
 
-  std::vector<double> moments(4, 0);
+  std::fill(moments, moments + 4, 0.);
   for (auto const & target_cell_tet : target_tet_coords) {
-    std::vector<r3d_plane> faces(4);
+    r3d_plane faces[4];
 
-    std::vector<double> target_tet_bounds = {1e99, -1e99, 1e99,
-                                             -1e99, 1e99, -1e99};
+    double target_tet_bounds[6] = {1e99, -1e99, 1e99, -1e99, 1e99, -1e99};
     r3d_rvec3 verts2[4];
     for (int i = 0; i < 4; i++)
       for (int j = 0; j < 3; j++) {
@@ -187,13 +392,13 @@ intersect_polys_r3d(const facetedpoly_t &srcpoly,
       throw std::runtime_error("target_wedge has negative volume");
 #endif
 
-    r3d_tet_faces_from_verts(&faces[0], verts2);
+    r3d_tet_faces_from_verts(faces, verts2);
 
     // clip the source poly against the faces of the target tet - but
     // make a copy of src_r3dpoly first because it will get modified
     // in the process of clipping
     r3d_poly src_r3dpoly_copy = src_r3dpoly;
-    r3d_clip(&src_r3dpoly_copy, &faces[0], 4);
+    r3d_clip(&src_r3dpoly_copy, faces, 4);
 
     // find the moments (up to quadratic order) of the clipped poly
     const int POLY_ORDER = 1;
@@ -211,16 +416,301 @@ intersect_polys_r3d(const facetedpoly_t &srcpoly,
     for (int i = 0; i < 4; i++)
       moments[i] += om[i];
   }
+}  // intersect_polys_3D
 
-  delete [] verts;
-  delete [] face_num_verts;
-  for (int i = 0; i < num_faces; i++)
-    delete [] face_vert_ids[i];
-  delete [] face_vert_ids;
 
-  return moments;
+/*!
+  @brief Faces of a convex target polyhedron as r3d clipping planes,
+  normals pointing inwards, along with its bounding box
+*/
+struct ConvexPolyPlanes {
+  r3d_plane const* planes;
+  int num_planes;
+  double const* bounds;     // xmin, xmax, ymin, ymax, zmin, zmax
+};
+
+
+/*!
+  @brief Clipping planes of a polyhedron if it is convex with planar faces
+  @param[in] faces   coordinates of the vertices of each face, in order
+  @param[out] planes one plane per face with its normal pointing inwards
+  @return whether the polyhedron is convex and all its faces are planar
+  (up to a small fraction of its size); planes is left empty otherwise
+*/
+inline
+bool convex_polyhedron_planes(std::vector<std::vector<Point<3>>> const& faces,
+                              std::vector<r3d_plane>* planes) {
+  planes->clear();
+
+  // the vertex average is strictly inside a convex polyhedron
+  Point<3> center;
+  Point<3> lower(1e99, 1e99, 1e99), upper(-1e99, -1e99, -1e99);
+  int num_points = 0;
+  for (auto&& face : faces) {
+    for (auto&& p : face) {
+      center += p;
+      for (int j = 0; j < 3; j++) {
+        lower[j] = std::min(lower[j], p[j]);
+        upper[j] = std::max(upper[j], p[j]);
+      }
+      num_points++;
+    }
+  }
+  if (faces.size() < 4 || num_points == 0)
+    return false;
+  center /= num_points;
+
+  double const tolerance = 1.e-12 * (upper - lower).norm();
+  std::vector<r3d_plane> face_planes;
+
+  for (auto&& face : faces) {
+    int const n = face.size();
+    if (n < 3)
+      return false;
+
+    // Newell normal and vertex average of the face
+    Vector<3> normal;
+    Point<3> face_center;
+    for (int i = 0; i < n; i++) {
+      Point<3> const& p = face[i];
+      Point<3> const& q = face[(i + 1) % n];
+      normal[0] += (p[1] - q[1]) * (p[2] + q[2]);
+      normal[1] += (p[2] - q[2]) * (p[0] + q[0]);
+      normal[2] += (p[0] - q[0]) * (p[1] + q[1]);
+      face_center += p;
+    }
+    face_center /= n;
+
+    double const area = normal.norm();
+    if (area == 0.)
+      return false;
+    normal /= area;
+
+    // point it inwards
+    if (dot(normal, center - face_center) < 0.)
+      normal *= -1.;
+
+    // the face must be planar ...
+    for (auto&& p : face)
+      if (std::abs(dot(normal, p - face_center)) > tolerance)
+        return false;
+
+    // ... and the other vertices on its inner side
+    for (auto&& other : faces)
+      for (auto&& p : other)
+        if (dot(normal, p - face_center) < -tolerance)
+          return false;
+
+    r3d_plane plane;
+    for (int j = 0; j < 3; j++)
+      plane.n.xyz[j] = normal[j];
+    plane.d = -dot(normal, face_center.asV());
+    face_planes.push_back(plane);
+  }
+
+  planes->swap(face_planes);
+  return true;
+}
+
+
+/*!
+  @class ConvexCellPlanes intersect_polys_r3d.h
+  @brief Clipping planes and bounding boxes of the cells of a mesh that
+  are convex with planar faces (no planes for the other cells). They are
+  only computed for the cells asked for, the first time they are.
+*/
+class ConvexCellPlanes {
+ public:
+
+  /// Number of cells of the mesh the planes are computed for
+  int num_cells() const { return slots_.size(); }
+
+  /// Were the planes of cell c computed?
+  bool has(int c) const { return c < num_cells() && slots_[c] >= 0; }
+
+  /// Planes of cell c (none if it is not convex), has(c) must hold
+  ConvexPolyPlanes operator[](int c) const {
+    int const i = slots_[c];
+    return {planes_.data() + offsets_[i], offsets_[i+1] - offsets_[i],
+            bounds_.data() + 6 * i};
+  }
+
+  /*!
+    @brief Compute the planes of the given cells that were not computed
+    yet, in parallel when the library is built with threads. Everything
+    is recomputed if the number of cells of the mesh changed.
+    @param[in] mesh   mesh wrapper
+    @param[in] cells  owned or ghost cells of the mesh (repeats allowed)
+  */
+  template<class Mesh>
+  void add(Mesh const& mesh, std::vector<int> const& cells) {
+    int const ncells = mesh.num_owned_cells() + mesh.num_ghost_cells();
+    if (ncells != num_cells()) {
+      clear();
+      slots_.assign(ncells, -1);
+    }
+
+    std::vector<int> missing;
+    for (int c : cells)
+      if (slots_[c] == -1) {
+        slots_[c] = -2;  // not a repeat
+        missing.push_back(c);
+      }
+
+    int const nmissing = missing.size();
+    std::vector<std::vector<r3d_plane>> cell_planes(nmissing);
+    std::vector<std::array<double, 6>> cell_bounds(nmissing);
+    Portage::for_each(make_counting_iterator(0),
+                      make_counting_iterator(nmissing),
+                      [&](int i) {
+                        cell_get_planes(mesh, missing[i], &cell_planes[i],
+                                        &cell_bounds[i]);
+                      });
+
+    for (int i = 0; i < nmissing; i++) {
+      slots_[missing[i]] = offsets_.size() - 1;
+      planes_.insert(planes_.end(), cell_planes[i].begin(),
+                     cell_planes[i].end());
+      offsets_.push_back(planes_.size());
+      bounds_.insert(bounds_.end(), cell_bounds[i].begin(),
+                     cell_bounds[i].end());
+    }
+  }
+
+  /// Forget all cells
+  void clear() {
+    slots_.clear();
+    planes_.clear();
+    offsets_.assign(1, 0);
+    bounds_.clear();
+  }
+
+  /*!
+    @brief Clipping planes and bounding box of one cell of a mesh
+    @param[in] mesh     mesh wrapper
+    @param[in] c        cell
+    @param[out] planes  planes of its faces if it is convex with planar
+                        faces, none otherwise
+    @param[out] bounds  xmin, xmax, ymin, ymax, zmin, zmax
+  */
+  template<class Mesh>
+  static void cell_get_planes(Mesh const& mesh, int c,
+                              std::vector<r3d_plane>* planes,
+                              std::array<double, 6>* bounds) {
+    std::vector<int> faces, dirs, nodes;
+    mesh.cell_get_faces_and_dirs(c, &faces, &dirs);
+
+    for (int j = 0; j < 3; j++) {
+      (*bounds)[2*j] = 1e99;
+      (*bounds)[2*j+1] = -1e99;
+    }
+
+    std::vector<std::vector<Point<3>>> face_points(faces.size());
+    for (int i = 0; i < static_cast<int>(faces.size()); i++) {
+      mesh.face_get_nodes(faces[i], &nodes);
+      for (int n : nodes) {
+        Point<3> p;
+        mesh.node_get_coordinates(n, &p);
+        face_points[i].push_back(p);
+        for (int j = 0; j < 3; j++) {
+          (*bounds)[2*j] = std::min((*bounds)[2*j], p[j]);
+          (*bounds)[2*j+1] = std::max((*bounds)[2*j+1], p[j]);
+        }
+      }
+    }
+
+    convex_polyhedron_planes(face_points, planes);
+  }
+
+ private:
+  std::vector<int> slots_;           // index of each cell, -1 if not computed
+  std::vector<r3d_plane> planes_;    // planes of all computed cells
+  std::vector<int> offsets_ {0};     // first plane of each computed cell
+  std::vector<double> bounds_;       // bounding box of each computed cell
+};
+
+
+// Intersect one source polyhedron (possibly non-convex but with
+// triangular facets only) with a convex target polyhedron, clipping it
+// against the target faces at once instead of against each of the tets
+// of a decomposition of the target
+
+inline
+void
+intersect_polys_r3d(FacetedPolyView const& srcpoly,
+                    ConvexPolyPlanes const& target,
+                    NumericTolerances_t num_tols,
+                    double* moments) {
+
+  double source_cell_bounds[6];
+  r3d_poly src_r3dpoly;
+  init_r3d_source_poly(srcpoly, &src_r3dpoly, source_cell_bounds);
+
+  std::fill(moments, moments + 4, 0.);
+
+  // Check if the target and source bounding boxes overlap - bbeps
+  // is used to subject touching cells to the full intersection
+  double bbeps = num_tols.min_absolute_distance;
+  for (int j = 0; j < 3; ++j)
+    if (target.bounds[2*j] > source_cell_bounds[2*j+1]+bbeps ||
+        target.bounds[2*j+1] < source_cell_bounds[2*j]-bbeps)
+      return;
+
+  R3DScratch& scratch = r3d_scratch();
+  scratch.planes.assign(target.planes, target.planes + target.num_planes);
+  r3d_clip(&src_r3dpoly, scratch.planes.data(), target.num_planes);
+
+  const int POLY_ORDER = 1;
+  r3d_real om[R3D_NUM_MOMENTS(POLY_ORDER)];
+  r3d_reduce(&src_r3dpoly, om, POLY_ORDER);
+
+  if (om[0] < num_tols.minimal_intersection_volume)
+    throw std::runtime_error("Negative volume");
+
+  for (int i = 0; i < 4; i++)
+    moments[i] = om[i];
+}
+
+
+// Same as above for a polyhedron in the facetedpoly_t layout
+
+template<class TargetPoly>
+void
+intersect_polys_r3d(const facetedpoly_t &srcpoly,
+                    TargetPoly const& target_poly,
+                    NumericTolerances_t num_tols,
+                    double* moments) {
+
+  R3DScratch& scratch = r3d_scratch();
+  scratch.facetoffsets.assign(1, 0);
+  scratch.facetpoints.clear();
+  for (auto const& facet : srcpoly.facetpoints) {
+    scratch.facetpoints.insert(scratch.facetpoints.end(),
+                               facet.begin(), facet.end());
+    scratch.facetoffsets.push_back(scratch.facetpoints.size());
+  }
+
+  FacetedPolyView const view {srcpoly.points.data(),
+                              static_cast<int>(srcpoly.points.size()),
+                              scratch.facetoffsets.data(),
+                              scratch.facetpoints.data(),
+                              static_cast<int>(srcpoly.facetpoints.size())};
+  intersect_polys_r3d(view, target_poly, num_tols, moments);
 }  // intersect_polys_3D
 
+
+// Same as the above, returning the moments
+
+template<class SourcePoly, class TargetPoly>
+std::vector<double>
+intersect_polys_r3d(SourcePoly const& srcpoly,
+                    TargetPoly const& target_poly,
+                    NumericTolerances_t num_tols) {
+  std::vector<double> moments(4, 0);
+  intersect_polys_r3d(srcpoly, target_poly, num_tols, moments.data());
+  return moments;
+}
+
 }  // namespace Portage
 
 #endif  // INTERSECT_POLYS_R3D_H
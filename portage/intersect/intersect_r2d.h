@@ -12,6 +12,7 @@ Please see the license file at the root of this repository, or at:
 #include <stdexcept>
 #include <vector>
 #include <algorithm>
+#include <memory>
 
 // portage includes
 extern "C" {
@@ -19,7 +20,9 @@ extern "C" {
 }
 #include "portage/support/portage.h"
 #include "portage/intersect/dummy_interface_reconstructor.h"
+#include "portage/intersect/intersect_boxes.h"
 #include "portage/intersect/intersect_polys_r2d.h"
+#include "portage/intersect/intersection_cache.h"
 
 #ifdef HAVE_TANGRAM
 #include "tangram/driver/CellMatPoly.h"
@@ -154,23 +157,63 @@ class IntersectR2D<Entity_kind::CELL, SourceMeshType, SourceStateType, TargetMes
     matid_ = m;
   }
 
+  /// \brief Share the per-cell data derived from the meshes with the
+  /// other intersectors built for the same meshes
+  /// \param[in] cache  cache of the per-cell data of these meshes
+
+  void set_cache(std::shared_ptr<IntersectionCache<2>> cache) {
+    cache_ = cache;
+  }
+
+  /// \brief Find which of the target cells about to be intersected and
+  /// of their candidate source cells are axis-aligned boxes, if not in
+  /// the cache yet. Cells that were not prepared are examined on the
+  /// fly. Unlike the intersection itself, this is not thread safe.
+  /// \param[in] tgt_cells  target cells about to be intersected
+  /// \param[in] src_cells  their candidate source cells (repeats allowed)
+
+  void prepare(std::vector<int> const& tgt_cells,
+               std::vector<int> const& src_cells) {
+    cache_->source_boxes.add(sourceMeshWrapper, src_cells);
+    cache_->target_boxes.add(targetMeshWrapper, tgt_cells);
+  }
+
   /// \brief Intersect target cell with a set of source cell
   /// \param[in] tgt_entity  Cell of target mesh to intersect
   /// \param[in] src_entities List of source cells to intersect against
   /// \return vector of Weights_t structure containing moments of intersection
 
   std::vector<Weights_t> operator() (int tgt_cell, std::vector<int> const& src_cells) const {
+    return intersection_weights<3>(*this, tgt_cell, src_cells);
+  }
+
+  /// \brief Intersect target cell with a set of source cells, writing
+  /// the intersections of positive volume to flat arrays instead of
+  /// building a list of Weights_t
+  /// \param[in] tgt_cell  Cell of target mesh to intersect
+  /// \param[in] src_cells List of source cells to intersect against
+  /// \param[out] entities Intersected source cells (room for src_cells.size())
+  /// \param[out] moments  3 moments per intersected source cell
+  /// \return number of intersected source cells
+
+  int intersect(int tgt_cell, std::vector<int> const& src_cells,
+                int* entities, double* moments) const {
     std::vector<Wonton::Point<2>> target_poly;
     targetMeshWrapper.cell_get_coordinates(tgt_cell, &target_poly);
 
+    // Bounds of the target cell if it is an axis-aligned box
+    Wonton::Point<2> target_box[2];
+    bool const is_box = cache_->target_boxes.cell_box(targetMeshWrapper,
+                                                      tgt_cell, &target_box[0],
+                                                      &target_box[1]);
+
     int nsrc = src_cells.size();
-    std::vector<Weights_t> sources_and_weights(nsrc);
     int ninserted = 0;
     for (int i = 0; i < nsrc; i++) {
       int s = src_cells[i];
 
-      Weights_t & this_wt = sources_and_weights[ninserted];
-      this_wt.entityID = s;
+      double* this_moments = moments + 3 * ninserted;
+      entities[ninserted] = s;
 
 #ifdef HAVE_TANGRAM
       int nmats = sourceStateWrapper.cell_get_num_mats(s);
@@ -184,11 +227,8 @@ class IntersectR2D<Entity_kind::CELL, SourceMeshType, SourceStateType, TargetMes
         // nmats == 1 && cellmats[0] == matid -- intersection with pure cell
         //                                       containing matid
 
-        std::vector<Wonton::Point<2>> source_poly;
-        sourceMeshWrapper.cell_get_coordinates(s, &source_poly);
-
-        this_wt.weights = intersect_polys_r2d(source_poly, target_poly,
-                                              num_tols_);
+        intersect_source_cell(s, target_poly, is_box ? target_box : nullptr,
+                              this_moments);
 
       } else {  // multi-material case
         // How can I check that I didn't get DummyInterfaceReconstructor
@@ -198,6 +238,7 @@ class IntersectR2D<Entity_kind::CELL, SourceMeshType, SourceStateType, TargetMes
 
         assert(interface_reconstructor != nullptr);  // cannot be nullptr
 
+        std::fill(this_moments, this_moments + 3, 0.);
         if (std::find(cellmats.begin(), cellmats.end(), matid_) !=
             cellmats.end()) {
           // mixed cell containing this material - intersect with
@@ -209,35 +250,30 @@ class IntersectR2D<Entity_kind::CELL, SourceMeshType, SourceStateType, TargetMes
           std::vector<Tangram::MatPoly<2>> matpolys =
               cellmatpoly.get_matpolys(matid_);
 
-          this_wt.weights.resize(3, 0.0);
           for (auto& matpoly : matpolys) {
             std::vector<Wonton::Point<2>> tpnts = matpoly.points();
             std::vector<Wonton::Point<2>> source_poly;
             source_poly.reserve(tpnts.size());
             for (auto const & p : tpnts) source_poly.push_back(p);
 
-            std::vector<double> momvec = intersect_polys_r2d(source_poly,
-                                                  target_poly, num_tols_);
+            double momvec[3];
+            intersect_polys_r2d(source_poly, target_poly, num_tols_, momvec);
             for (int k = 0; k < 3; k++)
-              this_wt.weights[k] += momvec[k];
+              this_moments[k] += momvec[k];
           }
         }
       }
 #else
-      std::vector<Wonton::Point<2>> source_poly;
-      sourceMeshWrapper.cell_get_coordinates(s, &source_poly);
-
-      this_wt.weights = intersect_polys_r2d(source_poly, target_poly,
-                                            num_tols_);
+      intersect_source_cell(s, target_poly, is_box ? target_box : nullptr,
+                              this_moments);
 #endif
 
       // Increment if vol of intersection > 0; otherwise, allow overwrite
-      if (!this_wt.weights.empty() && this_wt.weights[0] > 0.0)
+      if (this_moments[0] > 0.0)
         ninserted++;
     }
 
-    sources_and_weights.resize(ninserted);
-    return sources_and_weights;
+    return ninserted;
   }
 
   IntersectR2D() = delete;
@@ -246,6 +282,27 @@ class IntersectR2D<Entity_kind::CELL, SourceMeshType, SourceStateType, TargetMes
   IntersectR2D & operator = (const IntersectR2D &) = delete;
 
  private:
+
+  // Moments of the intersection of source cell s with the target cell,
+  // in closed form if both are axis-aligned boxes (target_box: bounds of
+  // the target cell if it is)
+  void intersect_source_cell(int s,
+                             std::vector<Wonton::Point<2>> const& target_poly,
+                             Wonton::Point<2> const* target_box,
+                             double* moments) const {
+    Wonton::Point<2> lower, upper;
+    if (target_box &&
+        cache_->source_boxes.cell_box(sourceMeshWrapper, s, &lower, &upper)) {
+      intersect_box_moments<2>(lower, upper, target_box[0], target_box[1],
+                               moments);
+      return;
+    }
+
+    std::vector<Wonton::Point<2>> source_poly;
+    sourceMeshWrapper.cell_get_coordinates(s, &source_poly);
+    intersect_polys_r2d(source_poly, target_poly, num_tols_, moments);
+  }
+
   SourceMeshType const & sourceMeshWrapper;
   SourceStateType const & sourceStateWrapper;
   TargetMeshType const & targetMeshWrapper;
@@ -254,6 +311,8 @@ class IntersectR2D<Entity_kind::CELL, SourceMeshType, SourceStateType, TargetMes
   std::shared_ptr<InterfaceReconstructor2D> interface_reconstructor;
 #endif
   NumericTolerances_t num_tols_;
+  std::shared_ptr<IntersectionCache<2>> cache_ =
+      std::make_shared<IntersectionCache<2>>();
 };  // class IntersectR2D
 
 
@@ -313,29 +372,39 @@ class IntersectR2D<Entity_kind::NODE, SourceMeshType, SourceStateType, TargetMes
   /// \return vector of Weights_t structure containing moments of intersection
 
   std::vector<Weights_t> operator() (int tgt_node, std::vector<int> const& src_nodes) const {
+    return intersection_weights<3>(*this, tgt_node, src_nodes);
+  }
+
+  /// \brief Same as above, writing the intersections of positive volume
+  /// to flat arrays (see the cell specialization)
+  /// \param[in] tgt_node  Target mesh node whose control volume we consider
+  /// \param[in] src_nodes List of source nodes whose control volumes we will intersect against
+  /// \param[out] entities Intersected source nodes (room for src_nodes.size())
+  /// \param[out] moments  3 moments per intersected source node
+  /// \return number of intersected source nodes
+
+  int intersect(int tgt_node, std::vector<int> const& src_nodes,
+                int* entities, double* moments) const {
     std::vector<Wonton::Point<2>> target_poly;
     targetMeshWrapper.dual_cell_get_coordinates(tgt_node, &target_poly);
 
     int nsrc = src_nodes.size();
-    std::vector<Weights_t> sources_and_weights(nsrc);
     int ninserted = 0;
     for (int i = 0; i < nsrc; i++) {
       int s = src_nodes[i];
       std::vector<Wonton::Point<2>> source_poly;
       sourceMeshWrapper.dual_cell_get_coordinates(s, &source_poly);
 
-      Weights_t & this_wt = sources_and_weights[ninserted];
-      this_wt.entityID = s;
-      this_wt.weights = intersect_polys_r2d(source_poly, target_poly,
-                                            num_tols_);
+      double* this_moments = moments + 3 * ninserted;
+      entities[ninserted] = s;
+      intersect_polys_r2d(source_poly, target_poly, num_tols_, this_moments);
 
       // Increment if vol of intersection > 0; otherwise, allow overwrite
-      if (!this_wt.weights.empty() && this_wt.weights[0] > 0.0)
+      if (this_moments[0] > 0.0)
         ninserted++;
     }
 
-    sources_and_weights.resize(ninserted);
-    return sources_and_weights;
+    return ninserted;
   }
 
   IntersectR2D() = delete;
@@ -10,6 +10,7 @@ Please see the license file at the root of this repository, or at:
 #include <array>
 #include <stdexcept>
 #include <vector>
+#include <memory>
 #include <algorithm>
 
 // portage includes
@@ -18,7 +19,9 @@ extern "C" {
 }
 #include "portage/support/portage.h"
 #include "portage/intersect/dummy_interface_reconstructor.h"
+#include "portage/intersect/intersect_boxes.h"
 #include "portage/intersect/intersect_polys_r3d.h"
+#include "portage/intersect/intersection_cache.h"
 
 #ifdef HAVE_TANGRAM
 #include "tangram/driver/CellMatPoly.h"
@@ -38,9 +41,16 @@ namespace Portage {
 /// faces to be intersected with a list of source polyhedra again with
 /// possibly non-planar faces. We will convert the target polyhedron
 /// into a set of convex polyhedra using a symmetric tetrahedral
-/// decomposition (24 tets for a hex). We will convert each source
+/// decomposition (24 tets for a hex), except for the target cells that
+/// are convex with planar faces: the sources are clipped directly by the
+/// planes of their faces (6 planes instead of 24 tets for a hex), which
+/// are kept in an IntersectionCache shared with the other intersectors
+/// built for the same meshes. We will convert each source
 /// polyhedron into a faceted non-convex polyhedron where each facet is
-/// a triangle and therefore planar.
+/// a triangle and therefore planar, also kept in the cache. Pure source
+/// cells and target cells that are both axis-aligned boxes skip r3d
+/// altogether: the moments of their intersection are computed in closed
+/// form.
 ///
 /// If this class is being adapted for use with a different intersector
 /// and it can only intersect convex polyhedra, both target and source
@@ -173,6 +183,37 @@ class IntersectR3D<Entity_kind::CELL, SourceMeshType, SourceStateType, TargetMes
     matid_ = m;
   }
 
+  /// \brief Share the per-cell data derived from the meshes with the
+  /// other intersectors built for the same meshes
+  /// \param[in] cache  cache of the per-cell data of these meshes
+
+  void set_cache(std::shared_ptr<IntersectionCache<3>> cache) {
+    cache_ = cache;
+  }
+
+  /// \brief Compute the per-cell data of target cells and of their
+  /// candidate source cells that is not in the cache yet, before
+  /// intersecting them. Cells that were not prepared are still
+  /// intersected, their data being computed on the fly. Unlike the
+  /// intersection itself, this is not thread safe.
+  /// \param[in] tgt_cells  target cells about to be intersected
+  /// \param[in] src_cells  their candidate source cells (repeats allowed)
+
+  void prepare(std::vector<int> const& tgt_cells,
+               std::vector<int> const& src_cells) {
+    cache_->source_boxes.add(sourceMeshWrapper, src_cells);
+    cache_->target_boxes.add(targetMeshWrapper, tgt_cells);
+    cache_->target_planes.add(targetMeshWrapper, tgt_cells);
+
+    auto const& mesh = sourceMeshWrapper;
+    cache_->source_polys.add(
+        mesh.num_owned_cells() + mesh.num_ghost_cells(), src_cells,
+        [&mesh](int c, std::vector<std::vector<int>>* facetpoints,
+                std::vector<Point<3>>* points) {
+          mesh.cell_get_facetization(c, facetpoints, points);
+        });
+  }
+
   /// \brief Intersect a cell with a set of candidate cells
   /// \param[in] tgt_cell cell of target mesh to intersect
   /// \param[in] src_cells list of source cells to intersect against
@@ -181,24 +222,78 @@ class IntersectR3D<Entity_kind::CELL, SourceMeshType, SourceStateType, TargetMes
 
   std::vector<Weights_t> operator() (const int tgt_cell,
                                      const std::vector<int>& src_cells) const {
+    return intersection_weights<4>(*this, tgt_cell, src_cells);
+  }
 
-    std::vector<std::array<Point<3>, 4>> target_tet_coords;
+  /// \brief Intersect a cell with a set of candidate cells, writing the
+  /// intersections of positive volume to flat arrays instead of building
+  /// a list of Weights_t
+  /// \param[in] tgt_cell cell of target mesh to intersect
+  /// \param[in] src_cells list of source cells to intersect against
+  /// \param[out] entities intersected source cells (room for src_cells.size())
+  /// \param[out] moments 4 moments per intersected source cell
+  /// \return number of intersected source cells
+  ///
 
-    // We should avoid any decomposition for cells of a rectangular
-    // mesh but for now we will decompose the target all the time
+  int intersect(int tgt_cell, std::vector<int> const& src_cells,
+                int* entities, double* moments) const {
+
+    // Clip the sources directly against the faces of convex target
+    // cells and only decompose the other ones into tets
+    if (cache_->target_planes.has(tgt_cell)) {
+      ConvexPolyPlanes const target_planes = cache_->target_planes[tgt_cell];
+      if (target_planes.num_planes > 0)
+        return intersect_target(tgt_cell, src_cells, target_planes,
+                                entities, moments);
+    } else {
+      std::vector<r3d_plane> planes;
+      std::array<double, 6> bounds;
+      ConvexCellPlanes::cell_get_planes(targetMeshWrapper, tgt_cell,
+                                        &planes, &bounds);
+      if (not planes.empty())
+        return intersect_target(tgt_cell, src_cells,
+                                ConvexPolyPlanes {planes.data(),
+                                                  static_cast<int>(planes.size()),
+                                                  bounds.data()},
+                                entities, moments);
+    }
 
+    std::vector<std::array<Point<3>, 4>> target_tet_coords;
     targetMeshWrapper.decompose_cell_into_tets(tgt_cell, &target_tet_coords,
                                                rectangular_mesh_);
+    return intersect_target(tgt_cell, src_cells, target_tet_coords,
+                            entities, moments);
+  }
+
+
+  IntersectR3D() = delete;
+
+  /// Assignment operator (disabled)
+  IntersectR3D & operator = (const IntersectR3D &) = delete;
+
+ private:
+
+  // Moments of the intersections of the target cell, given as convex
+  // planes or tets, with each source cell
+  template<class TargetPoly>
+  int intersect_target(int tgt_cell, std::vector<int> const& src_cells,
+                       TargetPoly const& target_poly,
+                       int* entities, double* moments) const {
+
+    // Bounds of the target cell if it is an axis-aligned box
+    Point<3> target_box[2];
+    bool const is_box = cache_->target_boxes.cell_box(targetMeshWrapper,
+                                                      tgt_cell, &target_box[0],
+                                                      &target_box[1]);
 
     // CAN MAKE THIS INTO A THRUST::TRANSFORM CALL
     int nsrc = src_cells.size();
-    std::vector<Weights_t> sources_and_weights(nsrc);
     int ninserted = 0;
     for (int i = 0; i < nsrc; i++) {
       int s = src_cells[i];
 
-      Weights_t & this_wt = sources_and_weights[ninserted];
-      this_wt.entityID = s;
+      double* this_moments = moments + 4 * ninserted;
+      entities[ninserted] = s;
 
 #ifdef HAVE_TANGRAM
       int nmats = sourceStateWrapper.cell_get_num_mats(s);
@@ -212,59 +307,71 @@ class IntersectR3D<Entity_kind::CELL, SourceMeshType, SourceStateType, TargetMes
         // nmats == 1 && cellmats[0] == matid -- intersection with pure cell
         //                                       containing matid
 
-        facetedpoly_t srcpoly;
-        sourceMeshWrapper.cell_get_facetization(s, &srcpoly.facetpoints,
-                                                &srcpoly.points);
-
-        this_wt.weights = intersect_polys_r3d(srcpoly, target_tet_coords,
-                                              num_tols_);
-
-      } else if (std::find(cellmats.begin(), cellmats.end(), matid_) !=
-                 cellmats.end()) {
-        // mixed cell containing this material - intersect with
-        // polygon approximation of this material in the cell
-        // (obtained from interface reconstruction)
-
-        Tangram::CellMatPoly<3> const& cellmatpoly =
-            interface_reconstructor->cell_matpoly_data(s);
-        std::vector<Tangram::MatPoly<3>> matpolys =
-            cellmatpoly.get_matpolys(matid_);
-
-        this_wt.weights.resize(4,0.0);
-        for (const auto& matpoly : matpolys) {
-          facetedpoly_t srcpoly = get_faceted_matpoly(matpoly);
-
-          std::vector<double> momvec = intersect_polys_r3d(srcpoly,
-                                          target_tet_coords, num_tols_);
-          for (int k = 0; k < 4; k++)
-            this_wt.weights[k] += momvec[k];
+        intersect_source_cell(s, target_poly, is_box ? target_box : nullptr,
+                              this_moments);
+
+      } else {
+        std::fill(this_moments, this_moments + 4, 0.);
+        if (std::find(cellmats.begin(), cellmats.end(), matid_) !=
+            cellmats.end()) {
+          // mixed cell containing this material - intersect with
+          // polygon approximation of this material in the cell
+          // (obtained from interface reconstruction)
+
+          Tangram::CellMatPoly<3> const& cellmatpoly =
+              interface_reconstructor->cell_matpoly_data(s);
+          std::vector<Tangram::MatPoly<3>> matpolys =
+              cellmatpoly.get_matpolys(matid_);
+
+          for (const auto& matpoly : matpolys) {
+            facetedpoly_t srcpoly = get_faceted_matpoly(matpoly);
+
+            double momvec[4];
+            intersect_polys_r3d(srcpoly, target_poly, num_tols_, momvec);
+            for (int k = 0; k < 4; k++)
+              this_moments[k] += momvec[k];
+          }
         }
-
       }
 #else
-      facetedpoly_t srcpoly;
-      sourceMeshWrapper.cell_get_facetization(s, &srcpoly.facetpoints,
-                                              &srcpoly.points);
-
-      this_wt.weights = intersect_polys_r3d(srcpoly, target_tet_coords,
-                                            num_tols_);
+      intersect_source_cell(s, target_poly, is_box ? target_box : nullptr,
+                              this_moments);
 #endif
       // Increment if vol of intersection > 0; otherwise, allow overwrite
-      if (!this_wt.weights.empty() && this_wt.weights[0] > 0.0)
+      if (this_moments[0] > 0.0)
         ninserted++;
     }
 
-    sources_and_weights.resize(ninserted);
-    return sources_and_weights;
+    return ninserted;
   }
 
+  // Moments of the intersection of source cell s with the target cell
+  // given as convex planes or tets, in closed form if both cells are
+  // axis-aligned boxes (target_box: bounds of the target cell if it is)
+  template<class TargetPoly>
+  void intersect_source_cell(int s, TargetPoly const& target_poly,
+                             Point<3> const* target_box,
+                             double* moments) const {
+    Point<3> lower, upper;
+    if (target_box &&
+        cache_->source_boxes.cell_box(sourceMeshWrapper, s, &lower, &upper)) {
+      intersect_box_moments<3>(lower, upper, target_box[0], target_box[1],
+                               moments);
+      return;
+    }
 
-  IntersectR3D() = delete;
+    if (cache_->source_polys.has(s)) {
+      intersect_polys_r3d(cache_->source_polys[s], target_poly, num_tols_,
+                          moments);
+      return;
+    }
 
-  /// Assignment operator (disabled)
-  IntersectR3D & operator = (const IntersectR3D &) = delete;
+    facetedpoly_t srcpoly;
+    sourceMeshWrapper.cell_get_facetization(s, &srcpoly.facetpoints,
+                                            &srcpoly.points);
+    intersect_polys_r3d(srcpoly, target_poly, num_tols_, moments);
+  }
 
- private:
   SourceMeshType const & sourceMeshWrapper;
   SourceStateType const & sourceStateWrapper;
   TargetMeshType const & targetMeshWrapper;
@@ -274,6 +381,8 @@ class IntersectR3D<Entity_kind::CELL, SourceMeshType, SourceStateType, TargetMes
   bool rectangular_mesh_ = false;
   int matid_ = -1;
   NumericTolerances_t num_tols_ {};
+  std::shared_ptr<IntersectionCache<3>> cache_ =
+      std::make_shared<IntersectionCache<3>>();
 };
 
 
@@ -326,6 +435,32 @@ class IntersectR3D<Entity_kind::NODE, SourceMeshType, SourceStateType, TargetMes
     matid_ = m;
   }
 
+  /// \brief Share the per-cell data derived from the meshes with the
+  /// other intersectors built for the same meshes
+  /// \param[in] cache  cache of the per-cell data of these meshes
+
+  void set_cache(std::shared_ptr<IntersectionCache<3>> cache) {
+    cache_ = cache;
+  }
+
+  /// \brief Facetize the control volumes of the candidate source nodes
+  /// that are not in the cache yet, before intersecting them. Nodes that
+  /// were not prepared are facetized on the fly. Unlike the intersection
+  /// itself, this is not thread safe.
+  /// \param[in] tgt_nodes  target nodes about to be intersected
+  /// \param[in] src_nodes  their candidate source nodes (repeats allowed)
+
+  void prepare(std::vector<int> const& tgt_nodes,
+               std::vector<int> const& src_nodes) {
+    auto const& mesh = sourceMeshWrapper;
+    cache_->source_dual_polys.add(
+        mesh.num_owned_nodes() + mesh.num_ghost_nodes(), src_nodes,
+        [&mesh](int n, std::vector<std::vector<int>>* facetpoints,
+                std::vector<Point<3>>* points) {
+          mesh.dual_cell_get_facetization(n, facetpoints, points);
+        });
+  }
+
   /// \brief Intersect a control volume corresponding to a target node
   /// with a set of control volumes corresponding to candidate source
   /// nodes
@@ -336,10 +471,20 @@ class IntersectR3D<Entity_kind::NODE, SourceMeshType, SourceStateType, TargetMes
 
   std::vector<Weights_t> operator() (const int tgt_node,
                                      const std::vector<int>& src_nodes) const {
+    return intersection_weights<4>(*this, tgt_node, src_nodes);
+  }
 
-    // for debug
-    Point<3> tgtxyz;
-    targetMeshWrapper.node_get_coordinates(tgt_node, &tgtxyz);
+  /// \brief Same as above, writing the intersections of positive volume
+  /// to flat arrays (see the cell specialization)
+  /// \param[in] tgt_node   Target mesh node whose control volume we consider
+  /// \param[in] src_nodes  List of source nodes whose control volumes we will intersect against
+  /// \param[out] entities  intersected source nodes (room for src_nodes.size())
+  /// \param[out] moments   4 moments per intersected source node
+  /// \return number of intersected source nodes
+  ///
+
+  int intersect(int tgt_node, std::vector<int> const& src_nodes,
+                int* entities, double* moments) const {
 
     std::vector<std::array<Point<3>, 4>> target_tet_coords;
 
@@ -352,27 +497,29 @@ class IntersectR3D<Entity_kind::NODE, SourceMeshType, SourceStateType, TargetMes
 
     // CAN MAKE THIS INTO A THRUST TRANSFORM CALL
     int nsrc = src_nodes.size();
-    std::vector<Weights_t> sources_and_weights(nsrc);
     int ninserted = 0;
     for (int i = 0; i < nsrc; i++) {
       int s = src_nodes[i];
 
-      facetedpoly_t srcpoly;
-      sourceMeshWrapper.dual_cell_get_facetization(s, &srcpoly.facetpoints,
-                                                   &srcpoly.points);
-
-      Weights_t & this_wt = sources_and_weights[ninserted];
-      this_wt.entityID = s;
-      this_wt.weights = intersect_polys_r3d(srcpoly, target_tet_coords,
-                                            num_tols_);
+      double* this_moments = moments + 4 * ninserted;
+      entities[ninserted] = s;
+      if (cache_->source_dual_polys.has(s))
+        intersect_polys_r3d(cache_->source_dual_polys[s], target_tet_coords,
+                            num_tols_, this_moments);
+      else {
+        facetedpoly_t srcpoly;
+        sourceMeshWrapper.dual_cell_get_facetization(s, &srcpoly.facetpoints,
+                                                     &srcpoly.points);
+        intersect_polys_r3d(srcpoly, target_tet_coords, num_tols_,
+                            this_moments);
+      }
 
       // Increment if vol of intersection > 0; otherwise, allow overwrite
-      if (!this_wt.weights.empty() && this_wt.weights[0] > 0.0)
+      if (this_moments[0] > 0.0)
         ninserted++;
     }
 
-    sources_and_weights.resize(ninserted);
-    return sources_and_weights;
+    return ninserted;
   }
 
 
@@ -382,6 +529,7 @@ class IntersectR3D<Entity_kind::NODE, SourceMeshType, SourceStateType, TargetMes
   IntersectR3D & operator = (const IntersectR3D &) = delete;
 
  private:
+
   SourceMeshType const & sourceMeshWrapper;
   SourceStateType const & sourceStateWrapper;
   TargetMeshType const & targetMeshWrapper;
@@ -391,6 +539,8 @@ class IntersectR3D<Entity_kind::NODE, SourceMeshType, SourceStateType, TargetMes
   bool rectangular_mesh_ = false;
   int matid_ = -1;
   NumericTolerances_t num_tols_ {};
+  std::shared_ptr<IntersectionCache<3>> cache_ =
+      std::make_shared<IntersectionCache<3>>();
 };  // class IntersectR3D
 
 
@@ -0,0 +1,65 @@
+/*
+This file is part of the Ristra portage project.
+Please see the license file at the root of this repository, or at:
+    https://github.com/laristra/portage/blob/master/LICENSE
+*/
+
+#ifndef PORTAGE_INTERSECT_INTERSECTION_CACHE_H_
+#define PORTAGE_INTERSECT_INTERSECTION_CACHE_H_
+
+#include "portage/intersect/intersect_boxes.h"
+#include "portage/intersect/intersect_polys_r3d.h"
+
+namespace Portage {
+
+/*!
+  @class IntersectionCache intersection_cache.h
+  @brief Per-cell data that the generic intersectors derive from the
+  geometry of a source and a target mesh, e.g. the clipping planes of
+  the convex target cells, the bounds of the axis-aligned box cells or
+  the facetizations of the source cells.
+
+  The data of a cell is only computed when the cell is about to be
+  intersected (see the prepare methods of IntersectR2D and
+  IntersectR3D), then kept. A cache handed to all the intersectors
+  built for the same pair of meshes (see CoreDriver::set_intersection_cache)
+  spares them recomputing it for the mesh intersection, for each material
+  and, when kept by a RemapPlan, for each remap until a mesh changes.
+  It is up to the owner to discard the cache when a mesh changes; the
+  tables only detect a change in the number of cells.
+
+  @tparam D  dimension of the meshes (the tables of 3D intersectors stay
+  empty in 2D)
+*/
+template<int D>
+struct IntersectionCache {
+
+  /// Axis-aligned box cells of the source mesh
+  AxisAlignedCells<D> source_boxes;
+
+  /// Axis-aligned box cells of the target mesh
+  AxisAlignedCells<D> target_boxes;
+
+  /// Clipping planes of the convex target cells (3D)
+  ConvexCellPlanes target_planes;
+
+  /// Facetizations of the source cells (3D)
+  FacetedCells source_polys;
+
+  /// Facetizations of the source dual cells, i.e. the control volumes
+  /// of the source nodes (3D)
+  FacetedCells source_dual_polys;
+
+  /// Forget all cells
+  void clear() {
+    source_boxes.clear();
+    target_boxes.clear();
+    target_planes.clear();
+    source_polys.clear();
+    source_dual_polys.clear();
+  }
+};
+
+}  // namespace Portage
+
+#endif  // PORTAGE_INTERSECT_INTERSECTION_CACHE_H_
@@ -0,0 +1,133 @@
+/*
+This file is part of the Ristra portage project.
+Please see the license file at the root of this repository, or at:
+    https://github.com/laristra/portage/blob/master/LICENSE
+*/
+
+#ifndef PORTAGE_INTERSECT_MATERIAL_MOMENTS_H_
+#define PORTAGE_INTERSECT_MATERIAL_MOMENTS_H_
+
+#include <vector>
+
+#include "portage/support/portage.h"
+
+#include "wonton/support/Point.h"
+
+/*!
+  @file material_moments.h
+  @brief Volume and centroid of each material in each of its cells.
+*/
+
+namespace Portage {
+
+/*!
+  @class MaterialMoments "material_moments.h"
+  @brief Volume and centroid of each material in each of its cells, stored
+  material by material in the order of the material cell lists of the state.
+
+  The moments of a material in a mixed cell are the sum of the moments of
+  its material polytopes given by the interface reconstructor. Computing
+  them once after the reconstruction spares the gradient and interpolation
+  kernels from summing the polytope moments of a cell again for every
+  neighboring cell, every source-target pair and every field. The moments
+  of a material in a pure cell are the ones of the cell itself.
+
+  @tparam D  dimension of the mesh
+*/
+template<int D>
+class MaterialMoments {
+ public:
+
+  //! Empty moments
+  MaterialMoments() = default;
+
+  /*!
+    @brief Compute the moments of all the materials of the state
+    @param[in] mesh   mesh wrapper
+    @param[in] state  state wrapper giving the material cell lists
+    @param[in] ir     interface reconstructor giving the material polytopes
+    of the mixed cells
+  */
+  template<class Mesh, class State, class InterfaceReconstructor>
+  void compute(Mesh const& mesh, State const& state,
+               InterfaceReconstructor const& ir) {
+
+    int const nb_mats = state.num_materials();
+    volumes_.resize(nb_mats);
+    centroids_.resize(nb_mats);
+
+    for (int m = 0; m < nb_mats; m++) {
+      std::vector<int> cells;
+      state.mat_get_cells(m, &cells);
+
+      int const nb_cells = cells.size();
+      volumes_[m].assign(nb_cells, 0.);
+      centroids_[m].assign(nb_cells, Wonton::Point<D>());
+
+      auto* volumes = volumes_[m].data();
+      auto* centroids = centroids_[m].data();
+
+      Portage::for_each(make_counting_iterator(0),
+                        make_counting_iterator(nb_cells),
+                        [&](int i) {
+        int const c = cells[i];
+        if (state.cell_get_num_mats(c) > 1) /* mixed cell */ {
+          auto const& cell_matpoly = ir.cell_matpoly_data(c);
+          auto matpolys = cell_matpoly.get_matpolys(m);
+
+          double volume = 0.;
+          Wonton::Point<D> centroid;
+          for (auto&& poly : matpolys) {
+            auto moments = poly.moments();
+            volume += moments[0];
+            for (int k = 0; k < D; k++)
+              centroid[k] += moments[k + 1];
+          }
+
+          // r3d may return a single zero volume polytope: keep a zero
+          // volume so that callers can skip it, and a null centroid
+          if (volume != 0.) {
+            for (int k = 0; k < D; k++)
+              centroid[k] /= volume;
+          }
+
+          volumes[i] = volume;
+          centroids[i] = centroid;
+        } else /* pure cell */ {
+          volumes[i] = mesh.cell_volume(c);
+          mesh.cell_centroid(c, &centroids[i]);
+        }
+      });
+    }
+  }
+
+  //! Whether the moments were computed
+  bool empty() const { return volumes_.empty(); }
+
+  //! Number of materials
+  int num_materials() const { return volumes_.size(); }
+
+  /*!
+    @brief Volume of a material in one of its cells
+    @param[in] m  material id
+    @param[in] i  index of the cell in the cell list of the material
+  */
+  double volume(int m, int i) const { return volumes_[m][i]; }
+
+  /*!
+    @brief Centroid of a material in one of its cells
+    @param[in] m  material id
+    @param[in] i  index of the cell in the cell list of the material
+  */
+  Wonton::Point<D> const& centroid(int m, int i) const {
+    return centroids_[m][i];
+  }
+
+ private:
+  std::vector<std::vector<double>> volumes_;
+  std::vector<std::vector<Wonton::Point<D>>> centroids_;
+};
+
+}  // namespace Portage
+
+#endif  // PORTAGE_INTERSECT_MATERIAL_MOMENTS_H_
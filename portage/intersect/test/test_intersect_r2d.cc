@@ -55,3 +55,113 @@ TEST(intersectR2D, simple1) {
   ASSERT_NEAR(moments[1], 1.5, eps);
   ASSERT_NEAR(moments[2], 1.5, eps);
 }
+
+/*!
+ * @brief Only quads whose nodes are the corners of their bounding box,
+ * in any order, are taken as axis-aligned boxes.
+ */
+TEST(intersectR2D, axis_aligned_cells) {
+  using Wonton::Point;
+  Point<2> lower, upper;
+
+  std::vector<Point<2>> square = {{1, 2}, {1, 3}, {2, 3}, {2, 2}};
+  ASSERT_TRUE(Portage::AxisAlignedCells<2>::box_bounds(square, &lower, &upper));
+  ASSERT_NEAR(1.0, lower[0], 1.E-12);
+  ASSERT_NEAR(2.0, lower[1], 1.E-12);
+  ASSERT_NEAR(2.0, upper[0], 1.E-12);
+  ASSERT_NEAR(3.0, upper[1], 1.E-12);
+
+  std::vector<Point<2>> skewed = {{1, 2}, {2, 2}, {2.1, 3}, {1, 3}};
+  ASSERT_FALSE(Portage::AxisAlignedCells<2>::box_bounds(skewed, &lower, &upper));
+
+  std::vector<Point<2>> repeated = {{1, 2}, {2, 2}, {2, 3}, {2, 2}};
+  ASSERT_FALSE(Portage::AxisAlignedCells<2>::box_bounds(repeated, &lower, &upper));
+
+  std::vector<Point<2>> triangle = {{1, 2}, {2, 2}, {2, 3}};
+  ASSERT_FALSE(Portage::AxisAlignedCells<2>::box_bounds(triangle, &lower, &upper));
+}
+
+/*!
+ * @brief Pairs of box cells intersected in closed form give the same
+ * moments as clipping them with r2d.
+ */
+TEST(intersectR2D, box_cells) {
+  auto sourcemesh = std::make_shared<Wonton::Simple_Mesh>(0, 0, 1, 1, 3, 3);
+  auto targetmesh = std::make_shared<Wonton::Simple_Mesh>(0.1, 0.2, 0.9, 0.7, 2, 2);
+  auto sourcestate = std::make_shared<Wonton::Simple_State>(sourcemesh);
+  const Wonton::Simple_Mesh_Wrapper sm(*sourcemesh);
+  const Wonton::Simple_Mesh_Wrapper tm(*targetmesh);
+  const Wonton::Simple_State_Wrapper ss(*sourcestate);
+
+  Portage::NumericTolerances_t num_tols = Portage::DEFAULT_NUMERIC_TOLERANCES<2>;
+
+  const Portage::IntersectR2D<Portage::Entity_kind::CELL,
+                              Wonton::Simple_Mesh_Wrapper,
+                              Wonton::Simple_State_Wrapper,
+                              Wonton::Simple_Mesh_Wrapper> isect{sm, ss, tm, num_tols};
+
+  std::vector<int> srccells(9);
+  for (int s = 0; s < 9; s++)
+    srccells[s] = s;
+
+  for (int t = 0; t < 4; t++) {
+    std::vector<Wonton::Point<2>> target_poly;
+    tm.cell_get_coordinates(t, &target_poly);
+
+    const std::vector<Portage::Weights_t> srcwts = isect(t, srccells);
+    ASSERT_EQ(unsigned(4), srcwts.size());
+
+    for (auto const& wt : srcwts) {
+      std::vector<Wonton::Point<2>> source_poly;
+      sm.cell_get_coordinates(wt.entityID, &source_poly);
+      std::vector<double> moments =
+          Portage::intersect_polys_r2d(source_poly, target_poly, num_tols);
+      ASSERT_EQ(moments.size(), wt.weights.size());
+      for (unsigned k = 0; k < moments.size(); k++)
+        ASSERT_NEAR(moments[k], wt.weights[k], 1.E-12);
+    }
+  }
+}
+
+/*!
+ * @brief Box cells are only examined when prepared, and cells that were
+ * not prepared are examined on the fly with the same result.
+ */
+TEST(intersectR2D, shared_cache) {
+  auto sourcemesh = std::make_shared<Wonton::Simple_Mesh>(0, 0, 1, 1, 3, 3);
+  auto targetmesh = std::make_shared<Wonton::Simple_Mesh>(0.1, 0.2, 0.9, 0.7, 2, 2);
+  auto sourcestate = std::make_shared<Wonton::Simple_State>(sourcemesh);
+  const Wonton::Simple_Mesh_Wrapper sm(*sourcemesh);
+  const Wonton::Simple_Mesh_Wrapper tm(*targetmesh);
+  const Wonton::Simple_State_Wrapper ss(*sourcestate);
+
+  Portage::NumericTolerances_t num_tols = Portage::DEFAULT_NUMERIC_TOLERANCES<2>;
+
+  using Intersector = Portage::IntersectR2D<Portage::Entity_kind::CELL,
+                                            Wonton::Simple_Mesh_Wrapper,
+                                            Wonton::Simple_State_Wrapper,
+                                            Wonton::Simple_Mesh_Wrapper>;
+  Intersector on_the_fly(sm, ss, tm, num_tols);
+  Intersector cached(sm, ss, tm, num_tols);
+
+  auto cache = std::make_shared<Portage::IntersectionCache<2>>();
+  cached.set_cache(cache);
+
+  std::vector<int> const sources = {0, 1, 3, 4};
+  cached.prepare({0}, sources);
+  ASSERT_TRUE(cache->target_boxes.is_box(0));
+  ASSERT_FALSE(cache->target_boxes.has(1));
+  ASSERT_TRUE(cache->source_boxes.is_box(4));
+  ASSERT_FALSE(cache->source_boxes.has(5));
+
+  for (int t = 0; t < 4; t++) {
+    std::vector<Portage::Weights_t> const expected = on_the_fly(t, sources);
+    std::vector<Portage::Weights_t> const weights = cached(t, sources);
+    ASSERT_EQ(expected.size(), weights.size());
+    for (unsigned i = 0; i < weights.size(); i++) {
+      ASSERT_EQ(expected[i].entityID, weights[i].entityID);
+      for (unsigned k = 0; k < weights[i].weights.size(); k++)
+        ASSERT_NEAR(expected[i].weights[k], weights[i].weights[k], 1.E-12);
+    }
+  }
+}
@@ -3,6 +3,8 @@ This file is part of the Ristra portage project.
 Please see the license file at the root of this repository, or at:
     https://github.com/laristra/portage/blob/master/LICENSE
 */
+#include <cmath>
+
 #include "gtest/gtest.h"
 
 // portage includes
@@ -12,6 +14,7 @@ Please see the license file at the root of this repository, or at:
 // wonton includes
 #include "wonton/mesh/simple/simple_mesh.h"
 #include "wonton/mesh/simple/simple_mesh_wrapper.h"
+#include "wonton/mesh/flat/flat_mesh_wrapper.h"
 #include "wonton/state/simple/simple_state.h"
 #include "wonton/state/simple/simple_state_wrapper.h"
 
@@ -441,3 +444,227 @@ TEST(intersectR3D, cube_0_1) {
     ASSERT_NEAR(moments[3], 0.0, eps);
   }
 }
+
+// Coordinates of the nodes of each face of a cell
+std::vector<std::vector<Wonton::Point<3>>>
+cell_faces(Wonton::Simple_Mesh_Wrapper const& mesh, int c) {
+  std::vector<int> faces, dirs, nodes;
+  mesh.cell_get_faces_and_dirs(c, &faces, &dirs);
+  std::vector<std::vector<Wonton::Point<3>>> face_points(faces.size());
+  for (unsigned i = 0; i < faces.size(); i++) {
+    mesh.face_get_nodes(faces[i], &nodes);
+    for (int n : nodes) {
+      Wonton::Point<3> p;
+      mesh.node_get_coordinates(n, &p);
+      face_points[i].push_back(p);
+    }
+  }
+  return face_points;
+}
+
+// Bounding box of a cell (xmin, xmax, ymin, ymax, zmin, zmax)
+void cell_bounds(Wonton::Simple_Mesh_Wrapper const& mesh, int c,
+                 double bounds[6]) {
+  std::vector<Wonton::Point<3>> points;
+  mesh.cell_get_coordinates(c, &points);
+  for (int j = 0; j < 3; j++) {
+    bounds[2*j] = 1e99;
+    bounds[2*j+1] = -1e99;
+    for (auto const& p : points) {
+      bounds[2*j] = std::min(bounds[2*j], p[j]);
+      bounds[2*j+1] = std::max(bounds[2*j+1], p[j]);
+    }
+  }
+}
+
+// Source cells facetized once when prepared, or box cells intersected in
+// closed form, give the same moments as facetizing them for every pair.
+// The interior nodes of the source mesh are moved so that the cells
+// around them are not boxes and go through the facetized path.
+TEST(intersectR3D, prefaceted_sources) {
+  auto sourcemesh = std::make_shared<Wonton::Simple_Mesh>(0, 0, 0, 1, 1, 1, 3, 3, 3);
+  auto targetmesh = std::make_shared<Wonton::Simple_Mesh>(0.1, 0.2, 0.3, 0.9, 0.8, 0.7, 2, 2, 2);
+  const Wonton::Simple_Mesh_Wrapper sourcewrapper(*sourcemesh);
+  const Wonton::Simple_Mesh_Wrapper tm(*targetmesh);
+
+  // flat copy of the source mesh, whose node coordinates can be changed
+  Wonton::Flat_Mesh_Wrapper<> sm;
+  sm.initialize(sourcewrapper);
+  std::vector<double>& coords = sm.get_coords();
+  int const nnodes = coords.size() / 3;
+  int nmoved = 0;
+  for (int n = 0; n < nnodes; n++) {
+    double* p = &coords[3*n];
+    bool interior = true;
+    for (int d = 0; d < 3; d++)
+      interior &= (p[d] > 1.e-12 && p[d] < 1. - 1.e-12);
+    if (!interior)
+      continue;
+    for (int d = 0; d < 3; d++)
+      p[d] += 0.05 * std::sin(2 * M_PI * (p[0] + 2*p[1] + 3*p[2]) + d);
+    nmoved++;
+  }
+  ASSERT_EQ(8, nmoved);
+
+  // every cell has an interior node: none of them is a box anymore
+  Portage::AxisAlignedCells<3> const boxes(sm);
+  for (int s = 0; s < 27; s++)
+    ASSERT_FALSE(boxes.is_box(s));
+
+  auto sourcestate = std::make_shared<Wonton::Simple_State>(sourcemesh);
+  const Wonton::Simple_State_Wrapper ss(*sourcestate);
+
+  Portage::NumericTolerances_t num_tols = Portage::DEFAULT_NUMERIC_TOLERANCES<3>;
+
+  Portage::IntersectR3D<Portage::Entity_kind::CELL,
+                        Wonton::Flat_Mesh_Wrapper<>,
+                        Wonton::Simple_State_Wrapper,
+                        Wonton::Simple_Mesh_Wrapper> isect{sm, ss, tm, num_tols};
+
+  std::vector<int> srccells(27);
+  for (int s = 0; s < 27; s++)
+    srccells[s] = s;
+  isect.prepare({0, 1, 2, 3, 4, 5, 6, 7}, srccells);
+
+  for (int t = 0; t < 8; t++) {
+    // the target cells are boxes: they are clipped against as planes
+    std::vector<r3d_plane> planes;
+    ASSERT_TRUE(Portage::convex_polyhedron_planes(cell_faces(tm, t), &planes));
+    double bounds[6];
+    cell_bounds(tm, t, bounds);
+    Portage::ConvexPolyPlanes const target{planes.data(),
+                                           static_cast<int>(planes.size()),
+                                           bounds};
+
+    const std::vector<Portage::Weights_t> srcwts = isect(t, srccells);
+    ASSERT_FALSE(srcwts.empty());
+
+    double volume = 0.;
+    for (auto const& wt : srcwts) {
+      Portage::facetedpoly_t srcpoly;
+      sm.cell_get_facetization(wt.entityID, &srcpoly.facetpoints, &srcpoly.points);
+      std::vector<double> moments =
+          Portage::intersect_polys_r3d(srcpoly, target, num_tols);
+      ASSERT_EQ(moments.size(), wt.weights.size());
+      for (unsigned k = 0; k < moments.size(); k++)
+        ASSERT_NEAR(moments[k], wt.weights[k], 1.e-12);
+      volume += wt.weights[0];
+    }
+
+    // the source cells still tile the domain
+    ASSERT_NEAR(0.4 * 0.3 * 0.2, volume, 1.e-12);
+  }
+}
+
+// Clipping against the faces of a convex target cell gives the same
+// moments as clipping against each tet of its decomposition
+TEST(intersectR3D, convex_target_planes) {
+  auto sourcemesh = std::make_shared<Wonton::Simple_Mesh>(0, 0, 0, 1, 1, 1, 3, 3, 3);
+  auto targetmesh = std::make_shared<Wonton::Simple_Mesh>(0.1, 0.2, 0.3, 0.9, 0.8, 0.7, 2, 2, 2);
+  const Wonton::Simple_Mesh_Wrapper sm(*sourcemesh);
+  const Wonton::Simple_Mesh_Wrapper tm(*targetmesh);
+
+  Portage::NumericTolerances_t num_tols = Portage::DEFAULT_NUMERIC_TOLERANCES<3>;
+
+  for (int t = 0; t < 8; t++) {
+    std::vector<r3d_plane> planes;
+    ASSERT_TRUE(Portage::convex_polyhedron_planes(cell_faces(tm, t), &planes));
+    ASSERT_EQ(unsigned(6), planes.size());
+    double bounds[6];
+    cell_bounds(tm, t, bounds);
+    Portage::ConvexPolyPlanes const target{planes.data(), 6, bounds};
+
+    std::vector<std::array<Wonton::Point<3>, 4>> target_tet_coords;
+    tm.decompose_cell_into_tets(t, &target_tet_coords, false);
+
+    for (int s = 0; s < 27; s++) {
+      Portage::facetedpoly_t srcpoly;
+      sm.cell_get_facetization(s, &srcpoly.facetpoints, &srcpoly.points);
+      std::vector<double> expected =
+          Portage::intersect_polys_r3d(srcpoly, target_tet_coords, num_tols);
+      std::vector<double> moments =
+          Portage::intersect_polys_r3d(srcpoly, target, num_tols);
+      ASSERT_EQ(expected.size(), moments.size());
+      for (unsigned k = 0; k < moments.size(); k++)
+        ASSERT_NEAR(expected[k], moments[k], 1.e-12);
+    }
+  }
+}
+
+// A hex with a node pushed inwards has non-planar faces and is not
+// convex: it must be decomposed into tets
+TEST(intersectR3D, non_convex_target) {
+  using Wonton::Point;
+  std::vector<Point<3>> p = {
+    {0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0},
+    {0, 0, 1}, {1, 0, 1}, {0.6, 0.6, 0.6}, {0, 1, 1}
+  };
+  std::vector<std::vector<Point<3>>> faces = {
+    {p[0], p[3], p[2], p[1]}, {p[4], p[5], p[6], p[7]},
+    {p[0], p[1], p[5], p[4]}, {p[1], p[2], p[6], p[5]},
+    {p[2], p[3], p[7], p[6]}, {p[3], p[0], p[4], p[7]}
+  };
+
+  std::vector<r3d_plane> planes;
+  ASSERT_FALSE(Portage::convex_polyhedron_planes(faces, &planes));
+  ASSERT_TRUE(planes.empty());
+
+  // the unit cube is fine
+  faces[1][2] = faces[3][2] = faces[4][3] = Point<3>(1, 1, 1);
+  ASSERT_TRUE(Portage::convex_polyhedron_planes(faces, &planes));
+  ASSERT_EQ(unsigned(6), planes.size());
+
+  // all planes keep the center of the cube
+  for (auto const& plane : planes) {
+    double const distance = plane.n.xyz[0] * 0.5 + plane.n.xyz[1] * 0.5 +
+                            plane.n.xyz[2] * 0.5 + plane.d;
+    ASSERT_NEAR(0.5, distance, 1.e-12);
+  }
+}
+
+// The per-cell data kept in a shared cache is only computed for the
+// cells prepared, and gives the same weights as computing it on the fly
+TEST(intersectR3D, shared_cache) {
+  auto sourcemesh = std::make_shared<Wonton::Simple_Mesh>(0, 0, 0, 1, 1, 1, 3, 3, 3);
+  auto targetmesh = std::make_shared<Wonton::Simple_Mesh>(0.1, 0.2, 0.3, 0.9, 0.8, 0.7, 2, 2, 2);
+  const Wonton::Simple_Mesh_Wrapper sm(*sourcemesh);
+  const Wonton::Simple_Mesh_Wrapper tm(*targetmesh);
+
+  auto sourcestate = std::make_shared<Wonton::Simple_State>(sourcemesh);
+  const Wonton::Simple_State_Wrapper ss(*sourcestate);
+
+  Portage::NumericTolerances_t num_tols = Portage::DEFAULT_NUMERIC_TOLERANCES<3>;
+
+  using Intersector = Portage::IntersectR3D<Portage::Entity_kind::CELL,
+                                            Wonton::Simple_Mesh_Wrapper,
+                                            Wonton::Simple_State_Wrapper,
+                                            Wonton::Simple_Mesh_Wrapper>;
+  Intersector on_the_fly(sm, ss, tm, num_tols);
+  Intersector cached(sm, ss, tm, num_tols);
+
+  auto cache = std::make_shared<Portage::IntersectionCache<3>>();
+  cached.set_cache(cache);
+
+  std::vector<int> const sources = {0, 1, 3, 4, 9, 10, 12, 13};
+  cached.prepare({0, 1}, sources);
+  ASSERT_TRUE(cache->target_planes.has(0));
+  ASSERT_TRUE(cache->target_planes.has(1));
+  ASSERT_FALSE(cache->target_planes.has(2));
+  ASSERT_TRUE(cache->target_boxes.is_box(1));
+  ASSERT_FALSE(cache->target_boxes.has(2));
+  ASSERT_TRUE(cache->source_boxes.is_box(13));
+  ASSERT_FALSE(cache->source_boxes.has(2));
+  ASSERT_TRUE(cache->source_polys.has(13));
+  ASSERT_FALSE(cache->source_polys.has(2));
+
+  for (int t = 0; t < 8; t++) {
+    std::vector<Portage::Weights_t> const expected = on_the_fly(t, sources);
+    std::vector<Portage::Weights_t> const weights = cached(t, sources);
+    ASSERT_EQ(expected.size(), weights.size());
+    for (unsigned i = 0; i < weights.size(); i++) {
+      ASSERT_EQ(expected[i].entityID, weights[i].entityID);
+      for (unsigned k = 0; k < weights[i].weights.size(); k++)
+        ASSERT_NEAR(expected[i].weights[k], weights[i].weights[k], 1.e-12);
+    }
+  }
+}
@@ -0,0 +1,83 @@
+/*
+This file is part of the Ristra portage project.
+Please see the license file at the root of this repository, or at:
+    https://github.com/laristra/portage/blob/master/LICENSE
+*/
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "portage/intersect/material_moments.h"
+#include "portage/support/portage.h"
+
+#include "wonton/mesh/simple/simple_mesh.h"
+#include "wonton/mesh/simple/simple_mesh_wrapper.h"
+
+namespace {
+
+// Two materials on a 2 x 1 mesh [0,2]x[0,1]: material 0 fills cell 0 and
+// the left half of cell 1 (as two polygons), material 1 the right half of
+// cell 1 (as a single polygon)
+
+struct MockState {
+  int num_materials() const { return 2; }
+
+  void mat_get_cells(int m, std::vector<int>* cells) const {
+    *cells = (m == 0 ? std::vector<int>{0, 1} : std::vector<int>{1});
+  }
+
+  int cell_get_num_mats(int c) const { return c == 0 ? 1 : 2; }
+};
+
+struct MockPoly {
+  std::vector<double> moments_;
+  std::vector<double> moments() const { return moments_; }
+};
+
+struct MockCellMatPoly {
+  std::vector<MockPoly> get_matpolys(int m) const {
+    if (m == 0)  // [1,1.25]x[0,1] and [1.25,1.5]x[0,1]
+      return {MockPoly{{0.25, 0.25 * 1.125, 0.25 * 0.5}},
+              MockPoly{{0.25, 0.25 * 1.375, 0.25 * 0.5}}};
+    else         // [1.5,2]x[0,1]
+      return {MockPoly{{0.5, 0.5 * 1.75, 0.5 * 0.5}}};
+  }
+};
+
+struct MockReconstructor {
+  MockCellMatPoly const& cell_matpoly_data(int c) const {
+    EXPECT_EQ(1, c);  // only queried on mixed cells
+    return cell_matpoly_;
+  }
+  MockCellMatPoly cell_matpoly_;
+};
+
+}  // namespace
+
+TEST(MaterialMoments, MixedAndPureCells) {
+  Wonton::Simple_Mesh mesh(0.0, 0.0, 2.0, 1.0, 2, 1);
+  Wonton::Simple_Mesh_Wrapper mesh_wrapper(mesh);
+
+  Portage::MaterialMoments<2> moments;
+  ASSERT_TRUE(moments.empty());
+
+  moments.compute(mesh_wrapper, MockState(), MockReconstructor());
+  ASSERT_FALSE(moments.empty());
+  ASSERT_EQ(2, moments.num_materials());
+
+  // material 0 in pure cell 0: moments of the cell
+  ASSERT_NEAR(1.0, moments.volume(0, 0), 1.e-12);
+  ASSERT_NEAR(0.5, moments.centroid(0, 0)[0], 1.e-12);
+  ASSERT_NEAR(0.5, moments.centroid(0, 0)[1], 1.e-12);
+
+  // material 0 in mixed cell 1: aggregate of its two polygons
+  ASSERT_NEAR(0.5, moments.volume(0, 1), 1.e-12);
+  ASSERT_NEAR(1.25, moments.centroid(0, 1)[0], 1.e-12);
+  ASSERT_NEAR(0.5, moments.centroid(0, 1)[1], 1.e-12);
+
+  // material 1 in mixed cell 1
+  ASSERT_NEAR(0.5, moments.volume(1, 0), 1.e-12);
+  ASSERT_NEAR(1.75, moments.centroid(1, 0)[0], 1.e-12);
+  ASSERT_NEAR(0.5, moments.centroid(1, 0)[1], 1.e-12);
+}
@@ -0,0 +1,291 @@
+/*
+This file is part of the Ristra portage project.
+Please see the license file at the root of this repository, or at:
+    https://github.com/laristra/portage/blob/master/LICENSE
+*/
+
+#ifndef PORTAGE_SEARCH_BVH_H_
+#define PORTAGE_SEARCH_BVH_H_
+
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <utility>
+#include <cstdint>
+#include <limits>
+
+#include "portage/support/portage.h"
+#include "portage/search/BoundBox.h"
+#include "wonton/support/Point.h"
+
+/*!
+  @file bvh.h
+  @brief Linear bounding volume hierarchy of axis-aligned boxes.
+*/
+
+namespace Portage {
+
+/*!
+  @class BVH "bvh.h"
+  @brief A linear bounding volume hierarchy (LBVH) of axis-aligned boxes.
+
+  Boxes are sorted along a Morton (Z-order) curve through their centers
+  and the binary radix tree of the sorted Morton codes is built with the
+  method of T. Karras, "Maximizing parallelism in the construction of
+  BVHs, octrees, and k-d trees", HPG 2012. Every step of the build
+  (bounding boxes, Morton codes, sort, internal nodes and their boxes) is
+  a loop over boxes or nodes run through Portage::for_each, so it uses
+  all the threads available to the library, unlike the recursive median
+  splits of KDTreeCreate.
+
+  Nodes are stored in flat arrays: internal nodes are numbered 0 to n-2
+  (0 being the root) and leaf i, the i-th box along the curve, is node
+  n-1+i. Queries are read-only and may run concurrently.
+
+  @tparam D Dimension of the boxes.
+*/
+template<int D>
+class BVH {
+ public:
+
+  /*!
+    @brief Build the hierarchy
+    @param[in] boxes Boxes to search; query results are indices in it.
+  */
+  explicit BVH(std::vector<IsotheticBBox<D>> const& boxes) { build(boxes); }
+
+  /// Number of boxes in the hierarchy
+  int size() const { return num_leaves_; }
+
+  /*!
+    @brief Find the boxes intersecting a given box
+    @param[in] box Query box.
+    @param[out] found Indices of the intersecting boxes in increasing order.
+  */
+  void intersect(IsotheticBBox<D> const& box, std::vector<int>* found) const {
+    found->clear();
+    if (num_leaves_ == 0)
+      return;
+
+    double lo[D], hi[D];
+    for (int d = 0; d < D; d++) {
+      lo[d] = box.getMin(d);
+      hi[d] = box.getMax(d);
+    }
+
+    // depth is bounded by the number of bits of the sort keys
+    int stack[max_depth];
+    int top = 0;
+    stack[top++] = root();
+
+    while (top > 0) {
+      int const node = stack[--top];
+      if (not overlaps(node, lo, hi))
+        continue;
+      if (is_leaf(node))
+        found->push_back(entity_[node - (num_leaves_ - 1)]);
+      else {
+        stack[top++] = left_[node];
+        stack[top++] = right_[node];
+      }
+    }
+
+    std::sort(found->begin(), found->end());
+  }
+
+ private:
+
+  // 64-bit Morton codes: the bits of all axes are interleaved
+  static constexpr int bits_per_axis = 63 / D;
+
+  // Sort keys are (Morton code, position) pairs so that their common
+  // prefix is at most 64 + 32 bits long
+  static constexpr int max_depth = 128;
+
+  int root() const { return num_leaves_ > 1 ? 0 : num_leaves_ - 1; }
+  bool is_leaf(int node) const { return node >= num_leaves_ - 1; }
+
+  bool overlaps(int node, double const* lo, double const* hi) const {
+    double const* node_lo = lo_.data() + static_cast<size_t>(node) * D;
+    double const* node_hi = hi_.data() + static_cast<size_t>(node) * D;
+    for (int d = 0; d < D; d++)
+      if (hi[d] < node_lo[d] or lo[d] > node_hi[d])
+        return false;
+    return true;
+  }
+
+  // Spread the low bits of x so that bit b lands at bit b*D + axis
+  static uint64_t spread_bits(uint64_t x, int axis) {
+    uint64_t code = 0;
+    for (int b = 0; b < bits_per_axis; b++)
+      code |= ((x >> b) & uint64_t(1)) << (b * D + axis);
+    return code;
+  }
+
+  static int count_leading_zeros(uint64_t x) {
+#if defined(__GNUC__)
+    return x ? __builtin_clzll(x) : 64;
+#else
+    int n = 0;
+    for (uint64_t bit = uint64_t(1) << 63; bit and not (x & bit); bit >>= 1)
+      n++;
+    return n;
+#endif
+  }
+
+  // Length of the common prefix of the keys of leaves i and j, or -1 if
+  // j is out of range. Equal codes are told apart by their positions.
+  int common_prefix(int i, int j) const {
+    if (j < 0 or j >= num_leaves_)
+      return -1;
+    uint64_t const ci = codes_[i].first;
+    uint64_t const cj = codes_[j].first;
+    if (ci != cj)
+      return count_leading_zeros(ci ^ cj);
+    return 64 + count_leading_zeros(static_cast<uint64_t>(i ^ j)) - 32;
+  }
+
+  // Children of internal node i (Karras 2012, fig. 4)
+  void make_internal_node(int i) {
+    int const n = num_leaves_;
+
+    // direction of the range covered by the node
+    int const dir = common_prefix(i, i + 1) > common_prefix(i, i - 1) ? 1 : -1;
+    int const min_prefix = common_prefix(i, i - dir);
+
+    // other end of the range
+    int max_length = 2;
+    while (common_prefix(i, i + max_length * dir) > min_prefix)
+      max_length *= 2;
+    int length = 0;
+    for (int step = max_length / 2; step >= 1; step /= 2)
+      if (common_prefix(i, i + (length + step) * dir) > min_prefix)
+        length += step;
+    int const j = i + length * dir;
+
+    // split position: last leaf sharing more than the range's prefix
+    int const node_prefix = common_prefix(i, j);
+    int split = 0;
+    int divisor = 2;
+    int step;
+    do {
+      step = (length + divisor - 1) / divisor;
+      if (common_prefix(i, i + (split + step) * dir) > node_prefix)
+        split += step;
+      divisor *= 2;
+    } while (step > 1);
+    int const gamma = i + split * dir + std::min(dir, 0);
+
+    int const left = std::min(i, j) == gamma ? n - 1 + gamma : gamma;
+    int const right = std::max(i, j) == gamma + 1 ? n + gamma : gamma + 1;
+    left_[i] = left;
+    right_[i] = right;
+    parent_[left] = i;
+    parent_[right] = i;
+  }
+
+  void build(std::vector<IsotheticBBox<D>> const& boxes) {
+    int const n = boxes.size();
+    num_leaves_ = n;
+    if (n == 0)
+      return;
+
+    int const nnodes = 2 * n - 1;
+    lo_.resize(static_cast<size_t>(nnodes) * D);
+    hi_.resize(static_cast<size_t>(nnodes) * D);
+    entity_.resize(n);
+    codes_.resize(n);
+
+    // extents of the box centers, to scale them to the Morton grid
+    double origin[D], scale[D];
+    for (int d = 0; d < D; d++) {
+      double cmin = std::numeric_limits<double>::max();
+      double cmax = std::numeric_limits<double>::lowest();
+      for (auto const& box : boxes) {
+        double const c = box.center(d);
+        cmin = std::min(cmin, c);
+        cmax = std::max(cmax, c);
+      }
+      origin[d] = cmin;
+      double const cells = static_cast<double>((uint64_t(1) << bits_per_axis) - 1);
+      scale[d] = cmax > cmin ? cells / (cmax - cmin) : 0.;
+    }
+
+    // Morton code of each box center
+    auto* codes = &codes_;
+    Portage::for_each(make_counting_iterator(0), make_counting_iterator(n),
+                      [codes, &boxes, &origin, &scale](int i) {
+                        uint64_t code = 0;
+                        for (int d = 0; d < D; d++) {
+                          auto const x = static_cast<uint64_t>(
+                              (boxes[i].center(d) - origin[d]) * scale[d]);
+                          code |= spread_bits(x, d);
+                        }
+                        (*codes)[i] = {code, i};
+                      });
+
+    parallel_sort(codes_);
+
+    // leaves: boxes in curve order
+    Portage::for_each(make_counting_iterator(0), make_counting_iterator(n),
+                      [this, &boxes](int i) {
+                        int const entity = codes_[i].second;
+                        int const node = num_leaves_ - 1 + i;
+                        entity_[i] = entity;
+                        for (int d = 0; d < D; d++) {
+                          lo_[static_cast<size_t>(node) * D + d] = boxes[entity].getMin(d);
+                          hi_[static_cast<size_t>(node) * D + d] = boxes[entity].getMax(d);
+                        }
+                      });
+
+    if (n == 1)
+      return;
+
+    // internal nodes, each built independently
+    left_.resize(n - 1);
+    right_.resize(n - 1);
+    parent_.assign(nnodes, -1);
+    Portage::for_each(make_counting_iterator(0), make_counting_iterator(n - 1),
+                      [this](int i) { make_internal_node(i); });
+
+    // boxes of internal nodes, bottom-up from every leaf: the second
+    // child to reach a node merges the boxes of both and goes on
+    std::vector<std::atomic<int>> visits(n - 1);
+    for (auto& count : visits)
+      count.store(0, std::memory_order_relaxed);
+
+    Portage::for_each(make_counting_iterator(0), make_counting_iterator(n),
+                      [this, &visits](int i) {
+                        int node = parent_[num_leaves_ - 1 + i];
+                        while (node >= 0) {
+                          if (visits[node].fetch_add(1, std::memory_order_acq_rel) == 0)
+                            break;
+                          merge_children(node);
+                          node = parent_[node];
+                        }
+                      });
+  }
+
+  void merge_children(int node) {
+    size_t const k = static_cast<size_t>(node) * D;
+    size_t const l = static_cast<size_t>(left_[node]) * D;
+    size_t const r = static_cast<size_t>(right_[node]) * D;
+    for (int d = 0; d < D; d++) {
+      lo_[k + d] = std::min(lo_[l + d], lo_[r + d]);
+      hi_[k + d] = std::max(hi_[l + d], hi_[r + d]);
+    }
+  }
+
+  int num_leaves_ = 0;
+  std::vector<std::pair<uint64_t, int>> codes_;  // sorted (code, box) pairs
+  std::vector<int> entity_;   // box of each leaf
+  std::vector<int> left_;     // children of internal nodes
+  std::vector<int> right_;
+  std::vector<int> parent_;   // parent of each node, -1 for the root
+  std::vector<double> lo_;    // lower corners of node boxes, D per node
+  std::vector<double> hi_;    // upper corners of node boxes, D per node
+};  // class BVH
+
+}  // namespace Portage
+
+#endif  // PORTAGE_SEARCH_BVH_H_
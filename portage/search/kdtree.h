@@ -82,6 +82,11 @@ void Intersect(const IsotheticBBox<D>& box,
         const KDTree<D>* kdtree,
         std::vector<int>& pfound);
 
+template<int D>
+void IntersectAppend(const IsotheticBBox<D>& box,
+        const KDTree<D>* kdtree,
+        std::vector<int>& pfound);
+
 
 /****************************************************************************/
 /* File           :MedianSelect.c                                           */
@@ -441,6 +446,16 @@ void Intersect(const IsotheticBBox<D>& box,
                std::vector<int>& pfound)    
 {
     pfound.clear();
+    IntersectAppend(box, kdtree, pfound);
+}
+
+// Same as Intersect but append the ids to pfound, so that a caller can
+// reuse the same list for many queries without reallocating it
+template<int D>
+void IntersectAppend(const IsotheticBBox<D>& box,
+                     const KDTree<D>* kdtree,
+                     std::vector<int>& pfound)
+{
     int itop, node, ind, j;
     int istack[100];
 
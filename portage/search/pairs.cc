@@ -8,8 +8,10 @@ Please see the license file at the root of this repository, or at:
 #include <cassert>
 #include <list>
 #include <limits>
+#include <numeric>
 #include <vector>
 #include "pairs.hh"
+#include "portage/support/portage.h"
 
 namespace Portage { namespace Meshfree { namespace Pairs {
 
@@ -64,6 +66,7 @@ void CellPairFinder::init(vpile const& in_x, vpile const& in_y,
   // get sizes and check
   ulong nx = x.size()[1];
   ulong ny = y.size()[1];
+  assert(dim <= max_dim);
   assert(y.size()[0] == unsigned(dim));
   assert(h.size()[0] >= unsigned(dim));
   assert(h.size()[1] == (do_scatter ? nx : ny));
@@ -115,16 +118,16 @@ void CellPairFinder::init(vpile const& in_x, vpile const& in_y,
   if (do_scatter) {
     for (ulong i = 0; i < nx; i++) {
       // get lower left and upper right bounds and indices for source box
-      pile xll(dim), xur(dim);
+      double xll[max_dim], xur[max_dim];
       for (int m = 0; m < dim; m++) {
         xll[m] = x[m][i] - 2. * h[m][i];
         xur[m] = x[m][i] + 2. * h[m][i];
       }
-      vulong ixl(dim), ixu(dim);
+      ulong ixl[max_dim], ixu[max_dim];
       PairsIntegize(dim, xll, cminmax, delta, nsidesm, ixl);
       PairsIntegize(dim, xur, cminmax, delta, nsidesm, ixu);
-      size_t ndxll = cellindex(dim, strides, ixl);
-      size_t ndxur = cellindex(dim, strides, ixu) + 1;
+      size_t ndxll = cellindex(dim, &strides[0], ixl);
+      size_t ndxur = cellindex(dim, &strides[0], ixu) + 1;
 
       // add x to all cells covered or intersected by this source box
       for (size_t ndx = ndxll; ndx < ndxur; ndx++) {
@@ -136,7 +139,7 @@ void CellPairFinder::init(vpile const& in_x, vpile const& in_y,
     for (ulong i = 0; i < nx; i++) {
       // ignore x values outside bounding box
       bool outside = false;
-      pile xi(dim);
+      double xi[max_dim];
       for (int m = 0; m < dim; m++) {
         if (x[m][i] <= cminmax[0][m]) outside = true;
         if (x[m][i] >= cminmax[1][m]) outside = true;
@@ -145,38 +148,37 @@ void CellPairFinder::init(vpile const& in_x, vpile const& in_y,
       if (outside) continue;
 
       // get cell indices this x
-      vulong ix(dim);
+      ulong ix[max_dim];
       PairsIntegize(dim, xi, cminmax, delta, nsidesm, ix);
 
       // add this x to cell list
-      ulong ndx = cellindex(dim, strides, ix);
+      ulong ndx = cellindex(dim, &strides[0], ix);
       cells[ndx].push_back(i);
     }
   }
 }
 
 /**
- * @brief Get pairs for target point j, gather case.
+ * @brief Visit the pairs of target point j, gather case.
  *
  * @param j: current point index.
- * @return a lst of neighbors of the j-th point.
+ * @param visit: called on each neighbor of the j-th point, in order.
  */
-std::list<ulong> CellPairFinder::find_gather(const ulong j) const {
-  std::list<ulong> pairlist;
-
+template<class Visit>
+void CellPairFinder::scan_gather(const ulong j, Visit&& visit) const {
   // get cell indices lower left and upper right corners of box
-  pile yll(dim), yur(dim);
+  double yll[max_dim], yur[max_dim];
   for (int m = 0; m < dim; m++) {
     yll[m] = y[m][j] - 2. * h[m][j];
     yur[m] = y[m][j] + 2. * h[m][j];
   }
-  vulong iyl(dim), iyu(dim);
+  ulong iyl[max_dim], iyu[max_dim];
   PairsIntegize(dim, yll, cminmax, delta, nsidesm, iyl);
   PairsIntegize(dim, yur, cminmax, delta, nsidesm, iyu);
 
   // total number of cells for this y
   ulong ncellsy = iyu[dim - 1] - iyl[dim - 1] + 1;
-  vulong ystrides(dim);
+  ulong ystrides[max_dim];
   ystrides[dim - 1] = 1;
   for (int m = dim - 2; m >= 0; m--) {
     ystrides[m] = ncellsy;
@@ -186,11 +188,11 @@ std::list<ulong> CellPairFinder::find_gather(const ulong j) const {
   // scan cells for this y
   for (ulong cell = 0; cell < ncellsy; cell++) {
     // convert local y-cell indices to global cell index
-    vulong yndx(dim);
+    ulong yndx[max_dim];
     cellindices(dim, ystrides, cell, yndx);
-    vulong cellis(dim);
+    ulong cellis[max_dim];
     for (int m = 0; m < dim; m++) cellis[m] = iyl[m] + yndx[m];
-    size_t celli = cellindex(dim, strides, cellis);
+    size_t celli = cellindex(dim, &strides[0], cellis);
 
     // determine if in interior or boundary of y-cell
     bool ybndry = false;
@@ -210,65 +212,44 @@ std::list<ulong> CellPairFinder::find_gather(const ulong j) const {
 
       // add pair: put x's in this y-cell onto neighbor list, if inside
       if (inside) {
-        pairlist.push_back(i);
+        visit(i);
       }
     }  // for i
   }  // for cell
-
-  return pairlist;
-}  // CellPairFinder::find_gather
+}  // CellPairFinder::scan_gather
 
 /**
- * @brief Get pairs for target point j, scatter case.
+ * @brief Visit the pairs of target point j, scatter case.
  *
  * @param j: current point index.
- * @return a lst of neighbors of the j-th point.
+ * @param visit: called on each neighbor of the j-th point, in order.
  */
-std::list<ulong> CellPairFinder::find_scatter(const ulong j) const {
-  std::list<ulong> pairlist;
-
+template<class Visit>
+void CellPairFinder::scan_scatter(const ulong j, Visit&& visit) const {
   // get a compact representation of this point
-  pile ypt(dim);
+  double ypt[max_dim];
   for (int m = 0; m < dim; m++)
     ypt[m] = y[m][j];
 
   // check for completely outside source boxes
-  bool outside = false;
   for (int m = 0; m < dim; m++) {
-    if (y[m][j] <= cminmax[0][m]) {
-      outside = true;
-      break;
-    }
-    if (y[m][j] >= cminmax[1][m]) {
-      outside = true;
-      break;
-    }
+    if (ypt[m] <= cminmax[0][m] or ypt[m] >= cminmax[1][m])
+      return;
   }
-  if (outside)
-    return pairlist;
 
   // get cell indices of input y-point
-  vulong iy(dim);
+  ulong iy[max_dim];
   PairsIntegize(dim, ypt, cminmax, delta, nsidesm, iy);
-  size_t ndx = cellindex(dim, strides, iy);
+  size_t ndx = cellindex(dim, &strides[0], iy);
 
   // loop over all x's in this y-cell's list
   for (auto&& i : cells[ndx]) {
-    // get lower left and upper right coords for this x
-    pile xll(dim), xur(dim);
-    for (int m = 0; m < dim; m++) {
-      xll[m] = x[m][i] - 2. * h[m][i];
-      xur[m] = x[m][i] + 2. * h[m][i];
-    }
-
-    // check that y is contained
+    // check that y is contained in the box of this x
     bool inside = true;
     for (int m = 0; m < dim; m++) {
-      if (y[m][j] <= xll[m]) {
-        inside = false;
-        break;
-      }
-      if (y[m][j] >= xur[m]) {
+      double const xll = x[m][i] - 2. * h[m][i];
+      double const xur = x[m][i] + 2. * h[m][i];
+      if (ypt[m] <= xll or ypt[m] >= xur) {
         inside = false;
         break;
       }
@@ -276,13 +257,69 @@ std::list<ulong> CellPairFinder::find_scatter(const ulong j) const {
 
     // add pair: put x's in this y-cell onto neighbor list, if inside
     if (inside) {
-      pairlist.push_back(i);
+      visit(i);
     }
   }  // for i
+}  // CellPairFinder::scan_scatter
 
-  return pairlist;
-}  // CellPairFinder::find_scatter
+/**
+ * @brief Visit the pairs of target point j.
+ *
+ * @param j: current point index.
+ * @param visit: called on each neighbor of the j-th point, in order.
+ */
+template<class Visit>
+void CellPairFinder::scan(const ulong j, Visit&& visit) const {
+  if (do_scatter)
+    scan_scatter(j, visit);
+  else
+    scan_gather(j, visit);
+}
 
+/**
+ * @brief Get pairs for target point j.
+ *
+ * @param j: current point index.
+ * @param neighbors: set to the neighbors of the j-th point.
+ */
+void CellPairFinder::find(const ulong j, std::vector<int>& neighbors) const {
+  neighbors.clear();
+  scan(j, [&neighbors](ulong i) { neighbors.push_back(i); });
+}
+
+/**
+ * @brief Get pairs for all target points as a compressed table.
+ *
+ * The neighbors are counted in a first pass so that the second one can
+ * write those of every point in place, without any per-point list.
+ *
+ * @param offsets: set to the offsets of the neighbors of each point.
+ * @param neighbors: set to the neighbors of all the points.
+ */
+void CellPairFinder::find_all(std::vector<int>& offsets,
+                              std::vector<int>& neighbors) const {
+  int const ny = y.size()[1];
+  offsets.assign(ny + 1, 0);
+
+  int* counts = offsets.data() + 1;
+  Portage::for_each(make_counting_iterator(0), make_counting_iterator(ny),
+                    [this, counts](int j) {
+                      int count = 0;
+                      scan(j, [&count](ulong) { count++; });
+                      counts[j] = count;
+                    });
+
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+  neighbors.resize(offsets[ny]);
+
+  int const* starts = offsets.data();
+  int* values = neighbors.data();
+  Portage::for_each(make_counting_iterator(0), make_counting_iterator(ny),
+                    [this, starts, values](int j) {
+                      int* current = values + starts[j];
+                      scan(j, [&current](ulong i) { *current++ = i; });
+                    });
+}
 
 /**
  * @brief Find bounding box of all the y-boxes, variable h
@@ -340,9 +377,9 @@ vpile CellPairFinder::PairsMinMax(const vpile &in_c, const pile &in_h) const {
  * @param in_sizes
  * @param in_ivalue
  */
-void CellPairFinder::PairsIntegize(int in_dim, const pile &in_value,
+void CellPairFinder::PairsIntegize(int in_dim, const double *in_value,
                                    const vpile &in_minmax, const pile &in_delta,
-                                   const vulong &in_sizes, vulong &in_ivalue) const {
+                                   const vulong &in_sizes, ulong *in_ivalue) const {
   for (int m = 0; m < in_dim; m++) {
     auto value = in_sizes[m] * (in_value[m] - in_minmax[0][m]) / in_delta[m];
     value = static_cast<ulong>(std::floor(value));
@@ -358,8 +395,8 @@ void CellPairFinder::PairsIntegize(int in_dim, const pile &in_value,
  * @param in_indices
  * @return
  */
-ulong CellPairFinder::cellindex(int in_dim, const vulong &in_strides,
-                                const vulong &in_indices) const {
+ulong CellPairFinder::cellindex(int in_dim, const ulong *in_strides,
+                                const ulong *in_indices) const {
   ulong result = 0;
   for (int m = 0; m < in_dim; m++) {
     result += in_indices[m] * in_strides[m];
@@ -375,8 +412,8 @@ ulong CellPairFinder::cellindex(int in_dim, const vulong &in_strides,
  * @param in_index
  * @param in_indices
  */
-void CellPairFinder::cellindices(int in_dim, const vulong &in_strides,
-                                 const ulong &in_index, vulong &in_indices) const {
+void CellPairFinder::cellindices(int in_dim, const ulong *in_strides,
+                                 ulong in_index, ulong *in_indices) const {
   size_t offset = 0;
   for (int m = 0; m < in_dim; m++) {
     in_indices[m] = (in_index - offset) / in_strides[m];
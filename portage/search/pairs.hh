@@ -67,6 +67,16 @@ public:
   void init(vpile const& in_x, vpile const& in_y,
             vpile const& in_h, bool in_do_scatter);
 
+  /**
+   * @brief Find neighbors of a given point based on containment.
+   *
+   * @param j: current point index.
+   * @param neighbors: set to the neighbors of the j-th point. Its storage
+   *        is reused, so that a buffer kept across queries no longer
+   *        allocates once it fits the largest neighborhood.
+   */
+  void find(ulong j, std::vector<int>& neighbors) const;
+
   /**
    * @brief Find neighbors of a given point based on containment.
    *
@@ -74,21 +84,37 @@ public:
    * @return a lst of neighbors of the j-th point.
    */
   std::list<ulong> find(ulong j) const {
-    return do_scatter ? find_scatter(j) : find_gather(j);
+    std::vector<int> neighbors;
+    find(j, neighbors);
+    return std::list<ulong>(neighbors.begin(), neighbors.end());
   }
 
+  /**
+   * @brief Find neighbors of all the points at once, in parallel.
+   *
+   * @param offsets: set to the offsets of the neighbors of each point,
+   *        those of the j-th point being in [offsets[j], offsets[j+1]).
+   * @param neighbors: set to the neighbors of all the points, point
+   *        after point, in the order given by find.
+   */
+  void find_all(std::vector<int>& offsets, std::vector<int>& neighbors) const;
+
+  /// maximum spatial dimension
+  static constexpr int max_dim = 3;
+
 protected:
-  std::list<ulong> find_gather(ulong j) const;
-  std::list<ulong> find_scatter(ulong j) const;
+  template<class Visit> void scan(ulong j, Visit&& visit) const;
+  template<class Visit> void scan_gather(ulong j, Visit&& visit) const;
+  template<class Visit> void scan_scatter(ulong j, Visit&& visit) const;
   vpile PairsMinMax(const vpile &in_y, const vpile &in_h) const;
   vpile PairsMinMax(const vpile &in_c, const pile &in_h) const;
-  void PairsIntegize(int in_dim, const pile &in_value,
+  void PairsIntegize(int in_dim, const double *in_value,
                      const vpile &in_minmax, const pile &in_delta,
-                     const vulong &in_sizes, vulong &in_ivalue) const;
-  ulong cellindex(int in_dim, const vulong &in_strides,
-                  const vulong &in_indices) const;
-  void cellindices(int in_dim, const vulong &in_strides,
-                   const ulong &in_index, vulong &in_indices) const;
+                     const vulong &in_sizes, ulong *in_ivalue) const;
+  ulong cellindex(int in_dim, const ulong *in_strides,
+                  const ulong *in_indices) const;
+  void cellindices(int in_dim, const ulong *in_strides,
+                   ulong in_index, ulong *in_indices) const;
 
 
 private:
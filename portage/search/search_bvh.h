@@ -0,0 +1,217 @@
+/*
+This file is part of the Ristra portage project.
+Please see the license file at the root of this repository, or at:
+    https://github.com/laristra/portage/blob/master/LICENSE
+*/
+
+#ifndef PORTAGE_SEARCH_SEARCH_BVH_H_
+#define PORTAGE_SEARCH_SEARCH_BVH_H_
+
+#include <vector>
+#include <memory>
+#include <iostream>
+
+// portage includes
+#include "portage/support/portage.h"
+#include "portage/search/BoundBox.h"
+#include "portage/search/bvh.h"
+#include "wonton/support/Point.h"
+
+namespace Portage {
+
+/*!
+  @class SearchBVH "search_bvh.h"
+  @brief A search class based on a linear bounding volume hierarchy that
+  allows us to search for control volumes of entities from one mesh
+  (source) that potentially overlap the control volume of an entity from
+  the second mesh (target).
+
+  It returns the same candidates as SearchKDTree (in increasing order),
+  but both the construction of the hierarchy and the bounding boxes of
+  the source entities are computed with all the threads available to
+  Portage::for_each. Queries are const and thread-safe, so the search
+  loop over target entities of the drivers runs them concurrently.
+
+  @tparam D The dimension of the problem space.
+  @tparam on_what  The kind of entity we are doing a search on (NODE, CELL)
+  @tparam SourceMeshType The mesh type of the source mesh.
+  @tparam TargetMeshType The mesh type of the target mesh.
+*/
+template <int D, Entity_kind on_what,
+          typename SourceMeshType, typename TargetMeshType>
+class SearchBVH {
+ public:
+
+  //! Default constructor (disabled)
+  SearchBVH() = delete;
+
+  /*!
+    @brief Builds the hierarchy for searching for intersection candidates.
+    @param[in] source_mesh Mesh in which we search for candidates
+    @param[in] target_mesh Mesh containing entity for which we search
+  */
+  SearchBVH(const SourceMeshType & source_mesh,
+            const TargetMeshType & target_mesh)
+      : sourceMesh_(source_mesh), targetMesh_(target_mesh)  {}
+
+  /*!
+    @brief Find the source mesh entities whose control volumes
+    potentially overlap control volumes of a given target entity
+    @param[in] entityId The index of the entity in the target mesh.
+    @return The candidate entities in the source mesh.
+  */
+  std::vector<int> operator() (const int entityId) const {
+    std::vector<int> candidates;
+    std::cerr << "Search not implemented for generic entity kind" << std::endl;
+    return candidates;
+  }
+
+ private:
+  const SourceMeshType & sourceMesh_;
+  const TargetMeshType & targetMesh_;
+};  // class SearchBVH
+
+
+
+
+//////////////////////////////////////////////////////////////////////////////
+/*!
+  @brief A bounding volume hierarchy search class (specialization) that
+  allows us to search for cells from one mesh (source) that potentially
+  overlap a cell from the second mesh (target)
+
+  @tparam D The dimension of the problem space.
+  @tparam SourceMeshType The mesh type of the source mesh.
+  @tparam TargetMeshType The mesh type of the target mesh.
+*/
+template <int D, typename SourceMeshType, typename TargetMeshType>
+class SearchBVH<D, Entity_kind::CELL, SourceMeshType, TargetMeshType> {
+ public:
+
+  //! Default constructor (disabled)
+  SearchBVH() = delete;
+
+  /*!
+    @brief Builds the hierarchy of source cell bounding boxes.
+    @param[in] source_mesh Mesh in which we search for candidates
+    @param[in] target_mesh Mesh containing entity for which we search
+  */
+  SearchBVH(const SourceMeshType & source_mesh,
+            const TargetMeshType & target_mesh)
+      : sourceMesh_(source_mesh), targetMesh_(target_mesh)  {
+
+    const int numCells = sourceMesh_.num_owned_cells();
+    std::vector<Portage::IsotheticBBox<D>> bboxes(numCells);
+
+    // find bounding boxes for all cells
+    auto* boxes = bboxes.data();
+    Portage::for_each(make_counting_iterator(0),
+                      make_counting_iterator(numCells),
+                      [this, boxes](int c) {
+                        std::vector<Wonton::Point<D>> cell_coord;
+                        sourceMesh_.cell_get_coordinates(c, &cell_coord);
+                        for (const auto& cc : cell_coord)
+                          boxes[c].add(cc);
+                      });
+
+    tree_ = std::make_shared<Portage::BVH<D>>(bboxes);
+  }  // SearchBVH::SearchBVH
+
+  /*!
+    @brief Find the source mesh cells whose bounding boxes overlap
+    the bounding box of a given target cell
+    @param[in] cellId The index of the cell in the target mesh.
+    @return The candidate cells in the source mesh.
+  */
+  std::vector<int> operator() (const int cellId) const {
+    std::vector<Wonton::Point<D>> cell_coord;
+    targetMesh_.cell_get_coordinates(cellId, &cell_coord);
+    Portage::IsotheticBBox<D> bb;
+    for (const auto& cc : cell_coord)
+      bb.add(cc);
+
+    std::vector<int> candidates;
+    tree_->intersect(bb, &candidates);
+    return candidates;
+  }  // SearchBVH::operator()
+
+ private:
+  const SourceMeshType & sourceMesh_;
+  const TargetMeshType & targetMesh_;
+  std::shared_ptr<Portage::BVH<D>> tree_;
+};  // class SearchBVH (CELL specialization)
+
+
+
+
+//////////////////////////////////////////////////////////////////////////////
+/*!
+  @brief A bounding volume hierarchy search class (specialization) that
+  allows us to search for nodes from one mesh (source) whose control
+  volumes potentially overlap the control volumes of a node from the
+  second mesh (target)
+
+  @tparam D The dimension of the problem space.
+  @tparam SourceMeshType The mesh type of the source mesh.
+  @tparam TargetMeshType The mesh type of the target mesh.
+*/
+template <int D, typename SourceMeshType, typename TargetMeshType>
+class SearchBVH<D, Entity_kind::NODE, SourceMeshType, TargetMeshType> {
+ public:
+
+  //! Default constructor (disabled)
+  SearchBVH() = delete;
+
+  /*!
+    @brief Builds the hierarchy of source dual cell bounding boxes.
+    @param[in] source_mesh Mesh in which we search for candidates
+    @param[in] target_mesh Mesh containing entity for which we search
+  */
+  SearchBVH(const SourceMeshType & source_mesh,
+            const TargetMeshType & target_mesh)
+      : sourceMesh_(source_mesh), targetMesh_(target_mesh)  {
+
+    const int numNodes = sourceMesh_.num_owned_nodes();
+    std::vector<Portage::IsotheticBBox<D>> bboxes(numNodes);
+
+    // find bounding boxes for all dual cells
+    auto* boxes = bboxes.data();
+    Portage::for_each(make_counting_iterator(0),
+                      make_counting_iterator(numNodes),
+                      [this, boxes](int n) {
+                        std::vector<Wonton::Point<D>> dual_cell_coord;
+                        sourceMesh_.dual_cell_get_coordinates(n, &dual_cell_coord);
+                        for (const auto& cc : dual_cell_coord)
+                          boxes[n].add(cc);
+                      });
+
+    tree_ = std::make_shared<Portage::BVH<D>>(bboxes);
+  }  // SearchBVH::SearchBVH
+
+  /*!
+    @brief Find the source mesh nodes whose dual cell bounding boxes
+    overlap the dual cell bounding box of a given target node
+    @param[in] nodeId The index of the node in the target mesh.
+    @return The candidate nodes in the source mesh.
+  */
+  std::vector<int> operator() (const int nodeId) const {
+    std::vector<Wonton::Point<D>> dual_cell_coord;
+    targetMesh_.dual_cell_get_coordinates(nodeId, &dual_cell_coord);
+    Portage::IsotheticBBox<D> bb;
+    for (const auto& cc : dual_cell_coord)
+      bb.add(cc);
+
+    std::vector<int> candidates;
+    tree_->intersect(bb, &candidates);
+    return candidates;
+  }  // SearchBVH::operator()
+
+ private:
+  const SourceMeshType & sourceMesh_;
+  const TargetMeshType & targetMesh_;
+  std::shared_ptr<Portage::BVH<D>> tree_;
+};  // class SearchBVH (NODE specialization)
+
+}  // namespace Portage
+
+#endif  // PORTAGE_SEARCH_SEARCH_BVH_H_
@@ -9,6 +9,9 @@ Please see the license file at the root of this repository, or at:
 
 #include <vector>
 #include <memory>
+#include <array>
+#include <limits>
+#include <algorithm>
 
 // portage includes
 #include "portage/support/portage.h"
@@ -18,6 +21,69 @@ Please see the license file at the root of this repository, or at:
 
 namespace Portage {
 
+namespace search_kdtree {
+
+/*!
+  @brief Bounding boxes of the first cells of a mesh, as one array of
+  lower and upper bounds per axis. Cells are processed in blocks that
+  reuse the same coordinate list, in parallel when the library is built
+  with threads.
+  @param[in] mesh Mesh wrapper.
+  @param[in] ncells Number of cells to box.
+  @param[out] lower Lower bounds of the boxes along each axis.
+  @param[out] upper Upper bounds of the boxes along each axis.
+*/
+template<int D, typename MeshType>
+void cell_bounding_boxes(MeshType const& mesh, int ncells,
+                         std::array<std::vector<double>, D>* lower,
+                         std::array<std::vector<double>, D>* upper) {
+  for (int d = 0; d < D; ++d) {
+    (*lower)[d].resize(ncells);
+    (*upper)[d].resize(ncells);
+  }
+
+  int const block = 1024;
+  int const nblocks = (ncells + block - 1) / block;
+  Portage::for_each(make_counting_iterator(0),
+                    make_counting_iterator(nblocks),
+                    [&mesh, ncells, lower, upper](int b) {
+                      std::vector<Wonton::Point<D>> cell_coord;
+                      int const last = std::min(ncells, (b + 1) * block);
+                      for (int c = b * block; c < last; ++c) {
+                        cell_coord.clear();
+                        mesh.cell_get_coordinates(c, &cell_coord);
+                        for (int d = 0; d < D; ++d) {
+                          double lo = std::numeric_limits<double>::max();
+                          double hi = std::numeric_limits<double>::lowest();
+                          for (const auto& cc : cell_coord) {
+                            lo = std::min(lo, cc[d]);
+                            hi = std::max(hi, cc[d]);
+                          }
+                          (*lower)[d][c] = lo;
+                          (*upper)[d][c] = hi;
+                        }
+                      }
+                    });
+}
+
+/// Box of cell c out of the bounds computed by cell_bounding_boxes
+template<int D>
+Portage::IsotheticBBox<D>
+bounding_box(std::array<std::vector<double>, D> const& lower,
+             std::array<std::vector<double>, D> const& upper, int c) {
+  Wonton::Point<D> lo, hi;
+  for (int d = 0; d < D; ++d) {
+    lo[d] = lower[d][c];
+    hi[d] = upper[d][c];
+  }
+  Portage::IsotheticBBox<D> bb;
+  bb.add(lo);
+  bb.add(hi);
+  return bb;
+}
+
+}  // namespace search_kdtree
+
 /*!
   @class SearchKDTree "search_kdtree.h"
   @brief A k-d tree search class that allows us to search for control
@@ -105,20 +171,17 @@ class SearchKDTree<D, Entity_kind::CELL, SourceMeshType, TargetMeshType> {
                const TargetMeshType & target_mesh)
       : sourceMesh_(source_mesh), targetMesh_(target_mesh)  {
 
-    const int numCells = sourceMesh_.num_owned_cells();
-    std::vector<Portage::IsotheticBBox<D>> bboxes;
-    bboxes.reserve(numCells);
+    // find bounding boxes for all source and target cells
+    const int numSourceCells = sourceMesh_.num_owned_cells();
+    const int numTargetCells = targetMesh_.num_owned_cells();
+    search_kdtree::cell_bounding_boxes<D>(sourceMesh_, numSourceCells,
+                                       &sourceMin_, &sourceMax_);
+    search_kdtree::cell_bounding_boxes<D>(targetMesh_, numTargetCells,
+                                       &targetMin_, &targetMax_);
 
-    // find bounding boxes for all cells
-    for (int c = 0; c < numCells; ++c) {
-      std::vector<Wonton::Point<D>> cell_coord;
-      sourceMesh_.cell_get_coordinates(c, &cell_coord);
-      Portage::IsotheticBBox<D> bb;
-      for (const auto& cc : cell_coord) {
-        bb.add(cc);
-      }
-      bboxes.emplace_back(bb);
-    }
+    std::vector<Portage::IsotheticBBox<D>> bboxes(numSourceCells);
+    for (int c = 0; c < numSourceCells; ++c)
+      bboxes[c] = search_kdtree::bounding_box<D>(sourceMin_, sourceMax_, c);
 
     // create the k-d tree
     tree_ = std::make_shared<Portage::KDTree<D>>(*Portage::KDTreeCreate(bboxes));
@@ -130,32 +193,47 @@ class SearchKDTree<D, Entity_kind::CELL, SourceMeshType, TargetMeshType> {
     @param[in] cellId The index of the cell in the target mesh for
     which we wish to find the candidate overlapping cells in the
     source mesh.
-    @param[in,out] candidates Pointer to a vector of potential candidate
-    cells in the source mesh.
+    @return The candidate cells in the source mesh.
   */
   std::vector<int> operator() (const int cellId) const {
-    // find bounding box for target cell
-    std::vector<Wonton::Point<D>> cell_coord;
-    targetMesh_.cell_get_coordinates(cellId, &cell_coord);
+    std::vector<int> candidates;
+    (*this)(cellId, &candidates);
+    return candidates;
+  }  // SearchKDTree::operator()
+
+  /*!  @brief Same as above but append the candidates to a list owned
+    by the caller, which can be reused across target cells to avoid
+    allocating a list per query
+    @param[in] cellId The index of the cell in the target mesh.
+    @param[in,out] candidates Pointer to the list to which the candidate
+    cells in the source mesh are appended.
+  */
+  void operator() (const int cellId, std::vector<int>* candidates) const {
+    // bounding box of the target cell, computed on the fly only for
+    // cells that were not boxed at construction
     Portage::IsotheticBBox<D> bb;
-    for (const auto& cc : cell_coord)
-      bb.add(cc);
+    if (cellId < static_cast<int>(targetMin_[0].size()))
+      bb = search_kdtree::bounding_box<D>(targetMin_, targetMax_, cellId);
+    else {
+      std::vector<Wonton::Point<D>> cell_coord;
+      targetMesh_.cell_get_coordinates(cellId, &cell_coord);
+      for (const auto& cc : cell_coord)
+        bb.add(cc);
+    }
 
     // now see which sourceMesh cells have bounding boxes overlapping
-    // with target cell, using the kdtree - since Portage::Intersect does
-    // not take a shared_ptr, we have have to dereference and take
-    // address of tree_
-    std::vector<int> lcandidates;
-    Portage::Intersect(bb, &(*tree_), lcandidates);
-
-    std::vector<int> candidates(lcandidates.begin(), lcandidates.end());
-    return candidates;
+    // with target cell, using the kdtree
+    Portage::IntersectAppend(bb, tree_.get(), *candidates);
   }  // SearchKDTree::operator()
 
  private:
   const SourceMeshType & sourceMesh_;
   const TargetMeshType & targetMesh_;
   std::shared_ptr<Portage::KDTree<D>> tree_;
+
+  // bounding boxes of source and target cells, one array per axis
+  std::array<std::vector<double>, D> sourceMin_, sourceMax_;
+  std::array<std::vector<double>, D> targetMin_, targetMax_;
 };  // class SearchKDTree (CELL specialization)
 
 
@@ -134,8 +134,20 @@ public:
     points in the source swarm.
   */
   std::vector<int> operator() (int pointId) const {
-    auto result = pair_finder_->find(pointId);
-    return std::vector<int>(result.begin(), result.end());
+    std::vector<int> candidates;
+    pair_finder_->find(pointId, candidates);
+    return candidates;
+  }
+
+  /*!
+    @brief Find the candidate source points of all the target points at
+    once, as a compressed table.
+    @param[out] offsets The candidates of target point i are at
+    positions offsets[i] to offsets[i+1]-1 of candidates.
+    @param[out] candidates Candidates of all the target points.
+  */
+  void find_all(std::vector<int>& offsets, std::vector<int>& candidates) const {
+    pair_finder_->find_all(offsets, candidates);
   }
 
 private:
@@ -0,0 +1,144 @@
+/*
+This file is part of the Ristra portage project.
+Please see the license file at the root of this repository, or at:
+    https://github.com/laristra/portage/blob/master/LICENSE
+*/
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+// portage includes
+#include "portage/search/bvh.h"
+#include "portage/search/search_bvh.h"
+#include "portage/search/search_kdtree.h"
+
+// wonton includes
+#include "wonton/mesh/simple/simple_mesh.h"
+#include "wonton/mesh/simple/simple_mesh_wrapper.h"
+
+// Random boxes, including duplicates, against a brute-force search
+TEST(search_bvh, boxes) {
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<double> position(0., 1.);
+  std::uniform_real_distribution<double> extent(0., 0.1);
+
+  std::vector<Portage::IsotheticBBox<3>> boxes;
+  for (int i = 0; i < 500; ++i) {
+    Wonton::Point<3> p(position(generator), position(generator), position(generator));
+    Portage::IsotheticBBox<3> box;
+    box.add(p);
+    box.add(Wonton::Point<3>(p[0] + extent(generator),
+                             p[1] + extent(generator),
+                             p[2] + extent(generator)));
+    boxes.push_back(box);
+    if (i % 50 == 0)
+      boxes.push_back(box);
+  }
+
+  Portage::BVH<3> tree(boxes);
+  ASSERT_EQ(int(boxes.size()), tree.size());
+
+  std::vector<int> found;
+  for (auto const& query : boxes) {
+    std::vector<int> expected;
+    for (unsigned j = 0; j < boxes.size(); ++j)
+      if (boxes[j].intersect(query))
+        expected.push_back(j);
+
+    tree.intersect(query, &found);
+    ASSERT_EQ(expected, found);
+  }
+
+  // degenerate hierarchies
+  Portage::BVH<3> empty(std::vector<Portage::IsotheticBBox<3>>{});
+  empty.intersect(boxes[0], &found);
+  ASSERT_TRUE(found.empty());
+
+  Portage::BVH<3> single(std::vector<Portage::IsotheticBBox<3>>{boxes[0]});
+  single.intersect(boxes[0], &found);
+  ASSERT_EQ(std::vector<int>{0}, found);
+}  // TEST(search_bvh, boxes)
+
+TEST(search_bvh, cell2) {
+  Wonton::Simple_Mesh sm{0, 0, 1, 1, 7, 5};
+  Wonton::Simple_Mesh tm{0, 0, 1, 1, 3, 4};
+  const Wonton::Simple_Mesh_Wrapper source_mesh_wrapper(sm);
+  const Wonton::Simple_Mesh_Wrapper target_mesh_wrapper(tm);
+
+  Portage::SearchBVH<2, Portage::Entity_kind::CELL,
+                     Wonton::Simple_Mesh_Wrapper,
+                     Wonton::Simple_Mesh_Wrapper>
+      search(source_mesh_wrapper, target_mesh_wrapper);
+
+  Portage::SearchKDTree<2, Portage::Entity_kind::CELL,
+                        Wonton::Simple_Mesh_Wrapper,
+                        Wonton::Simple_Mesh_Wrapper>
+      reference(source_mesh_wrapper, target_mesh_wrapper);
+
+  for (int tc = 0; tc < 12; ++tc) {
+    std::vector<int> candidates = search(tc);
+    std::vector<int> expected = reference(tc);
+    std::sort(expected.begin(), expected.end());
+    ASSERT_EQ(expected, candidates);
+  }
+}  // TEST(search_bvh, cell2)
+
+TEST(search_bvh, cell3) {
+  // overlay a 2x2x2 target mesh on a 3x3x3 source mesh
+  // each target mesh cell gives eight candidate source cells
+  Wonton::Simple_Mesh smesh{0.0, 0.0, 0.0, 1.0, 1.0, 1.0, 3, 3, 3};
+  Wonton::Simple_Mesh tmesh{0.0, 0.0, 0.0, 1.0, 1.0, 1.0, 2, 2, 2};
+  const Wonton::Simple_Mesh_Wrapper source_mesh_wrapper(smesh);
+  const Wonton::Simple_Mesh_Wrapper target_mesh_wrapper(tmesh);
+
+  Portage::SearchBVH<3, Portage::Entity_kind::CELL,
+                     Wonton::Simple_Mesh_Wrapper,
+                     Wonton::Simple_Mesh_Wrapper>
+      search(source_mesh_wrapper, target_mesh_wrapper);
+
+  for (int tc = 0; tc < 8; ++tc) {
+    std::vector<int> candidates = search(tc);
+
+    // candidates are returned in increasing order
+    ASSERT_EQ(unsigned(8), candidates.size());
+    const int tx = tc % 2;
+    const int ty = (tc / 2) % 2;
+    const int tz = tc / 4;
+    const int scbase = tx + ty * 3 + tz * 9;
+    ASSERT_EQ(scbase,      candidates[0]);
+    ASSERT_EQ(scbase + 1,  candidates[1]);
+    ASSERT_EQ(scbase + 3,  candidates[2]);
+    ASSERT_EQ(scbase + 4,  candidates[3]);
+    ASSERT_EQ(scbase + 9,  candidates[4]);
+    ASSERT_EQ(scbase + 10, candidates[5]);
+    ASSERT_EQ(scbase + 12, candidates[6]);
+    ASSERT_EQ(scbase + 13, candidates[7]);
+  }
+}  // TEST(search_bvh, cell3)
+
+TEST(search_bvh, node) {
+  Wonton::Simple_Mesh sm{0, 0, 1, 1, 3, 3};
+  Wonton::Simple_Mesh tm{0, 0, 1, 1, 2, 2};
+  const Wonton::Simple_Mesh_Wrapper source_mesh_wrapper(sm);
+  const Wonton::Simple_Mesh_Wrapper target_mesh_wrapper(tm);
+
+  Portage::SearchBVH<2, Portage::Entity_kind::NODE,
+                     Wonton::Simple_Mesh_Wrapper,
+                     Wonton::Simple_Mesh_Wrapper>
+      search(source_mesh_wrapper, target_mesh_wrapper);
+
+  Portage::SearchKDTree<2, Portage::Entity_kind::NODE,
+                        Wonton::Simple_Mesh_Wrapper,
+                        Wonton::Simple_Mesh_Wrapper>
+      reference(source_mesh_wrapper, target_mesh_wrapper);
+
+  for (int tn = 0; tn < 9; ++tn) {
+    std::vector<int> candidates = search(tn);
+    std::vector<int> expected = reference(tn);
+    std::sort(expected.begin(), expected.end());
+    ASSERT_EQ(expected, candidates);
+  }
+}  // TEST(search_bvh, node)
@@ -45,6 +45,34 @@ TEST(search_kdtree2, cell) {
 
 }  // TEST(search_kdtree2, cell)
 
+// Candidates of all target cells appended to a single list
+TEST(search_kdtree2, cell_append) {
+  Wonton::Simple_Mesh sm{0, 0, 1, 1, 3, 3};
+  Wonton::Simple_Mesh tm{0, 0, 1, 1, 2, 2};
+  const Wonton::Simple_Mesh_Wrapper source_mesh_wrapper(sm);
+  const Wonton::Simple_Mesh_Wrapper target_mesh_wrapper(tm);
+
+  Portage::SearchKDTree<2, Portage::Entity_kind::CELL,
+                        Wonton::Simple_Mesh_Wrapper,
+                        Wonton::Simple_Mesh_Wrapper>
+      search(source_mesh_wrapper, target_mesh_wrapper);
+
+  std::vector<int> candidates;
+  std::vector<int> offsets(1, 0);
+  for (int tc = 0; tc < 4; ++tc) {
+    search(tc, &candidates);
+    offsets.push_back(candidates.size());
+  }
+
+  ASSERT_EQ(unsigned(16), candidates.size());
+  for (int tc = 0; tc < 4; ++tc) {
+    std::vector<int> expected = search(tc);
+    std::vector<int> appended(candidates.begin() + offsets[tc],
+                              candidates.begin() + offsets[tc + 1]);
+    ASSERT_EQ(expected, appended);
+  }
+}  // TEST(search_kdtree2, cell_append)
+
 TEST(search_kdtree2, node) {
   Wonton::Simple_Mesh sm{0, 0, 1, 1, 3, 3};
   Wonton::Simple_Mesh tm{0, 0, 1, 1, 2, 2};
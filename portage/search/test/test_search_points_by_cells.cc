@@ -698,3 +698,57 @@ TEST(search_by_cells, scatter_2d_random_edge) {
 } // TEST(search_by_cells, scatter_2d_random_edge)
 
 
+
+
+TEST(search_by_cells, find_all) {
+
+  using Portage::Meshfree::Swarm;
+
+  int const nsrc = 256;
+  int const ntgt = 128;
+
+  // random point sets, neighbor table against individual queries
+  Portage::vector<Wonton::Point<2>> source_points(nsrc);
+  Portage::vector<Wonton::Point<2>> source_extent(nsrc);
+  Portage::vector<Wonton::Point<2>> target_points(ntgt);
+  Portage::vector<Wonton::Point<2>> target_extent(ntgt);
+
+  for (int j = 0; j < nsrc; ++j) {
+    double x = 1.0 * rand()/RAND_MAX;
+    double y = 1.0 * rand()/RAND_MAX;
+    double ext = 1./sqrt(nsrc*1.0);
+    source_points[j] = Wonton::Point<2>(x, y);
+    source_extent[j] = Wonton::Point<2>(ext, ext);
+  }
+
+  for (int j = 0; j < ntgt; ++j) {
+    double x = 1.0 * rand()/RAND_MAX;
+    double y = 1.0 * rand()/RAND_MAX;
+    double ext = 1./sqrt(ntgt*1.0);
+    target_points[j] = Wonton::Point<2>(x, y);
+    target_extent[j] = Wonton::Point<2>(ext, ext);
+  }
+
+  Swarm<2> source_swarm(source_points);
+  Swarm<2> target_swarm(target_points);
+
+  for (auto center : {Portage::Meshfree::Scatter, Portage::Meshfree::Gather}) {
+    Portage::SearchPointsByCells<2, Swarm<2>, Swarm<2>>
+      cellsearch(source_swarm, target_swarm, source_extent, target_extent,
+                 center);
+
+    std::vector<int> offsets, candidates;
+    cellsearch.find_all(offsets, candidates);
+    ASSERT_EQ(unsigned(ntgt + 1), offsets.size());
+    ASSERT_EQ(unsigned(offsets[ntgt]), candidates.size());
+    ASSERT_GT(candidates.size(), unsigned(0));
+
+    for (int tp = 0; tp < ntgt; tp++) {
+      auto cnbr = cellsearch(tp);
+      std::vector<int> row(candidates.begin() + offsets[tp],
+                           candidates.begin() + offsets[tp + 1]);
+      ASSERT_EQ(cnbr, row);
+    }
+  }
+
+} // TEST(search_by_cells, find_all)
@@ -0,0 +1,161 @@
+/*
+This file is part of the Ristra portage project.
+Please see the license file at the root of this repository, or at:
+    https://github.com/laristra/portage/blob/master/LICENSE
+*/
+
+#ifndef PORTAGE_SUPPORT_GID_MAP_H_
+#define PORTAGE_SUPPORT_GID_MAP_H_
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "portage/support/portage.h"
+#include "wonton/support/wonton.h"
+
+/*!
+  @file gid_map.h
+  @brief Hash map from global ids to local indices.
+*/
+
+namespace Portage {
+
+using Wonton::GID_t;
+
+/*!
+  @class GidMap "gid_map.h"
+  @brief Open addressing hash map from unique global ids to their index
+  in a vector of global ids, e.g. the flat mesh entities.
+
+  The table has at least twice as many slots as global ids and collisions
+  are resolved by linear probing, so that a lookup usually reads a single
+  cache line instead of walking the log2(n) nodes of a std::map. The table
+  is filled with all the threads available to Portage::for_each, each
+  global id being inserted with a compare-and-swap on its slot.
+*/
+class GidMap {
+ public:
+
+  //! Empty map
+  GidMap() = default;
+
+  /*!
+    @brief Map each global id to its index
+    @param[in] gids Unique global ids
+  */
+  explicit GidMap(std::vector<GID_t> const& gids) { build(gids); }
+
+  GidMap(GidMap const&) = delete;
+  GidMap& operator=(GidMap const&) = delete;
+  GidMap(GidMap&&) = default;
+  GidMap& operator=(GidMap&&) = default;
+
+  /*!
+    @brief Map each global id to its index, replacing the current content
+    @param[in] gids Unique global ids
+  */
+  void build(std::vector<GID_t> const& gids) {
+    int const n = gids.size();
+    size_ = n;
+
+    capacity_ = 16;
+    while (capacity_ < 2 * static_cast<size_t>(n))
+      capacity_ *= 2;
+    keys_.reset(new std::atomic<GID_t>[capacity_]);
+    values_.assign(capacity_, -1);
+
+    auto* keys = keys_.get();
+    auto* values = values_.data();
+    size_t const mask = capacity_ - 1;
+
+    Portage::for_each(make_counting_iterator(0),
+                      make_counting_iterator(static_cast<unsigned>(capacity_)),
+                      [keys](size_t s) {
+                        keys[s].store(empty_key, std::memory_order_relaxed);
+                      });
+
+    auto const* in = gids.data();
+    Portage::for_each(make_counting_iterator(0), make_counting_iterator(n),
+                      [keys, values, mask, in](int i) {
+                        GID_t const gid = in[i];
+                        assert(gid != empty_key);
+                        size_t s = hash(gid) & mask;
+                        while (true) {
+                          GID_t expected = empty_key;
+                          if (keys[s].compare_exchange_strong(
+                                  expected, gid, std::memory_order_relaxed)) {
+                            values[s] = i;
+                            return;
+                          }
+                          assert(expected != gid);  // ids must be unique
+                          s = (s + 1) & mask;
+                        }
+                      });
+  }
+
+  /*!
+    @brief Index of a global id
+    @param[in] gid Global id
+    @return Its index, or -1 if it is not in the map
+  */
+  int find(GID_t gid) const {
+    if (size_ == 0)
+      return -1;
+    size_t const mask = capacity_ - 1;
+    for (size_t s = hash(gid) & mask; ; s = (s + 1) & mask) {
+      GID_t const key = keys_[s].load(std::memory_order_relaxed);
+      if (key == gid)
+        return values_[s];
+      if (key == empty_key)
+        return -1;
+    }
+  }
+
+  /*!
+    @brief Index of a global id that must be in the map
+    @param[in] gid Global id
+    @return Its index
+    @throw std::out_of_range if the global id is not in the map
+  */
+  int at(GID_t gid) const {
+    int const index = find(gid);
+    if (index < 0)
+      throw std::out_of_range("GidMap: unknown global id " + std::to_string(gid));
+    return index;
+  }
+
+  //! Number of global ids in the map
+  int size() const { return size_; }
+
+ private:
+
+  //! Marker of the empty slots, not a valid global id
+  static constexpr GID_t empty_key = std::numeric_limits<GID_t>::min();
+
+  //! Mix the bits of a global id (splitmix64 finalizer) so that strided
+  //! global ids do not pile up in the same slots
+  static size_t hash(GID_t gid) {
+    uint64_t x = static_cast<uint64_t>(gid);
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return static_cast<size_t>(x);
+  }
+
+  int size_ = 0;
+  size_t capacity_ = 0;
+  std::unique_ptr<std::atomic<GID_t>[]> keys_;
+  std::vector<int> values_;
+};
+
+}  // namespace Portage
+
+#endif  // PORTAGE_SUPPORT_GID_MAP_H_
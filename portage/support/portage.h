@@ -18,17 +18,29 @@ Please see the license file at the root of this repository, or at:
 #include "thrust/iterator/counting_iterator.h"
 #include "thrust/transform.h"
 
+#include <vector>
+#include <algorithm>
+#include <functional>
+
 #else  // no thrust
 
 #include <boost/iterator/counting_iterator.hpp>
+#include <boost/iterator/iterator_categories.hpp>
 
 #include <vector>
 #include <algorithm>
+#include <functional>
+#include <iterator>
 #include <string>
 #include <limits>
+#include <type_traits>
 
 #endif
 
+#if defined(PORTAGE_ENABLE_OPENMP) && defined(_OPENMP)
+#include <omp.h>
+#endif
+
 #include "wonton/support/Point.h"
 #include "wonton/support/Vector.h"
 #include "wonton/support/Matrix.h"
@@ -81,6 +93,31 @@ using Wonton::Field_type;
 using Wonton::Data_layout;
 using Wonton::Weights_t;
 
+/*!
+  @brief Intersect a target entity with candidate source entities using
+  an intersector that writes the intersections to flat arrays (see
+  IntersectR2D::intersect) and return them as a list of Weights_t
+  @tparam NMOMENTS number of moments the intersector writes per entry
+*/
+template<int NMOMENTS, class Intersector>
+std::vector<Weights_t> intersection_weights(Intersector const& intersector,
+                                            int target,
+                                            std::vector<int> const& sources) {
+  int const nsources = sources.size();
+  std::vector<int> entities(nsources);
+  std::vector<double> moments(NMOMENTS * nsources);
+  int const nentries = intersector.intersect(target, sources, entities.data(),
+                                             moments.data());
+
+  std::vector<Weights_t> weights;
+  weights.reserve(nentries);
+  for (int i = 0; i < nentries; i++)
+    weights.emplace_back(entities[i],
+                         std::vector<double>(moments.begin() + NMOMENTS * i,
+                                             moments.begin() + NMOMENTS * (i+1)));
+  return weights;
+}
+
 /// Limiter type
 typedef enum {NOLIMITER, BARTH_JESPERSEN} Limiter_type;
 constexpr int NUM_LIMITER_TYPE = 2;
@@ -148,6 +185,24 @@ inline std::string to_string(Empty_fixup_type empty_fixup_type) {
       "INVALID EMPTY FIXUP TYPE";
 }
 
+/// Granularity at which source data is redistributed in distributed runs
+typedef enum {PARTITION_BOUNDING_BOX, CELL_BOUNDING_BOX}
+  Redistribution_type;
+constexpr int NUM_REDISTRIBUTION_TYPE = 2;
+
+constexpr Redistribution_type DEFAULT_REDISTRIBUTION_TYPE =
+    Redistribution_type::PARTITION_BOUNDING_BOX;
+
+inline std::string to_string(Redistribution_type redistribution_type) {
+  static const std::string type2string[NUM_REDISTRIBUTION_TYPE] =
+      {"Redistribution_type::PARTITION_BOUNDING_BOX",
+       "Redistribution_type::CELL_BOUNDING_BOX"};
+
+  int itype = static_cast<int>(redistribution_type);
+  return (itype >= 0 && itype < NUM_REDISTRIBUTION_TYPE) ? type2string[itype] :
+      "INVALID REDISTRIBUTION TYPE";
+}
+
 /// Intersection and other tolerances to handle tiny values
 struct NumericTolerances_t {
     // Flag if custom tolerances were used. If user is setting his own
@@ -245,6 +300,120 @@ inline counting_iterator make_counting_iterator(unsigned int const i) {
   return boost::make_counting_iterator<unsigned int>(i);
 }
 
+#ifdef PORTAGE_ENABLE_OPENMP
+
+namespace detail {
+
+/// Whether all the given iterators allow indexed access so that the
+/// range can be split among threads (counting iterators, pointers and
+/// vector iterators do; list or stream iterators do not)
+template<typename... Iterators>
+struct is_random_access;
+
+template<typename Iterator>
+struct is_random_access<Iterator>
+    : std::is_convertible<typename boost::iterator_traversal<Iterator>::type,
+                          boost::random_access_traversal_tag> {};
+
+template<typename Iterator, typename... Iterators>
+struct is_random_access<Iterator, Iterators...>
+    : std::integral_constant<bool, is_random_access<Iterator>::value and
+                                   is_random_access<Iterators...>::value> {};
+
+// Threaded versions of the algorithms. The per-entity cost of search,
+// intersection and interpolation varies a lot (e.g. near material
+// interfaces), so iterations are handed out with a guided schedule.
+
+template<typename InputIterator, typename OutputIterator,
+         typename UnaryFunction>
+inline OutputIterator transform(InputIterator first, InputIterator last,
+                                OutputIterator result, UnaryFunction op,
+                                std::true_type) {
+  auto const n = static_cast<long>(std::distance(first, last));
+#pragma omp parallel for schedule(guided)
+  for (long i = 0; i < n; i++)
+    result[i] = op(first[i]);
+  return result + n;
+}
+
+template<typename InputIterator, typename OutputIterator,
+         typename UnaryFunction>
+inline OutputIterator transform(InputIterator first, InputIterator last,
+                                OutputIterator result, UnaryFunction op,
+                                std::false_type) {
+  return std::transform(first, last, result, op);
+}
+
+template<typename InputIterator1, typename InputIterator2,
+         typename OutputIterator, typename BinaryFunction>
+inline OutputIterator transform(InputIterator1 first1, InputIterator1 last1,
+                                InputIterator2 first2, OutputIterator result,
+                                BinaryFunction op, std::true_type) {
+  auto const n = static_cast<long>(std::distance(first1, last1));
+#pragma omp parallel for schedule(guided)
+  for (long i = 0; i < n; i++)
+    result[i] = op(first1[i], first2[i]);
+  return result + n;
+}
+
+template<typename InputIterator1, typename InputIterator2,
+         typename OutputIterator, typename BinaryFunction>
+inline OutputIterator transform(InputIterator1 first1, InputIterator1 last1,
+                                InputIterator2 first2, OutputIterator result,
+                                BinaryFunction op, std::false_type) {
+  return std::transform(first1, last1, first2, result, op);
+}
+
+template<typename InputIterator, typename UnaryFunction>
+inline void for_each(InputIterator first, InputIterator last,
+                     UnaryFunction f, std::true_type) {
+  auto const n = static_cast<long>(std::distance(first, last));
+#pragma omp parallel for schedule(guided)
+  for (long i = 0; i < n; i++)
+    f(first[i]);
+}
+
+template<typename InputIterator, typename UnaryFunction>
+inline void for_each(InputIterator first, InputIterator last,
+                     UnaryFunction f, std::false_type) {
+  std::for_each(first, last, f);
+}
+
+}  // namespace detail
+
+// As with the Thrust OpenMP backend, the functors passed in here are
+// invoked concurrently and must not modify shared state
+
+template<typename InputIterator, typename OutputIterator,
+    typename UnaryFunction>
+inline OutputIterator transform(InputIterator first, InputIterator last,
+                                OutputIterator result, UnaryFunction op) {
+  using tag = std::integral_constant<bool,
+      detail::is_random_access<InputIterator, OutputIterator>::value>;
+  return detail::transform(first, last, result, op, tag());
+}
+
+template<typename InputIterator1, typename InputIterator2,
+         typename OutputIterator, typename BinaryFunction>
+inline OutputIterator transform(InputIterator1 first1, InputIterator1 last1,
+                                InputIterator2 first2, OutputIterator result,
+                                BinaryFunction op) {
+  using tag = std::integral_constant<bool,
+      detail::is_random_access<InputIterator1, InputIterator2,
+                               OutputIterator>::value>;
+  return detail::transform(first1, last1, first2, result, op, tag());
+}
+
+template<typename InputIterator, typename UnaryFunction>
+inline void for_each(InputIterator first, InputIterator last,
+                     UnaryFunction f) {
+  using tag = std::integral_constant<bool,
+      detail::is_random_access<InputIterator>::value>;
+  detail::for_each(first, last, f, tag());
+}
+
+#else  // no openmp
+
 template<typename InputIterator, typename OutputIterator,
     typename UnaryFunction>
 inline OutputIterator transform(InputIterator first, InputIterator last,
@@ -266,8 +435,71 @@ inline void for_each(InputIterator first, InputIterator last,
   std::for_each(first, last, f);
 }
 
+#endif  // PORTAGE_ENABLE_OPENMP
+
 #endif
 
+/// Number of threads available to the Portage::transform and
+/// Portage::for_each algorithms on this rank. Only the OpenMP backend
+/// counts, not OpenMP enabled elsewhere in the application.
+inline int num_threads() {
+#if defined(PORTAGE_ENABLE_OPENMP) && defined(_OPENMP)
+  return omp_get_max_threads();
+#else
+  return 1;
+#endif
+}
+
+/// Index of the calling thread within Portage::transform and
+/// Portage::for_each, in [0, num_threads())
+inline int thread_id() {
+#if defined(PORTAGE_ENABLE_OPENMP) && defined(_OPENMP)
+  return omp_get_thread_num();
+#else
+  return 0;
+#endif
+}
+
+/// Sort a vector on this rank with all the threads available to
+/// Portage::for_each: chunks are sorted independently, then adjacent runs
+/// are merged pairwise
+template<typename T, typename Compare = std::less<T>>
+void parallel_sort(std::vector<T>& values, Compare compare = Compare()) {
+  int const n = values.size();
+  int const nchunks = std::min(num_threads(), std::max(n / 4096, 1));
+  if (nchunks <= 1) {
+    std::sort(values.begin(), values.end(), compare);
+    return;
+  }
+
+  auto bound = [n, nchunks](int k) {
+    return static_cast<int>(static_cast<long>(n) * k / nchunks);
+  };
+
+  auto* data = &values;
+  Portage::for_each(make_counting_iterator(0),
+                    make_counting_iterator(nchunks),
+                    [data, bound, compare](int k) {
+                      std::sort(data->begin() + bound(k),
+                                data->begin() + bound(k + 1), compare);
+                    });
+
+  for (int width = 1; width < nchunks; width *= 2) {
+    int const npairs = (nchunks + 2 * width - 1) / (2 * width);
+    Portage::for_each(make_counting_iterator(0),
+                      make_counting_iterator(npairs),
+                      [data, bound, width, nchunks, compare](int p) {
+                        int const first = 2 * p * width;
+                        int const middle = std::min(first + width, nchunks);
+                        int const last = std::min(first + 2 * width, nchunks);
+                        std::inplace_merge(data->begin() + bound(first),
+                                           data->begin() + bound(middle),
+                                           data->begin() + bound(last),
+                                           compare);
+                      });
+  }
+}
+
 }  // namespace Portage
 
 #endif  // PORTAGE_SUPPORT_PORTAGE_H_
@@ -0,0 +1,271 @@
+/*
+  This file is part of the Ristra portage project.
+  Please see the license file at the root of this repository, or at:
+  https://github.com/laristra/portage/blob/master/LICENSE
+*/
+
+#ifndef PORTAGE_SUPPORT_SMOOTHING_LENGTHS_H_
+#define PORTAGE_SUPPORT_SMOOTHING_LENGTHS_H_
+
+#include <vector>
+#include <cassert>
+#include <algorithm>
+
+#include "portage/support/portage.h"
+
+/*!
+  @file smoothing_lengths.h
+  @brief Flat storage of the smoothing lengths of all the particles of a
+  swarm.
+*/
+
+namespace Portage { namespace Meshfree {
+
+/*!
+  @class SmoothingLengths "smoothing_lengths.h"
+
+  @brief Smoothing lengths of all the particles of a swarm in a single
+  strided array.
+
+  Each particle has a list of facets and each facet a fixed number of
+  lengths: a single facet of dim lengths for elliptic and tensor product
+  weights, or one facet of dim+1 values (normal and distance) per face
+  for faceted weights. This replaces the
+  Portage::vector<std::vector<std::vector<double>>> layout, which carries
+  two heap-allocated vectors per particle, with one array of lengths.
+
+  When all the particles have the same number of facets, which is the
+  common case, the facets of particle i simply start at i times that
+  number and no offsets are stored. Facets with fewer lengths than the
+  others are padded with zeros.
+
+  Particles are exposed through lightweight views indexable like the
+  nested vectors ('lengths[i][j][k]') and convertible to them, so that
+  code written against the old layout works on both.
+*/
+class SmoothingLengths {
+ public:
+
+  /// Read-only view of the lengths of one facet
+  class Facet {
+   public:
+    Facet(double const* data, int size) : data_(data), size_(size) {}
+
+    double operator[](int k) const { assert(k < size_); return data_[k]; }
+    int size() const { return size_; }
+    double const* begin() const { return data_; }
+    double const* end() const { return data_ + size_; }
+
+    /// Copy the lengths (for code expecting a std::vector<double>)
+    operator std::vector<double>() const { return {begin(), end()}; }
+
+   private:
+    double const* data_;
+    int size_;
+  };
+
+  /// Read-only view of the facets of one particle
+  class Facets {
+   public:
+    Facets(double const* data, int num_facets, int facet_size)
+        : data_(data), num_facets_(num_facets), facet_size_(facet_size) {}
+
+    Facet operator[](int j) const {
+      assert(j < num_facets_);
+      return {data_ + j * facet_size_, facet_size_};
+    }
+    int size() const { return num_facets_; }
+    bool empty() const { return num_facets_ == 0; }
+    double const* data() const { return data_; }
+
+    /// Copy the facets (for code expecting nested vectors)
+    operator std::vector<std::vector<double>>() const {
+      std::vector<std::vector<double>> facets;
+      facets.reserve(num_facets_);
+      for (int j = 0; j < num_facets_; j++)
+        facets.emplace_back((*this)[j]);
+      return facets;
+    }
+
+   private:
+    double const* data_;
+    int num_facets_;
+    int facet_size_;
+  };
+
+  /// No particle
+  SmoothingLengths() = default;
+
+  /*!
+    @brief The same smoothing lengths for all the particles
+    @param[in] num_particles  Number of particles
+    @param[in] lengths        Facets of every particle
+  */
+  SmoothingLengths(int num_particles,
+                   std::vector<std::vector<double>> const& lengths) {
+    num_facets_ = lengths.size();
+    for (auto const& facet : lengths)
+      facet_size_ = std::max(facet_size_, static_cast<int>(facet.size()));
+
+    std::vector<double> particle(num_facets_ * facet_size_, 0.);
+    for (int j = 0; j < num_facets_; j++)
+      std::copy(lengths[j].begin(), lengths[j].end(),
+                particle.begin() + j * facet_size_);
+
+    values_.reserve(num_particles * particle.size());
+    for (int i = 0; i < num_particles; i++)
+      values_.insert(values_.end(), particle.begin(), particle.end());
+    size_ = num_particles;
+  }
+
+  /*!
+    @brief Flatten nested smoothing lengths. Explicit since it copies all
+    the lengths, padding facets to the widest one.
+    @param[in] lengths  lengths[i][j][k] is the k-th length of the j-th
+                        facet of particle i
+  */
+  explicit SmoothingLengths(Portage::vector<std::vector<std::vector<double>>> const& lengths) {
+    int const num_particles = lengths.size();
+    std::vector<int> num_facets(num_particles);
+    size_t total_facets = 0;
+    for (int i = 0; i < num_particles; i++) {
+      std::vector<std::vector<double>> const& facets = lengths[i];
+      num_facets[i] = facets.size();
+      total_facets += facets.size();
+      for (auto const& facet : facets)
+        facet_size_ = std::max(facet_size_, static_cast<int>(facet.size()));
+    }
+
+    if (num_particles > 0)
+      num_facets_ = num_facets[0];
+    if (std::any_of(num_facets.begin(), num_facets.end(),
+                    [this](int n) { return n != num_facets_; })) {
+      offsets_.resize(num_particles + 1, 0);
+      for (int i = 0; i < num_particles; i++)
+        offsets_[i+1] = offsets_[i] + num_facets[i];
+    }
+
+    values_.assign(total_facets * facet_size_, 0.);
+    for (int i = 0; i < num_particles; i++) {
+      std::vector<std::vector<double>> const& facets = lengths[i];
+      double* particle = data(i);
+      for (int j = 0; j < num_facets[i]; j++)
+        std::copy(facets[j].begin(), facets[j].end(), particle + j * facet_size_);
+    }
+    size_ = num_particles;
+  }
+
+  /// Number of particles
+  int size() const { return size_; }
+
+  /// Whether there is no particle
+  bool empty() const { return size_ == 0; }
+
+  /// Number of lengths per facet
+  int facet_size() const { return facet_size_; }
+
+  /// Number of facets of particle i
+  int num_facets(int i) const {
+    return offsets_.empty() ? num_facets_ : offsets_[i+1] - offsets_[i];
+  }
+
+  /// Facets of particle i
+  Facets operator[](int i) const {
+    assert(i < size_);
+    return {data(i), num_facets(i), facet_size_};
+  }
+
+  /// Lengths of the facets of particle i, facet after facet
+  double const* data(int i) const {
+    return values_.data() + first_facet(i) * facet_size_;
+  }
+
+  /// Lengths of the facets of particle i, facet after facet
+  double* data(int i) {
+    return values_.data() + first_facet(i) * facet_size_;
+  }
+
+  /*!
+    @brief Append a particle. Facets are padded to facet_size(), which
+    grows if one of them is wider.
+    @param[in] lengths  Its facets
+  */
+  void push_back(std::vector<std::vector<double>> const& lengths) {
+    int const nfacets = lengths.size();
+    int width = 0;
+    for (auto const& facet : lengths)
+      width = std::max(width, static_cast<int>(facet.size()));
+    double* particle = append(nfacets, width);
+    for (int j = 0; j < nfacets; j++)
+      std::copy(lengths[j].begin(), lengths[j].end(), particle + j * facet_size_);
+  }
+
+  /*!
+    @brief Append a particle. Facets are padded to facet_size(), which
+    grows if they are wider.
+    @param[in] lengths  Its facets, facet after facet
+    @param[in] nfacets  Its number of facets
+    @param[in] width    Number of lengths of each of its facets
+  */
+  void push_back(double const* lengths, int nfacets, int width) {
+    assert(width > 0 or nfacets == 0);
+    double* particle = append(nfacets, width);
+    for (int j = 0; j < nfacets; j++)
+      std::copy(lengths + j * width, lengths + (j+1) * width,
+                particle + j * facet_size_);
+  }
+
+ private:
+
+  /// Add a zeroed particle of nfacets facets of up to width lengths and
+  /// return its lengths
+  double* append(int nfacets, int width) {
+    if (width > facet_size_)
+      widen(width);
+    if (size_ == 0)
+      num_facets_ = nfacets;
+    else if (nfacets != num_facets_ and offsets_.empty())
+      use_offsets();
+
+    size_t const start = values_.size();
+    values_.resize(start + static_cast<size_t>(nfacets) * facet_size_, 0.);
+    if (not offsets_.empty())
+      offsets_.push_back(offsets_.back() + nfacets);
+    size_++;
+    return values_.data() + start;
+  }
+
+  /// Pad all the facets to width lengths
+  void widen(int width) {
+    size_t const nfacets = facet_size_ > 0 ? values_.size() / facet_size_ : 0;
+    std::vector<double> values(nfacets * width, 0.);
+    for (size_t j = 0; j < nfacets; j++)
+      std::copy(values_.begin() + j * facet_size_,
+                values_.begin() + (j+1) * facet_size_,
+                values.begin() + j * width);
+    values_.swap(values);
+    facet_size_ = width;
+  }
+
+  /// Store the offsets of the facets once particles differ in facet count
+  void use_offsets() {
+    offsets_.resize(size_ + 1);
+    for (int i = 0; i <= size_; i++)
+      offsets_[i] = i * num_facets_;
+  }
+
+  /// Index of the first facet of particle i
+  size_t first_facet(int i) const {
+    return offsets_.empty() ? static_cast<size_t>(i) * num_facets_ : offsets_[i];
+  }
+
+  int size_ = 0;
+  int num_facets_ = 0;          // of every particle, if offsets_ is empty
+  int facet_size_ = 0;
+  std::vector<int> offsets_;    // first facet of each particle, otherwise
+  std::vector<double> values_;
+};
+
+}}  // namespace Portage::Meshfree
+
+#endif  // PORTAGE_SUPPORT_SMOOTHING_LENGTHS_H_
@@ -0,0 +1,53 @@
+/*
+This file is part of the Ristra portage project.
+Please see the license file at the root of this repository, or at:
+    https://github.com/laristra/portage/blob/master/LICENSE
+*/
+
+#include <vector>
+#include <stdexcept>
+
+#include "gtest/gtest.h"
+
+#include "portage/support/gid_map.h"
+
+// Check that each global id maps to its index and that unknown global ids
+// are not found, for ids that are consecutive, strided or negative.
+TEST(GidMap, FindAndAt) {
+
+  int const n = 50000;
+  std::vector<Wonton::GID_t> gids(n);
+  for (int i = 0; i < n; ++i)
+    gids[i] = (i % 2 ? 1 : -1) * static_cast<Wonton::GID_t>(i) * 1024 + 3;
+
+  Portage::GidMap map(gids);
+  ASSERT_EQ(map.size(), n);
+
+  for (int i = 0; i < n; ++i) {
+    ASSERT_EQ(map.find(gids[i]), i);
+    ASSERT_EQ(map.at(gids[i]), i);
+  }
+
+  ASSERT_EQ(map.find(4), -1);
+  ASSERT_EQ(map.find(1024 + 4), -1);
+  ASSERT_THROW(map.at(4), std::out_of_range);
+
+  // rebuilding replaces the previous content
+  map.build({12, 7});
+  ASSERT_EQ(map.size(), 2);
+  ASSERT_EQ(map.at(12), 0);
+  ASSERT_EQ(map.at(7), 1);
+  ASSERT_EQ(map.find(gids[5]), -1);
+}
+
+// Check that an empty map finds nothing.
+TEST(GidMap, Empty) {
+
+  Portage::GidMap map;
+  ASSERT_EQ(map.size(), 0);
+  ASSERT_EQ(map.find(0), -1);
+  ASSERT_THROW(map.at(0), std::out_of_range);
+
+  map.build({});
+  ASSERT_EQ(map.find(0), -1);
+}
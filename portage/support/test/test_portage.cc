@@ -0,0 +1,95 @@
+/*
+This file is part of the Ristra portage project.
+Please see the license file at the root of this repository, or at:
+    https://github.com/laristra/portage/blob/master/LICENSE
+*/
+
+#include <vector>
+#include <list>
+#include <numeric>
+#include <utility>
+#include <algorithm>
+
+#include "gtest/gtest.h"
+
+#include "portage/support/portage.h"
+
+// Check that the transform on a counting iterator gives the same result
+// as its serial counterpart, whatever the backend in use.
+TEST(Portage_Algorithms, TransformCounting) {
+
+  int const n = 10000;
+  Portage::vector<double> result(n, 0.);
+
+  Portage::transform(Portage::make_counting_iterator(0),
+                     Portage::make_counting_iterator(n),
+                     result.begin(), [](int i) { return 2. * i + 1.; });
+
+  for (int i = 0; i < n; ++i)
+    ASSERT_DOUBLE_EQ(result[i], 2. * i + 1.);
+}
+
+// Check the binary transform with a pointer as output iterator, as done
+// in the core driver when writing into the target state.
+TEST(Portage_Algorithms, TransformBinary) {
+
+  int const n = 10000;
+  std::vector<int> ids(n);
+  std::vector<std::vector<double>> weights(n);
+  std::iota(ids.begin(), ids.end(), 0);
+  for (int i = 0; i < n; ++i)
+    weights[i].assign(i % 7, 0.5);
+
+  std::vector<double> values(n, 0.);
+  Portage::pointer<double> output(values.data());
+
+  Portage::transform(ids.begin(), ids.end(), weights.begin(), output,
+                     [](int i, std::vector<double> const& w) {
+                       return i + std::accumulate(w.begin(), w.end(), 0.);
+                     });
+
+  for (int i = 0; i < n; ++i)
+    ASSERT_DOUBLE_EQ(values[i], i + 0.5 * (i % 7));
+}
+
+// Check that non random-access ranges are still correctly handled.
+TEST(Portage_Algorithms, ForEachList) {
+
+  std::list<int> cells = { 4, 2, 0, 3, 1 };
+  std::vector<int> marks(cells.size(), 0);
+
+  Portage::for_each(cells.begin(), cells.end(), [&](int c) { marks[c] = c + 1; });
+
+  for (int c = 0; c < 5; ++c)
+    ASSERT_EQ(marks[c], c + 1);
+
+  ASSERT_GE(Portage::num_threads(), 1);
+#ifndef PORTAGE_ENABLE_OPENMP
+  // compiling the application with OpenMP does not thread the serial backend
+  ASSERT_EQ(Portage::num_threads(), 1);
+  ASSERT_EQ(Portage::thread_id(), 0);
+#endif
+}
+
+// Check that the threaded sort gives the same order as std::sort, for
+// sizes split in several chunks or not and with a custom comparison.
+TEST(Portage_Algorithms, ParallelSort) {
+
+  for (int n : {0, 1, 1000, 100003}) {
+    std::vector<std::pair<int, int>> values(n);
+    for (int i = 0; i < n; ++i)
+      values[i] = {(i * 7919) % 1009, i};
+
+    auto expected = values;
+    std::sort(expected.begin(), expected.end());
+    Portage::parallel_sort(values);
+    ASSERT_EQ(values, expected);
+
+    auto greater = [](std::pair<int, int> const& a, std::pair<int, int> const& b) {
+      return a > b;
+    };
+    std::sort(expected.begin(), expected.end(), greater);
+    Portage::parallel_sort(values, greater);
+    ASSERT_EQ(values, expected);
+  }
+}
@@ -0,0 +1,38 @@
+/*
+This file is part of the Ristra portage project.
+Please see the license file at the root of this repository, or at:
+    https://github.com/laristra/portage/blob/master/LICENSE
+*/
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "portage/support/timer.h"
+
+// Export counters as JSON with their min/max/mean over ranks
+TEST(Profiler, JSON) {
+
+  Profiler profiler;
+  profiler.time.search = 1.5;
+  profiler.count.targets = 12;
+  profiler.count.intersections = 30;
+  profiler.thread_load = {4, 8};
+
+  std::string const json = profiler.to_json();
+
+  ASSERT_NE(json.find("\"search\": {\"min\": 1.5, \"max\": 1.5, \"mean\": 1.5}"),
+            std::string::npos);
+  ASSERT_NE(json.find("\"targets\": {\"min\": 12, \"max\": 12, \"mean\": 12}"),
+            std::string::npos);
+  ASSERT_NE(json.find("\"intersections\": {\"min\": 30"), std::string::npos);
+  ASSERT_NE(json.find("\"thread_load\": {\"min\": 4, \"max\": 8, \"mean\": 6}"),
+            std::string::npos);
+
+  // everything is cleared on reset
+  profiler.reset();
+  ASSERT_EQ(profiler.count.targets, 0);
+  ASSERT_TRUE(profiler.thread_load.empty());
+  ASSERT_NE(profiler.to_json().find("\"thread_load\": {\"min\": 0, \"max\": 0, \"mean\": 0}"),
+            std::string::npos);
+}
@@ -0,0 +1,107 @@
+/*
+This file is part of the Ristra portage project.
+Please see the license file at the root of this repository, or at:
+    https://github.com/laristra/portage/blob/master/LICENSE
+*/
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "portage/support/portage.h"
+#include "portage/support/smoothing_lengths.h"
+#include "portage/support/weight.h"
+
+using Portage::Meshfree::SmoothingLengths;
+
+// Same lengths for all particles: no offsets, particle i at i * dim
+TEST(SmoothingLengths, Uniform) {
+
+  SmoothingLengths lengths(3, {{1.0, 2.0}});
+  ASSERT_EQ(lengths.size(), 3);
+  ASSERT_EQ(lengths.facet_size(), 2);
+  ASSERT_EQ(lengths.num_facets(2), 1);
+  ASSERT_EQ(lengths.data(1), lengths.data(0) + 2);
+
+  lengths.data(1)[1] = 5.0;
+  ASSERT_DOUBLE_EQ(lengths[1][0][1], 5.0);
+  ASSERT_DOUBLE_EQ(lengths[2][0][1], 2.0);
+
+  // views convert back to the nested layout
+  std::vector<std::vector<double>> h = lengths[1];
+  ASSERT_EQ(h, std::vector<std::vector<double>>({{1.0, 5.0}}));
+}
+
+// Particles with different numbers of facets, as given by faceted_setup
+TEST(SmoothingLengths, Faceted) {
+
+  Portage::vector<std::vector<std::vector<double>>> nested(3);
+  nested[0] = {{1., 0., 0.5}, {0., 1., 0.5}, {-1., 0., 0.5}};
+  nested[1] = {{1., 0., 0.25}, {-1., 0., 0.25}};
+  nested[2] = {{0., -1., 2.}, {0., 1., 2.}, {1., 0., 2.}};
+
+  SmoothingLengths lengths(nested);
+  ASSERT_EQ(lengths.size(), 3);
+  ASSERT_EQ(lengths.facet_size(), 3);
+  ASSERT_EQ(lengths.num_facets(0), 3);
+  ASSERT_EQ(lengths.num_facets(1), 2);
+  ASSERT_EQ(lengths.data(2), lengths.data(0) + 15);
+
+  for (int i = 0; i < 3; i++) {
+    std::vector<std::vector<double>> const& h = nested[i];
+    ASSERT_EQ(std::vector<std::vector<double>>(lengths[i]), h);
+  }
+
+  // append particles as received from other ranks
+  lengths.push_back(nested[1]);
+  double const received[] = {0., 1., 3., 0., -1., 3., 1., 0., 3.};
+  lengths.push_back(received, 3, 3);
+  ASSERT_EQ(lengths.size(), 5);
+  ASSERT_EQ(lengths.num_facets(3), 2);
+  ASSERT_EQ(lengths.num_facets(4), 3);
+  ASSERT_DOUBLE_EQ(lengths[3][1][2], 0.25);
+  ASSERT_DOUBLE_EQ(lengths[4][2][0], 1.);
+
+  // weights read the views like the nested vectors
+  using namespace Portage::Meshfree::Weight;
+  Wonton::Point<2> x(0., 0.), y(0.1, 0.2);
+  for (int i = 0; i < 3; i++) {
+    std::vector<std::vector<double>> const& h = nested[i];
+    ASSERT_DOUBLE_EQ(eval<2>(FACETED, POLYRAMP, x, y, lengths[i]),
+                     eval<2>(FACETED, POLYRAMP, x, y, h));
+  }
+}
+
+// Shorter facets are padded to the widest one
+TEST(SmoothingLengths, Padding) {
+
+  Portage::vector<std::vector<std::vector<double>>> nested(2);
+  nested[0] = {{1., 2.}};
+  nested[1] = {{3., 4., 5.}};
+
+  SmoothingLengths lengths(nested);
+  ASSERT_EQ(lengths.facet_size(), 3);
+  ASSERT_EQ(lengths.num_facets(0), 1);
+  ASSERT_DOUBLE_EQ(lengths[0][0][1], 2.);
+  ASSERT_DOUBLE_EQ(lengths[0][0][2], 0.);
+  ASSERT_DOUBLE_EQ(lengths[1][0][2], 5.);
+}
+
+// Appending to an empty container sets the facet width, appending wider
+// facets pads the existing ones
+TEST(SmoothingLengths, Append) {
+
+  SmoothingLengths lengths;
+  double const received[] = {1., 2., 3., 4.};
+  lengths.push_back(received, 2, 2);
+  ASSERT_EQ(lengths.size(), 1);
+  ASSERT_EQ(lengths.facet_size(), 2);
+  ASSERT_DOUBLE_EQ(lengths[0][1][1], 4.);
+
+  lengths.push_back({{5., 6., 7.}, {8., 9., 10.}});
+  ASSERT_EQ(lengths.facet_size(), 3);
+  ASSERT_DOUBLE_EQ(lengths[0][1][0], 3.);
+  ASSERT_DOUBLE_EQ(lengths[0][1][2], 0.);
+  ASSERT_DOUBLE_EQ(lengths[1][1][2], 10.);
+  ASSERT_EQ(lengths.data(1), lengths.data(0) + 6);
+}
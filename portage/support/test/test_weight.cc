@@ -5,6 +5,8 @@ Please see the license file at the root of this repository, or at:
 */
 #include <cmath>
 #include <ctime>
+#include <vector>
+#include <algorithm>
 
 #include "gtest/gtest.h"
 
@@ -185,3 +187,74 @@ INSTANTIATE_TEST_CASE_P(
 INSTANTIATE_TEST_CASE_P(FacetedSupport, WeightTest,
                         Combine(Values(FACETED), Values(POLYRAMP, STEP)));
 
+
+// Batched weights are the single point weights, element by element
+class BatchWeightTest : public TestWithParam<tuple<Geometry, Kernel>> {
+ public:
+  template<int Dim>
+  void checkBatch(const Geometry geo, const Kernel kernel) {
+
+    Point<Dim> x;
+    for (int d = 0; d < Dim; d++)
+      x[d] = ((double) rand()) / RAND_MAX;
+
+    double const nominal_h = .2;
+    vector<vector<double>> hvec;
+    if (geo == FACETED) {
+      // isothetic box of 2*Dim facets of Dim+1 values
+      for (int j = 0; j < Dim; j++) {
+        for (double sign : {-1., 1.}) {
+          vector<double> facet(Dim + 1, 0.);
+          facet[j] = sign;
+          facet[Dim] = nominal_h;
+          hvec.push_back(facet);
+        }
+      }
+    } else {
+      hvec.emplace_back(Dim, nominal_h);
+      hvec[0][0] = 1.5 * nominal_h;  // anisotropic
+    }
+
+    // odd sizes so that no batch is a multiple of a vector width
+    for (int n : {1, 3, 7, 13, 33}) {
+      vector<Point<Dim>> y(n);
+      y[0] = x;
+      for (int j = 1; j < n; j++) {
+        // inside (-3h,3h), every third one well outside the support
+        double const scale = (j % 3 == 0) ? 20. : 6.;
+        for (int d = 0; d < Dim; d++)
+          y[j][d] = x[d] + scale * nominal_h * (((double) rand()) / RAND_MAX - 0.5);
+      }
+      y[n-1][0] = x[0] + 5 * nominal_h;  // outside along an axis
+
+      vector<double> batch(n);
+      eval<Dim>(geo, kernel, x, y.data(), n, hvec, batch.data());
+      for (int j = 0; j < n; j++) {
+        double const single = eval<Dim>(geo, kernel, x, y[j], hvec);
+        EXPECT_NEAR(batch[j], single, 1.e-12 * std::max(1., std::abs(single)))
+          << "n = " << n << ", j = " << j;
+      }
+    }
+  }
+};
+
+TEST_P(BatchWeightTest, check_batch_1D) {
+  checkBatch<1>(std::get<0>(GetParam()), std::get<1>(GetParam()));
+}
+
+TEST_P(BatchWeightTest, check_batch_2D) {
+  checkBatch<2>(std::get<0>(GetParam()), std::get<1>(GetParam()));
+}
+
+TEST_P(BatchWeightTest, check_batch_3D) {
+  checkBatch<3>(std::get<0>(GetParam()), std::get<1>(GetParam()));
+}
+
+INSTANTIATE_TEST_CASE_P(
+    GeoKernelCombos,
+    BatchWeightTest,
+    Combine(Values(ELLIPTIC, TENSOR),
+            Values(B4, SQUARE, EPANECHNIKOV, POLYRAMP, INVSQRT, COULOMB, STEP)));
+
+INSTANTIATE_TEST_CASE_P(FacetedSupport, BatchWeightTest,
+                        Combine(Values(FACETED), Values(POLYRAMP, STEP)));
@@ -0,0 +1,113 @@
+/*
+This file is part of the Ristra portage project.
+Please see the license file at the root of this repository, or at:
+    https://github.com/laristra/portage/blob/master/LICENSE
+*/
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "portage/support/portage.h"
+#include "portage/support/weights_csr.h"
+
+using Wonton::Weights_t;
+
+// Compress a list of weights per target entity and read it back
+TEST(WeightsCSR, RoundTrip) {
+
+  std::vector<std::vector<Weights_t>> list(3);
+  list[0] = {Weights_t(4, {1.0, 0.1, 0.2}), Weights_t(7, {2.0, 0.3, 0.4})};
+  // list[1] left empty: target entity not covered
+  list[2] = {Weights_t(2, {0.5, 0.05, 0.06})};
+
+  Portage::vector<std::vector<Weights_t>> weights(list.begin(), list.end());
+  Portage::WeightsCSR csr(weights);
+
+  ASSERT_EQ(csr.size(), 3);
+  ASSERT_EQ(csr.num_entries(), 3);
+  ASSERT_EQ(csr.num_moments(), 3);
+  ASSERT_TRUE(csr[1].empty());
+
+  auto const& row = csr[0];
+  ASSERT_EQ(row.size(), 2);
+  ASSERT_EQ(row[1].entityID, 7);
+  ASSERT_DOUBLE_EQ(row[1].weights[0], 2.0);
+  ASSERT_DOUBLE_EQ(row[1].weights[2], 0.4);
+
+  // loops written for the old layout work on rows
+  double volume = 0.;
+  for (auto const& entry : csr[0])
+    volume += entry.weights[0];
+  ASSERT_DOUBLE_EQ(volume, 3.0);
+
+  auto const back = csr.to_vector();
+  for (int t = 0; t < 3; t++) {
+    std::vector<Weights_t> const& expected = weights[t];
+    std::vector<Weights_t> const& actual = back[t];
+    ASSERT_EQ(actual.size(), expected.size());
+    for (unsigned i = 0; i < expected.size(); i++) {
+      ASSERT_EQ(actual[i].entityID, expected[i].entityID);
+      ASSERT_EQ(actual[i].weights, expected[i].weights);
+    }
+  }
+}
+
+// Entries with fewer moments than others are padded with zeros
+TEST(WeightsCSR, VariableMoments) {
+
+  Portage::WeightsCSR csr;
+  csr.append({Weights_t(0, {1.0})});
+  csr.append({Weights_t(1, {2.0, 0.5, 0.25}), Weights_t(3, {3.0, 0.1})});
+
+  ASSERT_EQ(csr.num_moments(), 3);
+  ASSERT_DOUBLE_EQ(csr[0][0].weights[0], 1.0);
+  ASSERT_DOUBLE_EQ(csr[0][0].weights[2], 0.0);
+  ASSERT_DOUBLE_EQ(csr[1][0].weights[2], 0.25);
+  ASSERT_DOUBLE_EQ(csr[1][1].weights[1], 0.1);
+  ASSERT_DOUBLE_EQ(csr[1][1].weights[2], 0.0);
+
+  // the two layouts are interchangeable for row-by-row consumers
+  Portage::vector<std::vector<Weights_t>> weights = csr.to_vector();
+  auto const& old_row = Portage::weights_row(weights, 1);
+  auto const& new_row = Portage::weights_row(csr, 1);
+  ASSERT_EQ(old_row.size(), new_row.size());
+  ASSERT_EQ(old_row[1].entityID, new_row[1].entityID);
+}
+
+// Rows given as flat arrays, as written by the intersectors, and rows
+// of other instances are appended without going through Weights_t
+TEST(WeightsCSR, FlatRows) {
+
+  int const entities[] = {5, 8, 9};
+  double const moments[] = {1.0, 0.1, 0.2,  2.0, 0.3, 0.4,  3.0, 0.5, 0.6};
+
+  Portage::WeightsCSR tile;
+  tile.append(entities, moments, 2, 3);
+  tile.append(entities + 2, moments + 6, 1, 3);
+  tile.append(entities, moments, 0, 3);
+
+  ASSERT_EQ(tile.size(), 3);
+  ASSERT_EQ(tile.num_entries(), 3);
+  ASSERT_EQ(tile.num_moments(), 3);
+  ASSERT_EQ(tile[0][1].entityID, 8);
+  ASSERT_DOUBLE_EQ(tile[0][1].weights[2], 0.4);
+  ASSERT_EQ(tile[1][0].entityID, 9);
+  ASSERT_TRUE(tile[2].empty());
+
+  Portage::WeightsCSR all;
+  all.append({Weights_t(1, {4.0})});
+  all.append(tile);
+  ASSERT_EQ(all.size(), 4);
+  ASSERT_EQ(all.num_moments(), 3);
+  ASSERT_DOUBLE_EQ(all[0][0].weights[1], 0.0);
+  ASSERT_DOUBLE_EQ(all[2][0].weights[0], 3.0);
+
+  // cleared instances are reused for the next tile
+  tile.clear();
+  ASSERT_TRUE(tile.empty());
+  ASSERT_EQ(tile.num_entries(), 0);
+  tile.append(entities, moments, 1, 1);
+  ASSERT_EQ(tile.num_moments(), 1);
+  ASSERT_DOUBLE_EQ(tile[0][0].weights[0], 1.0);
+}
@@ -6,9 +6,24 @@
 
 #pragma once
 
+// portage-config.h decides whether the MPI variants of the JSON export
+// below are compiled, which must be the same in every translation unit
+#include "portage-config.h"
+
 #include <chrono>
 #include <cstdio>
 #include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <cassert>
+
+#ifdef PORTAGE_ENABLE_MPI
+#include <mpi.h>
+#endif
 
 /* Wrapper for high precision time point */ 
 namespace timer {
@@ -29,8 +44,8 @@ inline float elapsed(
 ) {
   auto const toc = now();
   auto const timing = static_cast<float>(
-    std::chrono::duration_cast<std::chrono::milliseconds>(toc - tic).count()
-  ) / 1.E3;
+    std::chrono::duration_cast<std::chrono::microseconds>(toc - tic).count()
+  ) / 1.E6;
 
   if (reset) { tic = now(); }
   return timing;
@@ -68,6 +83,19 @@ public:
     float total       = 0;
   } time;
 
+  // event counters
+  struct {
+    long targets       = 0;   // target entities processed
+    long candidates    = 0;   // candidate source entities examined
+    long intersections = 0;   // intersections kept
+    long empty_fixed   = 0;   // empty target entities fixed up
+    long partial_fixed = 0;   // partially covered target entities fixed up
+    long bytes_sent    = 0;   // bytes sent during redistribution
+  } count;
+
+  // candidates examined by each thread during intersection
+  std::vector<long> thread_load;
+
   // run parameters
   struct {
     int ranks    = 1;
@@ -98,6 +126,13 @@ public:
     time.mismatch     = 0;
     time.remap        = 0;
     time.total        = 0;
+    count.targets       = 0;
+    count.candidates    = 0;
+    count.intersections = 0;
+    count.empty_fixed   = 0;
+    count.partial_fixed = 0;
+    count.bytes_sent    = 0;
+    thread_load.clear();
     params.ranks      = 1;
     params.threads    = 1;
     params.dim        = 2;
@@ -219,4 +254,127 @@ public:
     std::fflush(stdout);
     return true;
   }
+
+  /*!
+    @brief Export all counters as a JSON object. Each time and count is
+    reduced over the ranks of the communicator (if any) into its min,
+    max and mean, so that load imbalance across ranks is visible. The
+    thread load is reduced over all threads of all ranks.
+    Collective when a communicator is given.
+    @param[in] comm  communicator of the ranks to reduce over
+    @return the JSON object as a string.
+  */
+#ifdef PORTAGE_ENABLE_MPI
+  std::string to_json(MPI_Comm comm = MPI_COMM_NULL) const {
+#else
+  std::string to_json() const {
+#endif
+
+    int nranks = 1;
+#ifdef PORTAGE_ENABLE_MPI
+    if (comm != MPI_COMM_NULL)
+      MPI_Comm_size(comm, &nranks);
+#endif
+
+    // min, max and sum of a value over all ranks: a rank without any
+    // value passes n = 0 with min/max seeded to +inf/-inf
+    auto reduce = [&](double min, double max, double sum, long n) {
+      std::vector<double> stats = { min, max, sum, static_cast<double>(n) };
+#ifdef PORTAGE_ENABLE_MPI
+      if (comm != MPI_COMM_NULL) {
+        MPI_Allreduce(MPI_IN_PLACE, &stats[0], 1, MPI_DOUBLE, MPI_MIN, comm);
+        MPI_Allreduce(MPI_IN_PLACE, &stats[1], 1, MPI_DOUBLE, MPI_MAX, comm);
+        MPI_Allreduce(MPI_IN_PLACE, &stats[2], 2, MPI_DOUBLE, MPI_SUM, comm);
+      }
+#endif
+      // no value anywhere: report zeros rather than the seeds
+      if (stats[3] == 0)
+        stats[0] = stats[1] = 0.;
+      std::ostringstream entry;
+      entry << "{\"min\": " << stats[0]
+            << ", \"max\": " << stats[1]
+            << ", \"mean\": " << (stats[3] > 0 ? stats[2] / stats[3] : 0.)
+            << "}";
+      return entry.str();
+    };
+
+    auto reduce_value = [&](double value) {
+      return reduce(value, value, value, 1);
+    };
+
+    std::ostringstream json;
+    json << "{\n";
+    json << "  \"ranks\": "   << nranks         << ",\n";
+    json << "  \"threads\": " << params.threads << ",\n";
+    json << "  \"dim\": "     << params.dim     << ",\n";
+    json << "  \"nsource\": " << reduce_value(params.nsource) << ",\n";
+    json << "  \"ntarget\": " << reduce_value(params.ntarget) << ",\n";
+    json << "  \"nmats\": "   << params.nmats   << ",\n";
+    json << "  \"order\": "   << params.order   << ",\n";
+
+    json << "  \"time\": {\n";
+    json << "    \"mesh_init\": "   << reduce_value(time.mesh_init)   << ",\n";
+    json << "    \"redistrib\": "   << reduce_value(time.redistrib)   << ",\n";
+    json << "    \"interface\": "   << reduce_value(time.interface)   << ",\n";
+    json << "    \"search\": "      << reduce_value(time.search)      << ",\n";
+    json << "    \"intersect\": "   << reduce_value(time.intersect)   << ",\n";
+    json << "    \"gradient\": "    << reduce_value(time.gradient)    << ",\n";
+    json << "    \"interpolate\": " << reduce_value(time.interpolate) << ",\n";
+    json << "    \"mismatch\": "    << reduce_value(time.mismatch)    << ",\n";
+    json << "    \"remap\": "       << reduce_value(time.remap)       << ",\n";
+    json << "    \"total\": "       << reduce_value(time.total)       << "\n";
+    json << "  },\n";
+
+    json << "  \"count\": {\n";
+    json << "    \"targets\": "       << reduce_value(count.targets)       << ",\n";
+    json << "    \"candidates\": "    << reduce_value(count.candidates)    << ",\n";
+    json << "    \"intersections\": " << reduce_value(count.intersections) << ",\n";
+    json << "    \"empty_fixed\": "   << reduce_value(count.empty_fixed)   << ",\n";
+    json << "    \"partial_fixed\": " << reduce_value(count.partial_fixed) << ",\n";
+    json << "    \"bytes_sent\": "    << reduce_value(count.bytes_sent)    << "\n";
+    json << "  },\n";
+
+    double load_min = std::numeric_limits<double>::infinity();
+    double load_max = -std::numeric_limits<double>::infinity();
+    double load_sum = 0.;
+    for (long load : thread_load) {
+      load_min = std::min(load_min, static_cast<double>(load));
+      load_max = std::max(load_max, static_cast<double>(load));
+      load_sum += load;
+    }
+
+    json << "  \"thread_load\": "
+         << reduce(load_min, load_max, load_sum, thread_load.size()) << "\n";
+    json << "}\n";
+    return json.str();
+  }
+
+  /*!
+    @brief Export all counters as JSON to the output file. The counters
+    are reduced over the ranks of the communicator (if any) and only the
+    first rank writes. Collective when a communicator is given.
+    @param[in] comm  communicator of the ranks to reduce over
+    @return false if the file could not be written.
+  */
+#ifdef PORTAGE_ENABLE_MPI
+  bool dump_json(MPI_Comm comm = MPI_COMM_NULL) const {
+    std::string const json = to_json(comm);
+    int rank = 0;
+    if (comm != MPI_COMM_NULL)
+      MPI_Comm_rank(comm, &rank);
+    if (rank > 0)
+      return true;
+#else
+  bool dump_json() const {
+    std::string const json = to_json();
+#endif
+
+    std::ofstream file(params.output, std::ios::out);
+    if (not file.good()) {
+      std::fprintf(stderr, "Could not open file :%s\n", params.output.data());
+      return false;
+    }
+    file << json;
+    return true;
+  }
 };
@@ -7,9 +7,11 @@ Please see the license file at the root of this repository, or at:
 #define PORTAGE_SUPPORT_WEIGHT_H_
 
 #include <cmath>
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <limits>
+#include <stdexcept>
 #include <vector>
 
 // portage includes
@@ -51,14 +53,17 @@ inline double unit_step(double x) { return 0.5 * (1. + sign(x)); }
 /**
  * @brief scalar cubic b-spline.
  *
+ * Written as (2-|x|)_+^3 / 4 - (1-|x|)_+^3, which is branch free and
+ * lets the compiler vectorize loops over many arguments.
+ *
  * @param x: given scalar
  * @return its value at x.
  */
 inline double b4(double x) {
-  return (std::pow(2. - std::abs(x), 3) * unit_step(2. - std::abs(x))
-          * unit_step(-1. + std::abs(x))) / 4.
-          + (1. - 1.5 * std::pow(x, 2)
-          + 0.75 * std::pow(std::abs(x), 3)) * unit_step(1. - std::abs(x));
+  double const ax = std::abs(x);
+  double const t1 = std::max(1. - ax, 0.);
+  double const t2 = std::max(2. - ax, 0.);
+  return 0.25 * t2 * t2 * t2 - t1 * t1 * t1;
 }
 
 /**
@@ -68,9 +73,10 @@ inline double b4(double x) {
  * @return its value at x.
  */
 inline double db4(double x) {
-  return (-3. * x + (9. * std::pow(x, 2) * sign(x)) / 4.)
-         * unit_step(1. - std::abs(x)) - (3. * std::pow(2. - std::abs(x), 2)
-         * sign(x) * unit_step(2. - std::abs(x)) * unit_step(-1. + std::abs(x))) / 4.;
+  double const ax = std::abs(x);
+  double const t1 = std::max(1. - ax, 0.);
+  double const t2 = std::max(2. - ax, 0.);
+  return sign(x) * (3. * t1 * t1 - 0.75 * t2 * t2);
 }
 
 /**
@@ -80,9 +86,10 @@ inline double db4(double x) {
  * @return its value at x.
  */
 inline double ddb4(double x) {
-  return (-3. + (9. * x * sign(x)) / 2.) * unit_step(1. - std::abs(x))
-          + (3. * (2. - std::abs(x)) * unit_step(2. - std::abs(x))
-          * unit_step(-1. + std::abs(x))) / 2.;
+  double const ax = std::abs(x);
+  double const t1 = std::max(1. - ax, 0.);
+  double const t2 = std::max(2. - ax, 0.);
+  return 1.5 * t2 - 6. * t1;
 }
 
 /**
@@ -92,14 +99,17 @@ inline double ddb4(double x) {
  * @return its value at x.
  */
 inline double ib4(double x) {
+  double const x2 = x * x;
+  double const xm2 = (x - 2.) * (x - 2.);
+  double const xp2 = (x + 2.) * (x + 2.);
   return unit_step(-2. + x) + 0.6666666666666666 *
-         ((1.4375 + (0.25 - std::pow(-2. + x, 4) / 4.) / 4.) *
+         ((1.4375 + (0.25 - xm2 * xm2 / 4.) / 4.) *
          unit_step(2. - x) * unit_step(-1. + x) +
-         (0.75 + x - std::pow(x, 3) / 2. + (3. * std::pow(x, 4)) / 16.) *
+         (0.75 + x - x2 * x / 2. + (3. * x2 * x2) / 16.) *
          unit_step(1. - x) * unit_step(x) +
-         (0.75 + x - std::pow(x, 3) / 2. - (3. * std::pow(x, 4)) / 16.) *
+         (0.75 + x - x2 * x / 2. - (3. * x2 * x2) / 16.) *
          unit_step(-x) * unit_step(1. + x) +
-         (std::pow(2. + x, 4) * unit_step(-1. - x) * unit_step(2. + x)) / 16.);
+         (xp2 * xp2 * unit_step(-1. - x) * unit_step(2. + x)) / 16.);
 }
 
 /**
@@ -458,15 +468,17 @@ double faceted(Kernel const kern,
  * @param kern: the kernel to consider.
  * @param x: first point.
  * @param y: second point.
+ * @tparam SizeMatrix: nested vectors, or the facets of a particle in
+ *         SmoothingLengths, indexed as vh[facet][component].
  * @param vh: size matrix.
  * @return evaluated kernel value.
  */
-template<int dim>
+template<int dim, class SizeMatrix>
 double eval(Geometry const geo,
             Kernel const kern,
             Wonton::Point<dim> const& x,
             Wonton::Point<dim> const& y,
-            std::vector<std::vector<double>> const& vh) {
+            SizeMatrix const& vh) {
   switch (geo) {
     case TENSOR:
     case ELLIPTIC: {
@@ -490,6 +502,113 @@ double eval(Geometry const geo,
   }
 }
 
+/**
+ * @brief elliptic or tensor product weights of a point with a batch of
+ *        points, for a kernel known at compile time.
+ *
+ * The loop over the batch has no call nor branch left once the kernel
+ * is inlined, so that the compiler can vectorize it. The arithmetic is
+ * the one of the single point evaluation.
+ *
+ * @tparam dim: spatial dimension.
+ * @tparam kern: the kernel function.
+ * @param geometry: ELLIPTIC or TENSOR.
+ * @param x: first point.
+ * @param y: array of second points.
+ * @param n: number of second points.
+ * @param h: size metric.
+ * @param result: array of the n evaluated kernel values.
+ */
+template<int dim, double (*kern)(double)>
+void eval_batch(Geometry const geometry,
+                Wonton::Point<dim> const& x,
+                Wonton::Point<dim> const* y, int n,
+                std::array<double,dim> const& h,
+                double* result) {
+  double const norm = kern(0.0);
+  switch (geometry) {
+    case ELLIPTIC: {
+      for (int j = 0; j < n; j++) {
+        double distance = 0.;
+        for (int i = 0; i < dim; i++)
+          distance += (x[i] - y[j][i]) * (x[i] - y[j][i]) / (h[i] * h[i]);
+        result[j] = kern(std::sqrt(distance)) / norm;
+      }
+      break;
+    }
+    case TENSOR: {
+      for (int j = 0; j < n; j++) {
+        double value = 1.;
+        for (int i = 0; i < dim; i++)
+          value *= kern((x[i] - y[j][i]) / h[i]) / norm;
+        result[j] = value;
+      }
+      break;
+    }
+    default:
+      throw std::runtime_error("invalid weight geometry");
+  }
+}
+
+/**
+ * @brief evaluation function for any weight of a point with a batch of
+ *        points sharing the same geometry, kernel and size matrix.
+ *
+ * @tparam dim: spatial dimension.
+ * @param geo: the geometry to consider.
+ * @param kern: the kernel to consider.
+ * @param x: first point.
+ * @param y: array of second points.
+ * @param n: number of second points.
+ * @tparam SizeMatrix: nested vectors, or the facets of a particle in
+ *         SmoothingLengths, indexed as vh[facet][component].
+ * @param vh: size matrix.
+ * @param result: array of the n evaluated kernel values, the same as
+ *        eval(geo, kern, x, y[j], vh).
+ */
+template<int dim, class SizeMatrix>
+void eval(Geometry const geo,
+          Kernel const kern,
+          Wonton::Point<dim> const& x,
+          Wonton::Point<dim> const* y, int n,
+          SizeMatrix const& vh,
+          double* result) {
+  switch (geo) {
+    case TENSOR:
+    case ELLIPTIC: {
+      std::array<double,dim> h;
+      for (size_t i = 0; i < dim; i++)
+        h[i] = vh[0][i];
+      switch (kern) {
+        case B4:           eval_batch<dim, b4>(geo, x, y, n, h, result); break;
+        case SQUARE:       eval_batch<dim, square>(geo, x, y, n, h, result); break;
+        case EPANECHNIKOV: eval_batch<dim, epanechnikov>(geo, x, y, n, h, result); break;
+        case POLYRAMP:     eval_batch<dim, polyramp>(geo, x, y, n, h, result); break;
+        case INVSQRT:      eval_batch<dim, invsqrt>(geo, x, y, n, h, result); break;
+        case COULOMB:      eval_batch<dim, coulomb>(geo, x, y, n, h, result); break;
+        case STEP:         eval_batch<dim, step>(geo, x, y, n, h, result); break;
+        default:
+          throw std::runtime_error("invalid weight kernel");
+      }
+      break;
+    }
+    case FACETED: {
+      int const nsides = vh.size();
+      std::vector<FacetData<dim>> facets(nsides);
+      for (int i = 0; i < nsides; i++) {
+        for (int j = 0; j < dim; j++)
+          facets[i].normal[j] = vh[i][j];
+        facets[i].smoothing = vh[i][dim];
+      }
+      for (int j = 0; j < n; j++)
+        result[j] = faceted<dim>(kern, x, y[j], facets, nsides);
+      break;
+    }
+    default:
+      throw std::runtime_error("invalid weight geometry");
+  }
+}
+
 }}}  // namespace Portage::Meshfree::Weight
 
 #endif  // PORTAGE_SUPPORT_WEIGHT_H_
@@ -0,0 +1,331 @@
+/*
+  This file is part of the Ristra portage project.
+  Please see the license file at the root of this repository, or at:
+  https://github.com/laristra/portage/blob/master/LICENSE
+*/
+
+#ifndef PORTAGE_SUPPORT_WEIGHTS_CSR_H_
+#define PORTAGE_SUPPORT_WEIGHTS_CSR_H_
+
+#include <vector>
+#include <cassert>
+#include <algorithm>
+#include <iterator>
+#include <cstddef>
+
+#include "portage/support/portage.h"
+
+/*!
+  @file weights_csr.h
+  @brief Compressed storage of the intersection moments of all target
+  entities.
+*/
+
+namespace Portage {
+
+/*!
+  @class WeightsCSR "weights_csr.h"
+
+  @brief Intersection moments of all target entities stored in
+  compressed sparse row form.
+
+  The moments of target entity t are entries offsets[t] to
+  offsets[t+1]-1 of a single list of source entities and of a single
+  array of moments with a fixed number of moments per entry. This
+  replaces the Portage::vector<std::vector<Weights_t>> layout (one
+  heap-allocated list per target entity and one heap-allocated moment
+  vector per entry) with three flat arrays.
+
+  Rows and entries are exposed through lightweight views mimicking
+  std::vector<Weights_t> and Weights_t (an entry has an 'entityID' and
+  indexable 'weights'), so that code written against the old layout
+  works unchanged on both. If entries of a row have fewer moments than
+  others, their missing moments are zero.
+*/
+class WeightsCSR {
+ public:
+
+  /// Read-only view of the moments of one entry
+  class Moments {
+   public:
+    Moments(double const* data, int size) : data_(data), size_(size) {}
+
+    double operator[](int i) const { assert(i < size_); return data_[i]; }
+    int size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    double const* begin() const { return data_; }
+    double const* end() const { return data_ + size_; }
+
+    /// Copy the moments (for code expecting a std::vector<double>)
+    operator std::vector<double>() const { return {begin(), end()}; }
+
+   private:
+    double const* data_;
+    int size_;
+  };
+
+  /// Read-only view of one entry (source entity and its moments)
+  struct Entry {
+    int entityID;
+    Moments weights;
+
+    /// Copy the entry into a Weights_t
+    operator Weights_t() const {
+      return Weights_t(entityID, std::vector<double>(weights));
+    }
+  };
+
+  /// Read-only view of the entries of one target entity
+  class Row {
+   public:
+
+    /// Random access iterator over the entries of a row
+    class const_iterator {
+     public:
+      using iterator_category = std::random_access_iterator_tag;
+      using value_type = Entry;
+      using difference_type = std::ptrdiff_t;
+      using pointer = void;
+      using reference = Entry;
+
+      const_iterator(int const* entities, double const* moments, int stride)
+          : entities_(entities), moments_(moments), stride_(stride) {}
+
+      Entry operator*() const {
+        return {*entities_, Moments(moments_, stride_)};
+      }
+      Entry operator[](difference_type n) const { return *(*this + n); }
+      const_iterator& operator++() { return *this += 1; }
+      const_iterator operator++(int) { auto it = *this; *this += 1; return it; }
+      const_iterator& operator--() { return *this -= 1; }
+      const_iterator operator--(int) { auto it = *this; *this -= 1; return it; }
+      const_iterator& operator+=(difference_type n) {
+        entities_ += n;
+        moments_ += n*stride_;
+        return *this;
+      }
+      const_iterator& operator-=(difference_type n) { return *this += -n; }
+      const_iterator operator+(difference_type n) const { auto it = *this; return it += n; }
+      const_iterator operator-(difference_type n) const { auto it = *this; return it -= n; }
+      difference_type operator-(const_iterator const& it) const { return entities_ - it.entities_; }
+      bool operator==(const_iterator const& it) const { return entities_ == it.entities_; }
+      bool operator!=(const_iterator const& it) const { return entities_ != it.entities_; }
+      bool operator<(const_iterator const& it) const { return entities_ < it.entities_; }
+
+     private:
+      int const* entities_;
+      double const* moments_;
+      int stride_;
+    };
+
+    Row(int const* entities, double const* moments, int size, int stride)
+        : entities_(entities), moments_(moments), size_(size), stride_(stride) {}
+
+    int size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    Entry operator[](int i) const {
+      assert(i < size_);
+      return {entities_[i], Moments(moments_ + i*stride_, stride_)};
+    }
+
+    const_iterator begin() const { return {entities_, moments_, stride_}; }
+    const_iterator end() const { return begin() + size_; }
+
+    /// Copy the row (for code expecting a std::vector<Weights_t>)
+    operator std::vector<Weights_t>() const {
+      return std::vector<Weights_t>(begin(), end());
+    }
+
+   private:
+    int const* entities_;
+    double const* moments_;
+    int size_;
+    int stride_;
+  };
+
+
+  /// Default constructor: no target entities
+  WeightsCSR() : offsets_(1, 0) {}
+
+  /*!
+    @brief Compress weights stored one list per target entity
+    @param[in] weights  moments of intersection of each target entity
+  */
+  explicit WeightsCSR(Portage::vector<std::vector<Weights_t>> const& weights)
+      : offsets_(1, 0) {
+    int const ntargets = weights.size();
+    int nentries = 0;
+    for (int t = 0; t < ntargets; t++) {
+      std::vector<Weights_t> const& row = weights[t];
+      nentries += row.size();
+    }
+    reserve(ntargets, nentries);
+    for (int t = 0; t < ntargets; t++)
+      append(weights[t]);
+  }
+
+  /*!
+    @brief Reserve space to avoid reallocations while appending
+    @param[in] ntargets  expected number of target entities
+    @param[in] nentries  expected total number of entries
+  */
+  void reserve(int ntargets, int nentries) {
+    offsets_.reserve(ntargets + 1);
+    entities_.reserve(nentries);
+    moments_.reserve(static_cast<size_t>(nentries) * std::max(stride_, 1));
+  }
+
+  /*!
+    @brief Add the moments of the next target entity
+    @param[in] row  source entities and moments of intersection
+  */
+  void append(std::vector<Weights_t> const& row) {
+    for (auto const& entry : row)
+      if (static_cast<int>(entry.weights.size()) > stride_)
+        restride(entry.weights.size());
+
+    for (auto const& entry : row) {
+      entities_.push_back(entry.entityID);
+      int const nmoments = entry.weights.size();
+      moments_.insert(moments_.end(), entry.weights.begin(), entry.weights.end());
+      moments_.insert(moments_.end(), stride_ - nmoments, 0.0);
+    }
+    offsets_.push_back(entities_.size());
+  }
+
+  /*!
+    @brief Add the moments of the next target entity given as flat arrays
+    @param[in] entities  source entities of the entries
+    @param[in] moments   moments of the entries, nmoments per entry
+    @param[in] nentries  number of entries
+    @param[in] nmoments  number of moments per entry
+  */
+  void append(int const* entities, double const* moments, int nentries,
+              int nmoments) {
+    if (nentries > 0 && nmoments > stride_)
+      restride(nmoments);
+
+    entities_.insert(entities_.end(), entities, entities + nentries);
+    if (nmoments == stride_)
+      moments_.insert(moments_.end(), moments,
+                      moments + static_cast<size_t>(nentries) * nmoments);
+    else
+      for (int i = 0; i < nentries; i++) {
+        moments_.insert(moments_.end(), moments + i * nmoments,
+                        moments + (i+1) * nmoments);
+        moments_.insert(moments_.end(), stride_ - nmoments, 0.0);
+      }
+    offsets_.push_back(entities_.size());
+  }
+
+  /// Add the moments of all the target entities of another instance
+  void append(WeightsCSR const& other) {
+    int const ntargets = other.size();
+    for (int t = 0; t < ntargets; t++) {
+      int const first = other.offsets_[t];
+      append(other.entities_.data() + first,
+             other.moments_.data() + static_cast<size_t>(first) * other.stride_,
+             other.offsets_[t+1] - first, other.stride_);
+    }
+  }
+
+  /// Remove all target entities, keeping the memory for reuse
+  void clear() {
+    offsets_.assign(1, 0);
+    entities_.clear();
+    moments_.clear();
+    stride_ = 0;
+  }
+
+  /// Release the memory reserved beyond what is used
+  void shrink_to_fit() {
+    offsets_.shrink_to_fit();
+    entities_.shrink_to_fit();
+    moments_.shrink_to_fit();
+  }
+
+  /// Number of target entities
+  int size() const { return offsets_.size() - 1; }
+
+  /// Is there no target entity?
+  bool empty() const { return size() == 0; }
+
+  /// Total number of entries (target-source pairs) over all target entities
+  int num_entries() const { return entities_.size(); }
+
+  /// Number of moments stored per entry
+  int num_moments() const { return stride_; }
+
+  /// Entries of target entity t
+  Row operator[](int t) const {
+    assert(t < size());
+    int const first = offsets_[t];
+    return Row(entities_.data() + first,
+               moments_.data() + static_cast<size_t>(first) * stride_,
+               offsets_[t+1] - first, stride_);
+  }
+
+  /// Offsets of the rows of each target entity in the entry arrays
+  std::vector<int> const& offsets() const { return offsets_; }
+
+  /// Source entities of all entries
+  std::vector<int> const& entities() const { return entities_; }
+
+  /// Moments of all entries, num_moments() per entry
+  std::vector<double> const& moments() const { return moments_; }
+
+  /// Copy into the one-list-per-target-entity layout
+  Portage::vector<std::vector<Weights_t>> to_vector() const {
+    int const ntargets = size();
+    std::vector<std::vector<Weights_t>> weights(ntargets);
+    for (int t = 0; t < ntargets; t++)
+      weights[t] = (*this)[t];
+    return Portage::vector<std::vector<Weights_t>>(weights.begin(),
+                                                   weights.end());
+  }
+
+ private:
+
+  // Widen the moment array when an entry has more moments than the others
+  void restride(int stride) {
+    int const nentries = entities_.size();
+    std::vector<double> moments(static_cast<size_t>(nentries) * stride, 0.0);
+    for (int i = 0; i < nentries; i++)
+      std::copy(moments_.begin() + static_cast<size_t>(i) * stride_,
+                moments_.begin() + static_cast<size_t>(i+1) * stride_,
+                moments.begin() + static_cast<size_t>(i) * stride);
+    moments_.swap(moments);
+    stride_ = stride;
+  }
+
+  std::vector<int> offsets_;
+  std::vector<int> entities_;
+  std::vector<double> moments_;
+  int stride_ = 0;
+};
+
+/*!
+  @brief Entries of target entity t, whatever the layout of the weights.
+  Lets code be written once for both layouts.
+*/
+#ifdef PORTAGE_ENABLE_THRUST
+// elements of a thrust vector cannot be bound to host references
+inline std::vector<Weights_t>
+weights_row(Portage::vector<std::vector<Weights_t>> const& weights, int t) {
+  return weights[t];
+}
+#else
+inline std::vector<Weights_t> const&
+weights_row(Portage::vector<std::vector<Weights_t>> const& weights, int t) {
+  return weights[t];
+}
+#endif
+
+inline WeightsCSR::Row weights_row(WeightsCSR const& weights, int t) {
+  return weights[t];
+}
+
+}  // namespace Portage
+
+#endif  // PORTAGE_SUPPORT_WEIGHTS_CSR_H_